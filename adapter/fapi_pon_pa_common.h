@@ -133,6 +133,8 @@ struct fapi_pon_wrapper_cfg {
 	uint32_t sfp_tweaks;
 	/** Bias threshold */
 	uint16_t bias_threshold;
+	/** Maximum age of the cached optical status in ms */
+	uint32_t dmi_max_age;
 	/** Lower optical threshold */
 	int8_t lower_receive_optical_threshold;
 	/** Upper optical threshold */
@@ -196,6 +198,8 @@ struct fapi_pon_wrapper_cfg {
 struct fapi_pon_ani_g_data {
 	/** Lock for data structure */
 	pthread_mutex_t lock;
+	/** Wakes up the alarm checking before the next sample is due */
+	pthread_cond_t cond;
 	/** Update status of ANI-G ME */
 	bool update_status;
 	/** Thread identifier */
@@ -224,6 +228,10 @@ struct fapi_pon_ani_g_data {
 	bool signal_fail;
 	/** Signal degrade */
 	bool signal_degrade;
+	/** Signal fail state last reported by the alarm checking */
+	bool signal_fail_reported;
+	/** Signal degrade state last reported by the alarm checking */
+	bool signal_degrade_reported;
 };
 
 struct pa_config;
@@ -234,8 +242,12 @@ struct fapi_pon_wrapper_ctx {
 	struct pon_ctx *ponevt_ctx;
 	/** Pointer to context of higher layer */
 	void *hl_ctx;
-	/* locks this structure */
+	/* locks this structure, the mailbox access through pon_ctx is
+	 * thread-safe on its own and does not need this lock
+	 */
 	pthread_mutex_t lock;
+	/** protects the mapper array, readers may run in parallel */
+	pthread_rwlock_t mapper_lock;
 
 	/** Configuration parameters for FAPI PON */
 	struct fapi_pon_wrapper_cfg cfg;
@@ -256,6 +268,31 @@ struct fapi_pon_wrapper_ctx {
 	/** Control parameters for ANI-G ME */
 	struct fapi_pon_ani_g_data ani_g_data;
 
+	/** Counter snapshot shared by the PM counter getters */
+	struct pon_cnt_snapshot cnt_snap;
+	/** protects the counter snapshot, the GEM port and the TWDM channel
+	 *  counters
+	 */
+	pthread_mutex_t cnt_snap_lock;
+	/** Counters of all active GEM ports shared by the GEM port PM
+	 *  counter getters
+	 */
+	struct pon_gem_port_counters *gem_cnt;
+	/** Number of entries allocated in gem_cnt */
+	uint32_t gem_cnt_size;
+	/** Number of valid entries in gem_cnt */
+	uint32_t gem_cnt_num;
+	/** Time the GEM port counters were read in us */
+	uint64_t gem_cnt_time;
+	/** TWDM counters of all active channels shared by the PM counter
+	 *  getters
+	 */
+	struct pon_twdm_channel_counters twdm_cnt[PON_TWDM_DSWLCH_MAX];
+	/** Number of valid entries in twdm_cnt */
+	uint32_t twdm_cnt_num;
+	/** Time the TWDM channel counters were read in us */
+	uint64_t twdm_cnt_time;
+
 	/** true in case the FW init was done */
 	bool init_done_fw;
 	/** true in case the OMCI init was done */
@@ -320,6 +357,14 @@ pon_pa_ani_g_alarm_check_start(struct fapi_pon_wrapper_ctx *ctx);
 enum pon_adapter_errno
 pon_pa_ani_g_alarm_check_stop(struct fapi_pon_wrapper_ctx *ctx);
 
+/**
+ *	Wakes up the alarm checking for optical values to report a changed
+ *	signal fail or signal degrade state.
+ *
+ *	\param[in] ctx     Wrapper context.
+ */
+void pon_pa_ani_g_alarm_wake(struct fapi_pon_wrapper_ctx *ctx);
+
 /**
  *	Retrigger the alarm checking for optical values.
  *
@@ -26,9 +26,15 @@
 
 #include <pthread.h>
 #include <string.h>
+#include <errno.h>
+#include <poll.h>
 
 #define DMI_STATUS_CONTROL	110
 #define DMI_CONTROL_SOFT_TX_DISABLE	(1 << 6)
+/* Maximum number of events handled per wakeup of the event thread */
+#define PON_EVENT_BURST	32
+/* Threads executing the alarm and other unacknowledged event callbacks */
+#define PON_EVENT_WORKERS	3
 
 static bool is_operational_state(int state)
 {
@@ -209,10 +215,12 @@ handle_active_alarms(void *priv, const struct pon_alarm_status *alarms)
 
 	case PON_ALARM_STATIC_SF:
 		ctx->ani_g_data.signal_fail = PON_ALARM_EN;
+		pon_pa_ani_g_alarm_wake(ctx);
 		break;
 
 	case PON_ALARM_STATIC_SD:
 		ctx->ani_g_data.signal_degrade = PON_ALARM_EN;
+		pon_pa_ani_g_alarm_wake(ctx);
 		break;
 
 	default:
@@ -234,10 +242,12 @@ handle_clear_alarms(void *priv, const struct pon_alarm_status *alarms)
 	switch (alarms->alarm_id) {
 	case PON_ALARM_STATIC_SF:
 		ctx->ani_g_data.signal_fail = PON_ALARM_DIS;
+		pon_pa_ani_g_alarm_wake(ctx);
 		break;
 
 	case PON_ALARM_STATIC_SD:
 		ctx->ani_g_data.signal_degrade = PON_ALARM_DIS;
+		pon_pa_ani_g_alarm_wake(ctx);
 		break;
 
 	case PON_ALARM_STATIC_LODS:
@@ -447,7 +457,9 @@ static void init_ponip_fw(struct fapi_pon_wrapper_ctx *ctx,
 	struct pon_gpon_cfg gpon_onu_cfg = {0};
 	struct pon_iop_cfg iop_cfg = {0};
 	struct pon_enc_cfg enc_cfg = {0};
+	struct pon_cfg_tx_stats tx_stats = {0};
 	enum fapi_pon_errorcode ret = PON_STATUS_OK;
+	enum fapi_pon_errorcode tx_ret;
 
 	fapi_pon_register_alarm_report(ponevt_ctx, handle_active_alarms);
 	fapi_pon_register_alarm_clear(ponevt_ctx, handle_clear_alarms);
@@ -469,6 +481,17 @@ static void init_ponip_fw(struct fapi_pon_wrapper_ctx *ctx,
 	if (ctx->event_handlers.mib_reset)
 		ctx->event_handlers.mib_reset(ctx->hl_ctx);
 
+	/* The configuration below is recorded and sent as one batch. The
+	 * firmware lost its configuration, so no message is skipped. The
+	 * recorded messages are sent before each message to the mailbox
+	 * driver, a set function called after one of them failed returns
+	 * its error. The remaining answers are checked when the transaction
+	 * is committed.
+	 */
+	tx_ret = fapi_pon_cfg_tx_begin(pon_ctx);
+	if (tx_ret != PON_STATUS_OK)
+		dbg_err_fn_ret(fapi_pon_cfg_tx_begin, tx_ret);
+
 	if (memcpy_s(omci_cfg.mac_sa, sizeof(omci_cfg.mac_sa),
 		     cfg->mac_sa, sizeof(cfg->mac_sa)))
 		ret = PON_STATUS_ERR;
@@ -665,6 +688,18 @@ static void init_ponip_fw(struct fapi_pon_wrapper_ctx *ctx,
 	}
 
 err:
+	if (tx_ret == PON_STATUS_OK) {
+		tx_ret = fapi_pon_cfg_tx_commit(pon_ctx, &tx_stats);
+		if (tx_ret != PON_STATUS_OK) {
+			dbg_err("%s: FW command 0x%x failed: %d\n", __func__,
+				tx_stats.err_command, tx_ret);
+			if (ret == PON_STATUS_OK)
+				ret = tx_ret;
+		}
+		dbg_prn("FW config: %u messages, %u sent, %u skipped\n",
+			tx_stats.msgs, tx_stats.sent, tx_stats.skipped);
+	}
+
 	ctx->init_result = ret;
 }
 
@@ -691,6 +726,7 @@ event_handling_thread(void *arg)
 {
 	struct fapi_pon_wrapper_ctx *ctx = arg;
 	enum fapi_pon_errorcode ret;
+	struct pollfd pfd = {0,};
 	int err;
 
 	err = pthread_setname_np(pthread_self(), "ponevt");
@@ -706,9 +742,23 @@ event_handling_thread(void *arg)
 	sem_post(&ctx->init_done);
 #endif
 
+	ret = fapi_pon_listener_fd_get(ctx->ponevt_ctx, &pfd.fd);
+	if (ret != PON_STATUS_OK) {
+		dbg_err_fn_ret(fapi_pon_listener_fd_get, ret);
+		return EXIT_SUCCESS;
+	}
+	pfd.events = POLLIN;
+
 	for (;;) {
 		pthread_testcancel();
-		ret = fapi_pon_listener_run(ctx->ponevt_ctx);
+		/* poll() is a cancellation point */
+		if (poll(&pfd, 1, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		ret = fapi_pon_listener_dispatch(ctx->ponevt_ctx,
+						 PON_EVENT_BURST, NULL);
 		if (ret != PON_STATUS_OK)
 			break;
 	}
@@ -749,7 +799,8 @@ pon_pa_event_handling_init(struct fapi_pon_wrapper_ctx *ctx)
 	sem_init(&ctx->init_done, 0, 0);
 	pthread_mutex_init(&ctx->init_lock, NULL);
 
-	ret = fapi_pon_open(&ponevt_ctx);
+	/* The deferred event callbacks use the context concurrently */
+	ret = fapi_pon_open_mt(&ponevt_ctx);
 	if (ret != PON_STATUS_OK)
 		return EXIT_FAILURE;
 
@@ -782,6 +833,13 @@ pon_pa_event_handling_init(struct fapi_pon_wrapper_ctx *ctx)
 		return EXIT_FAILURE;
 	}
 
+	/* Slow OMCI alarm handling must not delay the firmware answers,
+	 * without the workers all callbacks are executed by the listener.
+	 */
+	ret = fapi_pon_listener_defer_start(ponevt_ctx, PON_EVENT_WORKERS);
+	if (ret != PON_STATUS_OK)
+		dbg_err_fn_ret(fapi_pon_listener_defer_start, ret);
+
 	/* Set the soft tx disable bit in the DMI EEPROM.
 	 * By this we ensure that the TX path is disabled before loading
 	 * the firmware and we don't have the laser active before the firmware
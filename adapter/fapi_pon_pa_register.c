@@ -29,6 +29,7 @@
 #include "fapi_pon_pa_register.h"
 #include "fapi_pon_pa_twdm.h"
 #include "fapi_pon.h"
+#include "fapi_pon_alarms.h"
 
 uint8_t libpon_dbg_lvl = DBG_ERR;
 
@@ -480,6 +481,9 @@ static const struct cfg_option cfg_options[] = {
 		   parse_str, eeprom_dmi),
 	CFG_OPTION(PON_OPT, "optic", "sfp_eeprom", "serial_id", NULL,
 		   parse_str, eeprom_serial_id),
+	/* The ANI-G alarm thread refreshes the status at least every 10 s */
+	CFG_OPTION(PON_OPT, "optic", "sfp_eeprom", "dmi_max_age", "15000",
+		   parse_uint, dmi_max_age),
 	/* Default values for thresholds: ITU-T G.989 chapter 11.1.4 */
 	/* Defined in units of 0.5dBm */
 	/* - 29 dBm is below the lowest usable receive power value. */
@@ -948,8 +952,10 @@ static enum pon_adapter_errno init(char const * const *init_data,
 	static const uint8_t protocol_default[5] = {0x0, 0x19, 0xA7, 0x0, 0x2};
 	const char *pon_mode = NULL;
 	struct pon_dp_config dp_config = { 0 };
+	pthread_condattr_t cond_attr;
 
 	pthread_mutex_init(&ctx->lock, NULL);
+	pthread_rwlock_init(&ctx->mapper_lock, NULL);
 
 	error = pon_pa_mapper_init(ctx);
 	if (error != PON_ADAPTER_SUCCESS)
@@ -1066,7 +1072,10 @@ static enum pon_adapter_errno init(char const * const *init_data,
 			return error;
 	}
 
-	fapi_ret = fapi_pon_open(&pon_ctx);
+	/* The ME handlers are called from several threads of the OMCI daemon,
+	 * use a context which can be shared by them.
+	 */
+	fapi_ret = fapi_pon_open_mt(&pon_ctx);
 	if (fapi_ret != PON_STATUS_OK)
 		return PON_ADAPTER_ERROR;
 
@@ -1100,8 +1109,17 @@ static enum pon_adapter_errno init(char const * const *init_data,
 
 	set_sd_polarity(cfg, pon_ctx);
 
-	/* Initialize ani_g_data lock */
+	/* Initialize ani_g_data lock, the condition waits use the monotonic
+	 * clock so a time change does not stretch the sampling interval
+	 */
 	pthread_mutex_init(&ctx->ani_g_data.lock, NULL);
+	pthread_condattr_init(&cond_attr);
+#ifndef WIN32
+	pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+#endif
+	pthread_cond_init(&ctx->ani_g_data.cond, &cond_attr);
+	pthread_condattr_destroy(&cond_attr);
+	pthread_mutex_init(&ctx->cnt_snap_lock, NULL);
 
 	ctx->pon_ctx = pon_ctx;
 	ctx->event_handlers = *event_handler;
@@ -1130,7 +1148,10 @@ static enum pon_adapter_errno shutdown(void *ll_handle)
 	if (ctx->pon_ctx)
 		(void)fapi_pon_close(ctx->pon_ctx);
 
+	pthread_rwlock_destroy(&ctx->mapper_lock);
+	pthread_mutex_destroy(&ctx->cnt_snap_lock);
 	pthread_mutex_destroy(&ctx->lock);
+	free(ctx->gem_cnt);
 	free(ctx);
 
 	return pa_error;
@@ -1144,9 +1165,7 @@ static enum pon_adapter_errno ik_key_get(void *ll_handle, uint8_t *ik_key,
 	struct fapi_pon_wrapper_ctx *ctx = ll_handle;
 	struct pon_ctx *pon_ctx = ctx->pon_ctx;
 
-	pthread_mutex_lock(&ctx->lock);
 	ret = fapi_pon_omci_ik_get(pon_ctx, &omci_ik);
-	pthread_mutex_unlock(&ctx->lock);
 	if (ret != PON_STATUS_OK)
 		return pon_fapi_to_pa_error(ret);
 
@@ -1202,26 +1221,37 @@ static enum pon_adapter_errno get_pon_op_mode(void *ll_handle,
 	return PON_ADAPTER_SUCCESS;
 }
 
+/*
+ * The alarm state is tracked per process by the event listener, not per
+ * context, all contexts of the process see the same state. An edge alarm has
+ * no current state, it is reported as set from the time it was raised until
+ * the edge alarms are cleared with fapi_pon_alarm_snapshot_get() anywhere in
+ * this process.
+ */
 static enum pon_adapter_errno get_alarm_status(void *ll_handle,
 					       uint16_t alarm_id,
 					       uint8_t *status)
 {
 	struct fapi_pon_wrapper_ctx *ctx = ll_handle;
-	struct pon_alarm_status param = {0,};
+	struct pon_alarm_snapshot param = {0,};
 	enum fapi_pon_errorcode err;
 
 	if (!status)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_alarm_status_get(ctx->pon_ctx, alarm_id, &param);
-	pthread_mutex_unlock(&ctx->lock);
+	/* The alarms are tracked by the ponevt listener, no FW access */
+	err = fapi_pon_alarm_snapshot_get(ctx->pon_ctx, &param, 0);
 	if (err != PON_STATUS_OK) {
 		dbg_err("getting alarm status failed\n");
 		return pon_fapi_to_pa_error(err);
 	}
 
-	*status = param.alarm_status;
+	if (fapi_pon_alarm_edge_info_get(alarm_id))
+		*status = PON_ALARM_IS_SET(param.edge, alarm_id) ?
+			  PON_ALARM_EN : PON_ALARM_DIS;
+	else
+		*status = PON_ALARM_IS_SET(param.level, alarm_id) ?
+			  PON_ALARM_EN : PON_ALARM_DIS;
 
 	return PON_ADAPTER_SUCCESS;
 }
@@ -1232,9 +1262,7 @@ static enum pon_adapter_errno get_pon_status(void *ll_handle, bool *enabled)
 	struct fapi_pon_wrapper_ctx *ctx = ll_handle;
 	enum fapi_pon_errorcode err;
 
-	pthread_mutex_lock(&ctx->lock);
 	err = fapi_pon_gpon_rerange_status_get(ctx->pon_ctx, &rerange_cfg);
-	pthread_mutex_unlock(&ctx->lock);
 	if (err != PON_STATUS_OK) {
 		dbg_err("setting rerange config failed\n");
 		return pon_fapi_to_pa_error(err);
@@ -1294,9 +1322,7 @@ static enum pon_adapter_errno get_gemports(void *ll_handle,
 	if (gemport_num == NULL)
 		return PON_ADAPTER_ERR_PTR_INVALID;
 
-	pthread_mutex_lock(&ctx->lock);
 	ret = fapi_pon_cap_get(pon_ctx, &caps);
-	pthread_mutex_unlock(&ctx->lock);
 	if (ret != PON_STATUS_OK) {
 		dbg_err("The maximum number of GEM ports can not be read from the capabilities!\n");
 		return pon_fapi_to_pa_error(ret);
@@ -1325,9 +1351,7 @@ optic_properties_get(void *ll_handle, struct pa_optic_properties *props)
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
 	ret = fapi_pon_optic_properties_get(ctx->pon_ctx, &tmp);
-	pthread_mutex_unlock(&ctx->lock);
 	if (ret != PON_STATUS_OK)
 		return pon_fapi_to_pa_error(ret);
 
@@ -1385,10 +1409,9 @@ optic_status_get(void *ll_handle, struct pa_optic_status *props)
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
 	scale = ctx->cfg.optic.tx_power_scale;
-	ret = fapi_pon_optic_status_get(ctx->pon_ctx, &tmp, scale);
-	pthread_mutex_unlock(&ctx->lock);
+	ret = fapi_pon_optic_status_cached_get(ctx->pon_ctx, &tmp, scale,
+					       ctx->cfg.dmi_max_age);
 	if (ret != PON_STATUS_OK)
 		return pon_fapi_to_pa_error(ret);
 
@@ -1432,10 +1455,8 @@ static enum pon_adapter_errno eeprom_data_get(void *ll_handle,
 	if (!ctx || ddmi == PON_DDMI_MAX)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
 	ret = fapi_pon_eeprom_data_get(ctx->pon_ctx, ddmi, data, offset,
 				       data_size);
-	pthread_mutex_unlock(&ctx->lock);
 	if (ret != PON_STATUS_OK)
 		return pon_fapi_to_pa_error(ret);
 
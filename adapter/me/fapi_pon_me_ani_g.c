@@ -29,9 +29,7 @@ dba_mode_get(void *ll_handle, uint16_t me_id, uint8_t *dba_mode)
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
 	pon_ret = fapi_pon_cap_get(pon_ctx, &caps);
-	pthread_mutex_unlock(&ctx->lock);
 	if (pon_ret != PON_STATUS_OK) {
 		dbg_err_fn_ret(fapi_pon_cap_get, pon_ret);
 		return pon_fapi_to_pa_error(pon_ret);
@@ -68,9 +66,7 @@ total_tcon_num_get(void *ll_handle, uint16_t me_id, uint16_t *num)
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
 	pon_ret = fapi_pon_cap_get(pon_ctx, &caps);
-	pthread_mutex_unlock(&ctx->lock);
 	if (pon_ret != PON_STATUS_OK) {
 		dbg_err_fn_ret(fapi_pon_cap_get, pon_ret);
 		return pon_fapi_to_pa_error(pon_ret);
@@ -90,9 +86,7 @@ response_time_get(void *ll_handle, uint16_t me_id, uint16_t *ont_response_time)
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
 	pon_ret = fapi_pon_gpon_status_get(pon_ctx, &gpon_status);
-	pthread_mutex_unlock(&ctx->lock);
 	if (pon_ret != PON_STATUS_OK) {
 		dbg_err_fn_ret(fapi_pon_gpon_status_get, pon_ret);
 		return pon_fapi_to_pa_error(pon_ret);
@@ -109,9 +103,7 @@ static enum pon_adapter_errno onu_id_get(void *ll_handle, uint32_t *onu_id)
 	enum fapi_pon_errorcode pon_ret;
 	struct pon_gpon_status gpon_status;
 
-	pthread_mutex_lock(&ctx->lock);
 	pon_ret = fapi_pon_gpon_status_get(pon_ctx, &gpon_status);
-	pthread_mutex_unlock(&ctx->lock);
 	if (pon_ret != PON_STATUS_OK) {
 		dbg_err_fn_ret(fapi_pon_gpon_status_get, pon_ret);
 		return pon_fapi_to_pa_error(pon_ret);
@@ -131,10 +123,9 @@ supply_voltage_get(void *ll_handle, uint16_t me_id, uint16_t *voltage)
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
-	pon_ret = fapi_pon_optic_status_get(pon_ctx, &optic_status,
-					ctx->cfg.optic.tx_power_scale);
-	pthread_mutex_unlock(&ctx->lock);
+	pon_ret = fapi_pon_optic_status_cached_get(pon_ctx, &optic_status,
+					ctx->cfg.optic.tx_power_scale,
+					ctx->cfg.dmi_max_age);
 	if (pon_ret != PON_STATUS_OK)
 		*voltage = 0;
 	else
@@ -160,10 +151,9 @@ signal_lvl_rx_get(void *ll_handle, uint16_t me_id, int16_t *level)
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
-	pon_ret = fapi_pon_optic_status_get(pon_ctx, &optic_status,
-					ctx->cfg.optic.tx_power_scale);
-	pthread_mutex_unlock(&ctx->lock);
+	pon_ret = fapi_pon_optic_status_cached_get(pon_ctx, &optic_status,
+					ctx->cfg.optic.tx_power_scale,
+					ctx->cfg.dmi_max_age);
 	if (pon_ret != PON_STATUS_OK)
 		*level = DMI_POWER_ZERO;
 	else
@@ -187,10 +177,9 @@ signal_lvl_rx_dbu_get(void *ll_handle, uint16_t me_id, int16_t *level)
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
-	pon_ret = fapi_pon_optic_status_get(pon_ctx, &optic_status,
-					ctx->cfg.optic.tx_power_scale);
-	pthread_mutex_unlock(&ctx->lock);
+	pon_ret = fapi_pon_optic_status_cached_get(pon_ctx, &optic_status,
+					ctx->cfg.optic.tx_power_scale,
+					ctx->cfg.dmi_max_age);
 	if (pon_ret != PON_STATUS_OK) {
 		*level = DMI_POWER_ZERO;
 	} else {
@@ -217,10 +206,9 @@ signal_lvl_tx_get(void *ll_handle, uint16_t me_id, int16_t *level)
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
-	pon_ret = fapi_pon_optic_status_get(pon_ctx, &optic_status,
-					ctx->cfg.optic.tx_power_scale);
-	pthread_mutex_unlock(&ctx->lock);
+	pon_ret = fapi_pon_optic_status_cached_get(pon_ctx, &optic_status,
+					ctx->cfg.optic.tx_power_scale,
+					ctx->cfg.dmi_max_age);
 	if (pon_ret != PON_STATUS_OK)
 		*level = DMI_POWER_ZERO;
 	else
@@ -244,10 +232,9 @@ signal_lvl_tx_dbu_get(void *ll_handle, uint16_t me_id, int16_t *level)
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
-	pon_ret = fapi_pon_optic_status_get(pon_ctx, &optic_status,
-					ctx->cfg.optic.tx_power_scale);
-	pthread_mutex_unlock(&ctx->lock);
+	pon_ret = fapi_pon_optic_status_cached_get(pon_ctx, &optic_status,
+					ctx->cfg.optic.tx_power_scale,
+					ctx->cfg.dmi_max_age);
 	if (pon_ret != PON_STATUS_OK) {
 		*level = DMI_POWER_ZERO;
 	} else {
@@ -276,10 +263,9 @@ bias_current_get(void *ll_handle, uint16_t me_id, uint16_t *bias_current)
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
-	pon_ret = fapi_pon_optic_status_get(pon_ctx, &optic_status,
-					ctx->cfg.optic.tx_power_scale);
-	pthread_mutex_unlock(&ctx->lock);
+	pon_ret = fapi_pon_optic_status_cached_get(pon_ctx, &optic_status,
+					ctx->cfg.optic.tx_power_scale,
+					ctx->cfg.dmi_max_age);
 	if (pon_ret != PON_STATUS_OK)
 		*bias_current = 0;
 	else
@@ -298,10 +284,9 @@ temperature_get(void *ll_handle, uint16_t me_id, int16_t *temperature)
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
-	pon_ret = fapi_pon_optic_status_get(pon_ctx, &optic_status,
-					ctx->cfg.optic.tx_power_scale);
-	pthread_mutex_unlock(&ctx->lock);
+	pon_ret = fapi_pon_optic_status_cached_get(pon_ctx, &optic_status,
+					ctx->cfg.optic.tx_power_scale,
+					ctx->cfg.dmi_max_age);
 	if (pon_ret != PON_STATUS_OK)
 		*temperature = 0;
 	else
@@ -366,6 +351,7 @@ ani_g_update(void *ll_handle, uint16_t me_id,
 			(int8_t)update_data->upper_tx_power_thr *
 			250; /* 500 * 0.5 */
 
+	pthread_cond_signal(&ani_g_data->cond);
 	pthread_mutex_unlock(&ani_g_data->lock);
 
 	/** TODO: Add missing handling of
@@ -390,6 +376,7 @@ enum pon_adapter_errno pon_ani_g_alarm_recheck(struct fapi_pon_wrapper_ctx *ctx)
 
 	pthread_mutex_lock(&ani_g_data->lock);
 	ani_g_data->update_status = true;
+	pthread_cond_signal(&ani_g_data->cond);
 	pthread_mutex_unlock(&ani_g_data->lock);
 
 	return PON_ADAPTER_SUCCESS;
@@ -20,57 +20,216 @@
 #include "fapi_pon.h"
 #include "fapi_pon_error.h"
 
+#include <errno.h>
 #include <pthread.h>
 #include <string.h>
+#include <time.h>
+
+/* Longest sampling interval, used well inside the thresholds, in s */
+#define OPTIC_CHECK_INTERVAL_MAX 10
+/* Shortest sampling interval, used close to a threshold, in s */
+#define OPTIC_CHECK_INTERVAL_MIN 1
+/* First check is delayed 1 ms after thread start */
+#define OPTIC_CHECK_FIRST 1
+/* Number of failed reads in a row after which an error is logged */
+#define MAX_EEPROM_READ_ATTEMPTS 10
+/* Distance to a power threshold per second of sampling interval,
+ * 1 dB in 0.002 dBm
+ */
+#define OPTIC_POWER_STEP 500
+/* Distance to the bias threshold per second of sampling interval,
+ * 1 mA in 2 uA
+ */
+#define OPTIC_BIAS_STEP 500
+/* Hysteresis to clear a power alarm, 0.5 dB in 0.002 dBm */
+#define OPTIC_POWER_HYST 250
+/* Hysteresis to clear the bias alarm, 0.5 mA in 2 uA */
+#define OPTIC_BIAS_HYST 250
 
 /**
- * Check values against threshold and report alarms
+ * Check values against threshold and report alarms. An active alarm is
+ * only cleared when the value is back inside the threshold by more than
+ * the hysteresis.
  *
  * \param ctx		Wrapper context
  * \param check_upper	Check for upper (true) or lower (false) limits
  * \param value		Current value
  * \param limit		Limit to check against
+ * \param hyst		Hysteresis to clear an active alarm
+ * \param step		Distance to the limit per second of sampling interval
  * \param last_state	Pointer to last alarm state, to detect and update on
  *			changes
  * \param alarm_nr	Number of alarm to report
  * \param only_change	Report only on change (true) or always the current state
  *			(false)
+ *
+ * \return Sampling interval in seconds suitable for the distance of the
+ *	   value to the point where the alarm state changes
  */
-static void alarm_check_and_set(struct fapi_pon_wrapper_ctx *ctx,
-				bool check_upper, int32_t value, int32_t limit,
-				bool *last_state, int alarm_nr,
-				bool only_change)
+static unsigned int alarm_check_and_set(struct fapi_pon_wrapper_ctx *ctx,
+					bool check_upper, int32_t value,
+					int32_t limit, int32_t hyst,
+					int32_t step, bool *last_state,
+					int alarm_nr, bool only_change)
 {
 	bool alarm_state;
+	int32_t dist;
+
+	if (*last_state)
+		limit = check_upper ? limit - hyst : limit + hyst;
 
 	if (check_upper)
-		alarm_state = (value >= limit);
+		alarm_state = *last_state ? (value > limit) : (value >= limit);
 	else
-		alarm_state = (value <= limit);
+		alarm_state = *last_state ? (value < limit) : (value <= limit);
 
 	if (!only_change || *last_state != alarm_state)
 		ctx->event_handlers.optic_alarm(ctx->hl_ctx, alarm_nr,
 						alarm_state);
 
 	*last_state = alarm_state;
+
+	dist = value > limit ? value - limit : limit - value;
+	if (dist / step >= OPTIC_CHECK_INTERVAL_MAX)
+		return OPTIC_CHECK_INTERVAL_MAX;
+	if (dist / step <= OPTIC_CHECK_INTERVAL_MIN)
+		return OPTIC_CHECK_INTERVAL_MIN;
+	return (unsigned int)(dist / step);
 }
 
-/* We are checking optical values every 10 seconds */
-#define OPTIC_CHECK_INTERVAL 10
-/* First check is delayed 1 ms after thread start */
-#define OPTIC_CHECK_FIRST 1
-/* Maximum number of EEPROM read attempts */
-#define MAX_EEPROM_READ_ATTEMPTS 10
+/**
+ * Report a signal alarm state set by the event handling
+ *
+ * \param ctx		Wrapper context
+ * \param state		Current alarm state
+ * \param last_state	Pointer to last reported alarm state
+ * \param alarm_nr	Number of alarm to report
+ * \param only_change	Report only on change (true) or always the current state
+ *			(false)
+ */
+static void signal_alarm_set(struct fapi_pon_wrapper_ctx *ctx, bool state,
+			     bool *last_state, int alarm_nr, bool only_change)
+{
+	if (!only_change || *last_state != state)
+		ctx->event_handlers.optic_alarm(ctx->hl_ctx, alarm_nr, state);
+
+	*last_state = state;
+}
+
+/* Check all values, returns the next sampling interval in seconds */
+static unsigned int
+ani_g_alarm_check(struct fapi_pon_wrapper_ctx *ctx,
+		  const struct pon_optic_status *optic_status, bool only_change)
+{
+	struct fapi_pon_ani_g_data *ani_g_data = &ctx->ani_g_data;
+	unsigned int interval = OPTIC_CHECK_INTERVAL_MAX;
+	unsigned int tmp;
+
+	/*
+	 * Both bias_thr and bias_threshold are given in units of 2uA.
+	 * No units conversion is needed.
+	 */
+	tmp = alarm_check_and_set(ctx, false, optic_status->rx_power,
+				  ani_g_data->lower_optic_thr,
+				  OPTIC_POWER_HYST, OPTIC_POWER_STEP,
+				  &ani_g_data->lower_optic_alarm,
+				  PA_ALARM_ID_ANIG_LOW_RX_OPT_POWER,
+				  only_change);
+	interval = tmp < interval ? tmp : interval;
+
+	tmp = alarm_check_and_set(ctx, true, optic_status->rx_power,
+				  ani_g_data->upper_optic_thr,
+				  OPTIC_POWER_HYST, OPTIC_POWER_STEP,
+				  &ani_g_data->upper_optic_alarm,
+				  PA_ALARM_ID_ANIG_HIGH_RX_OPT_POWER,
+				  only_change);
+	interval = tmp < interval ? tmp : interval;
+
+	tmp = alarm_check_and_set(ctx, false, optic_status->tx_power,
+				  ani_g_data->lower_tx_power_thr,
+				  OPTIC_POWER_HYST, OPTIC_POWER_STEP,
+				  &ani_g_data->lower_tx_power_alarm,
+				  PA_ALARM_ID_ANIG_LOW_TX_OPT_POWER,
+				  only_change);
+	interval = tmp < interval ? tmp : interval;
+
+	tmp = alarm_check_and_set(ctx, true, optic_status->tx_power,
+				  ani_g_data->upper_tx_power_thr,
+				  OPTIC_POWER_HYST, OPTIC_POWER_STEP,
+				  &ani_g_data->upper_tx_power_alarm,
+				  PA_ALARM_ID_ANIG_HIGH_TX_OPT_POWER,
+				  only_change);
+	interval = tmp < interval ? tmp : interval;
+
+	tmp = alarm_check_and_set(ctx, true, optic_status->bias,
+				  ctx->cfg.bias_threshold,
+				  OPTIC_BIAS_HYST, OPTIC_BIAS_STEP,
+				  &ani_g_data->bias_current_alarm,
+				  PA_ALARM_ID_ANIG_LASER_BIAS_CURRENT,
+				  only_change);
+	interval = tmp < interval ? tmp : interval;
+
+	signal_alarm_set(ctx, ani_g_data->signal_fail,
+			 &ani_g_data->signal_fail_reported,
+			 PA_ALARM_ID_ANIG_SF, only_change);
+
+	signal_alarm_set(ctx, ani_g_data->signal_degrade,
+			 &ani_g_data->signal_degrade_reported,
+			 PA_ALARM_ID_ANIG_SD, only_change);
+
+	return interval;
+}
+
+static void ani_g_alarm_unlock(void *arg)
+{
+	pthread_mutex_unlock(arg);
+}
+
+/*
+ * Wait until the next sample is due. The wait ends early when the ANI-G
+ * thresholds were updated, a recheck was requested or a signal alarm
+ * changed. Must be called with cancellation enabled.
+ */
+static void ani_g_alarm_wait(struct fapi_pon_ani_g_data *ani_g_data,
+			     unsigned int interval)
+{
+	struct timespec ts;
+	int err = 0;
+
+	/* the condition variable uses the monotonic clock */
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ts.tv_sec += interval;
+
+	pthread_mutex_lock(&ani_g_data->lock);
+	pthread_cleanup_push(ani_g_alarm_unlock, &ani_g_data->lock);
+	while (err != ETIMEDOUT && !ani_g_data->update_status &&
+	       ani_g_data->signal_fail == ani_g_data->signal_fail_reported &&
+	       ani_g_data->signal_degrade ==
+	       ani_g_data->signal_degrade_reported)
+		err = pthread_cond_timedwait(&ani_g_data->cond,
+					     &ani_g_data->lock, &ts);
+	pthread_cleanup_pop(1);
+}
+
+void pon_pa_ani_g_alarm_wake(struct fapi_pon_wrapper_ctx *ctx)
+{
+	struct fapi_pon_ani_g_data *ani_g_data = &ctx->ani_g_data;
+
+	pthread_mutex_lock(&ani_g_data->lock);
+	pthread_cond_signal(&ani_g_data->cond);
+	pthread_mutex_unlock(&ani_g_data->lock);
+}
 
 static void *ani_g_alarm_thread(void *arg)
 {
 	struct fapi_pon_wrapper_ctx *ctx = arg;
 	struct pon_ctx *pon_ctx = ctx->pon_ctx;
-	struct fapi_pon_wrapper_cfg *cfg = &ctx->cfg;
 	struct fapi_pon_ani_g_data *ani_g_data = &ctx->ani_g_data;
 	enum fapi_pon_errorcode ret;
 	struct pon_optic_status optic_status;
-	uint32_t bias_thr;
+	unsigned int interval;
+	unsigned int retry = OPTIC_CHECK_INTERVAL_MIN;
+	bool only_change = false;
 	int err;
 	int read_err_count;
 
@@ -78,12 +237,6 @@ static void *ani_g_alarm_thread(void *arg)
 	if (err)
 		dbg_err("Can't set name <pon_ani_g_alarm> for thread\n");
 
-	/*
-	 * Both bias_thr and bias_threshold are given in units of 2uA.
-	 * No units conversion is needed.
-	 */
-	bias_thr = cfg->bias_threshold;
-
 	pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, NULL);
 	pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
 
@@ -93,6 +246,7 @@ static void *ani_g_alarm_thread(void *arg)
 	for (;;) {
 		pthread_testcancel();
 
+		/* This also refreshes the status cached for the ANI-G reads */
 		ret = fapi_pon_optic_status_get(pon_ctx, &optic_status,
 						ctx->cfg.optic.tx_power_scale);
 		if (ret == PON_STATUS_INPUT_ERR) {
@@ -100,75 +254,46 @@ static void *ani_g_alarm_thread(void *arg)
 			dbg_err("Exit thread <pon_ani_g_alarm>, no eeprom assigned\n");
 			break;
 		}
-		if (ret == PON_STATUS_EEPROM_READ_ERR) {
-			if (read_err_count < MAX_EEPROM_READ_ATTEMPTS) {
-				read_err_count++;
-				continue;
-			} else {
-				dbg_err("Exit thread <pon_ani_g_alarm>, couldn't read from EEPROM file\n");
-				break;
-			}
+		if (ret != PON_STATUS_OK) {
+			if (++read_err_count == MAX_EEPROM_READ_ATTEMPTS)
+				dbg_err("Couldn't read optical status: %d\n",
+					ret);
+			/*
+			 * Retry with exponential backoff. A pending update or
+			 * signal alarm change would end ani_g_alarm_wait()
+			 * immediately, so sleep unconditionally. sleep() is a
+			 * cancellation point.
+			 */
+			sleep(retry);
+			retry = retry * 2 < OPTIC_CHECK_INTERVAL_MAX ?
+				retry * 2 : OPTIC_CHECK_INTERVAL_MAX;
+			continue;
 		}
 		read_err_count = 0;
-
-		if (ret != PON_STATUS_OK)
-			continue;
+		retry = OPTIC_CHECK_INTERVAL_MIN;
 
 		/* Do not allow thread cancelling during the locked section. */
 		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
 
 		pthread_mutex_lock(&ani_g_data->lock);
 
-		alarm_check_and_set(ctx, false, optic_status.rx_power,
-				    ani_g_data->lower_optic_thr,
-				    &ani_g_data->lower_optic_alarm,
-				    PA_ALARM_ID_ANIG_LOW_RX_OPT_POWER,
-				    !ani_g_data->update_status);
-
-		alarm_check_and_set(ctx, true, optic_status.rx_power,
-				    ani_g_data->upper_optic_thr,
-				    &ani_g_data->upper_optic_alarm,
-				    PA_ALARM_ID_ANIG_HIGH_RX_OPT_POWER,
-				    !ani_g_data->update_status);
-
-		alarm_check_and_set(ctx, false, optic_status.tx_power,
-				    ani_g_data->lower_tx_power_thr,
-				    &ani_g_data->lower_tx_power_alarm,
-				    PA_ALARM_ID_ANIG_LOW_TX_OPT_POWER,
-				    !ani_g_data->update_status);
-
-		alarm_check_and_set(ctx, true, optic_status.tx_power,
-				    ani_g_data->upper_tx_power_thr,
-				    &ani_g_data->upper_tx_power_alarm,
-				    PA_ALARM_ID_ANIG_HIGH_TX_OPT_POWER,
-				    !ani_g_data->update_status);
-
-		alarm_check_and_set(ctx, true, optic_status.bias,
-				    bias_thr,
-				    &ani_g_data->bias_current_alarm,
-				    PA_ALARM_ID_ANIG_LASER_BIAS_CURRENT,
-				    !ani_g_data->update_status);
-
-		ctx->event_handlers.optic_alarm(ctx->hl_ctx,
-						PA_ALARM_ID_ANIG_SF,
-						ani_g_data->signal_fail);
-
-		ctx->event_handlers.optic_alarm(ctx->hl_ctx,
-						PA_ALARM_ID_ANIG_SD,
-						ani_g_data->signal_degrade);
-
+		/* Report all states after start and after an update */
+		if (ani_g_data->update_status)
+			only_change = false;
+		interval = ani_g_alarm_check(ctx, &optic_status, only_change);
 		ani_g_data->update_status = false;
+		only_change = true;
 
 		pthread_mutex_unlock(&ani_g_data->lock);
 
 		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
 
 		/*
-		 * We want to check the fapi_pon_optic_status_get() values
-		 * every OPTIC_CHECK_INTERVAL seconds, so we sleep the time.
-		 * Functions: sleep and usleep are cancellation points.
+		 * Sample faster when a value is close to a threshold and
+		 * slower when all values are well inside. The wait is a
+		 * cancellation point.
 		 */
-		sleep(OPTIC_CHECK_INTERVAL);
+		ani_g_alarm_wait(ani_g_data, interval);
 	}
 	return EXIT_SUCCESS;
 }
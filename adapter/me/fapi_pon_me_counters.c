@@ -20,10 +20,138 @@
 #include "../fapi_pon_pa_common.h"
 #include "fapi_pon.h"
 
+/* Maximum age of the shared counter snapshot in us. The PM history data
+ * MEs are read one after the other at the end of each interval, the
+ * snapshot lets them share the raw counter groups of one pass. A value
+ * handed to OMCI is therefore at most this old, so counts of the last
+ * 2 s of an interval can be reported with the next interval.
+ */
+#define CNT_SNAP_MAX_AGE 2000000
+
 /*
  * PON Adapter wrappers and structures
  */
 
+/* Provide the requested raw counter groups from the shared snapshot, only
+ * the groups which are missing or outdated are read from the firmware.
+ */
+static enum fapi_pon_errorcode
+cnt_snapshot_get(struct fapi_pon_wrapper_ctx *ctx, uint32_t groups,
+		 struct pon_cnt_snapshot *snap)
+{
+	enum fapi_pon_errorcode ret = PON_STATUS_OK;
+	uint64_t now = pon_time_us();
+
+	pthread_mutex_lock(&ctx->cnt_snap_lock);
+	if (ctx->cnt_snap.valid && now - ctx->cnt_snap.time > CNT_SNAP_MAX_AGE)
+		memset(&ctx->cnt_snap, 0, sizeof(ctx->cnt_snap));
+
+	groups &= ~ctx->cnt_snap.valid;
+	if (groups)
+		ret = fapi_pon_cnt_snapshot_get(ctx->pon_ctx, groups,
+						&ctx->cnt_snap);
+	*snap = ctx->cnt_snap;
+	pthread_mutex_unlock(&ctx->cnt_snap_lock);
+
+	return ret;
+}
+
+/* Provide the counters of a GEM port. The counters of all active GEM ports
+ * are read in one batch and shared by the GEM port network CTP PM history
+ * data MEs of one pass. A GEM port which is not part of the batch, for
+ * example because it was just configured, is read on its own.
+ */
+static enum fapi_pon_errorcode
+gem_cnt_get(struct fapi_pon_wrapper_ctx *ctx, uint16_t gem_port_id,
+	    struct pon_gem_port_counters *cnt)
+{
+	struct pon_range_limits limits = {0};
+	enum fapi_pon_errorcode ret;
+	uint64_t now = pon_time_us();
+	uint32_t i;
+
+	pthread_mutex_lock(&ctx->cnt_snap_lock);
+	if (!ctx->gem_cnt &&
+	    fapi_pon_limits_get(ctx->pon_ctx, &limits) == PON_STATUS_OK) {
+		ctx->gem_cnt = calloc(limits.gem_port_idx_max + 1U,
+				      sizeof(*ctx->gem_cnt));
+		if (ctx->gem_cnt)
+			ctx->gem_cnt_size = limits.gem_port_idx_max + 1U;
+	}
+
+	/* a failed batch read is not repeated before the maximum age */
+	if (ctx->gem_cnt && (!ctx->gem_cnt_time ||
+			     now - ctx->gem_cnt_time > CNT_SNAP_MAX_AGE)) {
+		ctx->gem_cnt_num = ctx->gem_cnt_size;
+		ret = fapi_pon_gem_port_counters_batch_get(ctx->pon_ctx, NULL,
+							   &ctx->gem_cnt_num,
+							   ctx->gem_cnt);
+		if (ret != PON_STATUS_OK)
+			ctx->gem_cnt_num = 0;
+		ctx->gem_cnt_time = now;
+	}
+
+	for (i = 0; i < ctx->gem_cnt_num; i++) {
+		if (ctx->gem_cnt[i].gem_port_id == gem_port_id)
+			break;
+	}
+	if (i < ctx->gem_cnt_num) {
+		*cnt = ctx->gem_cnt[i];
+		ret = PON_STATUS_OK;
+	} else {
+		ret = fapi_pon_gem_port_counters_get(ctx->pon_ctx, gem_port_id,
+						     cnt);
+	}
+	pthread_mutex_unlock(&ctx->cnt_snap_lock);
+
+	return ret;
+}
+
+/* Provide the TWDM counters of a channel. The counters of all active
+ * channels are read at once and shared by the TWDM PM history data MEs of
+ * one pass, a channel without a valid channel profile is read on its own.
+ * The error of a channel which can not be read is kept with the channel.
+ */
+static enum fapi_pon_errorcode
+twdm_cnt_get(struct fapi_pon_wrapper_ctx *ctx, uint8_t dswlch_id,
+	     struct pon_twdm_channel_counters *cnt)
+{
+	enum fapi_pon_errorcode ret;
+	uint64_t now = pon_time_us();
+	uint32_t i, num = 1;
+
+	pthread_mutex_lock(&ctx->cnt_snap_lock);
+	/* a failed sweep is not repeated before the maximum age */
+	if (!ctx->twdm_cnt_time ||
+	    now - ctx->twdm_cnt_time > CNT_SNAP_MAX_AGE) {
+		ctx->twdm_cnt_num = ARRAY_SIZE(ctx->twdm_cnt);
+		ret = fapi_pon_twdm_counters_sweep(ctx->pon_ctx, NULL,
+						   &ctx->twdm_cnt_num,
+						   ctx->twdm_cnt);
+		if (ret != PON_STATUS_OK)
+			ctx->twdm_cnt_num = 0;
+		ctx->twdm_cnt_time = now;
+	}
+
+	for (i = 0; i < ctx->twdm_cnt_num; i++) {
+		if (ctx->twdm_cnt[i].dswlch_id == dswlch_id)
+			break;
+	}
+	if (i < ctx->twdm_cnt_num) {
+		*cnt = ctx->twdm_cnt[i];
+		ret = PON_STATUS_OK;
+	} else {
+		ret = fapi_pon_twdm_counters_sweep(ctx->pon_ctx, &dswlch_id,
+						   &num, cnt);
+	}
+	pthread_mutex_unlock(&ctx->cnt_snap_lock);
+
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	return cnt->result;
+}
+
 static enum pon_adapter_errno fec_cnt_get(void *ll_handle, uint16_t me_id,
 					  uint64_t *cnt_corrected_bytes,
 					  uint64_t *cnt_corrected_code_words,
@@ -35,17 +163,13 @@ static enum pon_adapter_errno fec_cnt_get(void *ll_handle, uint16_t me_id,
 	struct pon_ctx *pon_ctx = ctx->pon_ctx;
 	enum fapi_pon_errorcode ret;
 	struct pon_fec_counters fec_counters;
+	struct pon_cnt_snapshot snap;
 	uint8_t dswlch_id = 0;
 	uint8_t pon_mode = PON_MODE_UNKNOWN;
 
-	pthread_mutex_lock(&ctx->lock);
-
 	ret = fapi_pon_mode_get(pon_ctx, &pon_mode);
-	if (ret) {
-		pthread_mutex_unlock(&ctx->lock);
-
+	if (ret)
 		return pon_fapi_to_pa_error(ret);
-	}
 
 	if (pon_mode == PON_MODE_989_NGPON2_2G5 ||
 	    pon_mode == PON_MODE_989_NGPON2_10G) {
@@ -53,10 +177,13 @@ static enum pon_adapter_errno fec_cnt_get(void *ll_handle, uint16_t me_id,
 		ret = fapi_pon_twdm_fec_counters_get(pon_ctx, dswlch_id,
 						     &fec_counters);
 	} else {
-		ret = fapi_pon_fec_counters_get(pon_ctx, &fec_counters);
+		ret = cnt_snapshot_get(ctx, PON_CNT_SNAP_STATUS |
+				       PON_CNT_SNAP_GTC, &snap);
+		if (ret == PON_STATUS_OK)
+			ret = fapi_pon_cnt_snapshot_fec_get(&snap,
+							    &fec_counters);
 	}
 
-	pthread_mutex_unlock(&ctx->lock);
 	if (ret)
 		return pon_fapi_to_pa_error(ret);
 
@@ -81,13 +208,15 @@ static enum pon_adapter_errno gem_port_net_ctp_update(
 	struct mapper *mapper = ctx->mapper[MAPPER_GEMPORTCTP_MEID_TO_ID];
 	enum pon_adapter_errno ret;
 
-	pthread_mutex_lock(&ctx->lock);
+	pthread_rwlock_wrlock(&ctx->mapper_lock);
 	/* unconditionally remove possible previous mapping */
 	mapper_id_remove(mapper, me_id);
 
 	/* set new/updated mapping */
 	ret = mapper_explicit_map(mapper, me_id, upd_data->gem_port_id);
-	pthread_mutex_unlock(&ctx->lock);
+	/* the GEM port gets (re)configured outside of the PON library */
+	fapi_pon_gem_port_cache_invalidate(ctx->pon_ctx);
+	pthread_rwlock_unlock(&ctx->mapper_lock);
 	/* if we have an error here, it is always because of wrong values */
 	if (ret)
 		return PON_ADAPTER_ERR_INVALID_VAL;
@@ -103,9 +232,10 @@ static enum pon_adapter_errno gem_port_net_ctp_destroy(
 
 	UNUSED(dst_data);
 
-	pthread_mutex_lock(&ctx->lock);
+	pthread_rwlock_wrlock(&ctx->mapper_lock);
 	mapper_id_remove(ctx->mapper[MAPPER_GEMPORTCTP_MEID_TO_ID], me_id);
-	pthread_mutex_unlock(&ctx->lock);
+	fapi_pon_gem_port_cache_invalidate(ctx->pon_ctx);
+	pthread_rwlock_unlock(&ctx->mapper_lock);
 
 	return PON_ADAPTER_SUCCESS;
 }
@@ -126,24 +256,21 @@ static enum pon_adapter_errno gem_port_net_ctp_cnt_get(
 	uint64_t *tx_payload_bytes, uint32_t *key_errors)
 {
 	struct fapi_pon_wrapper_ctx *ctx = ll_handle;
-	struct pon_ctx *pon_ctx = ctx->pon_ctx;
 	struct mapper *mapper = ctx->mapper[MAPPER_GEMPORTCTP_MEID_TO_ID];
 	enum fapi_pon_errorcode err;
 	enum pon_adapter_errno ret;
 	struct pon_gem_port_counters gem_port_counters = { 0 };
 	uint32_t gem_port_id = 0;
 
-	pthread_mutex_lock(&ctx->lock);
+	pthread_rwlock_rdlock(&ctx->mapper_lock);
 	ret = mapper_index_get(mapper, me_id, &gem_port_id);
+	pthread_rwlock_unlock(&ctx->mapper_lock);
 	if (ret)
-		goto out;
+		return ret;
 
-	err = fapi_pon_gem_port_counters_get(pon_ctx, gem_port_id,
-					     &gem_port_counters);
-	if (err) {
-		ret = pon_fapi_to_pa_error(err);
-		goto out;
-	}
+	err = gem_cnt_get(ctx, gem_port_id, &gem_port_counters);
+	if (err)
+		return pon_fapi_to_pa_error(err);
 
 	*tx_gem_frames =
 		gem_port_counters.tx_frames + gem_port_counters.tx_fragments;
@@ -153,10 +280,7 @@ static enum pon_adapter_errno gem_port_net_ctp_cnt_get(
 	*tx_payload_bytes = gem_port_counters.tx_bytes;
 	*key_errors = (uint32_t)gem_port_counters.key_errors;
 
-	ret = PON_ADAPTER_SUCCESS;
-out:
-	pthread_mutex_unlock(&ctx->lock);
-	return ret;
+	return PON_ADAPTER_SUCCESS;
 }
 
 const struct pa_gem_port_net_ctp_pmhd_ops pon_pa_gem_port_net_ctp_pmhd_ops = {
@@ -169,27 +293,24 @@ static enum pon_adapter_errno management_ds_cnt(
 	struct pon_ploam_ds_counters ploam_counters = {
 		0,
 	};
-	struct pon_xgtc_counters gtx_counters = {
-		0,
-	};
 	struct fapi_pon_wrapper_ctx *ctx = ll_handle;
-	struct pon_ctx *pon_ctx = ctx->pon_ctx;
+	struct pon_cnt_snapshot snap;
 	enum fapi_pon_errorcode err;
 	enum pon_adapter_errno ret;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_ploam_ds_counters_get(pon_ctx, &ploam_counters);
+	err = cnt_snapshot_get(ctx, PON_CNT_SNAP_PLOAM_DS | PON_CNT_SNAP_XGTC,
+			       &snap);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
-	err = fapi_pon_xgtc_counters_get(pon_ctx, &gtx_counters);
+	err = fapi_pon_cnt_snapshot_ploam_ds_get(&snap, &ploam_counters);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
 
-	props->ploam_mic_errors = gtx_counters.ploam_mic_err;
+	props->ploam_mic_errors = snap.xgtc.ploam_mic_err;
 	props->all_ds = ploam_counters.all;
 	props->profile = ploam_counters.burst_profile;
 	props->ranging_time = ploam_counters.ranging_time;
@@ -203,32 +324,28 @@ static enum pon_adapter_errno management_ds_cnt(
 
 	ret = PON_ADAPTER_SUCCESS;
 out:
-	pthread_mutex_unlock(&ctx->lock);
 	return ret;
 }
 
 static enum pon_adapter_errno management_us_cnt(
 	void *ll_handle, struct pa_management_us_cnt *props)
 {
-	struct pon_ploam_us_counters ploam_counters = {
-		0,
-	};
+	struct pon_ploam_us_counters *ploam_counters;
 	struct fapi_pon_wrapper_ctx *ctx = ll_handle;
-	struct pon_ctx *pon_ctx = ctx->pon_ctx;
+	struct pon_cnt_snapshot snap;
 	enum fapi_pon_errorcode err;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_ploam_us_counters_get(pon_ctx, &ploam_counters);
-	pthread_mutex_unlock(&ctx->lock);
+	err = cnt_snapshot_get(ctx, PON_CNT_SNAP_PLOAM_US, &snap);
 	if (err)
 		return pon_fapi_to_pa_error(err);
+	ploam_counters = &snap.ploam_us;
 
-	props->all_us = ploam_counters.all;
-	props->serial_number = ploam_counters.ser_no;
-	props->registration = ploam_counters.reg;
-	props->key_report = ploam_counters.key_rep;
-	props->acknowledge = ploam_counters.ack;
-	props->sleep_request = ploam_counters.sleep_req;
+	props->all_us = ploam_counters->all;
+	props->serial_number = ploam_counters->ser_no;
+	props->registration = ploam_counters->reg;
+	props->key_report = ploam_counters->key_rep;
+	props->acknowledge = ploam_counters->ack;
+	props->sleep_request = ploam_counters->sleep_req;
 
 	return PON_ADAPTER_SUCCESS;
 }
@@ -248,42 +365,41 @@ static enum pon_adapter_errno enhanced_tc_counters_get(
 	struct pon_xgtc_counters xgtc_cnt = {
 		0,
 	};
-	struct pon_gem_port_counters gem_port_cnt = {
-		0,
-	};
+	struct pon_gem_port_counters *gem_port_cnt;
+	struct pon_cnt_snapshot snap;
 
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_xgtc_counters_get(ctx->pon_ctx, &xgtc_cnt);
+	err = cnt_snapshot_get(ctx, PON_CNT_SNAP_XGTC | PON_CNT_SNAP_GTC |
+			       PON_CNT_SNAP_GEM_ALL, &snap);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
-	err = fapi_pon_gem_all_counters_get(ctx->pon_ctx, &gem_port_cnt);
+	err = fapi_pon_cnt_snapshot_xgtc_get(&snap, &xgtc_cnt);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
+	gem_port_cnt = &snap.gem_all;
 
 	props->psbd_hec_err_uncorr = xgtc_cnt.psbd_hec_err_uncorr;
 	props->fs_hec_err_uncorr = xgtc_cnt.fs_hec_err_uncorr;
 	props->burst_profile_err = xgtc_cnt.burst_profile_err;
-	props->tx_frames = gem_port_cnt.tx_frames;
-	props->tx_fragments = gem_port_cnt.tx_fragments;
+	props->tx_frames = gem_port_cnt->tx_frames;
+	props->tx_fragments = gem_port_cnt->tx_fragments;
 	props->lost_words = xgtc_cnt.lost_words;
 	props->ploam_mic_err = xgtc_cnt.ploam_mic_err;
-	props->key_errors = gem_port_cnt.key_errors;
+	props->key_errors = gem_port_cnt->key_errors;
 	props->xgem_hec_err_uncorr = xgtc_cnt.xgem_hec_err_uncorr;
-	props->tx_bytes = gem_port_cnt.tx_bytes;
-	props->rx_bytes = gem_port_cnt.rx_bytes;
-	props->rx_frames = gem_port_cnt.rx_frames;
-	props->rx_fragments = gem_port_cnt.rx_fragments;
+	props->tx_bytes = gem_port_cnt->tx_bytes;
+	props->rx_bytes = gem_port_cnt->rx_bytes;
+	props->rx_frames = gem_port_cnt->rx_frames;
+	props->rx_fragments = gem_port_cnt->rx_fragments;
 
 	ret = PON_ADAPTER_SUCCESS;
 out:
-	pthread_mutex_unlock(&ctx->lock);
 	return ret;
 }
 
@@ -295,23 +411,21 @@ enhanced_tc_lods_counters_get(void *ll_handle,
 	struct fapi_pon_wrapper_ctx *ctx = ll_handle;
 	enum fapi_pon_errorcode err;
 	enum pon_adapter_errno ret;
-	struct pon_xgspon_lods_counters lods_cnt = {0};
+	struct pon_cnt_snapshot snap;
 
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_xgspon_lods_counters_get(ctx->pon_ctx, &lods_cnt);
-	pthread_mutex_unlock(&ctx->lock);
+	err = cnt_snapshot_get(ctx, PON_CNT_SNAP_LODS, &snap);
 
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
 
-	props->lods = lods_cnt.lods_events_all;
-	props->lods_rest = lods_cnt.lods_restored_oper;
-	props->lods_react = lods_cnt.lods_reactivation;
+	props->lods = snap.lods.lods_events_all;
+	props->lods_rest = snap.lods.lods_restored_oper;
+	props->lods_react = snap.lods.lods_reactivation;
 	ret = PON_ADAPTER_SUCCESS;
 out:
 	return ret;
@@ -331,39 +445,28 @@ twdm_channel_xgem_pmhd_get(void *ll_handle, uint16_t me_id,
 	enum fapi_pon_errorcode err;
 	enum pon_adapter_errno ret;
 	uint8_t dswlch_id = me_id & 0xFF;
-	struct pon_twdm_xgtc_counters xgtc_cnt = {0};
-	struct pon_gem_port_counters gem_port_cnt = {0};
+	struct pon_twdm_channel_counters cnt = {0};
 
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_twdm_xgtc_counters_get(ctx->pon_ctx,
-					      dswlch_id, &xgtc_cnt);
-	if (err) {
-		ret = pon_fapi_to_pa_error(err);
-		goto out;
-	}
-
-	err = fapi_pon_twdm_xgem_all_counters_get(ctx->pon_ctx,
-						  dswlch_id, &gem_port_cnt);
+	err = twdm_cnt_get(ctx, dswlch_id, &cnt);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
 
-	props->t_tx_frames = gem_port_cnt.tx_frames;
-	props->t_tx_fragments = gem_port_cnt.tx_fragments;
-	props->t_rx_frames = gem_port_cnt.rx_frames;
-	props->rx_frames_hdr_hec_err = xgtc_cnt.xgem_hec_err_uncorr;
-	props->fs_words_lost_hdr_hec_err = xgtc_cnt.lost_words;
-	props->encrypt_key_err = gem_port_cnt.key_errors;
-	props->t_tx_bytes_non_idle_frames = gem_port_cnt.tx_bytes;
-	props->t_rx_bytes_non_idle_frames = gem_port_cnt.rx_bytes;
+	props->t_tx_frames = cnt.xgem.tx_frames;
+	props->t_tx_fragments = cnt.xgem.tx_fragments;
+	props->t_rx_frames = cnt.xgem.rx_frames;
+	props->rx_frames_hdr_hec_err = cnt.xgtc.xgem_hec_err_uncorr;
+	props->fs_words_lost_hdr_hec_err = cnt.xgtc.lost_words;
+	props->encrypt_key_err = cnt.xgem.key_errors;
+	props->t_tx_bytes_non_idle_frames = cnt.xgem.tx_bytes;
+	props->t_rx_bytes_non_idle_frames = cnt.xgem.rx_bytes;
 
 	ret = PON_ADAPTER_SUCCESS;
 out:
-	pthread_mutex_unlock(&ctx->lock);
 	return ret;
 }
 
@@ -380,33 +483,30 @@ twdm_channel_phy_lods_pmhd_get(void *ll_handle, uint16_t me_id,
 	enum fapi_pon_errorcode err;
 	enum pon_adapter_errno ret;
 	uint8_t dswlch_id = me_id & 0xFF;
-	struct pon_twdm_xgtc_counters xgtc_cnt = {0};
+	struct pon_twdm_channel_counters cnt = {0};
 
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_twdm_xgtc_counters_get(ctx->pon_ctx,
-					      dswlch_id, &xgtc_cnt);
-	pthread_mutex_unlock(&ctx->lock);
+	err = twdm_cnt_get(ctx, dswlch_id, &cnt);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
 
-	props->total_words = xgtc_cnt.words;
-	props->bip32_errors = xgtc_cnt.bip_errors;
-	props->psbd_hec_err_corr = xgtc_cnt.psbd_hec_err_corr;
-	props->psbd_hec_err_uncorr = xgtc_cnt.psbd_hec_err_uncorr;
-	props->fs_hec_err_corr = xgtc_cnt.fs_hec_err_corr;
-	props->fs_hec_err_uncorr = xgtc_cnt.fs_hec_err_uncorr;
-	props->lods_events_all = xgtc_cnt.lods_events_all;
-	props->lods_restored_oper = xgtc_cnt.lods_restored_oper;
-	props->lods_restored_prot = xgtc_cnt.lods_restored_prot;
-	props->lods_restored_disc = xgtc_cnt.lods_restored_disc;
-	props->lods_reactivation = xgtc_cnt.lods_reactivation;
-	props->lods_reactivation_prot = xgtc_cnt.lods_reactivation_prot;
-	props->lods_reactivation_disc = xgtc_cnt.lods_reactivation_disc;
+	props->total_words = cnt.xgtc.words;
+	props->bip32_errors = cnt.xgtc.bip_errors;
+	props->psbd_hec_err_corr = cnt.xgtc.psbd_hec_err_corr;
+	props->psbd_hec_err_uncorr = cnt.xgtc.psbd_hec_err_uncorr;
+	props->fs_hec_err_corr = cnt.xgtc.fs_hec_err_corr;
+	props->fs_hec_err_uncorr = cnt.xgtc.fs_hec_err_uncorr;
+	props->lods_events_all = cnt.xgtc.lods_events_all;
+	props->lods_restored_oper = cnt.xgtc.lods_restored_oper;
+	props->lods_restored_prot = cnt.xgtc.lods_restored_prot;
+	props->lods_restored_disc = cnt.xgtc.lods_restored_disc;
+	props->lods_reactivation = cnt.xgtc.lods_reactivation;
+	props->lods_reactivation_prot = cnt.xgtc.lods_reactivation_prot;
+	props->lods_reactivation_disc = cnt.xgtc.lods_reactivation_disc;
 
 	ret = PON_ADAPTER_SUCCESS;
 out:
@@ -427,29 +527,26 @@ twdm_channel_ploam_pmhd1_get(void *ll_handle, uint16_t me_id,
 	enum fapi_pon_errorcode err;
 	enum pon_adapter_errno ret;
 	uint8_t dswlch_id = me_id & 0xFF;
-	struct pon_twdm_ploam_ds_counters ploam_ds_cnt = {0};
+	struct pon_twdm_channel_counters cnt = {0};
 
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_twdm_ploam_ds_counters_get(ctx->pon_ctx,
-						  dswlch_id, &ploam_ds_cnt);
+	err = twdm_cnt_get(ctx, dswlch_id, &cnt);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
 
-	props->ploam_mic_errors = ploam_ds_cnt.mic_err;
-	props->ds_ploam_msg_cnt = ploam_ds_cnt.all;
-	props->rng_time_msg_cnt = ploam_ds_cnt.ranging_time;
-	props->prot_ctrl_msg_cnt = ploam_ds_cnt.protection;
-	props->adj_tx_wl_msg_cnt = ploam_ds_cnt.tx_wavelength;
+	props->ploam_mic_errors = cnt.ploam_ds.mic_err;
+	props->ds_ploam_msg_cnt = cnt.ploam_ds.all;
+	props->rng_time_msg_cnt = cnt.ploam_ds.ranging_time;
+	props->prot_ctrl_msg_cnt = cnt.ploam_ds.protection;
+	props->adj_tx_wl_msg_cnt = cnt.ploam_ds.tx_wavelength;
 	props->adj_tx_wl_adj_amplitude = 0; /* not supported by HW */
 
 	ret = PON_ADAPTER_SUCCESS;
 out:
-	pthread_mutex_unlock(&ctx->lock);
 
 	return ret;
 }
@@ -463,37 +560,34 @@ twdm_channel_ploam_pmhd2_get(void *ll_handle, uint16_t me_id,
 	enum fapi_pon_errorcode err;
 	enum pon_adapter_errno ret;
 	uint8_t dswlch_id = me_id & 0xFF;
-	struct pon_twdm_ploam_ds_counters ploam_ds_cnt = {0};
+	struct pon_twdm_channel_counters cnt = {0};
 
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_twdm_ploam_ds_counters_get(ctx->pon_ctx,
-						  dswlch_id, &ploam_ds_cnt);
+	err = twdm_cnt_get(ctx, dswlch_id, &cnt);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
 
-	props->sys_profile_msg_cnt = ploam_ds_cnt.system_profile;
-	props->ch_profile_msg_cnt = ploam_ds_cnt.channel_profile;
-	props->burst_profile_msg_cnt = ploam_ds_cnt.burst_profile;
-	props->ass_onu_msg_cnt = ploam_ds_cnt.assign_onu_id;
-	props->uns_adj_tx_wl_req = ploam_ds_cnt.tx_wavelength_err;
-	props->deact_onu_msg_cnt = ploam_ds_cnt.deact_onu;
-	props->dis_serial_msg_cnt = ploam_ds_cnt.disable_ser_no;
-	props->req_reg_msg_cnt = ploam_ds_cnt.req_reg;
-	props->ass_alloc_id_msg_cnt = ploam_ds_cnt.assign_alloc_id;
-	props->key_ctrl_msg_cnt = ploam_ds_cnt.key_control;
-	props->slp_allow_msg_cnt = ploam_ds_cnt.sleep_allow;
-	props->tune_req_msg_cnt = ploam_ds_cnt.tuning_request;
-	props->tune_compl_msg_cnt = ploam_ds_cnt.tuning_complete;
-	props->calib_req_msg_cnt = ploam_ds_cnt.cal_req;
+	props->sys_profile_msg_cnt = cnt.ploam_ds.system_profile;
+	props->ch_profile_msg_cnt = cnt.ploam_ds.channel_profile;
+	props->burst_profile_msg_cnt = cnt.ploam_ds.burst_profile;
+	props->ass_onu_msg_cnt = cnt.ploam_ds.assign_onu_id;
+	props->uns_adj_tx_wl_req = cnt.ploam_ds.tx_wavelength_err;
+	props->deact_onu_msg_cnt = cnt.ploam_ds.deact_onu;
+	props->dis_serial_msg_cnt = cnt.ploam_ds.disable_ser_no;
+	props->req_reg_msg_cnt = cnt.ploam_ds.req_reg;
+	props->ass_alloc_id_msg_cnt = cnt.ploam_ds.assign_alloc_id;
+	props->key_ctrl_msg_cnt = cnt.ploam_ds.key_control;
+	props->slp_allow_msg_cnt = cnt.ploam_ds.sleep_allow;
+	props->tune_req_msg_cnt = cnt.ploam_ds.tuning_request;
+	props->tune_compl_msg_cnt = cnt.ploam_ds.tuning_complete;
+	props->calib_req_msg_cnt = cnt.ploam_ds.cal_req;
 
 	ret = PON_ADAPTER_SUCCESS;
 out:
-	pthread_mutex_unlock(&ctx->lock);
 
 	return ret;
 }
@@ -507,35 +601,32 @@ twdm_channel_ploam_pmhd3_get(void *ll_handle, uint16_t me_id,
 	enum fapi_pon_errorcode err;
 	enum pon_adapter_errno ret;
 	uint8_t dswlch_id = me_id & 0xFF;
-	struct pon_twdm_ploam_us_counters ploam_us_cnt = {0};
+	struct pon_twdm_channel_counters cnt = {0};
 
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_twdm_ploam_us_counters_get(ctx->pon_ctx,
-						  dswlch_id, &ploam_us_cnt);
+	err = twdm_cnt_get(ctx, dswlch_id, &cnt);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
 
-	props->us_ploam_msg_cnt = ploam_us_cnt.all;
+	props->us_ploam_msg_cnt = cnt.ploam_us.all;
 	props->ser_onu_inb_msg_cnt = 0;		/* not supported */
 	props->ser_onu_amcc_msg_cnt = 0;	/* not supported */
-	props->reg_msg_cnt = ploam_us_cnt.reg;
-	props->key_rep_msg_cnt = ploam_us_cnt.key_rep;
-	props->ack_msg_cnt = ploam_us_cnt.ack;
-	props->sleep_req_msg_cnt = ploam_us_cnt.sleep_req;
-	props->tune_resp_an_msg_cnt = ploam_us_cnt.tuning_resp_ack_nack;
+	props->reg_msg_cnt = cnt.ploam_us.reg;
+	props->key_rep_msg_cnt = cnt.ploam_us.key_rep;
+	props->ack_msg_cnt = cnt.ploam_us.ack;
+	props->sleep_req_msg_cnt = cnt.ploam_us.sleep_req;
+	props->tune_resp_an_msg_cnt = cnt.ploam_us.tuning_resp_ack_nack;
 	props->tune_resp_crb_msg_cnt =
-			ploam_us_cnt.tuning_resp_complete_rollback;
-	props->pwr_cons_msg_cnt = ploam_us_cnt.power_rep;
-	props->cpl_err_param_err = ploam_us_cnt.cpl_err;
+			cnt.ploam_us.tuning_resp_complete_rollback;
+	props->pwr_cons_msg_cnt = cnt.ploam_us.power_rep;
+	props->cpl_err_param_err = cnt.ploam_us.cpl_err;
 
 	ret = PON_ADAPTER_SUCCESS;
 out:
-	pthread_mutex_unlock(&ctx->lock);
 
 	return ret;
 }
@@ -556,37 +647,34 @@ twdm_channel_tuning_pmhd1_get(void *ll_handle, uint16_t me_id,
 	enum fapi_pon_errorcode err;
 	enum pon_adapter_errno ret;
 	uint8_t dswlch_id = me_id & 0xFF;
-	struct pon_twdm_tuning_counters tuning_cnt = {0};
+	struct pon_twdm_channel_counters cnt = {0};
 
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_twdm_tuning_counters_get(ctx->pon_ctx,
-						dswlch_id, &tuning_cnt);
+	err = twdm_cnt_get(ctx, dswlch_id, &cnt);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
 
-	props->tcr_rx = tuning_cnt.counters[0];
-	props->tcr_tx = tuning_cnt.counters[1];
-	props->tcr_rej_int_sfc = tuning_cnt.counters[2];
-	props->tcr_rej_ds = tuning_cnt.counters[3];
-	props->tcr_rej_us = tuning_cnt.counters[10];
-	props->tcr_ful_reac = tuning_cnt.counters[18];
-	props->tcr_fail_tar_not_fnd = tuning_cnt.counters[19];
-	props->tcr_fail_tar_no_fb = tuning_cnt.counters[20];
+	props->tcr_rx = cnt.tuning.counters[0];
+	props->tcr_tx = cnt.tuning.counters[1];
+	props->tcr_rej_int_sfc = cnt.tuning.counters[2];
+	props->tcr_rej_ds = cnt.tuning.counters[3];
+	props->tcr_rej_us = cnt.tuning.counters[10];
+	props->tcr_ful_reac = cnt.tuning.counters[18];
+	props->tcr_fail_tar_not_fnd = cnt.tuning.counters[19];
+	props->tcr_fail_tar_no_fb = cnt.tuning.counters[20];
 	props->tcr_res_reac_disc = 0; /* n.a. */
-	/* tuning_cnt.counters[21]; not used */
-	props->tcr_rb_com_ds = tuning_cnt.counters[22];
-	props->tcr_rb_ds = tuning_cnt.counters[23];
-	props->tcr_rb_us = tuning_cnt.counters[26];
-	props->tcr_fail_reac = tuning_cnt.counters[33];
+	/* cnt.tuning.counters[21]; not used */
+	props->tcr_rb_com_ds = cnt.tuning.counters[22];
+	props->tcr_rb_ds = cnt.tuning.counters[23];
+	props->tcr_rb_us = cnt.tuning.counters[26];
+	props->tcr_fail_reac = cnt.tuning.counters[33];
 
 	ret = PON_ADAPTER_SUCCESS;
 out:
-	pthread_mutex_unlock(&ctx->lock);
 
 	return ret;
 }
@@ -600,36 +688,33 @@ twdm_channel_tuning_pmhd2_get(void *ll_handle, uint16_t me_id,
 	enum fapi_pon_errorcode err;
 	enum pon_adapter_errno ret;
 	uint8_t dswlch_id = me_id & 0xFF;
-	struct pon_twdm_tuning_counters tuning_cnt = {0};
+	struct pon_twdm_channel_counters cnt = {0};
 
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_twdm_tuning_counters_get(ctx->pon_ctx,
-						dswlch_id, &tuning_cnt);
+	err = twdm_cnt_get(ctx, dswlch_id, &cnt);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
 
-	props->tcr_rej_ds_albl = tuning_cnt.counters[4];
-	props->tcr_rej_ds_void = tuning_cnt.counters[5];
-	props->tcr_rej_ds_part = tuning_cnt.counters[6];
-	props->tcr_rej_ds_tunr = tuning_cnt.counters[7];
-	props->tcr_rej_ds_lnrt = tuning_cnt.counters[8];
-	props->tcr_rej_ds_lncd = tuning_cnt.counters[9];
-	props->tcr_rej_us_albl = tuning_cnt.counters[11];
-	props->tcr_rej_us_void = tuning_cnt.counters[12];
-	props->tcr_rej_us_tunr = tuning_cnt.counters[13];
-	props->tcr_rej_us_clbr = tuning_cnt.counters[14];
-	props->tcr_rej_us_lktp = tuning_cnt.counters[15];
-	props->tcr_rej_us_lnrt = tuning_cnt.counters[16];
-	props->tcr_rej_us_lncd = tuning_cnt.counters[17];
+	props->tcr_rej_ds_albl = cnt.tuning.counters[4];
+	props->tcr_rej_ds_void = cnt.tuning.counters[5];
+	props->tcr_rej_ds_part = cnt.tuning.counters[6];
+	props->tcr_rej_ds_tunr = cnt.tuning.counters[7];
+	props->tcr_rej_ds_lnrt = cnt.tuning.counters[8];
+	props->tcr_rej_ds_lncd = cnt.tuning.counters[9];
+	props->tcr_rej_us_albl = cnt.tuning.counters[11];
+	props->tcr_rej_us_void = cnt.tuning.counters[12];
+	props->tcr_rej_us_tunr = cnt.tuning.counters[13];
+	props->tcr_rej_us_clbr = cnt.tuning.counters[14];
+	props->tcr_rej_us_lktp = cnt.tuning.counters[15];
+	props->tcr_rej_us_lnrt = cnt.tuning.counters[16];
+	props->tcr_rej_us_lncd = cnt.tuning.counters[17];
 
 	ret = PON_ADAPTER_SUCCESS;
 out:
-	pthread_mutex_unlock(&ctx->lock);
 
 	return ret;
 }
@@ -643,31 +728,28 @@ twdm_channel_tuning_pmhd3_get(void *ll_handle, uint16_t me_id,
 	enum fapi_pon_errorcode err;
 	enum pon_adapter_errno ret;
 	uint8_t dswlch_id = me_id & 0xFF;
-	struct pon_twdm_tuning_counters tuning_cnt = {0};
+	struct pon_twdm_channel_counters cnt = {0};
 
 	if (!ctx)
 		return PON_ADAPTER_ERR_INVALID_VAL;
 
-	pthread_mutex_lock(&ctx->lock);
-	err = fapi_pon_twdm_tuning_counters_get(ctx->pon_ctx,
-						dswlch_id, &tuning_cnt);
+	err = twdm_cnt_get(ctx, dswlch_id, &cnt);
 	if (err) {
 		ret = pon_fapi_to_pa_error(err);
 		goto out;
 	}
 
-	props->tcr_rb_ds_albl = tuning_cnt.counters[24];
-	props->tcr_rb_ds_lktp = tuning_cnt.counters[25];
-	props->tcr_rb_us_albl = tuning_cnt.counters[27];
-	props->tcr_rb_us_void = tuning_cnt.counters[28];
-	props->tcr_rb_us_tunr = tuning_cnt.counters[29];
-	props->tcr_rb_us_lktp = tuning_cnt.counters[30];
-	props->tcr_rb_us_lnrt = tuning_cnt.counters[31];
-	props->tcr_rb_us_lncd = tuning_cnt.counters[32];
+	props->tcr_rb_ds_albl = cnt.tuning.counters[24];
+	props->tcr_rb_ds_lktp = cnt.tuning.counters[25];
+	props->tcr_rb_us_albl = cnt.tuning.counters[27];
+	props->tcr_rb_us_void = cnt.tuning.counters[28];
+	props->tcr_rb_us_tunr = cnt.tuning.counters[29];
+	props->tcr_rb_us_lktp = cnt.tuning.counters[30];
+	props->tcr_rb_us_lnrt = cnt.tuning.counters[31];
+	props->tcr_rb_us_lncd = cnt.tuning.counters[32];
 
 	ret = PON_ADAPTER_SUCCESS;
 out:
-	pthread_mutex_unlock(&ctx->lock);
 
 	return ret;
 }
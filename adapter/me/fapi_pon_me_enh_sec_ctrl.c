@@ -31,9 +31,7 @@ encryption_get(void *ll_handle,
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
 	pon_ret = fapi_pon_cap_get(pon_ctx, &pon_cap);
-	pthread_mutex_unlock(&ctx->lock);
 	if (pon_ret != PON_STATUS_OK)
 		return pon_fapi_to_pa_error(pon_ret);
 
@@ -156,9 +154,7 @@ msk_get(void *ll_handle,
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
 	pon_ret = fapi_pon_auth_onu_msk_hash_get(pon_ctx, &pon_onu_msk_hash);
-	pthread_mutex_unlock(&ctx->lock);
 	if (pon_ret != PON_STATUS_OK)
 		return pon_fapi_to_pa_error(pon_ret);
 
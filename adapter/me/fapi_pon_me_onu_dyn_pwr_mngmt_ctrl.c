@@ -116,9 +116,7 @@ static enum pon_adapter_errno pwr_reduction_mngmt_cap_get(void *ll_handle,
 
 	UNUSED(me_id);
 
-	pthread_mutex_lock(&ctx->lock);
 	ret = capabilities_get(ctx, value);
-	pthread_mutex_unlock(&ctx->lock);
 	return ret;
 }
 
@@ -135,9 +133,7 @@ static enum pon_adapter_errno itransinit_get(void *ll_handle,
 	if (!value)
 		return PON_ADAPTER_ERR_DRV;
 
-	pthread_mutex_lock(&ctx->lock);
 	pon_ret = fapi_pon_cap_get(ctx->pon_ctx, &pon_cap);
-	pthread_mutex_unlock(&ctx->lock);
 
 	if (pon_ret != PON_STATUS_OK) {
 		dbg_err_fn_ret(fapi_pon_cap_get, pon_ret);
@@ -162,9 +158,7 @@ static enum pon_adapter_errno itxinit_get(void *ll_handle,
 	if (!value)
 		return PON_ADAPTER_ERR_DRV;
 
-	pthread_mutex_lock(&ctx->lock);
 	pon_ret = fapi_pon_cap_get(ctx->pon_ctx, &pon_cap);
-	pthread_mutex_unlock(&ctx->lock);
 
 	if (pon_ret != PON_STATUS_OK) {
 		dbg_err_fn_ret(fapi_pon_cap_get, pon_ret);
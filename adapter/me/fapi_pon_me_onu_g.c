@@ -43,9 +43,7 @@ ext_tc_opt_get(void *ll_handle, uint16_t *bitmask)
 	if (bitmask == NULL)
 		return PON_ADAPTER_ERR_PTR_INVALID;
 
-	pthread_mutex_lock(&ctx->lock);
 	ret = fapi_pon_cap_get(pon_ctx, &caps);
-	pthread_mutex_unlock(&ctx->lock);
 	if (ret != PON_STATUS_OK) {
 		dbg_err_fn_ret(fapi_pon_cap_get, ret);
 		return pon_fapi_to_pa_error(ret);
@@ -28,8 +28,6 @@ static enum pon_adapter_errno is_ch_active_get(void *ll_handle,
 
 	*is_ch_active = false;
 
-	pthread_mutex_lock(&ctx->lock);
-
 	for (i = 0; i <= MAX_CHANNEL_ID; i++) {
 		pon_ret = fapi_pon_twdm_channel_profile_status_get(ctx->pon_ctx,
 						i, &twdm_channel_profile);
@@ -46,7 +44,6 @@ static enum pon_adapter_errno is_ch_active_get(void *ll_handle,
 	}
 	ret = PON_ADAPTER_SUCCESS;
 out:
-	pthread_mutex_unlock(&ctx->lock);
 	return ret;
 }
 
@@ -58,9 +55,7 @@ static enum pon_adapter_errno operational_ch_get(void *ll_handle,
 	enum fapi_pon_errorcode pon_ret = PON_STATUS_OK;
 	struct pon_twdm_status twdm_status;
 
-	pthread_mutex_lock(&ctx->lock);
 	pon_ret = fapi_pon_twdm_status_get(ctx->pon_ctx, &twdm_status);
-	pthread_mutex_unlock(&ctx->lock);
 	if (pon_ret != PON_STATUS_OK)
 		return PON_ADAPTER_ERROR;
 
@@ -1416,6 +1416,407 @@ static int cli_fapi_pon_debug_test_pattern_cfg_set(
 		       (int)fct_ret, FAPI_PON_CRLF);
 }
 
+/** Handle command
+ * \param[in] p_ctx     FAPI_PON context pointer
+ * \param[in] p_cmd     Input commands
+ * \param[in] p_out     Output FD
+ */
+static int cli_fapi_pon_cmd_stats_get(
+	void *p_ctx,
+	const char *p_cmd,
+	clios_file_io_t *p_out)
+{
+	int ret = 0;
+	enum fapi_pon_errorcode fct_ret = (enum fapi_pon_errorcode)0;
+	struct pon_cmd_stats *stats;
+	uint32_t num = PON_CMD_STATS_MAX;
+	unsigned int i, j;
+
+#ifndef FAPI_PON_DEBUG_DISABLE
+	static const char usage[] =
+		"Long Form: cmd_stats_get" FAPI_PON_CRLF
+		"Short Form: csg" FAPI_PON_CRLF
+		FAPI_PON_CRLF
+		"Output Parameter" FAPI_PON_CRLF
+		"- enum fapi_pon_errorcode errorcode" FAPI_PON_CRLF
+		"- uint32_t num" FAPI_PON_CRLF
+		"- per command:" FAPI_PON_CRLF
+		"   uint16_t command" FAPI_PON_CRLF
+		"   uint8_t read" FAPI_PON_CRLF
+		"   uint64_t count" FAPI_PON_CRLF
+		"   uint64_t errors" FAPI_PON_CRLF
+		"   uint64_t nacks" FAPI_PON_CRLF
+		"   uint64_t timeouts" FAPI_PON_CRLF
+		"   uint32_t lat_min" FAPI_PON_CRLF
+		"   uint32_t lat_avg" FAPI_PON_CRLF
+		"   uint32_t lat_max" FAPI_PON_CRLF
+		"   uint64_t tx_bytes" FAPI_PON_CRLF
+		"   uint64_t rx_bytes" FAPI_PON_CRLF
+		"   uint32_t lat_hist[22]" FAPI_PON_CRLF
+		FAPI_PON_CRLF;
+#else
+#undef usage
+#define usage ""
+#endif
+
+	ret = cli_check_help__file(p_cmd, usage, p_out);
+	if (ret != 0)
+		return ret;
+
+	stats = calloc(num, sizeof(*stats));
+	if (!stats)
+		return fprintf(p_out, "errorcode=%d %s",
+			       (int)PON_STATUS_MEM_ERR, FAPI_PON_CRLF);
+
+	fct_ret = fapi_pon_stats_get(p_ctx, &num, stats);
+	if (fct_ret != PON_STATUS_OK)
+		num = 0;
+
+	ret = fprintf(p_out, "errorcode=%d num=%u %s", (int)fct_ret, num,
+		      FAPI_PON_CRLF);
+
+	for (i = 0; i < num; i++) {
+		fprintf(p_out,
+			"command=0x%04x read=%u count=%" PRIu64
+			" errors=%" PRIu64
+			" nacks=%" PRIu64
+			" timeouts=%" PRIu64
+			" lat_min=%u lat_avg=%u lat_max=%u"
+			" tx_bytes=%" PRIu64
+			" rx_bytes=%" PRIu64
+			" lat_hist=\"",
+			stats[i].command, stats[i].read, stats[i].count,
+			stats[i].errors, stats[i].nacks, stats[i].timeouts,
+			stats[i].lat_min, stats[i].lat_avg, stats[i].lat_max,
+			stats[i].tx_bytes, stats[i].rx_bytes);
+		for (j = 0; j < PON_CMD_STATS_LAT_BUCKETS; j++)
+			fprintf(p_out, j ? " %u" : "%u", stats[i].lat_hist[j]);
+		fprintf(p_out, "\" %s", FAPI_PON_CRLF);
+	}
+
+	free(stats);
+
+	return ret;
+}
+
+/** Handle command
+ * \param[in] p_ctx     FAPI_PON context pointer
+ * \param[in] p_cmd     Input commands
+ * \param[in] p_out     Output FD
+ */
+static int cli_fapi_pon_cmd_stats_reset(
+	void *p_ctx,
+	const char *p_cmd,
+	clios_file_io_t *p_out)
+{
+	int ret = 0;
+	enum fapi_pon_errorcode fct_ret = (enum fapi_pon_errorcode)0;
+
+#ifndef FAPI_PON_DEBUG_DISABLE
+	static const char usage[] =
+		"Long Form: cmd_stats_reset" FAPI_PON_CRLF
+		"Short Form: csr" FAPI_PON_CRLF
+		FAPI_PON_CRLF
+		"Output Parameter" FAPI_PON_CRLF
+		"- enum fapi_pon_errorcode errorcode" FAPI_PON_CRLF
+		FAPI_PON_CRLF;
+#else
+#undef usage
+#define usage ""
+#endif
+
+	ret = cli_check_help__file(p_cmd, usage, p_out);
+	if (ret != 0)
+		return ret;
+	fct_ret = fapi_pon_stats_reset(p_ctx);
+	return fprintf(p_out, "errorcode=%d %s",
+		       (int)fct_ret, FAPI_PON_CRLF);
+}
+
+/* Print the alarm IDs set in a bitmap of struct pon_alarm_snapshot */
+static void cli_alarm_bitmap_print(clios_file_io_t *p_out, const char *name,
+				   const uint32_t *map)
+{
+	unsigned int group, bit;
+	int first = 1;
+
+	fprintf(p_out, " %s=\"", name);
+	for (group = 0; group < PON_ALARM_GROUPS; group++) {
+		for (bit = 0; bit < 32; bit++) {
+			if (!(map[group] & (1U << bit)))
+				continue;
+			fprintf(p_out, first ? "0x%04x" : " 0x%04x",
+				(group << 8) | bit);
+			first = 0;
+		}
+	}
+	fprintf(p_out, "\"");
+}
+
+/** Handle command
+ * \param[in] p_ctx     FAPI_PON context pointer
+ * \param[in] p_cmd     Input commands
+ * \param[in] p_out     Output FD
+ */
+static int cli_fapi_pon_alarm_snapshot_get(
+	void *p_ctx,
+	const char *p_cmd,
+	clios_file_io_t *p_out)
+{
+	int ret = 0;
+	enum fapi_pon_errorcode fct_ret = (enum fapi_pon_errorcode)0;
+	struct pon_alarm_snapshot param = {0};
+	uint8_t edge_clear = 0;
+
+#ifndef FAPI_PON_DEBUG_DISABLE
+	static const char usage[] =
+		"Long Form: alarm_snapshot_get" FAPI_PON_CRLF
+		"Short Form: alsg" FAPI_PON_CRLF
+		FAPI_PON_CRLF
+		"Input Parameter" FAPI_PON_CRLF
+		"- uint8_t edge_clear" FAPI_PON_CRLF
+		FAPI_PON_CRLF
+		"Output Parameter" FAPI_PON_CRLF
+		"- enum fapi_pon_errorcode errorcode" FAPI_PON_CRLF
+		"- uint32_t seq" FAPI_PON_CRLF
+		"- uint16_t level[]" FAPI_PON_CRLF
+		"- uint16_t edge[]" FAPI_PON_CRLF
+		FAPI_PON_CRLF;
+#else
+#undef usage
+#define usage ""
+#endif
+
+	ret = cli_check_help__file(p_cmd, usage, p_out);
+	if (ret != 0)
+		return ret;
+	ret = cli_sscanf(p_cmd, "%bu", &edge_clear);
+	if (ret != 1)
+		return cli_check_help__file("-h", usage, p_out);
+	fct_ret = fapi_pon_alarm_snapshot_get(p_ctx, &param, edge_clear);
+	ret = fprintf(p_out, "errorcode=%d seq=%u", (int)fct_ret, param.seq);
+	cli_alarm_bitmap_print(p_out, "level", param.level);
+	cli_alarm_bitmap_print(p_out, "edge", param.edge);
+	fprintf(p_out, " %s", FAPI_PON_CRLF);
+
+	return ret;
+}
+
+static uint32_t cli_swap32(uint32_t val)
+{
+	return ((val & 0xFF) << 24) | ((val & 0xFF00) << 8) |
+	       ((val >> 8) & 0xFF00) | (val >> 24);
+}
+
+static uint64_t cli_swap64(uint64_t val)
+{
+	return ((uint64_t)cli_swap32((uint32_t)val) << 32) |
+	       cli_swap32((uint32_t)(val >> 32));
+}
+
+/** Handle command
+ * \param[in] p_ctx     FAPI_PON context pointer
+ * \param[in] p_cmd     Input commands
+ * \param[in] p_out     Output FD
+ */
+static int cli_fapi_pon_ploam_capture_decode(
+	void *p_ctx,
+	const char *p_cmd,
+	clios_file_io_t *p_out)
+{
+	int ret = 0;
+	char file_path[128];
+	struct pon_ploam_cap_file_hdr hdr;
+	struct pon_ploam_cap_rec_hdr rec;
+	uint8_t msg[256];
+	unsigned int num = 0, i;
+	int swap = 0;
+	FILE *file;
+
+#ifndef FAPI_PON_DEBUG_DISABLE
+	static const char usage[] =
+		"Long Form: ploam_capture_decode" FAPI_PON_CRLF
+		"Short Form: pcd" FAPI_PON_CRLF
+		FAPI_PON_CRLF
+		"Input Parameter" FAPI_PON_CRLF
+		"- char filename[128] (name of the PLOAM capture file)"
+		FAPI_PON_CRLF
+		FAPI_PON_CRLF
+		"Output Parameter" FAPI_PON_CRLF
+		"- enum fapi_pon_errorcode errorcode" FAPI_PON_CRLF
+		"- uint32_t records" FAPI_PON_CRLF
+		FAPI_PON_CRLF;
+#else
+#undef usage
+#define usage ""
+#endif
+
+	(void)p_ctx;
+
+	ret = cli_check_help__file(p_cmd, usage, p_out);
+	if (ret != 0)
+		return ret;
+
+	ret = cli_sscanf(p_cmd, "%127s", &file_path[0]);
+	if (ret != 1)
+		return cli_check_help__file("-h", usage, p_out);
+
+	file = fopen(file_path, "rb");
+	if (!file)
+		return fprintf(p_out, "errorcode=%d %s",
+			       (int)PON_STATUS_ERR, FAPI_PON_CRLF);
+
+	if (fread(&hdr, sizeof(hdr), 1, file) != 1)
+		goto err;
+	if (hdr.magic == cli_swap32(PON_PLOAM_CAP_MAGIC)) {
+		swap = 1;
+		hdr.version = (uint16_t)((hdr.version >> 8) |
+					 (hdr.version << 8));
+		hdr.rec_hdr_len = (uint16_t)((hdr.rec_hdr_len >> 8) |
+					     (hdr.rec_hdr_len << 8));
+		hdr.start_time = cli_swap64(hdr.start_time);
+	} else if (hdr.magic != PON_PLOAM_CAP_MAGIC) {
+		goto err;
+	}
+	if (hdr.version != PON_PLOAM_CAP_VERSION ||
+	    hdr.rec_hdr_len != sizeof(rec))
+		goto err;
+
+	fprintf(p_out, "start_time=%" PRIu64 "%s", hdr.start_time,
+		FAPI_PON_CRLF);
+
+	while (fread(&rec, sizeof(rec), 1, file) == 1) {
+		if (swap) {
+			rec.time = cli_swap64(rec.time);
+			rec.time_stamp = cli_swap32(rec.time_stamp);
+			rec.onu_id = cli_swap32(rec.onu_id);
+		}
+		if (fread(msg, 1, rec.len, file) != rec.len)
+			break;
+
+		fprintf(p_out, "%" PRIu64 " ts=%08x %s %s onu_id=%u type=%u",
+			rec.time, rec.time_stamp,
+			rec.format == PON_PLOAM_CAP_XGTC ? "xgtc" : "gtc",
+			rec.direction == PON_US ? "us" : "ds",
+			rec.onu_id, rec.message_type_id);
+		if (rec.format == PON_PLOAM_CAP_XGTC)
+			fprintf(p_out, " seq=%u", rec.message_seq_no);
+		fprintf(p_out, " msg=\"");
+		for (i = 0; i < rec.len; i++)
+			fprintf(p_out, i ? " %02x" : "%02x", msg[i]);
+		fprintf(p_out, "\"%s", FAPI_PON_CRLF);
+		num++;
+	}
+	fclose(file);
+
+	return fprintf(p_out, "errorcode=%d records=%u %s",
+		       (int)PON_STATUS_OK, num, FAPI_PON_CRLF);
+
+err:
+	fclose(file);
+	return fprintf(p_out, "errorcode=%d %s",
+		       (int)PON_STATUS_ERR, FAPI_PON_CRLF);
+}
+
+#ifndef WIN32
+/** Handle command
+ * \param[in] p_ctx     FAPI_PON context pointer
+ * \param[in] p_cmd     Input commands
+ * \param[in] p_out     Output FD
+ */
+static int cli_fapi_pon_shm_counters_get(
+	void *p_ctx,
+	const char *p_cmd,
+	clios_file_io_t *p_out)
+{
+	int ret = 0;
+	enum fapi_pon_errorcode fct_ret = (enum fapi_pon_errorcode)0;
+	struct pon_shm_reader *reader = NULL;
+	struct pon_shm_counters *param;
+	char name[64];
+	uint32_t i;
+
+#ifndef FAPI_PON_DEBUG_DISABLE
+	static const char usage[] =
+		"Long Form: shm_counters_get" FAPI_PON_CRLF
+		"Short Form: shcg" FAPI_PON_CRLF
+		FAPI_PON_CRLF
+		"Input Parameter" FAPI_PON_CRLF
+		"- char name[64] (shared memory object, - for the default)"
+		FAPI_PON_CRLF
+		FAPI_PON_CRLF
+		"Output Parameter" FAPI_PON_CRLF
+		"- enum fapi_pon_errorcode errorcode" FAPI_PON_CRLF
+		"- uint64_t time" FAPI_PON_CRLF
+		"- uint32_t sample" FAPI_PON_CRLF
+		"- uint32_t valid" FAPI_PON_CRLF
+		"- uint8_t pon_mode" FAPI_PON_CRLF
+		"- uint64_t gem_all_tx_frames" FAPI_PON_CRLF
+		"- uint64_t gem_all_tx_bytes" FAPI_PON_CRLF
+		"- uint64_t gem_all_rx_frames" FAPI_PON_CRLF
+		"- uint64_t gem_all_rx_bytes" FAPI_PON_CRLF
+		"- uint64_t bip_errors" FAPI_PON_CRLF
+		"- uint32_t gem_num" FAPI_PON_CRLF
+		"- uint32_t alloc_num" FAPI_PON_CRLF
+		FAPI_PON_CRLF;
+#else
+#undef usage
+#define usage ""
+#endif
+
+	(void)p_ctx;
+
+	ret = cli_check_help__file(p_cmd, usage, p_out);
+	if (ret != 0)
+		return ret;
+
+	ret = cli_sscanf(p_cmd, "%63s", &name[0]);
+	if (ret != 1)
+		return cli_check_help__file("-h", usage, p_out);
+
+	/* the sample is too large for the stack of the CLI thread */
+	param = calloc(1, sizeof(*param));
+	if (!param)
+		return fprintf(p_out, "errorcode=%d %s",
+			       (int)PON_STATUS_MEM_ERR, FAPI_PON_CRLF);
+
+	fct_ret = fapi_pon_shm_reader_open(strcmp(name, "-") ? name : NULL,
+					   &reader);
+	if (fct_ret == PON_STATUS_OK) {
+		fct_ret = fapi_pon_shm_read(reader, param);
+		fapi_pon_shm_reader_close(reader);
+	}
+
+	ret = fprintf(p_out,
+		"errorcode=%d time=%" PRIu64 " sample=%u valid=0x%x"
+		" pon_mode=%u gem_all_tx_frames=%" PRIu64
+		" gem_all_tx_bytes=%" PRIu64
+		" gem_all_rx_frames=%" PRIu64
+		" gem_all_rx_bytes=%" PRIu64
+		" bip_errors=%" PRIu64
+		" gem_num=%u alloc_num=%u %s",
+		(int)fct_ret, param->time, param->sample, param->valid,
+		param->pon_mode, param->gem_all.tx_frames,
+		param->gem_all.tx_bytes, param->gem_all.rx_frames,
+		param->gem_all.rx_bytes, param->gtc.bip_errors,
+		param->gem_num, param->alloc_num, FAPI_PON_CRLF);
+
+	for (i = 0; i < param->gem_num && i < PON_SHM_GEM_MAX; i++)
+		fprintf(p_out,
+			"gem_port_id=%u tx_frames=%" PRIu64
+			" tx_bytes=%" PRIu64
+			" rx_frames=%" PRIu64
+			" rx_bytes=%" PRIu64 " %s",
+			param->gem[i].gem_port_id, param->gem[i].tx_frames,
+			param->gem[i].tx_bytes, param->gem[i].rx_frames,
+			param->gem[i].rx_bytes, FAPI_PON_CRLF);
+
+	free(param);
+
+	return ret;
+}
+#endif
+
 /** Register cli commands */
 int pon_ext_cli_cmd_register(struct cli_core_context_s *p_core_ctx)
 {
@@ -1461,6 +1862,18 @@ int pon_ext_cli_cmd_register(struct cli_core_context_s *p_core_ctx)
 	cli_core_key_add__file(p_core_ctx, group_mask, "dtpcs",
 		"debug_test_pattern_cfg_set",
 		cli_fapi_pon_debug_test_pattern_cfg_set);
+	cli_core_key_add__file(p_core_ctx, group_mask, "csg",
+		"cmd_stats_get", cli_fapi_pon_cmd_stats_get);
+	cli_core_key_add__file(p_core_ctx, group_mask, "csr",
+		"cmd_stats_reset", cli_fapi_pon_cmd_stats_reset);
+	cli_core_key_add__file(p_core_ctx, group_mask, "alsg",
+		"alarm_snapshot_get", cli_fapi_pon_alarm_snapshot_get);
+	cli_core_key_add__file(p_core_ctx, group_mask, "pcd",
+		"ploam_capture_decode", cli_fapi_pon_ploam_capture_decode);
+#ifndef WIN32
+	cli_core_key_add__file(p_core_ctx, group_mask, "shcg",
+		"shm_counters_get", cli_fapi_pon_shm_counters_get);
+#endif
 
 	return 0;
 }
@@ -21,6 +21,7 @@
 #include <signal.h>
 #include <stdio.h>
 #include <getopt.h>
+#include <poll.h>
 #include <string.h>
 #include <time.h>
 
@@ -69,6 +70,9 @@ struct ploam_state_reason_mapping {
 
 #define FLAG_IS_SET(var, flag) (((var) & (flag)) == (flag))
 
+/* Maximum number of events handled per wakeup of the main loop */
+#define POND_EVENT_BURST 32
+
 /* This value is valid as of 2017-01-01 and will change in the future,
  * not before 2020-01-01.
  * Check https://www.iers.org/SharedDocs/News/EN/BulletinC.html.
@@ -316,60 +320,30 @@ static void pond_get_ploam_state(void *priv,
 		ploam_state_reason_get(ploam_state->change_reason));
 }
 
-static int act_alarm_level_print(void *ctx, const struct alarm_type *alarm,
-				 void *data)
+static void
+pond_print_active_alarms(void *priv, const struct pon_alarm_status *alarms)
 {
-	const struct pon_alarm_status *status = data;
+	const struct alarm_type *alarm;
 
-	if (status->alarm_id == alarm->code) {
+	alarm = fapi_pon_alarm_level_info_get(alarms->alarm_id);
+	if (alarm) {
 		printf("alarm %s set\n", alarm->desc);
-		/* tell iterator to stop looping */
-		return 1;
+		return;
 	}
-	return 0;
-}
-
-static int act_alarm_edge_print(void *ctx, const struct alarm_type *alarm,
-				void *data)
-{
-	const struct pon_alarm_status *status = data;
 
-	if (status->alarm_id == alarm->code) {
+	alarm = fapi_pon_alarm_edge_info_get(alarms->alarm_id);
+	if (alarm)
 		printf("alarm %s triggered\n", alarm->desc);
-		/* tell iterator to stop looping */
-		return 1;
-	}
-	return 0;
-}
-
-static int clr_alarm_level_print(void *ctx, const struct alarm_type *alarm,
-				 void *data)
-{
-	const struct pon_alarm_status *status = data;
-
-	if (status->alarm_id == alarm->code) {
-		printf("alarm %s cleared\n", alarm->desc);
-		/* tell iterator to stop looping */
-		return 1;
-	}
-	return 0;
-}
-
-static void
-pond_print_active_alarms(void *priv, const struct pon_alarm_status *alarms)
-{
-	fapi_pon_visit_alarms_level(priv, act_alarm_level_print,
-				    (void *)alarms);
-
-	fapi_pon_visit_alarms_edge(priv, act_alarm_edge_print,
-				   (void *)alarms);
 }
 
 static void
 pond_print_inactive_alarms(void *priv, const struct pon_alarm_status *alarms)
 {
-	fapi_pon_visit_alarms_level(priv, clr_alarm_level_print,
-				    (void *)alarms);
+	const struct alarm_type *alarm;
+
+	alarm = fapi_pon_alarm_level_info_get(alarms->alarm_id);
+	if (alarm)
+		printf("alarm %s cleared\n", alarm->desc);
 }
 
 static enum fapi_pon_errorcode pond_get_xgtc_power_level(void *priv,
@@ -489,6 +463,15 @@ static enum fapi_pon_errorcode pond_print_unlink_all(void *priv)
 	return PON_STATUS_OK_NO_RESPONSE;
 }
 
+static void pond_print_resync(void *priv, const struct pon_resync_info *info)
+{
+	printf("events lost, resync: overflows - %llu, active alarms - %u",
+	       (unsigned long long)info->overflows, info->alarms_active);
+	if (info->ploam_valid)
+		printf(", ploam state - %u", info->ploam_state.current);
+	printf("\n");
+}
+
 /* Currently we are doing the testing with the OpenWrt ubus method
  * internally, the non OpenWrt ubus version is not fully supported.
  */
@@ -696,6 +679,8 @@ static const struct option long_options[] = {
 	{"tod only",	no_argument,		0, 't'},
 	{"verbose",	no_argument,		0, 'v'},
 	{"mode",	required_argument,	0, 'm'},
+	{"ploam_capture", required_argument,	0, 'p'},
+	{"shm_export",	required_argument,	0, 'e'},
 	{NULL,		0,			0,  0 },
 };
 
@@ -791,9 +776,13 @@ int main(int argc, char *argv[])
 	int opt;
 	int option_index;
 	struct sigaction sig_action = {0,};
+	struct pollfd pfd = {0,};
 	enum fapi_pon_errorcode ret;
 	enum pon_mode pon_mode = PON_MODE_UNKNOWN;
 	bool reset = false,  tod_only = false;
+	const char *ploam_capture = NULL;
+	const char *shm_export = NULL;
+	struct pon_ctx *shm_ctx = NULL;
 	struct pond_config cfg = {
 		.aon_pol = 0,
 		.mac_sa = {0,},
@@ -810,7 +799,7 @@ int main(int argc, char *argv[])
 	if (setvbuf(stderr, NULL, _IONBF, 0))
 		perror("Attempt to set stderr to unbuffered mode has failed");
 
-	while ((opt = getopt_long(argc, argv, "a:r:hs:d:n:i:o:tvm:",
+	while ((opt = getopt_long(argc, argv, "a:r:hs:d:n:i:o:tvm:p:e:",
 				  long_options, &option_index)) != -1) {
 		switch (opt) {
 		case 'a':
@@ -896,6 +885,18 @@ int main(int argc, char *argv[])
 		case 'v':
 			cfg.verbose = true;
 			break;
+		case 'p':
+			/* the capture needs the PLOAM log events */
+			ploam_capture = optarg;
+			cfg.verbose = true;
+			break;
+		case 'e':
+			/* "-" selects the default shared memory name */
+			if (strcmp(optarg, "-") == 0)
+				shm_export = PON_SHM_NAME_DEF;
+			else
+				shm_export = optarg;
+			break;
 		case 'h':
 			print_help(argv[0]);
 			return EXIT_SUCCESS;
@@ -926,9 +927,41 @@ int main(int argc, char *argv[])
 		return EXIT_FAILURE;
 	}
 
+	ret = fapi_pon_listener_fd_get(cfg.fapi_ctx, &pfd.fd);
+	if (ret != PON_STATUS_OK) {
+		fprintf(stderr, "getting event listener fd failed\n");
+		return EXIT_FAILURE;
+	}
+	pfd.events = POLLIN;
+
+	if (ploam_capture) {
+		ret = fapi_pon_ploam_capture_start(cfg.fapi_ctx, ploam_capture,
+						   0);
+		if (ret != PON_STATUS_OK) {
+			fprintf(stderr, "starting PLOAM capture failed\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (shm_export) {
+		/* the export thread needs its own thread safe context */
+		ret = fapi_pon_open_mt(&shm_ctx);
+		if (ret == PON_STATUS_OK)
+			ret = fapi_pon_shm_export_start(shm_ctx, shm_export,
+							NULL);
+		if (ret != PON_STATUS_OK) {
+			fprintf(stderr, "starting counter export failed\n");
+			return EXIT_FAILURE;
+		}
+	}
+
 	if (tod_only == false) {
-		fapi_pon_register_xgtc_log(cfg.fapi_ctx, pond_get_xgtc_log);
-		fapi_pon_register_gtc_log(cfg.fapi_ctx, pond_get_gtc_log);
+		if (!ploam_capture) {
+			fapi_pon_register_xgtc_log(cfg.fapi_ctx,
+						   pond_get_xgtc_log);
+			fapi_pon_register_gtc_log(cfg.fapi_ctx,
+						  pond_get_gtc_log);
+		}
 		fapi_pon_register_ploam_state(cfg.fapi_ctx,
 					      pond_get_ploam_state);
 		fapi_pon_register_alarm_report(cfg.fapi_ctx,
@@ -955,6 +988,7 @@ int main(int argc, char *argv[])
 						   pond_print_onu_auth_res_tbl);
 		fapi_pon_register_unlink_all(cfg.fapi_ctx,
 					     pond_print_unlink_all);
+		fapi_pon_register_resync(cfg.fapi_ctx, pond_print_resync);
 	} else {
 		fapi_pon_register_onu_tod_sync(cfg.fapi_ctx,
 					       pond_get_onu_tod_sync_output);
@@ -974,11 +1008,19 @@ int main(int argc, char *argv[])
 		fapi_pon_reset(cfg.fapi_ctx, pon_mode);
 
 	while (listen) {
-		ret = fapi_pon_listener_run(cfg.fapi_ctx);
+		if (poll(&pfd, 1, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		ret = fapi_pon_listener_dispatch(cfg.fapi_ctx, POND_EVENT_BURST,
+						 NULL);
 		if (ret != PON_STATUS_OK)
 			break;
 	}
 
+	if (shm_ctx)
+		fapi_pon_close(shm_ctx);
 	fapi_pon_close(cfg.fapi_ctx);
 
 	return EXIT_SUCCESS;
@@ -134,6 +134,32 @@
  */
 #define PON_TYPE_XGSPON		0x00000008
 
+/** Default timeout for firmware requests in milliseconds.
+ *  Used by \ref fapi_pon_timeout_set
+ */
+#define PON_TIMEOUT_DEFAULT	2000
+/** Do not wait for answers to asynchronous requests which were not
+ *  received yet.
+ *  Used by \ref fapi_pon_timeout_set
+ */
+#define PON_TIMEOUT_NONBLOCK	0
+/** Derive the timeout from the measured firmware round-trip time.
+ *  Used by \ref fapi_pon_timeout_set
+ */
+#define PON_TIMEOUT_ADAPTIVE	0xFFFFFFFF
+
+/** Maximum number of asynchronous requests held by one context.
+ *  Used by \ref fapi_pon_async_process
+ */
+#define PON_ASYNC_MAX_PENDING	32
+
+/** Number of latency histogram buckets in \ref pon_cmd_stats */
+#define PON_CMD_STATS_LAT_BUCKETS	22
+/** Maximum number of firmware commands tracked by the request statistics.
+ *  Used by \ref fapi_pon_stats_get
+ */
+#define PON_CMD_STATS_MAX	256
+
 /* PON alarm event codes.
  * Used by \ref fapi_pon_alarm_status_get,
  * \ref fapi_pon_alarm_status_set and the callback functions registered
@@ -1533,6 +1559,31 @@ struct pon_alarm_status {
 	uint16_t alarm_id;
 };
 
+/** Number of alarm groups in \ref pon_alarm_snapshot. The group of an alarm
+ *  is given by bits 15:8 of the alarm ID, the bit within the group by
+ *  bits 7:0, which are below 32 for all alarms.
+ */
+#define PON_ALARM_GROUPS	17
+
+/** Checks if an alarm is set in a bitmap of \ref pon_alarm_snapshot. */
+#define PON_ALARM_IS_SET(map, id) \
+	((((id) >> 8) < PON_ALARM_GROUPS) && (((id) & 0xFF) < 32) && \
+	 ((map)[(id) >> 8] & (1U << ((id) & 0xFF))))
+
+/** Active alarms as tracked by the library from the alarm events.
+ *  Used by \ref fapi_pon_alarm_snapshot_get.
+ */
+struct pon_alarm_snapshot {
+	/** Active level alarms, use \ref PON_ALARM_IS_SET to check an alarm */
+	uint32_t level[PON_ALARM_GROUPS];
+	/** Edge alarms reported since they were cleared last time,
+	 *  use \ref PON_ALARM_IS_SET to check an alarm
+	 */
+	uint32_t edge[PON_ALARM_GROUPS];
+	/** Counter incremented on every alarm change */
+	uint32_t seq;
+};
+
 /** Synchronous Ethernet operation mode configuration.
  *  Used by \ref fapi_pon_synce_cfg_set and
  *  \ref fapi_pon_synce_cfg_get.
@@ -1705,6 +1756,64 @@ struct pon_olt_type {
 	enum olt_type type;
 };
 
+/** Statistics of the synchronous requests sent with one firmware command.
+ *  Used by \ref fapi_pon_stats_get.
+ */
+struct pon_cmd_stats {
+	/** Firmware command ID (PONFW_*_CMD_ID). */
+	uint16_t command;
+	/** Request type.
+	 *  - 0: Write request
+	 *  - 1: Read request
+	 */
+	uint8_t read;
+	/** Number of requests. */
+	uint64_t count;
+	/** Number of requests which did not return PON_STATUS_OK,
+	 *  including the NACKs and timeouts.
+	 */
+	uint64_t errors;
+	/** Number of requests answered with a NACK by the firmware. */
+	uint64_t nacks;
+	/** Number of requests without an answer in time. */
+	uint64_t timeouts;
+	/** Minimum round-trip time in microseconds. */
+	uint32_t lat_min;
+	/** Average round-trip time in microseconds. */
+	uint32_t lat_avg;
+	/** Maximum round-trip time in microseconds. */
+	uint32_t lat_max;
+	/** Histogram of the round-trip times. Bucket n counts the requests
+	 *  answered within 2^n to 2^(n+1) - 1 microseconds, the last bucket
+	 *  also counts all slower ones.
+	 */
+	uint32_t lat_hist[PON_CMD_STATS_LAT_BUCKETS];
+	/** Number of payload bytes sent to the firmware. */
+	uint64_t tx_bytes;
+	/** Number of payload bytes received from the firmware. */
+	uint64_t rx_bytes;
+};
+
+/** Result of a configuration transaction.
+ *  Used by \ref fapi_pon_cfg_tx_commit.
+ */
+struct pon_cfg_tx_stats {
+	/** Number of firmware write requests recorded. */
+	uint32_t msgs;
+	/** Number of requests sent to the firmware. */
+	uint32_t sent;
+	/** Number of requests skipped, as the firmware already holds the
+	 *  same configuration.
+	 */
+	uint32_t skipped;
+	/** Number of batches the requests were sent in. */
+	uint32_t batches;
+	/** Firmware command ID (PONFW_*_CMD_ID) of the first failed request,
+	 *  only valid if the commit did not return PON_STATUS_OK.
+	 */
+	uint16_t err_command;
+};
+
 /* Global PON library function definitions */
 /* ======================================= */
 
@@ -1727,6 +1836,75 @@ struct pon_olt_type {
 enum fapi_pon_errorcode fapi_pon_open(struct pon_ctx **param);
 #endif
 
+/**
+ *	Function to create a PON library context which can be shared by
+ *	multiple threads.
+ *
+ *	Requests of different threads are sent concurrently over the netlink
+ *	socket of the context and the answers are dispatched to the waiting
+ *	threads by their sequence number.
+ *
+ *	\param[out] param Pointer to a pointer of a structure as defined
+ *                        by \ref pon_ctx.
+ *
+ *	\remarks The function returns an error code in case of error.
+ *	The error code is described in \ref fapi_pon_errorcode.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_open_mt(struct pon_ctx **param);
+#endif
+
+/**
+ *	Function to create a PON library context which is connected to the
+ *	loopback backend instead of the pon_mbox driver. The loopback
+ *	backend answers the firmware requests and sends the events defined in
+ *	a fixture file, it allows to use the library without PON IP hardware.
+ *	All contexts opened with the same fixture file share one emulated
+ *	device.
+ *
+ *	In builds configured with --enable-tests \ref fapi_pon_open also
+ *	connects to the loopback backend if the environment variable
+ *	PON_LIB_LOOPBACK is set to the path of a fixture file.
+ *
+ *	\param[out] param Pointer to a pointer of a structure as defined
+ *                        by \ref pon_ctx.
+ *	\param[in] fixture Path of the fixture file.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_open_loopback(struct pon_ctx **param,
+					       const char *fixture);
+#endif
+
+/**
+ *	Function to send an event from the emulated firmware to all listeners
+ *	of the loopback device of the context.
+ *
+ *	\param[in] ctx PON library context created by
+ *	\ref fapi_pon_open_loopback.
+ *	\param[in] command Firmware command ID of the event.
+ *	\param[in] data Payload of the event, can be NULL.
+ *	\param[in] size Size of the payload in bytes.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- PON_STATUS_SUPPORT: The context does not use the loopback backend
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_loopback_event_send(struct pon_ctx *ctx,
+						     uint16_t command,
+						     const void *data,
+						     uint32_t size);
+#endif
+
 /**
  *	Function to close and free the PON library context.
  *
@@ -1800,6 +1978,33 @@ enum fapi_pon_errorcode fapi_pon_optic_status_get(struct pon_ctx *ctx,
 				struct pon_optic_status *param,
 				enum pon_tx_power_scale scale);
 
+#ifndef SWIG
+/**
+ *	Function to get the optical interface status from the status cache of
+ *	the context. The EEPROM is only read if the cached status is older
+ *	than max_age or was converted with another TX power scale.
+ *	\ref fapi_pon_optic_status_get always reads the EEPROM and updates
+ *	the cache.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[out] param Pointer to a structure as defined
+ *	by \ref pon_optic_status.
+ *	\param[in] scale TX power scaling factor used by the optical module
+ *	TX_POWER_SCALE_0_1 = 0.1 uW/LSB, TX_POWER_SCALE_0_2 = 0.2 uW/LSB
+ *	\param[in] max_age Maximum age of the cached status in ms,
+ *	0 forces an EEPROM read
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode
+fapi_pon_optic_status_cached_get(struct pon_ctx *ctx,
+				 struct pon_optic_status *param,
+				 enum pon_tx_power_scale scale,
+				 uint32_t max_age);
+#endif
+
 /**
  *	Function to check the optical interface properties by reading through
  *	the two-wire interface from the PMD.
@@ -2400,6 +2605,421 @@ enum fapi_pon_errorcode fapi_pon_synce_hold_disable(struct pon_ctx *ctx);
 enum fapi_pon_errorcode fapi_pon_olt_type_set(struct pon_ctx *ctx,
 					      const struct pon_olt_type *param,
 					      const uint32_t iop_mask);
+
+/**
+ *	Type definition of the function which is called when an asynchronous
+ *	request has been completed. The handle is released before the function
+ *	is called and must not be used afterwards.
+ *
+ *	\param[in] ctx PON library context the request was sent on.
+ *	\param[in] handle Handle returned when the request was submitted.
+ *	\param[in] err Result of the request, as the synchronous variant of
+ *		the request would have returned it.
+ *	\param[in] priv Private data given when the request was submitted.
+ */
+#ifndef SWIG
+typedef void (*fapi_pon_async_done)(struct pon_ctx *ctx, uint32_t handle,
+				    enum fapi_pon_errorcode err, void *priv);
+#endif
+
+/**
+ *	Asynchronous request handling
+ *
+ *	The fapi_pon_async_*_get functions send a request to the firmware and
+ *	return without waiting for the answer. Up to PON_ASYNC_MAX_PENDING
+ *	requests can be held by one context, a further request is rejected
+ *	with PON_STATUS_RESOURCE_ERR until a slot is released.
+ *	The answers are handled by \ref fapi_pon_async_process,
+ *	\ref fapi_pon_async_wait or \ref fapi_pon_async_wait_all, which
+ *	decode them into the structure given when the request was submitted.
+ *	This structure must stay valid until the request is completed or
+ *	cancelled.
+ *
+ *	A request with a completion callback releases its handle when the
+ *	callback is called. A request without a callback keeps its handle and
+ *	its result until the result is collected by \ref fapi_pon_async_wait,
+ *	or until the request is cancelled by \ref fapi_pon_async_cancel.
+ *
+ *	The asynchronous requests are not available on a context created by
+ *	\ref fapi_pon_open_mt, they return PON_STATUS_SUPPORT there.
+ *	Synchronous requests must not be mixed with outstanding asynchronous
+ *	requests on the same context, they use the same Netlink socket.
+ */
+
+/**
+ *	Function to get the file descriptor of the socket on which the answers
+ *	to asynchronous requests are received.
+ *	The file descriptor can be added to a poll() loop, when it becomes
+ *	readable \ref fapi_pon_async_process should be called.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[out] fd Socket file descriptor.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_async_fd_get(struct pon_ctx *ctx, int *fd);
+#endif
+
+/**
+ *	Function to handle the answers to asynchronous requests.
+ *	This function blocks until at least one answer was received, or
+ *	the receive timeout of the context expired. In case of a timeout all
+ *	outstanding requests are completed with PON_STATUS_TIMEOUT.
+ *	With a timeout of PON_TIMEOUT_NONBLOCK the function does not block and
+ *	the outstanding requests are kept if no answer was received yet.
+ *	Completion callbacks are executed from within this function and must
+ *	not issue synchronous requests on the same context.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- PON_STATUS_OK_NO_RESPONSE: No answer received yet, only with
+ *	  PON_TIMEOUT_NONBLOCK
+ *	- PON_STATUS_TIMEOUT: No answer received in time
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_async_process(struct pon_ctx *ctx);
+#endif
+
+/**
+ *	Function to wait for the completion of one asynchronous request which
+ *	was submitted without a completion callback, and to collect its result.
+ *	The handle is released when the result was collected.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in] handle Handle returned when the request was submitted.
+ *	\param[out] result Result of the request.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful, the result is given in result
+ *	- PON_STATUS_INPUT_ERR: Unknown handle
+ *	- Other: An error code in case of error, the request stays pending.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_async_wait(struct pon_ctx *ctx,
+					    uint32_t handle,
+					    enum fapi_pon_errorcode *result);
+#endif
+
+/**
+ *	Function to wait until all outstanding asynchronous requests of the
+ *	context have been answered. Results of requests without a completion
+ *	callback are kept until they are collected.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_async_wait_all(struct pon_ctx *ctx);
+#endif
+
+/**
+ *	Function to cancel an asynchronous request and to release its handle.
+ *	A late answer to the request is dropped, the completion callback of
+ *	the request is not called and the result structure is not written.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in] handle Handle of the request.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- PON_STATUS_INPUT_ERR: If no request with this handle exists
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_async_cancel(struct pon_ctx *ctx,
+					      uint32_t handle);
+#endif
+
+/**
+ *	Function to read the GEM port counters asynchronously, see
+ *	\ref fapi_pon_gem_port_counters_get.
+ *	The GEM port index is looked up synchronously if it is not cached yet.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in] gem_port_id GEM port ID.
+ *	\param[out] param Result, written when the request is completed.
+ *	\param[in] done Completion callback, can be NULL.
+ *	\param[in] done_priv Private data given to the completion callback.
+ *	\param[out] handle Handle of the request, can be NULL.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode
+fapi_pon_async_gem_port_counters_get(struct pon_ctx *ctx,
+				     uint16_t gem_port_id,
+				     struct pon_gem_port_counters *param,
+				     fapi_pon_async_done done,
+				     void *done_priv,
+				     uint32_t *handle);
+#endif
+
+/**
+ *	Function to read the summed counters of all GEM ports asynchronously,
+ *	see \ref fapi_pon_gem_all_counters_get.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[out] param Result, written when the request is completed.
+ *	\param[in] done Completion callback, can be NULL.
+ *	\param[in] done_priv Private data given to the completion callback.
+ *	\param[out] handle Handle of the request, can be NULL.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode
+fapi_pon_async_gem_all_counters_get(struct pon_ctx *ctx,
+				    struct pon_gem_port_counters *param,
+				    fapi_pon_async_done done,
+				    void *done_priv,
+				    uint32_t *handle);
+#endif
+
+/**
+ *	Function to read the allocation counters asynchronously, see
+ *	\ref fapi_pon_alloc_counters_get.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in] alloc_index Allocation index.
+ *	\param[out] param Result, written when the request is completed.
+ *	\param[in] done Completion callback, can be NULL.
+ *	\param[in] done_priv Private data given to the completion callback.
+ *	\param[out] handle Handle of the request, can be NULL.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode
+fapi_pon_async_alloc_counters_get(struct pon_ctx *ctx, uint8_t alloc_index,
+				  struct pon_alloc_counters *param,
+				  fapi_pon_async_done done, void *done_priv,
+				  uint32_t *handle);
+#endif
+
+/**
+ *	Function to read the Ethernet receive counters of a GEM port
+ *	asynchronously, see \ref fapi_pon_eth_rx_counters_get.
+ *	The GEM port index is looked up synchronously if it is not cached yet.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in] gem_port_id GEM port ID.
+ *	\param[out] param Result, written when the request is completed.
+ *	\param[in] done Completion callback, can be NULL.
+ *	\param[in] done_priv Private data given to the completion callback.
+ *	\param[out] handle Handle of the request, can be NULL.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode
+fapi_pon_async_eth_rx_counters_get(struct pon_ctx *ctx,
+				   uint32_t gem_port_id,
+				   struct pon_eth_counters *param,
+				   fapi_pon_async_done done,
+				   void *done_priv,
+				   uint32_t *handle);
+#endif
+
+/**
+ *	Function to read the Ethernet transmit counters of a GEM port
+ *	asynchronously, see \ref fapi_pon_eth_tx_counters_get.
+ *	The GEM port index is looked up synchronously if it is not cached yet.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in] gem_port_id GEM port ID.
+ *	\param[out] param Result, written when the request is completed.
+ *	\param[in] done Completion callback, can be NULL.
+ *	\param[in] done_priv Private data given to the completion callback.
+ *	\param[out] handle Handle of the request, can be NULL.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode
+fapi_pon_async_eth_tx_counters_get(struct pon_ctx *ctx,
+				   uint32_t gem_port_id,
+				   struct pon_eth_counters *param,
+				   fapi_pon_async_done done,
+				   void *done_priv,
+				   uint32_t *handle);
+#endif
+
+/**
+ *	Function to set the time to wait for the answer of the firmware.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in] timeout_ms Timeout in milliseconds or one of
+ *	- PON_TIMEOUT_NONBLOCK: \ref fapi_pon_async_process only handles
+ *	  answers which were already received and does not block.
+ *	  Synchronous requests, \ref fapi_pon_async_wait and
+ *	  \ref fapi_pon_async_wait_all use PON_TIMEOUT_DEFAULT meanwhile.
+ *	- PON_TIMEOUT_ADAPTIVE: Derive the timeout from the round-trip time
+ *	  of the previous requests. Until enough requests were measured
+ *	  PON_TIMEOUT_DEFAULT is used.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_timeout_set(struct pon_ctx *ctx,
+					     uint32_t timeout_ms);
+#endif
+
+/**
+ *	Function to read the time to wait for the answer of the firmware.
+ *	In adaptive mode the currently derived timeout is returned.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[out] timeout_ms Timeout in milliseconds.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_timeout_get(struct pon_ctx *ctx,
+					     uint32_t *timeout_ms);
+#endif
+
+/**
+ *	Function to set a deadline for the following requests.
+ *	All requests issued until \ref fapi_pon_deadline_clear is called
+ *	fail with PON_STATUS_TIMEOUT once the deadline has passed, even if
+ *	the timeout of the context is longer. For a context opened by
+ *	\ref fapi_pon_open_mt the deadline applies to the calling thread only.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in] timeout_ms Time from now until the deadline in
+ *	milliseconds.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_deadline_set(struct pon_ctx *ctx,
+					      uint32_t timeout_ms);
+#endif
+
+/**
+ *	Function to remove the deadline set by \ref fapi_pon_deadline_set.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_deadline_clear(struct pon_ctx *ctx);
+#endif
+
+/**
+ *	Function to read the statistics of the synchronous firmware requests
+ *	sent through the context, one entry per firmware command and
+ *	request type.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in,out] num Size of the stats buffer in entries, returns the
+ *		number of entries written.
+ *	\param[out] stats Buffer used to read the statistics, a buffer of
+ *		PON_CMD_STATS_MAX entries holds all of them.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_stats_get(struct pon_ctx *ctx,
+					   uint32_t *num,
+					   struct pon_cmd_stats *stats);
+#endif
+
+/**
+ *	Function to reset the statistics read by \ref fapi_pon_stats_get.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_stats_reset(struct pon_ctx *ctx);
+#endif
+
+/**
+ *	Function to start a configuration transaction on the context.
+ *
+ *	The firmware write requests of the configuration functions called by
+ *	the same thread are recorded instead of being sent.
+ *	\ref fapi_pon_cfg_tx_commit sends the recorded requests in one
+ *	pipelined batch, in the order they were recorded. Before a request
+ *	which reads back a recorded configuration, which can not be recorded
+ *	or which is a message to the mailbox driver itself is sent, the
+ *	requests recorded so far are sent first.
+ *
+ *	A recorded request returns PON_STATUS_OK as long as none of the
+ *	requests sent so far failed. Once one failed, the following write
+ *	requests are dropped and return its error code, so a sequence of
+ *	configuration functions stops at the first error as it does without
+ *	a transaction.
+ *
+ *	Requests which write the same data as the last committed transaction
+ *	of the process are skipped. This snapshot is dropped when the
+ *	firmware reports its initialization, when the mailbox driver reports
+ *	a reset, when events were lost, when \ref fapi_pon_reset is called
+ *	and for each command written outside of a transaction. The
+ *	configuration applied on a firmware initialization is therefore
+ *	always sent completely. Changes done by other processes are not
+ *	detected.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_cfg_tx_begin(struct pon_ctx *ctx);
+#endif
+
+/**
+ *	Function to send the requests recorded since \ref fapi_pon_cfg_tx_begin
+ *	and to end the transaction. All requests are sent, also after one of
+ *	them failed.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[out] stats Result of the transaction, can be NULL.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: The error code of the first failed request.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_cfg_tx_commit(struct pon_ctx *ctx,
+					       struct pon_cfg_tx_stats *stats);
+#endif
+
 /*! @} */ /* End of global functions */
 
 /*! @} */ /* End of PON library definitions */
@@ -54,7 +54,8 @@ typedef int (*alarms_visitor_t)(void *ctx, const struct alarm_type *alarm,
 /**
  *	General purpose LEVEL (static) alarms visitor function.
  *	This function iterates by all entries in pon_alarm_level[] table
- *	calling cb callback function for each table entry.
+ *	calling cb callback function for each table entry, in the order of
+ *	the alarm IDs.
  *
  *	\param[in] ctx PON library context created by \ref fapi_pon_open.
  *	The ctx is passed to cb function
@@ -77,7 +78,8 @@ int fapi_pon_visit_alarms_level(void *ctx, alarms_visitor_t cb, void *data);
 /**
  *	General purpose EDGE alarms visitor function.
  *	This function iterates by all entries in pon_alarm_edge[] table
- *	calling cb callback function for each table entry.
+ *	calling cb callback function for each table entry, in the order of
+ *	the alarm IDs.
  *
  *	\param[in] ctx PON library context created by \ref fapi_pon_open.
  *	The ctx is passed to cb function
@@ -97,5 +99,41 @@ int fapi_pon_visit_alarms_level(void *ctx, alarms_visitor_t cb, void *data);
  */
 int fapi_pon_visit_alarms_edge(void *ctx, alarms_visitor_t cb, void *data);
 
+/**
+ *	Look up a LEVEL (static) alarm by its ID.
+ *	The pon_alarm_level[] table is indexed by the alarm ID, the lookup
+ *	takes constant time.
+ *
+ *	\param[in] alarm_id Alarm ID, as given by the PON_ALARM_STATIC_*
+ *	definitions
+ *
+ *	\return Returns a pointer to the alarm definition or NULL if alarm_id
+ *	is not a known level alarm.
+ */
+const struct alarm_type *fapi_pon_alarm_level_info_get(uint32_t alarm_id);
+
+/**
+ *	Look up an EDGE alarm by its ID.
+ *	The pon_alarm_edge[] table is indexed by the alarm ID, the lookup
+ *	takes constant time.
+ *
+ *	\param[in] alarm_id Alarm ID, as given by the PON_ALARM_EDGE_*
+ *	definitions
+ *
+ *	\return Returns a pointer to the alarm definition or NULL if alarm_id
+ *	is not a known edge alarm.
+ */
+const struct alarm_type *fapi_pon_alarm_edge_info_get(uint32_t alarm_id);
+
+/**
+ *	Look up a LEVEL or EDGE alarm by its ID in constant time.
+ *
+ *	\param[in] alarm_id Alarm ID
+ *
+ *	\return Returns a pointer to the alarm definition or NULL if alarm_id
+ *	is not a known alarm.
+ */
+const struct alarm_type *fapi_pon_alarm_info_get(uint32_t alarm_id);
+
 #endif
 
@@ -103,6 +103,49 @@ enum fapi_pon_errorcode fapi_pon_listener_connect(struct pon_ctx *ctx,
 enum fapi_pon_errorcode fapi_pon_listener_run(struct pon_ctx *ctx);
 #endif
 
+/**
+ *	Get the file descriptor of the event listener.
+ *
+ *	The descriptor becomes readable when events are pending. It can be
+ *	added to a poll, epoll or libevent loop of the application, which
+ *	calls \ref fapi_pon_listener_dispatch when it is readable. The
+ *	application must not read from or close the descriptor.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open, in
+ *		addition \ref fapi_pon_listener_connect has to be called before.
+ *	\param[out] fd File descriptor to wait on for events.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_listener_fd_get(struct pon_ctx *ctx, int *fd);
+#endif
+
+/**
+ *	Handle the pending events without blocking.
+ *
+ *	Receives and handles up to max pending events and returns as soon as
+ *	no further event is pending. This allows to process a burst of
+ *	events in one wakeup of an application event loop.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open, in
+ *		addition \ref fapi_pon_listener_connect has to be called before.
+ *	\param[in] max Maximum number of events to handle, 0 handles all
+ *		pending events.
+ *	\param[out] num Number of events which were handled, can be NULL.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_listener_dispatch(struct pon_ctx *ctx,
+						   uint32_t max,
+						   uint32_t *num);
+#endif
+
 /**
  *	Type definition for the function to be called when the firmware
  *	requests random data.
@@ -701,6 +744,266 @@ fapi_pon_register_twdm_config(struct pon_ctx *ctx,
 			      fapi_pon_twdm_config func);
 #endif
 
+/** Event listener statistics.
+ *  Used by \ref fapi_pon_listener_stats_get.
+ */
+struct pon_listener_stats {
+	/** Number of events received from the firmware */
+	uint64_t events;
+	/** Number of event socket overflows, one or more events were lost
+	 *  each time.
+	 */
+	uint64_t overflows;
+	/** Number of state resynchronizations done after an overflow */
+	uint64_t resyncs;
+};
+
+/** State read back after events have been lost.
+ *  Used by \ref fapi_pon_resync.
+ */
+struct pon_resync_info {
+	/** Number of event socket overflows since the listener was connected */
+	uint64_t overflows;
+	/** Set to 1 if ploam_state is valid */
+	uint8_t ploam_valid;
+	/** Current PLOAM state */
+	struct pon_ploam_state ploam_state;
+	/** Set to 1 if twdm_status is valid, only in NG-PON2 mode */
+	uint8_t twdm_valid;
+	/** Current TWDM channel status */
+	struct pon_twdm_status twdm_status;
+	/** Number of alarms which are active */
+	uint32_t alarms_active;
+};
+
+/**
+ *	Type definition for the function to be called after the state was
+ *	resynchronized because events were lost.
+ *
+ *	Events are lost when the application does not receive them fast enough
+ *	and the event socket buffer overflows. The library then reads the
+ *	status of all static alarms and reports the active ones again through
+ *	the function registered with \ref fapi_pon_register_alarm_report.
+ *	The alarms which were active before and are not active anymore are
+ *	reported through the function registered with
+ *	\ref fapi_pon_register_alarm_clear. Then the current PLOAM state is
+ *	reported through the function registered with
+ *	\ref fapi_pon_register_ploam_state and this function is called last.
+ *
+ *	\param[in] priv Pointer to private data given
+ *	in \ref fapi_pon_listener_connect
+ *	\param[in] info Pointer to the state read back from the firmware.
+ */
+#ifndef SWIG
+typedef void (*fapi_pon_resync)(void *priv,
+				const struct pon_resync_info *info);
+#endif
+
+/**
+ *	Registers a function which should be called after the state was
+ *	resynchronized because events were lost.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in] func Function of the type \ref fapi_pon_resync
+ *
+ *	\return Returns the function which was previously registered as
+ *	callback function or NULL if no function was registered before.
+ */
+#ifndef SWIG
+fapi_pon_resync fapi_pon_register_resync(struct pon_ctx *ctx,
+					 fapi_pon_resync func);
+#endif
+
+/**
+ *	Read the event listener statistics.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open, in
+ *		addition \ref fapi_pon_listener_connect has to be called before.
+ *	\param[out] stats Pointer to a structure as defined by
+ *		\ref pon_listener_stats.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode
+fapi_pon_listener_stats_get(struct pon_ctx *ctx,
+			    struct pon_listener_stats *stats);
+#endif
+
+/**
+ *	Execute the callbacks of events which are not acknowledged to the
+ *	firmware by worker threads instead of the listener.
+ *
+ *	The alarm, SyncE status, TWDM configuration and authentication table
+ *	events are queued to the workers, events of the same kind are
+ *	executed in the order they were received. All events which are
+ *	answered to the firmware, like unlink all, are still handled by the
+ *	listener, a slow callback of a queued event does not delay these
+ *	answers.
+ *	The library state, like the alarm state returned by
+ *	\ref fapi_pon_alarm_snapshot_get, is updated by the listener before
+ *	the event is queued.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open_mt,
+ *		the callbacks can send requests on it concurrently.
+ *	\param[in] workers Number of worker threads, 0 selects one thread.
+ *		More threads than event kinds are not used.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_listener_defer_start(struct pon_ctx *ctx,
+						      uint32_t workers);
+#endif
+
+/**
+ *	Stop the worker threads started by \ref fapi_pon_listener_defer_start.
+ *
+ *	The queued events are executed before the workers terminate, the
+ *	following events are handled by the listener again. This is also
+ *	done by \ref fapi_pon_close. It must not be called while another
+ *	thread handles events of the context.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open_mt.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_listener_defer_stop(struct pon_ctx *ctx);
+#endif
+
+/** Magic number at the start of a PLOAM capture file, "PLOG" */
+#define PON_PLOAM_CAP_MAGIC	0x504C4F47
+/** Version of the PLOAM capture file format */
+#define PON_PLOAM_CAP_VERSION	1
+/** Record format of a GPON PLOAM message, \ref pon_gtc_ploam_message */
+#define PON_PLOAM_CAP_GTC	0
+/** Record format of an XGTC PLOAM message, \ref pon_xgtc_ploam_message */
+#define PON_PLOAM_CAP_XGTC	1
+
+/** Header at the start of a PLOAM capture file.
+ *  All values are written in the byte order of the capturing system, a
+ *  reader detects the byte order from the magic number.
+ */
+struct pon_ploam_cap_file_hdr {
+	/** Magic number, \ref PON_PLOAM_CAP_MAGIC */
+	uint32_t magic;
+	/** File format version, \ref PON_PLOAM_CAP_VERSION */
+	uint16_t version;
+	/** Size of each record header in bytes */
+	uint16_t rec_hdr_len;
+	/** Wall clock time of the capture start in us since the epoch */
+	uint64_t start_time;
+};
+
+/** Header of each record in a PLOAM capture file, followed by len bytes
+ *  of PLOAM message contents.
+ */
+struct pon_ploam_cap_rec_hdr {
+	/** Time of reception in us since the capture start */
+	uint64_t time;
+	/** Firmware time stamp of the message */
+	uint32_t time_stamp;
+	/** ONU ID */
+	uint32_t onu_id;
+	/** Record format, \ref PON_PLOAM_CAP_GTC or \ref PON_PLOAM_CAP_XGTC */
+	uint8_t format;
+	/** Message direction.
+	 *  - 0: PON_DS, Downstream.
+	 *  - 1: PON_US, Upstream.
+	 */
+	uint8_t direction;
+	/** Message type ID */
+	uint8_t message_type_id;
+	/** Message sequence number, XGTC only */
+	uint8_t message_seq_no;
+	/** Number of message bytes following the header */
+	uint8_t len;
+	/** Reserved, set to 0 */
+	uint8_t reserved[3];
+};
+
+/** PLOAM capture statistics.
+ *  Used by \ref fapi_pon_ploam_capture_stats_get.
+ */
+struct pon_ploam_cap_stats {
+	/** Number of messages written to the capture file */
+	uint64_t records;
+	/** Number of messages dropped because the ring buffer was full or
+	 *  the capture file could not be written
+	 */
+	uint64_t dropped;
+	/** Number of bytes written to the capture file */
+	uint64_t bytes;
+};
+
+/**
+ *	Start capturing the PLOAM message log events to a binary file.
+ *
+ *	The messages are stored in a lock-free ring buffer by the event
+ *	listener and written to the file by a separate thread, the event
+ *	handling is not slowed down by the file access. The file starts with
+ *	\ref pon_ploam_cap_file_hdr, followed by records of
+ *	\ref pon_ploam_cap_rec_hdr and the message contents.
+ *	The functions registered with \ref fapi_pon_register_xgtc_log and
+ *	\ref fapi_pon_register_gtc_log are still called.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open, in
+ *		addition \ref fapi_pon_listener_connect has to be called before.
+ *	\param[in] file Name of the capture file, an existing file is
+ *		overwritten.
+ *	\param[in] size Number of messages the ring buffer can hold, rounded
+ *		up to a power of two, 0 selects the default size.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_ploam_capture_start(struct pon_ctx *ctx,
+						     const char *file,
+						     uint32_t size);
+#endif
+
+/**
+ *	Stop capturing the PLOAM message log events.
+ *
+ *	All messages in the ring buffer are written to the file before it is
+ *	closed. This is also done by \ref fapi_pon_close.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode fapi_pon_ploam_capture_stop(struct pon_ctx *ctx);
+#endif
+
+/**
+ *	Read the statistics of the running PLOAM capture.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[out] stats Pointer to a structure as defined by
+ *		\ref pon_ploam_cap_stats.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode
+fapi_pon_ploam_capture_stats_get(struct pon_ctx *ctx,
+				 struct pon_ploam_cap_stats *stats);
+#endif
+
 /*! @} */ /* End of event functions */
 
 /*! @} */ /* End of PON library definitions */
@@ -1502,6 +1502,138 @@ struct pon_dp_config {
 	uint64_t lods_reactivation_disc;
 };
 
+/** Raw counter groups of a counter snapshot, see \ref pon_cnt_snapshot */
+/** ONU status, provides the downstream FEC status */
+#define PON_CNT_SNAP_STATUS	0x01
+/** GTC counters */
+#define PON_CNT_SNAP_GTC	0x02
+/** XGTC counters, XG-PON, XGS-PON and NG-PON2 only */
+#define PON_CNT_SNAP_XGTC	0x04
+/** PLOAM downstream counters */
+#define PON_CNT_SNAP_PLOAM_DS	0x08
+/** PLOAM upstream counters */
+#define PON_CNT_SNAP_PLOAM_US	0x10
+/** Counters summed over all GEM ports */
+#define PON_CNT_SNAP_GEM_ALL	0x20
+/** LODS counters, XG-PON and XGS-PON only */
+#define PON_CNT_SNAP_LODS	0x40
+
+/** Snapshot of the raw counter groups.
+ *  Used by \ref fapi_pon_cnt_snapshot_get. Each raw group is read from the
+ *  firmware once, the composite counter views are derived from the snapshot
+ *  by \ref fapi_pon_cnt_snapshot_fec_get,
+ *  \ref fapi_pon_cnt_snapshot_xgtc_get and
+ *  \ref fapi_pon_cnt_snapshot_ploam_ds_get without further firmware access.
+ *  A snapshot must be zero initialized before the first use.
+ */
+struct pon_cnt_snapshot {
+	/** Time of the first read into the snapshot in us,
+	 *  taken from CLOCK_MONOTONIC
+	 */
+	uint64_t time;
+	/** Bit mask of the valid raw groups, see PON_CNT_SNAP_* */
+	uint32_t valid;
+	/** PON mode the snapshot was taken in, see \ref pon_mode */
+	uint8_t pon_mode;
+	/** Downstream FEC status, 1 if FEC is enabled */
+	uint8_t fec_status_ds;
+	/** GTC counters */
+	struct pon_gtc_counters gtc;
+	/** XGTC counters, the XGEM HEC errors are only provided by the
+	 *  XGTC view
+	 */
+	struct pon_xgtc_counters xgtc;
+	/** PLOAM downstream counters, the MIC errors are only provided by
+	 *  the PLOAM downstream view
+	 */
+	struct pon_ploam_ds_counters ploam_ds;
+	/** PLOAM upstream counters */
+	struct pon_ploam_us_counters ploam_us;
+	/** Counters summed over all GEM ports */
+	struct pon_gem_port_counters gem_all;
+	/** LODS counters */
+	struct pon_xgspon_lods_counters lods;
+};
+
+/** Default name of the shared memory counter export */
+#define PON_SHM_NAME_DEF	"/pon_counters"
+/** Maximum number of GEM ports in the shared memory counter export */
+#define PON_SHM_GEM_MAX		256
+/** Maximum number of allocations in the shared memory counter export */
+#define PON_SHM_ALLOC_MAX	64
+
+/** Counter groups of the shared memory counter export */
+/** GTC counters */
+#define PON_SHM_GTC		0x01
+/** XGTC counters, XG-PON, XGS-PON and NG-PON2 only */
+#define PON_SHM_XGTC		0x02
+/** FEC counters */
+#define PON_SHM_FEC		0x04
+/** Counters summed over all GEM ports */
+#define PON_SHM_GEM_ALL		0x08
+/** Counters of each active GEM port */
+#define PON_SHM_GEM		0x10
+/** Ethernet receive and transmit counters of each active GEM port */
+#define PON_SHM_ETH		0x20
+/** Allocation counters */
+#define PON_SHM_ALLOC		0x40
+/** Optical interface status */
+#define PON_SHM_OPTIC		0x80
+
+/** Configuration of the shared memory counter export.
+ *  Used by \ref fapi_pon_shm_export_start.
+ */
+struct pon_shm_cfg {
+	/** Time between two samples in ms, 0 selects 1000 */
+	uint32_t period;
+	/** Counter groups to sample, see PON_SHM_*. 0 selects PON_SHM_GTC,
+	 *  PON_SHM_XGTC, PON_SHM_FEC, PON_SHM_GEM_ALL and PON_SHM_OPTIC.
+	 *  PON_SHM_GEM, PON_SHM_ETH and PON_SHM_ALLOC need a firmware request
+	 *  per GEM port or allocation and are only sampled on request.
+	 */
+	uint32_t groups;
+	/** TX power scale of the optical interface status */
+	enum pon_tx_power_scale tx_power_scale;
+};
+
+/** Counter sample of the shared memory counter export.
+ *  Used by \ref fapi_pon_shm_read.
+ */
+struct pon_shm_counters {
+	/** Time of the sample in us, taken from CLOCK_MONOTONIC */
+	uint64_t time;
+	/** Number of samples published since the export was started */
+	uint32_t sample;
+	/** Bit mask of the counter groups read successfully, see PON_SHM_* */
+	uint32_t valid;
+	/** PON mode of the sample, see \ref pon_mode */
+	uint8_t pon_mode;
+	/** GTC counters */
+	struct pon_gtc_counters gtc;
+	/** XGTC counters */
+	struct pon_xgtc_counters xgtc;
+	/** FEC counters */
+	struct pon_fec_counters fec;
+	/** Counters summed over all GEM ports */
+	struct pon_gem_port_counters gem_all;
+	/** Optical interface status */
+	struct pon_optic_status optic;
+	/** Number of valid entries in gem, eth_rx and eth_tx */
+	uint32_t gem_num;
+	/** Counters of each active GEM port */
+	struct pon_gem_port_counters gem[PON_SHM_GEM_MAX];
+	/** Ethernet receive counters of the GEM port in gem */
+	struct pon_eth_counters eth_rx[PON_SHM_GEM_MAX];
+	/** Ethernet transmit counters of the GEM port in gem */
+	struct pon_eth_counters eth_tx[PON_SHM_GEM_MAX];
+	/** Number of valid entries in alloc_index and alloc */
+	uint32_t alloc_num;
+	/** Allocation index of the entry in alloc */
+	uint8_t alloc_index[PON_SHM_ALLOC_MAX];
+	/** Allocation counters */
+	struct pon_alloc_counters alloc[PON_SHM_ALLOC_MAX];
+};
+
 /* GPON-specific PON library function definitions */
 /* ============================================== */
 
@@ -1757,6 +1889,34 @@ enum fapi_pon_errorcode
 				  uint16_t pon_alarm_id,
 				  struct pon_alarm_status *param);
 
+/**
+ *	Read all active alarms at once.
+ *
+ *	The library tracks the alarm report and clear events received by the
+ *	event listeners of the process, reading the snapshot needs no firmware
+ *	access. The level alarms which are active are read once from the
+ *	firmware on first use, this needs one firmware access.
+ *	This function is applicable to all ITU PON standards
+ *	(GPON, XG-PON, XGS-PON, NG-PON2).
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[out] param Pointer to a structure as defined by
+ *	\ref pon_alarm_snapshot.
+ *	\param[in] edge_clear Set to 1 to clear the edge alarms which have been
+ *	reported in the snapshot.
+ *
+ *	\remarks An event listener must be connected in the process with
+ *	\ref fapi_pon_listener_connect to keep the snapshot up to date.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode
+	fapi_pon_alarm_snapshot_get(struct pon_ctx *ctx,
+				    struct pon_alarm_snapshot *param,
+				    uint8_t edge_clear);
+
 /**
  *	Function to configure the firmware alarm limiter function.
  *	This function is applicable to all ITU PON standards
@@ -1840,6 +2000,60 @@ enum fapi_pon_errorcode fapi_pon_gem_port_counters_get(struct pon_ctx *ctx,
 enum fapi_pon_errorcode fapi_pon_gem_all_counters_get(struct pon_ctx *ctx,
 					struct pon_gem_port_counters *param);
 
+/**
+ *	Function to invalidate the cached GEM port ID to GEM port index
+ *	translation of all PON library contexts in this process.
+ *	The library invalidates the cache itself on firmware events which
+ *	change the GEM port configuration. This function has to be called
+ *	by applications which create or delete GEM ports through other
+ *	interfaces than this library.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode
+fapi_pon_gem_port_cache_invalidate(struct pon_ctx *ctx);
+#endif
+
+/**
+ *	Function to read the GEM/XGEM port related counters of multiple GEM
+ *	ports at once. All firmware requests needed for this are sent without
+ *	waiting for the individual answers, this is much faster than calling
+ *	\ref fapi_pon_gem_port_counters_get for each GEM port.
+ *	GEM ports which do not exist or are disabled are skipped, only the
+ *	counters of the existing GEM ports are returned.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open or
+ *	\ref fapi_pon_open_mt.
+ *	\param[in] gem_port_ids Array of GEM port IDs to read, set this to NULL
+ *	to read the counters of all active GEM ports.
+ *	\param[in,out] num In: Number of entries in gem_port_ids or, if
+ *	gem_port_ids is NULL, number of entries available in param.
+ *	Out: Number of entries written to param.
+ *	\param[out] param Array of structures as defined
+ *	by \ref pon_gem_port_counters, it must provide space for at least num
+ *	entries.
+ *
+ *	\remarks The function returns an error code in case of error.
+ *	The error code is described in \ref fapi_pon_errorcode.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- PON_STATUS_MEM_NOT_ENOUGH: More active GEM ports than entries in param
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode
+fapi_pon_gem_port_counters_batch_get(struct pon_ctx *ctx,
+				     const uint16_t *gem_port_ids,
+				     uint32_t *num,
+				     struct pon_gem_port_counters *param);
+#endif
+
 /**
  *	Function to read GPON TC (GTC) counters.
  *	This function is applicable only in GPON operation mode.
@@ -2656,6 +2870,180 @@ fapi_pon_dp_config_get(struct pon_ctx *ctx,
 enum fapi_pon_errorcode
 fapi_pon_xgspon_lods_counters_get(struct pon_ctx *ctx,
 			struct pon_xgspon_lods_counters *param);
+
+#ifndef SWIG
+/**
+ *	Function to read raw counter groups into a counter snapshot.
+ *	Only the requested groups are read, the other groups of the snapshot
+ *	are left unchanged. The time and PON mode are set when the first group
+ *	is read into an empty snapshot.
+ *	This function is applicable to all ITU PON standards
+ *	(GPON, XG-PON, XGS-PON, NG-PON2).
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in] groups Bit mask of the raw groups to read,
+ *	see PON_CNT_SNAP_*
+ *	\param[in,out] snap Pointer to a structure as defined
+ *	by \ref pon_cnt_snapshot.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- PON_STATUS_OPERATION_MODE_ERR: If a requested group is not
+ *	  available in the current PON mode
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode
+fapi_pon_cnt_snapshot_get(struct pon_ctx *ctx, uint32_t groups,
+			  struct pon_cnt_snapshot *snap);
+
+/**
+ *	Function to derive the FEC counters from a counter snapshot, as
+ *	provided by \ref fapi_pon_fec_counters_get.
+ *	The snapshot must contain PON_CNT_SNAP_STATUS and, if the downstream
+ *	FEC is enabled, PON_CNT_SNAP_GTC.
+ *
+ *	\param[in] snap Pointer to a structure as defined
+ *	by \ref pon_cnt_snapshot.
+ *	\param[out] param Pointer to a structure as defined
+ *	by \ref pon_fec_counters.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode
+fapi_pon_cnt_snapshot_fec_get(const struct pon_cnt_snapshot *snap,
+			      struct pon_fec_counters *param);
+
+/**
+ *	Function to derive the XGTC counters from a counter snapshot, as
+ *	provided by \ref fapi_pon_xgtc_counters_get.
+ *	The snapshot must contain PON_CNT_SNAP_XGTC and PON_CNT_SNAP_GTC.
+ *
+ *	\param[in] snap Pointer to a structure as defined
+ *	by \ref pon_cnt_snapshot.
+ *	\param[out] param Pointer to a structure as defined
+ *	by \ref pon_xgtc_counters.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode
+fapi_pon_cnt_snapshot_xgtc_get(const struct pon_cnt_snapshot *snap,
+			       struct pon_xgtc_counters *param);
+
+/**
+ *	Function to derive the PLOAM downstream counters from a counter
+ *	snapshot, as provided by \ref fapi_pon_ploam_ds_counters_get.
+ *	The snapshot must contain PON_CNT_SNAP_PLOAM_DS and, in XG-PON,
+ *	XGS-PON and NG-PON2 mode, PON_CNT_SNAP_XGTC.
+ *
+ *	\param[in] snap Pointer to a structure as defined
+ *	by \ref pon_cnt_snapshot.
+ *	\param[out] param Pointer to a structure as defined
+ *	by \ref pon_ploam_ds_counters.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode
+fapi_pon_cnt_snapshot_ploam_ds_get(const struct pon_cnt_snapshot *snap,
+				   struct pon_ploam_ds_counters *param);
+
+/**
+ *	Start exporting the counters to a shared memory region.
+ *
+ *	A thread samples the counters periodically and publishes each sample
+ *	in a POSIX shared memory object. Other processes read the latest
+ *	sample with \ref fapi_pon_shm_read without any firmware access, a
+ *	sequence counter lets them detect and retry a read which overlapped
+ *	with an update. Only one export per shared memory name can be active,
+ *	the object left behind by a terminated process is taken over.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open_mt,
+ *		the samples are read concurrently to the other requests.
+ *	\param[in] name Name of the shared memory object, NULL selects
+ *		PON_SHM_NAME_DEF.
+ *	\param[in] cfg Pointer to a structure as defined by
+ *		\ref pon_shm_cfg, NULL selects the default values.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- PON_STATUS_RESOURCE_ERR: If another process exports to this name
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode
+fapi_pon_shm_export_start(struct pon_ctx *ctx, const char *name,
+			  const struct pon_shm_cfg *cfg);
+
+/**
+ *	Stop exporting the counters and remove the shared memory object.
+ *	Readers which still have the object opened get an error on the next
+ *	read. This is also done by \ref fapi_pon_close.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open_mt.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode fapi_pon_shm_export_stop(struct pon_ctx *ctx);
+
+/** Reader of the shared memory counter export */
+struct pon_shm_reader;
+
+/**
+ *	Open the shared memory counter export for reading.
+ *	This does not need a PON library context and can be used by any
+ *	process which has read access to the shared memory object.
+ *
+ *	\param[in] name Name of the shared memory object, NULL selects
+ *		PON_SHM_NAME_DEF.
+ *	\param[out] reader Reader handle, to be closed with
+ *		\ref fapi_pon_shm_reader_close.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- PON_STATUS_RESOURCE_ERR: If the export is not running
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode
+fapi_pon_shm_reader_open(const char *name, struct pon_shm_reader **reader);
+
+/**
+ *	Close a reader of the shared memory counter export.
+ *
+ *	\param[in] reader Reader handle created by
+ *		\ref fapi_pon_shm_reader_open.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode
+fapi_pon_shm_reader_close(struct pon_shm_reader *reader);
+
+/**
+ *	Read the latest counter sample from the shared memory counter export.
+ *
+ *	\param[in] reader Reader handle created by
+ *		\ref fapi_pon_shm_reader_open.
+ *	\param[out] cnt Pointer to a structure as defined by
+ *		\ref pon_shm_counters.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- PON_STATUS_RESOURCE_ERR: If the export was stopped, the reader has
+ *	  to be opened again
+ *	- PON_STATUS_TIMEOUT: If no consistent sample could be read, because
+ *	  no sample was published yet or the update did not complete
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode fapi_pon_shm_read(struct pon_shm_reader *reader,
+					  struct pon_shm_counters *cnt);
+#endif
 /*! @} */ /* End of GPON functions */
 
 /*! @} */ /* End of PON library definitions */
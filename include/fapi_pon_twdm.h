@@ -978,6 +978,69 @@ fapi_pon_twdm_tuning_counters_get(struct pon_ctx *ctx,
 				  const uint8_t dswlch_id,
 				  struct pon_twdm_tuning_counters *param);
 
+/** Maximum number of TWDM downstream wavelength channels */
+#define PON_TWDM_DSWLCH_MAX 16
+
+/** Counters of one TWDM downstream wavelength channel.
+ *  Used by \ref fapi_pon_twdm_counters_sweep.
+ */
+struct pon_twdm_channel_counters {
+	/** Downstream wavelength channel ID */
+	uint8_t dswlch_id;
+	/** Result of the counter read of this channel, the counters are only
+	 *  valid if this is PON_STATUS_OK
+	 */
+	enum fapi_pon_errorcode result;
+	/** Wavelength-specific XGTC counters */
+	struct pon_twdm_xgtc_counters xgtc;
+	/** Downstream PLOAM message counters */
+	struct pon_twdm_ploam_ds_counters ploam_ds;
+	/** Upstream PLOAM message counters */
+	struct pon_twdm_ploam_us_counters ploam_us;
+	/** Tuning control counters */
+	struct pon_twdm_tuning_counters tuning;
+	/** Optic power leveling counters */
+	struct pon_twdm_optic_pl_counters optic_pl;
+	/** XGEM counters, accumulated over all XGEM ports */
+	struct pon_gem_port_counters xgem;
+};
+
+/**
+ *	Function to read all TWDM counters of several downstream wavelength
+ *	channels at once. The requests of all channels are sent without
+ *	waiting for the individual answers, the counters are the same as
+ *	reported by \ref fapi_pon_twdm_xgtc_counters_get,
+ *	\ref fapi_pon_twdm_ploam_ds_counters_get,
+ *	\ref fapi_pon_twdm_ploam_us_counters_get,
+ *	\ref fapi_pon_twdm_tuning_counters_get,
+ *	\ref fapi_pon_twdm_optic_pl_counters_get and
+ *	\ref fapi_pon_twdm_xgem_all_counters_get.
+ *
+ *	\param[in] ctx PON library context created by \ref fapi_pon_open.
+ *	\param[in] dswlch_ids Downstream wavelength channel IDs to read,
+ *	or NULL to read all channels which have a valid downstream channel
+ *	profile.
+ *	\param[in,out] num Number of channel IDs given in dswlch_ids and
+ *	number of elements of param. Returns the number of channels read.
+ *	\param[out] param Array of structures as defined by
+ *	\ref pon_twdm_channel_counters.
+ *
+ *	\remarks PON_STATUS_MEM_NOT_ENOUGH is returned if more channels are
+ *	active than param can hold. A channel which can not be read does not
+ *	fail the function, its error is returned in the result member.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+#ifndef SWIG
+enum fapi_pon_errorcode
+fapi_pon_twdm_counters_sweep(struct pon_ctx *ctx,
+			     const uint8_t *dswlch_ids,
+			     uint32_t *num,
+			     struct pon_twdm_channel_counters *param);
+#endif
+
 /*! @} */ /* End of TWDM functions */
 
 /*! @} */ /* End of PON library definitions */
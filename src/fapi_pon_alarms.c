@@ -8,12 +8,26 @@
  *
  *****************************************************************************/
 
+#include <pthread.h>
+
 #include "fapi_pon.h"
 #include "fapi_pon_alarms.h"
+#include "fapi_pon_os.h"
+#include "fapi_pon_core.h"
+
+/* Number of alarms per group, bits 7:0 of the alarm ID are below this */
+#define PON_ALARM_BITS 32
 
-#define DEFINE_ALARM(alarm_id, desc) {alarm_id, #alarm_id, desc}
+/* The alarm tables are indexed by the alarm ID, group (ID >> 8) and bit
+ * (ID & 0xFF), to look up an alarm in constant time. An alarm ID which does
+ * not fit into the table fails to compile with "array index in initializer
+ * exceeds array bounds", at run time such an ID is ignored.
+ */
+#define DEFINE_ALARM(alarm_id, desc) \
+	[(alarm_id) >> 8][(alarm_id) & 0xFF] = {alarm_id, #alarm_id, desc}
 
-static const struct alarm_type pon_alarm_level[] = {
+static const struct alarm_type
+	pon_alarm_level[PON_ALARM_GROUPS][PON_ALARM_BITS] = {
 	DEFINE_ALARM(PON_ALARM_STATIC_LOS, "Loss of signal"),
 	DEFINE_ALARM(PON_ALARM_STATIC_LOF, "Loss of frame"),
 	DEFINE_ALARM(PON_ALARM_STATIC_LODS,
@@ -100,7 +114,8 @@ static const struct alarm_type pon_alarm_level[] = {
 		     "Same signal as XGTCR just configured as level sensitive"),
 };
 
-static const struct alarm_type pon_alarm_edge[] = {
+static const struct alarm_type
+	pon_alarm_edge[PON_ALARM_GROUPS][PON_ALARM_BITS] = {
 	DEFINE_ALARM(PON_ALARM_EDGE_DSWL_ERR,
 		     "DWLCHID mismatch between the one selected by the transceiver and the one synchronized on."
 		     ),
@@ -332,30 +347,170 @@ static const struct alarm_type pon_alarm_edge[] = {
 		     ),
 };
 
-int fapi_pon_visit_alarms_level(void *ctx, alarms_visitor_t cb, void *data)
+static int pon_alarm_visit(const struct alarm_type table[][PON_ALARM_BITS],
+			   void *ctx, alarms_visitor_t cb, void *data)
 {
-	int i;
+	unsigned int group, bit;
 	int ret = 0;
 
-	for (i = 0; i < sizeof(pon_alarm_level) /
-	     sizeof(struct alarm_type); i++) {
-		ret = cb(ctx, &pon_alarm_level[i], data);
-		if (ret != 0)
-			break;
+	for (group = 0; group < PON_ALARM_GROUPS; group++) {
+		for (bit = 0; bit < PON_ALARM_BITS; bit++) {
+			if (!table[group][bit].name)
+				continue;
+			ret = cb(ctx, &table[group][bit], data);
+			if (ret != 0)
+				return ret;
+		}
 	}
 	return ret;
 }
 
+int fapi_pon_visit_alarms_level(void *ctx, alarms_visitor_t cb, void *data)
+{
+	return pon_alarm_visit(pon_alarm_level, ctx, cb, data);
+}
+
 int fapi_pon_visit_alarms_edge(void *ctx, alarms_visitor_t cb, void *data)
 {
-	int i;
-	int ret = 0;
+	return pon_alarm_visit(pon_alarm_edge, ctx, cb, data);
+}
+
+static const struct alarm_type *
+pon_alarm_lookup(const struct alarm_type table[][PON_ALARM_BITS],
+		 uint32_t alarm_id)
+{
+	const struct alarm_type *alarm;
+
+	if ((alarm_id >> 8) >= PON_ALARM_GROUPS ||
+	    (alarm_id & 0xFF) >= PON_ALARM_BITS)
+		return NULL;
+
+	alarm = &table[alarm_id >> 8][alarm_id & 0xFF];
+	if (!alarm->name)
+		return NULL;
+
+	return alarm;
+}
+
+const struct alarm_type *fapi_pon_alarm_level_info_get(uint32_t alarm_id)
+{
+	return pon_alarm_lookup(pon_alarm_level, alarm_id);
+}
+
+const struct alarm_type *fapi_pon_alarm_edge_info_get(uint32_t alarm_id)
+{
+	return pon_alarm_lookup(pon_alarm_edge, alarm_id);
+}
+
+const struct alarm_type *fapi_pon_alarm_info_get(uint32_t alarm_id)
+{
+	const struct alarm_type *alarm;
+
+	alarm = pon_alarm_lookup(pon_alarm_level, alarm_id);
+	if (!alarm)
+		alarm = pon_alarm_lookup(pon_alarm_edge, alarm_id);
+
+	return alarm;
+}
+
+/* Alarm states of the process, kept current by the event listeners.
+ * Bit (ID & 0xFF) of word (ID >> 8) is set when the alarm is active.
+ */
+static volatile uint32_t pon_alarm_level_active[PON_ALARM_GROUPS];
+static volatile uint32_t pon_alarm_edge_active[PON_ALARM_GROUPS];
+/* Value of pon_alarm_seq after the last event of each level alarm */
+static uint32_t pon_alarm_level_seq[PON_ALARM_GROUPS][PON_ALARM_BITS];
+/* Serializes the updates of the level alarm states */
+static pthread_mutex_t pon_alarm_lock = PTHREAD_MUTEX_INITIALIZER;
+/* Incremented on every alarm change */
+static volatile uint32_t pon_alarm_seq;
+/* Set to 1 when the level alarms were read from the firmware */
+static volatile uint32_t pon_alarm_synced;
 
-	for (i = 0; i < sizeof(pon_alarm_edge) /
-	     sizeof(struct alarm_type); i++) {
-		ret = cb(ctx, &pon_alarm_edge[i], data);
-		if (ret != 0)
-			break;
+void pon_alarm_state_set(uint16_t alarm_id, bool active)
+{
+	unsigned int group = alarm_id >> 8;
+	unsigned int nr = alarm_id & 0xFF;
+	uint32_t bit;
+
+	if (group >= PON_ALARM_GROUPS || nr >= PON_ALARM_BITS)
+		return;
+	bit = 1U << nr;
+
+	pthread_mutex_lock(&pon_alarm_lock);
+	if (!active) {
+		pon_atomic_and(&pon_alarm_level_active[group], ~bit);
+		pon_atomic_and(&pon_alarm_edge_active[group], ~bit);
+		pon_alarm_level_seq[group][nr] = pon_atomic_inc(&pon_alarm_seq);
+	} else if (pon_alarm_lookup(pon_alarm_level, alarm_id)) {
+		pon_atomic_or(&pon_alarm_level_active[group], bit);
+		pon_alarm_level_seq[group][nr] = pon_atomic_inc(&pon_alarm_seq);
+	} else {
+		pon_atomic_or(&pon_alarm_edge_active[group], bit);
+		pon_atomic_inc(&pon_alarm_seq);
+	}
+	pthread_mutex_unlock(&pon_alarm_lock);
+}
+
+uint32_t pon_alarm_level_sync_start(void)
+{
+	return pon_atomic_get(&pon_alarm_seq);
+}
+
+void pon_alarm_level_sync(const struct pon_alarm_active *active, uint32_t seq)
+{
+	uint32_t level[PON_ALARM_GROUPS] = {0};
+	uint32_t keep, cur;
+	unsigned int i, nr;
+	uint16_t id;
+
+	for (i = 0; i < active->num; i++) {
+		id = active->id[i];
+		if ((id >> 8) < PON_ALARM_GROUPS &&
+		    (id & 0xFF) < PON_ALARM_BITS)
+			level[id >> 8] |= 1U << (id & 0xFF);
+	}
+
+	pthread_mutex_lock(&pon_alarm_lock);
+	for (i = 0; i < PON_ALARM_GROUPS; i++) {
+		/* an event received after the read started is more recent */
+		keep = 0;
+		for (nr = 0; nr < PON_ALARM_BITS; nr++)
+			if ((int32_t)(pon_alarm_level_seq[i][nr] - seq) > 0)
+				keep |= 1U << nr;
+
+		cur = pon_atomic_get(&pon_alarm_level_active[i]);
+		pon_atomic_set(&pon_alarm_level_active[i],
+			       (cur & keep) | (level[i] & ~keep));
+	}
+	pon_atomic_inc(&pon_alarm_seq);
+	pon_atomic_set(&pon_alarm_synced, 1);
+	pthread_mutex_unlock(&pon_alarm_lock);
+}
+
+void pon_alarm_level_invalidate(void)
+{
+	pon_atomic_set(&pon_alarm_synced, 0);
+}
+
+bool pon_alarm_level_synced(void)
+{
+	return pon_atomic_get(&pon_alarm_synced) != 0;
+}
+
+void pon_alarm_snapshot_read(struct pon_alarm_snapshot *snap, bool edge_clear)
+{
+	unsigned int i;
+
+	snap->seq = pon_atomic_get(&pon_alarm_seq);
+
+	for (i = 0; i < PON_ALARM_GROUPS; i++) {
+		snap->level[i] = pon_atomic_get(&pon_alarm_level_active[i]);
+		if (edge_clear)
+			snap->edge[i] =
+				pon_atomic_and(&pon_alarm_edge_active[i], 0);
+		else
+			snap->edge[i] =
+				pon_atomic_get(&pon_alarm_edge_active[i]);
 	}
-	return ret;
 }
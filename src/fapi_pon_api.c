@@ -47,6 +47,8 @@
 #include <string.h>
 #include <math.h>
 #include <time.h>
+#include <stddef.h>
+#include <pthread.h>
 #include "fapi_pon.h"
 #include "fapi_pon_core.h"
 #include "fapi_pon_debug.h"
@@ -70,20 +72,6 @@
 				return PON_STATUS_VALUE_RANGE_ERR; \
 			} while (0)
 
-#define CNT_DECODE_U64(COUNTER, DEST) \
-	do { \
-		if (cnt[PON_MBOX_A_CNT_##COUNTER]) \
-			dst_param->DEST = \
-				nla_get_u64(cnt[PON_MBOX_A_CNT_##COUNTER]); \
-	} while (0)
-
-#define CNT_DECODE_U32(PARAM, DEST) \
-	do { \
-		if (cnt[PON_MBOX_A_CNT_##PARAM]) \
-			dst_param->DEST = \
-				nla_get_u32(cnt[PON_MBOX_A_CNT_##PARAM]); \
-	} while (0)
-
 #define SRDS_DECODE_U8(PARAM, DEST) \
 	do { \
 		if (cfg[PON_MBOX_SRDS_##PARAM]) \
@@ -173,6 +161,9 @@
 /** The PON operation mode belongs to ITU modes. */
 #define MODE_ITU_PON (MODE_984_GPON | MODE_987_XGPON | MODE_9807_XGSPON | \
 		      MODE_989_NGPON2_10G | MODE_989_NGPON2_2G5)
+/** The PON operation mode uses the XGTC layer (XG-PON, XGS-PON, NG-PON2). */
+#define MODE_XG_PON (MODE_987_XGPON | MODE_9807_XGSPON | \
+		     MODE_989_NGPON2_10G | MODE_989_NGPON2_2G5)
 
 /*
 * Conversion factor for downstream frames from bytes to BIP32 words (4-Byte)
@@ -209,52 +200,91 @@ static const uint32_t threshold_cfg_10g[8] = {99532800, 9953280, 995328,
 const char pon_whatversion[] =
 	"@(#)MaxLinear PON library, Version " PACKAGE_VERSION pon_extra_ver_str;
 
-static struct nla_policy
-pon_mbox_cnt_gtc_policy[PON_MBOX_A_CNT_GTC_MAX + 1] = {
-	[PON_MBOX_A_CNT_GTC_BIP_ERRORS] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_DISC_GEM_FRAMES] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_GEM_HEC_ERRORS_CORR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_GEM_HEC_ERRORS_UNCORR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_BWMAP_HEC_ERRORS_CORR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_BYTES_CORR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_FEC_CODEWORDS_CORR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_FEC_COREWORDS_UNCORR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_TOTAL_FRAMES] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_FEC_SEC] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_GEM_IDLE] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_LODS_EVENTS] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_DG_TIME] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GTC_PLOAM_CRC_ERRORS] = { .type = NLA_U64 },
+/** Location of a counter in the destination structure */
+struct pon_cnt_field {
+	/** Offset of the counter */
+	uint16_t offset;
+	/** Size of the counter, 0 if the attribute is not decoded */
+	uint16_t size;
 };
 
-static struct nla_policy
-pon_mbox_cnt_xgtc_policy[PON_MBOX_A_CNT_XGTC_MAX + 1] = {
-	[PON_MBOX_A_CNT_XGTC_PSBD_HEC_ERR_UNCORR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_XGTC_PSBD_HEC_ERR_CORR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_XGTC_FS_HEC_ERR_UNCORR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_XGTC_FS_HEC_ERR_CORR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_XGTC_LOST_WORDS] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_XGTC_PLOAM_MIC_ERR] = { .type = NLA_U64 },
+/** Netlink counter family decoded by \ref pon_cnt_decode */
+struct pon_cnt_family {
+	/** Counter locations, indexed by the netlink attribute ID */
+	const struct pon_cnt_field *field;
+	/** Highest netlink attribute ID of the family */
+	unsigned int max;
+	/** Size of the destination structure */
+	size_t size;
+	/** Offset of the sum of all decoded counters, -1 if not used */
+	int all;
 };
 
-static struct nla_policy
-pon_mbox_cnt_gem_port_policy[PON_MBOX_A_CNT_GEM_PORT_MAX + 1] = {
-	[PON_MBOX_A_CNT_GEM_PORT_GEM_PORT_ID] = { .type = NLA_U32 },
-	[PON_MBOX_A_CNT_GEM_PORT_TX_FRAMES] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GEM_PORT_TX_FRAGMENTS] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GEM_PORT_TX_BYTES] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GEM_PORT_RX_FRAMES] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GEM_PORT_RX_FRAGMENTS] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GEM_PORT_RX_BYTES] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_GEM_PORT_KEY_ERRORS] = { .type = NLA_U64 },
+#define CNT_FIELD(TYPE, ATTR, MEMBER) \
+	[PON_MBOX_A_CNT_##ATTR] = { offsetof(struct TYPE, MEMBER), \
+				    sizeof(((struct TYPE *)0)->MEMBER) }
+
+#define CNT_FAMILY(TYPE, FIELD) \
+	{ FIELD, ARRAY_SIZE(FIELD) - 1, sizeof(struct TYPE), -1 }
+
+#define CNT_FAMILY_ALL(TYPE, FIELD) \
+	{ FIELD, ARRAY_SIZE(FIELD) - 1, sizeof(struct TYPE), \
+	  offsetof(struct TYPE, all) }
+
+#define F(ATTR, MEMBER) CNT_FIELD(pon_gtc_counters, GTC_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_gtc_field[PON_MBOX_A_CNT_GTC_MAX + 1] = {
+	F(BIP_ERRORS, bip_errors),
+	F(DISC_GEM_FRAMES, disc_gem_frames),
+	F(GEM_HEC_ERRORS_CORR, gem_hec_errors_corr),
+	F(GEM_HEC_ERRORS_UNCORR, gem_hec_errors_uncorr),
+	F(BWMAP_HEC_ERRORS_CORR, bwmap_hec_errors_corr),
+	F(BYTES_CORR, bytes_corr),
+	F(FEC_CODEWORDS_CORR, fec_codewords_corr),
+	F(FEC_COREWORDS_UNCORR, fec_codewords_uncorr),
+	F(TOTAL_FRAMES, total_frames),
+	F(FEC_SEC, fec_sec),
+	F(GEM_IDLE, gem_idle),
+	F(LODS_EVENTS, lods_events),
+	F(DG_TIME, dg_time),
+	F(PLOAM_CRC_ERRORS, ploam_crc_errors),
 };
-
-static struct nla_policy
-pon_mbox_cnt_alloc_policy[PON_MBOX_A_CNT_ALLOC_MAX + 1] = {
-	[PON_MBOX_A_CNT_ALLOC_ALLOCATIONS] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ALLOC_IDLE] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ALLOC_US_BW] = { .type = NLA_U64 },
+#undef F
+
+#define F(ATTR, MEMBER) CNT_FIELD(pon_xgtc_counters, XGTC_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_xgtc_field[PON_MBOX_A_CNT_XGTC_MAX + 1] = {
+	F(PSBD_HEC_ERR_UNCORR, psbd_hec_err_uncorr),
+	F(PSBD_HEC_ERR_CORR, psbd_hec_err_corr),
+	F(FS_HEC_ERR_UNCORR, fs_hec_err_uncorr),
+	F(FS_HEC_ERR_CORR, fs_hec_err_corr),
+	F(LOST_WORDS, lost_words),
+	F(PLOAM_MIC_ERR, ploam_mic_err),
+};
+#undef F
+
+#define F(ATTR, MEMBER) \
+	CNT_FIELD(pon_gem_port_counters, GEM_PORT_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_gem_port_field[PON_MBOX_A_CNT_GEM_PORT_MAX + 1] = {
+	F(TX_FRAMES, tx_frames),
+	F(TX_FRAGMENTS, tx_fragments),
+	F(TX_BYTES, tx_bytes),
+	F(RX_FRAMES, rx_frames),
+	F(RX_FRAGMENTS, rx_fragments),
+	F(RX_BYTES, rx_bytes),
+	F(KEY_ERRORS, key_errors),
 };
+#undef F
+
+#define F(ATTR, MEMBER) CNT_FIELD(pon_alloc_counters, ALLOC_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_alloc_field[PON_MBOX_A_CNT_ALLOC_MAX + 1] = {
+	F(ALLOCATIONS, allocations),
+	F(IDLE, idle),
+	F(US_BW, us_bw),
+};
+#undef F
 
 static struct nla_policy
 pon_mbox_cnt_alloc_discard_policy[PON_MBOX_A_CNT_ALLOC_DISCARD_MAX + 1] = {
@@ -268,21 +298,23 @@ pon_mbox_cnt_alloc_discard_item_policy
 	  [PON_MBOX_A_CNT_ALLOC_DISCARD_ITEM] = { .type = NLA_U64 },
 };
 
-static struct nla_policy
-pon_mbox_cnt_eth_policy[PON_MBOX_A_CNT_ETH_MAX + 1] = {
-	[PON_MBOX_A_CNT_ETH_BYTES] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ETH_FRAMES_LT_64] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ETH_FRAMES_64] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ETH_FRAMES_65_127] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ETH_FRAMES_128_255] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ETH_FRAMES_256_511] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ETH_FRAMES_512_1023] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ETH_FRAMES_1024_1518] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ETH_FRAMES_GT_1518] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ETH_FRAMES_FCS_ERR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ETH_BYTES_FCS_ERR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_ETH_FRAMES_TOO_LONG] = { .type = NLA_U64 },
+#define F(ATTR, MEMBER) CNT_FIELD(pon_eth_counters, ETH_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_eth_field[PON_MBOX_A_CNT_ETH_MAX + 1] = {
+	F(BYTES, bytes),
+	F(FRAMES_LT_64, frames_lt_64),
+	F(FRAMES_64, frames_64),
+	F(FRAMES_65_127, frames_65_127),
+	F(FRAMES_128_255, frames_128_255),
+	F(FRAMES_256_511, frames_256_511),
+	F(FRAMES_512_1023, frames_512_1023),
+	F(FRAMES_1024_1518, frames_1024_1518),
+	F(FRAMES_GT_1518, frames_gt_1518),
+	F(FRAMES_FCS_ERR, frames_fcs_err),
+	F(BYTES_FCS_ERR, bytes_fcs_err),
+	F(FRAMES_TOO_LONG, frames_too_long),
 };
+#undef F
 
 static struct nla_policy
 serdes_config_policy[PON_MBOX_SRDS_MAX + 1] = {
@@ -319,23 +351,43 @@ static struct nla_policy dp_config_policy[PON_MBOX_DPCFG_MAX + 1] = {
 	[PON_MBOX_A_DP_CONFIG_WITHOUT_TIMESTAMP] = { .type = NLA_U8 },
 };
 
-static struct nla_policy
-pon_mbox_cnt_twdm_lods_policy[PON_MBOX_A_CNT_TWDM_LODS_MAX + 1] = {
-	[PON_MBOX_A_CNT_TWDM_LODS_EVENTS_ALL] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TWDM_LODS_RESTORED_OPER] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TWDM_LODS_RESTORED_PROT] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TWDM_LODS_RESTORED_DISK] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TWDM_LODS_REACTIVATION_OPER] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TWDM_LODS_REACTIVATION_PROT] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TWDM_LODS_REACTIVATION_DISC] = { .type = NLA_U64 },
+#define F(ATTR, MEMBER) \
+	CNT_FIELD(pon_twdm_xgtc_counters, TWDM_LODS_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_twdm_lods_field[PON_MBOX_A_CNT_TWDM_LODS_MAX + 1] = {
+	F(EVENTS_ALL, lods_events_all),
+	F(RESTORED_OPER, lods_restored_oper),
+	F(RESTORED_PROT, lods_restored_prot),
+	F(RESTORED_DISK, lods_restored_disc),
+	F(REACTIVATION_OPER, lods_reactivation),
+	F(REACTIVATION_PROT, lods_reactivation_prot),
+	F(REACTIVATION_DISC, lods_reactivation_disc),
 };
-
-static struct nla_policy
-pon_mbox_cnt_twdm_optic_pl_policy[PON_MBOX_A_CNT_TWDM_OPTIC_PL_MAX + 1] = {
-	[PON_MBOX_A_CNT_TWDM_OPTIC_PL_REJECTED] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TWDM_OPTIC_PL_INCOMPLETE] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TWDM_OPTIC_PL_COMPLETE] = { .type = NLA_U64 },
+#undef F
+
+#define F(ATTR, MEMBER) \
+	CNT_FIELD(pon_xgspon_lods_counters, TWDM_LODS_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_xgspon_lods_field[PON_MBOX_A_CNT_TWDM_LODS_MAX + 1] = {
+	F(EVENTS_ALL, lods_events_all),
+	F(RESTORED_OPER, lods_restored_oper),
+	F(RESTORED_PROT, lods_restored_prot),
+	F(RESTORED_DISK, lods_restored_disc),
+	F(REACTIVATION_OPER, lods_reactivation),
+	F(REACTIVATION_PROT, lods_reactivation_prot),
+	F(REACTIVATION_DISC, lods_reactivation_disc),
+};
+#undef F
+
+#define F(ATTR, MEMBER) \
+	CNT_FIELD(pon_twdm_optic_pl_counters, TWDM_OPTIC_PL_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_twdm_optic_pl_field[PON_MBOX_A_CNT_TWDM_OPTIC_PL_MAX + 1] = {
+	F(REJECTED, rejected),
+	F(INCOMPLETE, incomplete),
+	F(COMPLETE, complete),
 };
+#undef F
 
 static struct nla_policy
 pon_mbox_cnt_twdm_tc_policy[PON_MBOX_A_CNT_TWDM_TC_MAX + 1] = {
@@ -347,70 +399,197 @@ pon_mbox_cnt_twdm_tc_item_policy[PON_MBOX_A_CNT_TWDM_TC_ITEM_MAX + 1] = {
 	[PON_MBOX_A_CNT_TWDM_TC_ITEM] = { .type = NLA_U64 },
 };
 
-static struct nla_policy
-pon_mbox_cnt_tc_ploam_ds_policy[PON_MBOX_A_CNT_TC_PLOAM_DS_MAX + 1] = {
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_US_OVERHEAD] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_ENC_PORT_ID] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_REQ_PW] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_NO_MESSAGE] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_POPUP] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_REQ_KEY] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_CONFIG_PORT_ID] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_PEE] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_PST] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_BER_INTERVAL] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_KEY_SWITCHING] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_EXT_BURST] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_PON_ID] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_SWIFT_POPUP] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_RANGING_ADJ] = { .type = NLA_U64 },
-
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_BST_PROFILE] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_ASS_ONU] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_RNG_TIME] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_DEACT_ONU] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_DIS_SER] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_REQ_REG] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_ASS_ALLOC] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_KEY_CTRL] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_SLP_ALLOW] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_CALIB_REQ] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_ADJ_TX_WL] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_TUNE_CTRL] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_SYS_PROFILE] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_CH_PROFILE] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_PROT_CONTROL] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_CHG_PW_LVL] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_PW_CONS] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_RATE_CTRL] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_REBOOT_ONU] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_UNKNOWN] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_ADJ_TX_WL_FAIL] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_TUNE_REQ] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_DS_TUNE_COMPL] = { .type = NLA_U64 },
+#define F(ATTR, MEMBER) \
+	CNT_FIELD(pon_ploam_ds_counters, TC_PLOAM_DS_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_ploam_ds_field[PON_MBOX_A_CNT_TC_PLOAM_DS_MAX + 1] = {
+	F(US_OVERHEAD, us_overhead),
+	F(ENC_PORT_ID, enc_port_id),
+	F(REQ_PW, req_passwd),
+	F(NO_MESSAGE, no_message),
+	F(POPUP, popup),
+	F(REQ_KEY, req_key),
+	F(CONFIG_PORT_ID, config_port_id),
+	F(PEE, pee),
+	F(PST, pst),
+	F(BER_INTERVAL, ber_interval),
+	F(KEY_SWITCHING, key_switching),
+	F(EXT_BURST, ext_burst),
+	F(PON_ID, pon_id),
+	F(SWIFT_POPUP, swift_popup),
+	F(RANGING_ADJ, ranging_adj),
+
+	F(BST_PROFILE, burst_profile),
+	F(ASS_ONU, assign_onu_id),
+	F(RNG_TIME, ranging_time),
+	F(DEACT_ONU, deact_onu),
+	F(DIS_SER, disable_ser_no),
+	F(REQ_REG, req_reg),
+	F(ASS_ALLOC, assign_alloc_id),
+	F(KEY_CTRL, key_control),
+	F(SLP_ALLOW, sleep_allow),
+	F(CALIB_REQ, cal_req),
+	F(ADJ_TX_WL, tx_wavelength),
+	F(TUNE_CTRL, tune_ctrl),
+	F(SYS_PROFILE, system_profile),
+	F(CH_PROFILE, channel_profile),
+	F(PROT_CONTROL, protection),
+	F(CHG_PW_LVL, cpl),
+	F(PW_CONS, power),
+	F(RATE_CTRL, rate),
+	F(REBOOT_ONU, reset),
+	F(UNKNOWN, unknown),
+	F(ADJ_TX_WL_FAIL, tx_wavelength_err),
+	F(TUNE_REQ, tuning_request),
+	F(TUNE_COMPL, tuning_complete),
 };
-
-static struct nla_policy
-pon_mbox_cnt_tc_ploam_us_policy[PON_MBOX_A_CNT_TC_PLOAM_DS_MAX + 1] = {
-	[PON_MBOX_A_CNT_TC_PLOAM_US_SER_ONU] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_PASSWORD] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_DYG_GASP] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_NO_MSG] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_ENC_KEY] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_PHY_EE] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_PST_MSG] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_REM_ERR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_ACK] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_SLP_REQ] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_REG] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_KEY_REP] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_TUN_RES] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_PW_CONS] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_RATE_RESP] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_CPL_ERR] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_TUN_RES_AN] = { .type = NLA_U64 },
-	[PON_MBOX_A_CNT_TC_PLOAM_US_TUN_RES_CRB] = { .type = NLA_U64 }
+#undef F
+
+#define F(ATTR, MEMBER) \
+	CNT_FIELD(pon_twdm_ploam_ds_counters, TC_PLOAM_DS_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_twdm_ploam_ds_field[PON_MBOX_A_CNT_TC_PLOAM_DS_MAX + 1] = {
+	F(BST_PROFILE, burst_profile),
+	F(ASS_ONU, assign_onu_id),
+	F(RNG_TIME, ranging_time),
+	F(DEACT_ONU, deact_onu),
+	F(DIS_SER, disable_ser_no),
+	F(REQ_REG, req_reg),
+	F(ASS_ALLOC, assign_alloc_id),
+	F(KEY_CTRL, key_control),
+	F(SLP_ALLOW, sleep_allow),
+	F(CALIB_REQ, cal_req),
+	F(ADJ_TX_WL, tx_wavelength),
+	F(TUNE_CTRL, tune_ctrl),
+	F(SYS_PROFILE, system_profile),
+	F(CH_PROFILE, channel_profile),
+	F(PROT_CONTROL, protection),
+	F(CHG_PW_LVL, cpl),
+	F(PW_CONS, power),
+	F(RATE_CTRL, rate),
+	F(REBOOT_ONU, reset),
+	F(UNKNOWN, unknown),
+	F(ADJ_TX_WL_FAIL, tx_wavelength_err),
+	F(TUNE_REQ, tuning_request),
+	F(TUNE_COMPL, tuning_complete),
+};
+#undef F
+
+#define F(ATTR, MEMBER) \
+	CNT_FIELD(pon_ploam_us_counters, TC_PLOAM_US_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_ploam_us_field[PON_MBOX_A_CNT_TC_PLOAM_US_MAX + 1] = {
+	F(SER_ONU, ser_no),
+	F(PASSWORD, passwd),
+	F(DYG_GASP, dying_gasp),
+	F(NO_MSG, no_message),
+	F(ENC_KEY, enc_key),
+	F(PHY_EE, pee),
+	F(PST_MSG, pst),
+	F(REM_ERR, rei),
+	F(ACK, ack),
+	F(SLP_REQ, sleep_req),
+	F(REG, reg),
+	F(KEY_REP, key_rep),
+	F(TUN_RES, tuning_resp),
+	F(PW_CONS, power_rep),
+	F(RATE_RESP, rate_resp),
 };
+#undef F
+
+#define F(ATTR, MEMBER) \
+	CNT_FIELD(pon_twdm_ploam_us_counters, TC_PLOAM_US_##ATTR, MEMBER)
+static const struct pon_cnt_field
+pon_cnt_twdm_ploam_us_field[PON_MBOX_A_CNT_TC_PLOAM_US_MAX + 1] = {
+	F(SER_ONU, ser_no),
+	F(REG, reg),
+	F(KEY_REP, key_rep),
+	F(ACK, ack),
+	F(SLP_REQ, sleep_req),
+	F(TUN_RES_AN, tuning_resp_ack_nack),
+	F(TUN_RES_CRB, tuning_resp_complete_rollback),
+	F(PW_CONS, power_rep),
+	F(CPL_ERR, cpl_err),
+};
+#undef F
+
+static const struct pon_cnt_family pon_cnt_gtc =
+	CNT_FAMILY(pon_gtc_counters, pon_cnt_gtc_field);
+static const struct pon_cnt_family pon_cnt_xgtc =
+	CNT_FAMILY(pon_xgtc_counters, pon_cnt_xgtc_field);
+static const struct pon_cnt_family pon_cnt_gem_port =
+	CNT_FAMILY(pon_gem_port_counters, pon_cnt_gem_port_field);
+static const struct pon_cnt_family pon_cnt_alloc =
+	CNT_FAMILY(pon_alloc_counters, pon_cnt_alloc_field);
+static const struct pon_cnt_family pon_cnt_eth =
+	CNT_FAMILY(pon_eth_counters, pon_cnt_eth_field);
+static const struct pon_cnt_family pon_cnt_twdm_lods =
+	CNT_FAMILY(pon_twdm_xgtc_counters, pon_cnt_twdm_lods_field);
+static const struct pon_cnt_family pon_cnt_xgspon_lods =
+	CNT_FAMILY(pon_xgspon_lods_counters, pon_cnt_xgspon_lods_field);
+static const struct pon_cnt_family pon_cnt_twdm_optic_pl =
+	CNT_FAMILY(pon_twdm_optic_pl_counters, pon_cnt_twdm_optic_pl_field);
+static const struct pon_cnt_family pon_cnt_ploam_ds =
+	CNT_FAMILY_ALL(pon_ploam_ds_counters, pon_cnt_ploam_ds_field);
+static const struct pon_cnt_family pon_cnt_twdm_ploam_ds =
+	CNT_FAMILY_ALL(pon_twdm_ploam_ds_counters, pon_cnt_twdm_ploam_ds_field);
+static const struct pon_cnt_family pon_cnt_ploam_us =
+	CNT_FAMILY_ALL(pon_ploam_us_counters, pon_cnt_ploam_us_field);
+static const struct pon_cnt_family pon_cnt_twdm_ploam_us =
+	CNT_FAMILY_ALL(pon_twdm_ploam_us_counters, pon_cnt_twdm_ploam_us_field);
+
+/*
+ * Decode the nested PON_MBOX_A_CNT attribute of a counter reply into the
+ * destination structure. The attributes are walked once and written
+ * directly to their location, unknown attributes are ignored.
+ */
+static enum fapi_pon_errorcode pon_cnt_decode(const struct pon_cnt_family *fam,
+					      struct nlattr **attrs,
+					      void *dst)
+{
+	const struct pon_cnt_field *field;
+	uint8_t *base = dst;
+	struct nlattr *nla;
+	uint64_t val, all = 0;
+	int type, rem;
+
+	memset(dst, 0, fam->size);
+
+	if (!attrs[PON_MBOX_A_CNT])
+		return PON_STATUS_ERR;
+
+	nla_for_each_nested(nla, attrs[PON_MBOX_A_CNT], rem) {
+		type = nla_type(nla);
+		if (type > (int)fam->max)
+			continue;
+
+		field = &fam->field[type];
+		if (!field->size)
+			continue;
+
+		if (nla_len(nla) < field->size)
+			return PON_STATUS_ERR;
+
+		switch (field->size) {
+		case sizeof(uint64_t):
+			val = nla_get_u64(nla);
+			*(uint64_t *)(base + field->offset) = val;
+			break;
+		case sizeof(uint32_t):
+			val = nla_get_u32(nla);
+			*(uint32_t *)(base + field->offset) = (uint32_t)val;
+			break;
+		default:
+			continue;
+		}
+		all += val;
+	}
+
+	if (fam->all >= 0)
+		*(uint64_t *)(base + fam->all) = all;
+
+	return PON_STATUS_OK;
+}
 
 /*
  * Function used to check data integrity between source
@@ -464,22 +643,132 @@ void pon_byte_copy(uint8_t *dst, const uint8_t *src, int size)
 		*dst++ = *src++;
 }
 
+/*
+ * The firmware capabilities, version, limits and mode do not change while
+ * the firmware is running and are shared by all contexts of the process.
+ * The cache is updated under a mutex and read without locking: the sequence
+ * counter is odd while an update is in progress and a reader retries if it
+ * changed during the copy. The generation counter is incremented when the
+ * firmware is reloaded, a value read from the firmware is only stored if the
+ * generation did not change during the request. Loopback contexts bypass the
+ * cache, their firmware is a fixture file.
+ */
+enum pon_fw_info_item {
+	PON_FW_INFO_CAPS,
+	PON_FW_INFO_VER,
+	PON_FW_INFO_LIMITS,
+	PON_FW_INFO_MODE,
+	PON_FW_INFO_PLAT,
+};
+
+struct pon_fw_info {
+	/** Sequence counter, odd while an update is in progress */
+	volatile uint32_t seq;
+	/** Generation, incremented on each firmware reload */
+	volatile uint32_t gen;
+	/** Bit mask of the valid items */
+	uint32_t valid;
+	/** FW capabilities */
+	struct pon_cap caps;
+	/** FW version */
+	struct pon_version ver;
+	/** GEM port and allocation limits */
+	struct pon_range_limits limits;
+	/** PON mode */
+	uint8_t mode;
+	/** Platform type bit as established from the FW version */
+	uint32_t plat_type;
+};
+
+static struct pon_fw_info pon_fw_info;
+static pthread_mutex_t pon_fw_info_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Location of the cached items */
+static const struct {
+	size_t offset;
+	size_t size;
+} pon_fw_info_field[] = {
+	[PON_FW_INFO_CAPS] = { offsetof(struct pon_fw_info, caps),
+			       sizeof(struct pon_cap) },
+	[PON_FW_INFO_VER] = { offsetof(struct pon_fw_info, ver),
+			      sizeof(struct pon_version) },
+	[PON_FW_INFO_LIMITS] = { offsetof(struct pon_fw_info, limits),
+				 sizeof(struct pon_range_limits) },
+	[PON_FW_INFO_MODE] = { offsetof(struct pon_fw_info, mode),
+			       sizeof(uint8_t) },
+	[PON_FW_INFO_PLAT] = { offsetof(struct pon_fw_info, plat_type),
+			       sizeof(uint32_t) },
+};
+
+/* Copy a cached item, returns false if it is not cached */
+static bool pon_fw_info_get(struct pon_ctx *ctx, enum pon_fw_info_item item,
+			    void *data)
+{
+	const uint8_t *src = (const uint8_t *)&pon_fw_info +
+			     pon_fw_info_field[item].offset;
+	uint32_t seq;
+	bool valid;
+
+	if (ctx->lb)
+		return false;
+
+	do {
+		while ((seq = pon_atomic_get(&pon_fw_info.seq)) & 1)
+			;
+		valid = pon_fw_info.valid & (1U << item);
+		if (valid)
+			memcpy(data, src, pon_fw_info_field[item].size);
+		pon_smp_rmb();
+	} while (seq != pon_atomic_get(&pon_fw_info.seq));
+
+	return valid;
+}
+
+/* Store an item read from the firmware during generation gen */
+static void pon_fw_info_put(struct pon_ctx *ctx, enum pon_fw_info_item item,
+			    const void *data, uint32_t gen)
+{
+	uint8_t *dst = (uint8_t *)&pon_fw_info +
+		       pon_fw_info_field[item].offset;
+
+	if (ctx->lb)
+		return;
+
+	pthread_mutex_lock(&pon_fw_info_lock);
+	if (gen == pon_fw_info.gen) {
+		pon_atomic_set(&pon_fw_info.seq, pon_fw_info.seq + 1);
+		pon_smp_wmb();
+		memcpy(dst, data, pon_fw_info_field[item].size);
+		pon_fw_info.valid |= 1U << item;
+		pon_atomic_set(&pon_fw_info.seq, pon_fw_info.seq + 1);
+	}
+	pthread_mutex_unlock(&pon_fw_info_lock);
+}
+
+void pon_fw_info_invalidate(void)
+{
+	pthread_mutex_lock(&pon_fw_info_lock);
+	pon_atomic_set(&pon_fw_info.seq, pon_fw_info.seq + 1);
+	pon_smp_wmb();
+	pon_fw_info.valid = 0;
+	pon_atomic_inc(&pon_fw_info.gen);
+	pon_atomic_set(&pon_fw_info.seq, pon_fw_info.seq + 1);
+	pthread_mutex_unlock(&pon_fw_info_lock);
+}
+
 static enum fapi_pon_errorcode pon_mode_get_decode(struct pon_ctx *ctx,
 						   struct nlattr **attrs,
 						   void *priv)
 {
 	uint8_t *pon_mode = priv;
 
+	UNUSED(ctx);
+
 	if (!attrs[PON_MBOX_A_PON_MODE])
 		return PON_STATUS_ERR;
 
 	*pon_mode = nla_get_u8(attrs[PON_MBOX_A_PON_MODE]);
 
-	/* Caching PON mode in PON context */
-	ctx->mode = *pon_mode;
-	/* Caching PON mode validity in PON context */
-	ctx->mode_valid = 1;
-
 	return PON_STATUS_OK;
 }
 
@@ -549,6 +838,7 @@ static enum fapi_pon_errorcode actual_platform_type_get(struct pon_ctx *ctx,
 {
 	enum fapi_pon_errorcode ret;
 	struct pon_version version;
+	uint32_t gen = pon_atomic_get(&pon_fw_info.gen);
 	static const uint32_t mapper[] = {
 		[PONFW_VERSION_PLATFORM_FPGA_PRX_A] = PLAT_T_PRX,
 		[PONFW_VERSION_PLATFORM_SOC_PRX_A]  = PLAT_T_PRX,
@@ -563,8 +853,8 @@ static enum fapi_pon_errorcode actual_platform_type_get(struct pon_ctx *ctx,
 		/* [PONFW_VERSION_PLATFORM_SOC_TPZ_A] = PLAT_T_TPZ */
 	};
 
-	if (ctx->actual_plat_type)
-		goto actual_plat_type_get_exit;
+	if (pon_fw_info_get(ctx, PON_FW_INFO_PLAT, act_plat_type))
+		return PON_STATUS_OK;
 
 	ret = fapi_pon_version_get(ctx, &version);
 	if (ret != PON_STATUS_OK)
@@ -573,10 +863,9 @@ static enum fapi_pon_errorcode actual_platform_type_get(struct pon_ctx *ctx,
 	if (version.fw_version_platform >= ARRAY_SIZE(mapper))
 		return PON_STATUS_FW_UNEXPECTED;
 
-	ctx->actual_plat_type = 1UL << mapper[version.fw_version_platform];
+	*act_plat_type = 1UL << mapper[version.fw_version_platform];
+	pon_fw_info_put(ctx, PON_FW_INFO_PLAT, act_plat_type, gen);
 
-actual_plat_type_get_exit:
-	*act_plat_type = ctx->actual_plat_type;
 	return PON_STATUS_OK;
 }
 
@@ -637,15 +926,15 @@ enum fapi_pon_errorcode fapi_pon_mode_get(struct pon_ctx *ctx,
 	struct nl_msg *msg;
 	enum fapi_pon_errorcode ret;
 	uint32_t seq = NL_AUTO_SEQ;
+	uint32_t gen;
 
 	if (!ctx || !pon_mode)
 		return PON_STATUS_INPUT_ERR;
 
-	if (ctx->mode_valid) {
-		*pon_mode = ctx->mode;
+	if (pon_fw_info_get(ctx, PON_FW_INFO_MODE, pon_mode))
 		return PON_STATUS_OK;
-	}
 
+	gen = pon_atomic_get(&pon_fw_info.gen);
 	ret = fapi_pon_nl_msg_prepare_decode(ctx, &msg, &cb_data, &seq,
 					     &pon_mode_get_decode,
 					     NULL, pon_mode,
@@ -653,7 +942,11 @@ enum fapi_pon_errorcode fapi_pon_mode_get(struct pon_ctx *ctx,
 	if (ret != PON_STATUS_OK)
 		return ret;
 
-	return fapi_pon_nl_msg_send(ctx, &msg, &cb_data, &seq);
+	ret = fapi_pon_nl_msg_send(ctx, &msg, &cb_data, &seq);
+	if (ret == PON_STATUS_OK)
+		pon_fw_info_put(ctx, PON_FW_INFO_MODE, pon_mode, gen);
+
+	return ret;
 }
 
 static enum fapi_pon_errorcode external_calibration_update(struct pon_ctx *ctx)
@@ -688,20 +981,16 @@ enum fapi_pon_errorcode fapi_pon_limits_get(struct pon_ctx *ctx,
 					    struct pon_range_limits *param)
 {
 	enum fapi_pon_errorcode ret;
+	uint32_t gen;
 
 	if (!ctx || !param)
 		return PON_STATUS_INPUT_ERR;
 
-	if (ctx->limits_valid) {
-		if (memcpy_s(param, sizeof(*param),
-			     &ctx->limits_data,
-			     sizeof(ctx->limits_data))) {
-			PON_DEBUG_ERR("memcpy_s failed");
-			return PON_STATUS_MEMCPY_ERR;
-		}
-	} else {
+	if (!pon_fw_info_get(ctx, PON_FW_INFO_LIMITS, param)) {
 		struct pon_cap caps = {0};
 
+		gen = pon_atomic_get(&pon_fw_info.gen);
+
 		ret = fapi_pon_cap_get(ctx, &caps);
 		if (ret != PON_STATUS_OK)
 			return ret;
@@ -720,15 +1009,7 @@ enum fapi_pon_errorcode fapi_pon_limits_get(struct pon_ctx *ctx,
 		param->gem_port_idx_max = caps.gem_ports - 1;
 		param->alloc_idx_max = caps.alloc_ids - 1;
 
-		/* Caching limits data in PON context */
-		if (memcpy_s(&ctx->limits_data,
-			     sizeof(ctx->limits_data),
-			     param, sizeof(*param))) {
-			PON_DEBUG_ERR("memcpy_s failed");
-			return PON_STATUS_MEMCPY_ERR;
-		}
-		/* Caching limits validity in PON context */
-		ctx->limits_valid = 1;
+		pon_fw_info_put(ctx, PON_FW_INFO_LIMITS, param, gen);
 	}
 
 	return PON_STATUS_OK;
@@ -743,6 +1024,8 @@ static enum fapi_pon_errorcode pon_cap_get_copy(struct pon_ctx *ctx,
 	const struct ponfw_capabilities *src_param = data;
 	struct pon_cap *dst_param = priv;
 
+	UNUSED(ctx);
+
 	ret = integrity_check(dst_param, sizeof(*src_param), data_size);
 	if (ret != PON_STATUS_OK)
 		return ret;
@@ -755,39 +1038,32 @@ static enum fapi_pon_errorcode pon_cap_get_copy(struct pon_ctx *ctx,
 	dst_param->itxinit = src_param->itxinit;
 	dst_param->qos_max = src_param->qos_max;
 
-	/* Caching capabilities data in PON context */
-	if (memcpy_s(&ctx->caps_data, sizeof(ctx->caps_data),
-		     dst_param, sizeof(*dst_param))) {
-		PON_DEBUG_ERR("memcpy_s failed");
-		return PON_STATUS_MEMCPY_ERR;
-	}
-	/* Caching capabilities validity in PON context */
-	ctx->caps_valid = 1;
-
 	return PON_STATUS_OK;
 }
 
 enum fapi_pon_errorcode fapi_pon_cap_get(struct pon_ctx *ctx,
 					 struct pon_cap *param)
 {
-	if (!ctx)
+	enum fapi_pon_errorcode ret;
+	uint32_t gen;
+
+	if (!ctx || !param)
 		return PON_STATUS_INPUT_ERR;
 
-	if (ctx->caps_valid) {
-		if (memcpy_s(param, sizeof(*param),
-			     &ctx->caps_data, sizeof(ctx->caps_data))) {
-			PON_DEBUG_ERR("memcpy_s failed");
-			return PON_STATUS_MEMCPY_ERR;
-		}
+	if (pon_fw_info_get(ctx, PON_FW_INFO_CAPS, param))
 		return PON_STATUS_OK;
-	}
 
-	return fapi_pon_generic_get(ctx,
-				    PONFW_CAPABILITIES_CMD_ID,
-				    NULL,
-				    0,
-				    &pon_cap_get_copy,
-				    param);
+	gen = pon_atomic_get(&pon_fw_info.gen);
+	ret = fapi_pon_generic_get(ctx,
+				   PONFW_CAPABILITIES_CMD_ID,
+				   NULL,
+				   0,
+				   &pon_cap_get_copy,
+				   param);
+	if (ret == PON_STATUS_OK)
+		pon_fw_info_put(ctx, PON_FW_INFO_CAPS, param, gen);
+
+	return ret;
 }
 
 static enum fapi_pon_errorcode pon_version_get_copy(struct pon_ctx *ctx,
@@ -799,6 +1075,8 @@ static enum fapi_pon_errorcode pon_version_get_copy(struct pon_ctx *ctx,
 	const struct ponfw_version *src_param = data;
 	struct pon_version *dst_param = priv;
 
+	UNUSED(ctx);
+
 	ret = integrity_check(dst_param, sizeof(*src_param), data_size);
 	if (ret != PON_STATUS_OK)
 		return ret;
@@ -813,39 +1091,32 @@ static enum fapi_pon_errorcode pon_version_get_copy(struct pon_ctx *ctx,
 	dst_param->fw_timestamp = src_param->time;
 	dst_param->sw_version = PON_VERSION_CODE;
 
-	/* Caching version data in PON context */
-	if (memcpy_s(&ctx->ver_data, sizeof(ctx->ver_data),
-		     dst_param, sizeof(*dst_param))) {
-		PON_DEBUG_ERR("memcpy_s failed");
-		return PON_STATUS_MEMCPY_ERR;
-	}
-	/* Caching version validity in PON context */
-	ctx->ver_valid = 1;
-
 	return PON_STATUS_OK;
 }
 
 enum fapi_pon_errorcode fapi_pon_version_get(struct pon_ctx *ctx,
 					     struct pon_version *param)
 {
-	if (!ctx)
+	enum fapi_pon_errorcode ret;
+	uint32_t gen;
+
+	if (!ctx || !param)
 		return PON_STATUS_INPUT_ERR;
 
-	if (ctx->ver_valid) {
-		if (memcpy_s(param, sizeof(*param),
-			     &ctx->ver_data, sizeof(ctx->ver_data))) {
-			PON_DEBUG_ERR("memcpy_s failed");
-			return PON_STATUS_MEMCPY_ERR;
-		}
+	if (pon_fw_info_get(ctx, PON_FW_INFO_VER, param))
 		return PON_STATUS_OK;
-	}
 
-	return fapi_pon_generic_get(ctx,
-				    PONFW_VERSION_CMD_ID,
-				    NULL,
-				    0,
-				    &pon_version_get_copy,
-				    param);
+	gen = pon_atomic_get(&pon_fw_info.gen);
+	ret = fapi_pon_generic_get(ctx,
+				   PONFW_VERSION_CMD_ID,
+				   NULL,
+				   0,
+				   &pon_version_get_copy,
+				   param);
+	if (ret == PON_STATUS_OK)
+		pon_fw_info_put(ctx, PON_FW_INFO_VER, param, gen);
+
+	return ret;
 }
 
 /* External calibration option constants */
@@ -927,9 +1198,67 @@ static float dmi_calculate(unsigned char *slope, unsigned char *offset,
 #define DMI_RX_POW (104-DMI_START)
 #define DMI_STATUS (110-DMI_START)
 
-enum fapi_pon_errorcode
-fapi_pon_optic_status_get(struct pon_ctx *ctx, struct pon_optic_status *param,
-				  enum pon_tx_power_scale scale)
+/*
+ * The optical status is read from the SFP EEPROM, which is slow when the
+ * transceiver is connected by I2C. The last converted status is cached per
+ * context and served to all readers which accept its age.
+ */
+struct pon_dmi_cache {
+	/** Serializes the EEPROM reads and protects the cached status */
+	pthread_mutex_t lock;
+	/** Cached status */
+	struct pon_optic_status status;
+	/** TX power scale the cached status was converted with */
+	enum pon_tx_power_scale scale;
+	/** Monotonic time of the EEPROM read in us, 0 if invalid */
+	uint64_t time;
+};
+
+enum fapi_pon_errorcode pon_dmi_cache_init(struct pon_ctx *ctx)
+{
+	struct pon_dmi_cache *cache;
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache)
+		return PON_STATUS_MEM_ERR;
+
+	if (pthread_mutex_init(&cache->lock, NULL)) {
+		free(cache);
+		return PON_STATUS_ERR;
+	}
+
+	ctx->dmi_cache = cache;
+
+	return PON_STATUS_OK;
+}
+
+void pon_dmi_cache_invalidate(struct pon_ctx *ctx)
+{
+	struct pon_dmi_cache *cache = ctx->dmi_cache;
+
+	if (!cache)
+		return;
+
+	pthread_mutex_lock(&cache->lock);
+	cache->time = 0;
+	pthread_mutex_unlock(&cache->lock);
+}
+
+void pon_dmi_cache_free(struct pon_ctx *ctx)
+{
+	struct pon_dmi_cache *cache = ctx->dmi_cache;
+
+	if (!cache)
+		return;
+
+	pthread_mutex_destroy(&cache->lock);
+	free(cache);
+	ctx->dmi_cache = NULL;
+}
+
+static enum fapi_pon_errorcode
+pon_optic_status_read(struct pon_ctx *ctx, struct pon_optic_status *param,
+		      enum pon_tx_power_scale scale)
 {
 	enum fapi_pon_errorcode ret;
 	unsigned char ext_data[EXT_LINE];
@@ -937,9 +1266,6 @@ fapi_pon_optic_status_get(struct pon_ctx *ctx, struct pon_optic_status *param,
 	float rx_power;
 	float tx_power;
 
-	if (!ctx)
-		return PON_STATUS_INPUT_ERR;
-
 	ret = fapi_pon_eeprom_data_get(ctx, PON_DDMI_A2, dmi_data,
 				       DMI_START, DMI_LINE);
 	if (ret != PON_STATUS_OK)
@@ -1046,6 +1372,50 @@ fapi_pon_optic_status_get(struct pon_ctx *ctx, struct pon_optic_status *param,
 	return PON_STATUS_OK;
 }
 
+enum fapi_pon_errorcode
+fapi_pon_optic_status_cached_get(struct pon_ctx *ctx,
+				 struct pon_optic_status *param,
+				 enum pon_tx_power_scale scale,
+				 uint32_t max_age)
+{
+	enum fapi_pon_errorcode ret = PON_STATUS_OK;
+	struct pon_dmi_cache *cache;
+	uint64_t now;
+
+	if (!ctx || !param || !ctx->dmi_cache)
+		return PON_STATUS_INPUT_ERR;
+
+	cache = ctx->dmi_cache;
+
+	/* Concurrent readers wait for a running EEPROM read and use its
+	 * result instead of reading again.
+	 */
+	pthread_mutex_lock(&cache->lock);
+	now = pon_time_us();
+	if (!cache->time || cache->scale != scale ||
+	    now - cache->time >= (uint64_t)max_age * 1000) {
+		ret = pon_optic_status_read(ctx, &cache->status, scale);
+		if (ret == PON_STATUS_OK) {
+			cache->time = now;
+			cache->scale = scale;
+		} else {
+			cache->time = 0;
+		}
+	}
+	if (ret == PON_STATUS_OK)
+		*param = cache->status;
+	pthread_mutex_unlock(&cache->lock);
+
+	return ret;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_optic_status_get(struct pon_ctx *ctx, struct pon_optic_status *param,
+				  enum pon_tx_power_scale scale)
+{
+	return fapi_pon_optic_status_cached_get(ctx, param, scale, 0);
+}
+
 #define SID_PROP_START 0
 #define SID_PROP_SIZE 96
 #define SID_IDENTIFIER (0-SID_PROP_START)
@@ -1818,79 +2188,322 @@ enum fapi_pon_errorcode fapi_pon_omci_cfg_get(struct pon_ctx *ctx,
 				    param);
 }
 
-static enum fapi_pon_errorcode pon_gem_port_index_get_copy(struct pon_ctx *ctx,
-							  const void *data,
-							  size_t data_size,
-							  void *priv)
+/*
+ * The GEM port ID to GEM port index translation is needed for every GEM port
+ * counter read, but the mapping only changes when the GEM ports are
+ * reconfigured. The translation results are cached per context in a dense
+ * array indexed by the GEM port index and a hash table keyed by the GEM port
+ * ID. The caches of all contexts are invalidated by incrementing the process
+ * wide generation counter.
+ */
+static volatile uint32_t pon_gem_cache_gen;
+
+/** Entry of the GEM port ID hash table */
+struct pon_gem_cache_slot {
+	/** GEM port ID */
+	uint16_t gem_port_id;
+	/** GEM port index + 1, 0 marks an unused slot */
+	uint16_t idx;
+};
+
+struct pon_gem_cache {
+	/** Generation the cached values belong to */
+	uint32_t gen;
+	/** Number of GEM port indexes */
+	uint32_t size;
+	/** GEM port information, indexed by the GEM port index */
+	struct pon_gem_port *port;
+	/** Set to true if the entry in port is valid */
+	bool *valid;
+	/** GEM port ID hash table, size is a power of two */
+	struct pon_gem_cache_slot *slot;
+	/** Hash table size - 1 */
+	uint32_t mask;
+};
+
+void pon_gem_cache_invalidate(void)
 {
-	enum fapi_pon_errorcode ret;
-	const struct ponfw_gem_port_idx *src_param = data;
-	struct pon_gem_port *dst_param = priv;
+	pon_atomic_inc(&pon_gem_cache_gen);
+}
 
-	UNUSED(ctx);
+static uint32_t pon_gem_cache_gen_get(void)
+{
+	return pon_atomic_get(&pon_gem_cache_gen);
+}
 
-	ret = integrity_check(dst_param, sizeof(*src_param), data_size);
-	if (ret != PON_STATUS_OK)
-		return ret;
+void pon_gem_cache_free(struct pon_ctx *ctx)
+{
+	struct pon_gem_cache *cache = ctx->gem_cache;
 
-	dst_param->gem_port_index = (uint8_t)src_param->gem_port_idx;
-	dst_param->gem_port_id = (uint16_t)src_param->gem_port_id;
-	dst_param->encryption_key_ring = (uint8_t)src_param->enc;
-	dst_param->is_downstream =
-		(uint8_t)(!!(src_param->dir & PONFW_GEM_PORT_IDX_DIR_DS));
-	dst_param->is_upstream =
-		(uint8_t)(!!(src_param->dir & PONFW_GEM_PORT_IDX_DIR_US));
-	dst_param->payload_type = (uint8_t)src_param->tt;
-	dst_param->gem_max_size = (uint16_t)src_param->max_gem_size;
+	if (!cache)
+		return;
 
-	return PON_STATUS_OK;
+	free(cache->port);
+	free(cache->valid);
+	free(cache->slot);
+	free(cache);
+	ctx->gem_cache = NULL;
 }
 
-enum fapi_pon_errorcode
-fapi_pon_gem_port_index_get(struct pon_ctx *ctx, uint8_t gpix,
-			    struct pon_gem_port *param_out)
+static void pon_gem_cache_reset(struct pon_gem_cache *cache, uint32_t gen)
 {
-	struct ponfw_gem_port_idx fw_param = {0};
-	struct pon_range_limits limits = {0};
-	struct pon_allocation_id alloc_param;
-	enum fapi_pon_errorcode ret;
-	enum fapi_pon_errorcode alloc_ret;
+	memset(cache->valid, 0, cache->size * sizeof(*cache->valid));
+	memset(cache->slot, 0, (cache->mask + 1) * sizeof(*cache->slot));
+	cache->gen = gen;
+}
 
-	if (!param_out)
-		return PON_STATUS_INPUT_ERR;
+/*
+ * Return the GEM port cache of the context, matching the current generation
+ * and GEM port limits. Returns NULL if no cache can be provided, the caller
+ * has to ask the firmware in this case. Must be called with the context
+ * locked, the limits have to be read before as reading them can require a
+ * firmware request.
+ */
+static struct pon_gem_cache *
+pon_gem_cache_prepare(struct pon_ctx *ctx,
+		      const struct pon_range_limits *limits)
+{
+	struct pon_gem_cache *cache = ctx->gem_cache;
+	uint32_t gen = pon_gem_cache_gen_get();
+	uint32_t hash_size = 1;
 
-	if (!pon_mode_check(ctx, MODE_ITU_PON))
-		return PON_STATUS_OPERATION_MODE_ERR;
+	if (cache && cache->size == limits->gem_port_idx_max + 1U) {
+		if (cache->gen != gen)
+			pon_gem_cache_reset(cache, gen);
+		return cache;
+	}
 
-	ret = fapi_pon_limits_get(ctx, &limits);
-	if (ret != PON_STATUS_OK)
-		return ret;
+	pon_gem_cache_free(ctx);
 
-	if (gpix > limits.gem_port_idx_max)
-		return PON_STATUS_VALUE_RANGE_ERR;
+	cache = calloc(1, sizeof(*cache));
+	if (!cache)
+		return NULL;
 
-	ASSIGN_AND_OVERFLOW_CHECK(fw_param.gem_port_idx, gpix);
+	cache->size = limits->gem_port_idx_max + 1U;
+	while (hash_size < 2 * cache->size)
+		hash_size <<= 1;
+	cache->mask = hash_size - 1;
+	cache->gen = gen;
 
-	ret = fapi_pon_generic_get(ctx,
-				   PONFW_GEM_PORT_IDX_CMD_ID,
-				   &fw_param,
-				   PONFW_GEM_PORT_IDX_LENR,
-				   &pon_gem_port_index_get_copy,
-				   param_out);
-	if (ret != PON_STATUS_OK)
-		return ret;
+	cache->port = calloc(cache->size, sizeof(*cache->port));
+	cache->valid = calloc(cache->size, sizeof(*cache->valid));
+	cache->slot = calloc(hash_size, sizeof(*cache->slot));
+	ctx->gem_cache = cache;
+	if (!cache->port || !cache->valid || !cache->slot) {
+		pon_gem_cache_free(ctx);
+		return NULL;
+	}
 
-	/* not upstream and not downstream means it is disabled. */
-	if (param_out->is_downstream == 0 && param_out->is_upstream == 0)
-		return PON_STATUS_GEM_PORT_ID_NOT_EXISTS_ERR;
+	return cache;
+}
 
-	alloc_ret = fapi_pon_gem_port_alloc_get(ctx, param_out->gem_port_id,
-						&alloc_param);
+static uint32_t pon_gem_cache_hash(const struct pon_gem_cache *cache,
+				   uint16_t gem_port_id)
+{
+	return (gem_port_id * 2654435761U >> 16) & cache->mask;
+}
 
-	/*
-	 * PON_STATUS_GEM_PORT_ID_NOT_EXISTS_ERR means there is no allocation ID
-	 * associated with the GEM port. Only fail in case of another unexpected
-	 * error.
+/* A slot is in use if it still points to a valid entry of its GEM port ID. */
+static bool pon_gem_cache_slot_used(const struct pon_gem_cache *cache,
+				    const struct pon_gem_cache_slot *slot)
+{
+	return slot->idx && cache->valid[slot->idx - 1] &&
+	       cache->port[slot->idx - 1].gem_port_id == slot->gem_port_id;
+}
+
+static struct pon_gem_cache_slot *
+pon_gem_cache_find(struct pon_gem_cache *cache, uint16_t gem_port_id)
+{
+	struct pon_gem_cache_slot *slot;
+	uint32_t h = pon_gem_cache_hash(cache, gem_port_id);
+	uint32_t i;
+
+	for (i = 0; i <= cache->mask; i++) {
+		slot = &cache->slot[(h + i) & cache->mask];
+		if (!slot->idx)
+			return NULL;
+		if (slot->gem_port_id == gem_port_id &&
+		    pon_gem_cache_slot_used(cache, slot))
+			return slot;
+	}
+
+	return NULL;
+}
+
+static bool pon_gem_cache_lookup(struct pon_ctx *ctx, uint16_t gem_port_id,
+				 struct pon_gem_port *gem_port)
+{
+	struct pon_range_limits limits = {0};
+	struct pon_gem_cache *cache;
+	struct pon_gem_cache_slot *slot = NULL;
+
+	if (fapi_pon_limits_get(ctx, &limits) != PON_STATUS_OK)
+		return false;
+
+	pon_ctx_lock(ctx);
+	cache = pon_gem_cache_prepare(ctx, &limits);
+	if (cache)
+		slot = pon_gem_cache_find(cache, gem_port_id);
+	if (slot)
+		*gem_port = cache->port[slot->idx - 1];
+	pon_ctx_unlock(ctx);
+
+	return slot != NULL;
+}
+
+static void pon_gem_cache_insert_locked(struct pon_ctx *ctx,
+					const struct pon_range_limits *limits,
+					const struct pon_gem_port *gem_port,
+					uint32_t gen)
+{
+	struct pon_gem_cache *cache = pon_gem_cache_prepare(ctx, limits);
+	struct pon_gem_cache_slot *slot;
+	uint32_t h;
+	uint32_t i;
+
+	/* The answer was requested before the cache was invalidated */
+	if (!cache || cache->gen != gen)
+		return;
+
+	if (gem_port->gem_port_index >= cache->size)
+		return;
+
+	cache->port[gem_port->gem_port_index] = *gem_port;
+	cache->valid[gem_port->gem_port_index] = true;
+
+	h = pon_gem_cache_hash(cache, gem_port->gem_port_id);
+	for (i = 0; i <= cache->mask; i++) {
+		slot = &cache->slot[(h + i) & cache->mask];
+		/* Reuse slots of entries which were overwritten */
+		if (slot->gem_port_id == gem_port->gem_port_id ||
+		    !pon_gem_cache_slot_used(cache, slot)) {
+			slot->gem_port_id = gem_port->gem_port_id;
+			slot->idx = gem_port->gem_port_index + 1;
+			return;
+		}
+	}
+
+	/* No free slot, can only happen after many reconfigurations */
+	pon_gem_cache_reset(cache, cache->gen);
+}
+
+/*
+ * Insert a GEM port read from the firmware. The gen value has to be taken
+ * from pon_gem_cache_gen_get() before the request was sent.
+ */
+static void pon_gem_cache_insert(struct pon_ctx *ctx,
+				 const struct pon_gem_port *gem_port,
+				 uint32_t gen)
+{
+	struct pon_range_limits limits = {0};
+
+	if (fapi_pon_limits_get(ctx, &limits) != PON_STATUS_OK)
+		return;
+
+	pon_ctx_lock(ctx);
+	pon_gem_cache_insert_locked(ctx, &limits, gem_port, gen);
+	pon_ctx_unlock(ctx);
+}
+
+static void pon_gem_cache_remove(struct pon_ctx *ctx, uint16_t gem_port_id)
+{
+	struct pon_gem_cache *cache;
+	struct pon_gem_cache_slot *slot;
+
+	pon_ctx_lock(ctx);
+	cache = ctx->gem_cache;
+	if (cache) {
+		slot = pon_gem_cache_find(cache, gem_port_id);
+		if (slot)
+			cache->valid[slot->idx - 1] = false;
+	}
+	pon_ctx_unlock(ctx);
+}
+
+enum fapi_pon_errorcode
+fapi_pon_gem_port_cache_invalidate(struct pon_ctx *ctx)
+{
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	pon_gem_cache_invalidate();
+
+	return PON_STATUS_OK;
+}
+
+static enum fapi_pon_errorcode pon_gem_port_index_get_copy(struct pon_ctx *ctx,
+							  const void *data,
+							  size_t data_size,
+							  void *priv)
+{
+	enum fapi_pon_errorcode ret;
+	const struct ponfw_gem_port_idx *src_param = data;
+	struct pon_gem_port *dst_param = priv;
+
+	UNUSED(ctx);
+
+	ret = integrity_check(dst_param, sizeof(*src_param), data_size);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	dst_param->gem_port_index = (uint8_t)src_param->gem_port_idx;
+	dst_param->gem_port_id = (uint16_t)src_param->gem_port_id;
+	dst_param->encryption_key_ring = (uint8_t)src_param->enc;
+	dst_param->is_downstream =
+		(uint8_t)(!!(src_param->dir & PONFW_GEM_PORT_IDX_DIR_DS));
+	dst_param->is_upstream =
+		(uint8_t)(!!(src_param->dir & PONFW_GEM_PORT_IDX_DIR_US));
+	dst_param->payload_type = (uint8_t)src_param->tt;
+	dst_param->gem_max_size = (uint16_t)src_param->max_gem_size;
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_gem_port_index_get(struct pon_ctx *ctx, uint8_t gpix,
+			    struct pon_gem_port *param_out)
+{
+	struct ponfw_gem_port_idx fw_param = {0};
+	struct pon_range_limits limits = {0};
+	struct pon_allocation_id alloc_param;
+	enum fapi_pon_errorcode ret;
+	enum fapi_pon_errorcode alloc_ret;
+
+	if (!param_out)
+		return PON_STATUS_INPUT_ERR;
+
+	if (!pon_mode_check(ctx, MODE_ITU_PON))
+		return PON_STATUS_OPERATION_MODE_ERR;
+
+	ret = fapi_pon_limits_get(ctx, &limits);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	if (gpix > limits.gem_port_idx_max)
+		return PON_STATUS_VALUE_RANGE_ERR;
+
+	ASSIGN_AND_OVERFLOW_CHECK(fw_param.gem_port_idx, gpix);
+
+	ret = fapi_pon_generic_get(ctx,
+				   PONFW_GEM_PORT_IDX_CMD_ID,
+				   &fw_param,
+				   PONFW_GEM_PORT_IDX_LENR,
+				   &pon_gem_port_index_get_copy,
+				   param_out);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	/* not upstream and not downstream means it is disabled. */
+	if (param_out->is_downstream == 0 && param_out->is_upstream == 0)
+		return PON_STATUS_GEM_PORT_ID_NOT_EXISTS_ERR;
+
+	alloc_ret = fapi_pon_gem_port_alloc_get(ctx, param_out->gem_port_id,
+						&alloc_param);
+
+	/*
+	 * PON_STATUS_GEM_PORT_ID_NOT_EXISTS_ERR means there is no allocation ID
+	 * associated with the GEM port. Only fail in case of another unexpected
+	 * error.
 	 */
 	if (alloc_ret == PON_STATUS_OK) {
 		param_out->alloc_valid = PON_ALLOC_VALID;
@@ -1947,6 +2560,7 @@ enum fapi_pon_errorcode fapi_pon_gem_port_id_get(struct pon_ctx *ctx,
 	struct ponfw_gem_port_id fw_param = {0};
 	struct pon_range_limits limits = {0};
 	enum fapi_pon_errorcode ret;
+	uint32_t gen;
 
 	if (!pon_mode_check(ctx, MODE_ITU_PON))
 		return PON_STATUS_OPERATION_MODE_ERR;
@@ -1960,18 +2574,38 @@ enum fapi_pon_errorcode fapi_pon_gem_port_id_get(struct pon_ctx *ctx,
 
 	ASSIGN_AND_OVERFLOW_CHECK(fw_param.gem_port_id, gem_port_id);
 
+	gen = pon_gem_cache_gen_get();
 	ret = fapi_pon_generic_get(ctx,
 				   PONFW_GEM_PORT_ID_CMD_ID,
 				   &fw_param,
 				   PONFW_GEM_PORT_ID_LENR,
 				   &pon_gem_port_id_get_copy,
 				   param_out);
-	if (ret == PON_STATUS_FW_NACK)
+	if (ret == PON_STATUS_FW_NACK) {
+		pon_gem_cache_remove(ctx, gem_port_id);
 		return PON_STATUS_GEM_PORT_ID_NOT_EXISTS_ERR;
+	}
+
+	if (ret == PON_STATUS_OK)
+		pon_gem_cache_insert(ctx, param_out, gen);
 
 	return ret;
 }
 
+/*
+ * Get the GEM port information from the cache, only ask the firmware if the
+ * GEM port ID is not cached.
+ */
+static enum fapi_pon_errorcode
+pon_gem_port_cached_get(struct pon_ctx *ctx, uint16_t gem_port_id,
+			struct pon_gem_port *gem_port)
+{
+	if (pon_gem_cache_lookup(ctx, gem_port_id, gem_port))
+		return PON_STATUS_OK;
+
+	return fapi_pon_gem_port_id_get(ctx, gem_port_id, gem_port);
+}
+
 static enum fapi_pon_errorcode pon_alloc_id_copy(struct pon_ctx *ctx,
 						 const void *data,
 						 size_t data_size,
@@ -3228,38 +3862,9 @@ pon_twdm_ploam_us_counters_get_decode(struct pon_ctx *ctx,
 				      struct nlattr **attrs,
 				      void *priv)
 {
-	struct pon_twdm_ploam_us_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_TC_PLOAM_US_MAX + 1];
-
-	memset(dst_param, 0, sizeof(*dst_param));
-
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
-
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_TC_PLOAM_US_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_tc_ploam_us_policy) < 0)
-		return PON_STATUS_ERR;
-
-	#define ASSIGN(src, dst) \
-		do { \
-			CNT_DECODE_U64(src, dst);; \
-			dst_param->all += dst_param->dst; \
-		} while (0)
-	ASSIGN(TC_PLOAM_US_SER_ONU, ser_no);
-	ASSIGN(TC_PLOAM_US_REG, reg);
-	ASSIGN(TC_PLOAM_US_KEY_REP, key_rep);
-	ASSIGN(TC_PLOAM_US_ACK, ack);
-	ASSIGN(TC_PLOAM_US_SLP_REQ, sleep_req);
-	ASSIGN(TC_PLOAM_US_TUN_RES_AN, tuning_resp_ack_nack);
-	ASSIGN(TC_PLOAM_US_TUN_RES_CRB, tuning_resp_complete_rollback);
-	ASSIGN(TC_PLOAM_US_PW_CONS, power_rep);
-	ASSIGN(TC_PLOAM_US_CPL_ERR, cpl_err);
-	#undef ASSIGN
-
-	return PON_STATUS_OK;
+	return pon_cnt_decode(&pon_cnt_twdm_ploam_us, attrs, priv);
 }
 
 static enum fapi_pon_errorcode
@@ -3267,44 +3872,9 @@ pon_ploam_us_counters_get_decode(struct pon_ctx *ctx,
 				 struct nlattr **attrs,
 				 void *priv)
 {
-	struct pon_ploam_us_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_TC_PLOAM_US_MAX + 1];
-
-	memset(dst_param, 0, sizeof(*dst_param));
-
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
-
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_TC_PLOAM_US_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_tc_ploam_us_policy) < 0)
-		return PON_STATUS_ERR;
-
-	#define ASSIGN(src, dst) \
-		do { \
-			CNT_DECODE_U64(src, dst);; \
-			dst_param->all += dst_param->dst; \
-		} while (0)
-	ASSIGN(TC_PLOAM_US_SER_ONU, ser_no);
-	ASSIGN(TC_PLOAM_US_PASSWORD, passwd);
-	ASSIGN(TC_PLOAM_US_DYG_GASP, dying_gasp);
-	ASSIGN(TC_PLOAM_US_NO_MSG, no_message);
-	ASSIGN(TC_PLOAM_US_ENC_KEY, enc_key);
-	ASSIGN(TC_PLOAM_US_PHY_EE, pee);
-	ASSIGN(TC_PLOAM_US_PST_MSG, pst);
-	ASSIGN(TC_PLOAM_US_REM_ERR, rei);
-	ASSIGN(TC_PLOAM_US_ACK, ack);
-	ASSIGN(TC_PLOAM_US_SLP_REQ, sleep_req);
-	ASSIGN(TC_PLOAM_US_REG, reg);
-	ASSIGN(TC_PLOAM_US_KEY_REP, key_rep);
-	ASSIGN(TC_PLOAM_US_TUN_RES, tuning_resp);
-	ASSIGN(TC_PLOAM_US_PW_CONS, power_rep);
-	ASSIGN(TC_PLOAM_US_RATE_RESP, rate_resp);
-	#undef ASSIGN
-
-	return PON_STATUS_OK;
+	return pon_cnt_decode(&pon_cnt_ploam_us, attrs, priv);
 }
 
 static enum fapi_pon_errorcode
@@ -3364,69 +3934,9 @@ pon_ploam_ds_counters_get_decode(struct pon_ctx *ctx,
 				 struct nlattr **attrs,
 				 void *priv)
 {
-	struct pon_ploam_ds_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_TC_PLOAM_DS_MAX + 1];
-
-	memset(dst_param, 0, sizeof(*dst_param));
-
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
-
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_TC_PLOAM_DS_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_tc_ploam_ds_policy) < 0)
-		return PON_STATUS_ERR;
-
-	#define ASSIGN(src, dst) \
-		do { \
-			CNT_DECODE_U64(src, dst);; \
-			dst_param->all += dst_param->dst; \
-		} while (0)
-
-	ASSIGN(TC_PLOAM_DS_BST_PROFILE, burst_profile);
-	ASSIGN(TC_PLOAM_DS_ASS_ONU, assign_onu_id);
-	ASSIGN(TC_PLOAM_DS_RNG_TIME, ranging_time);
-	ASSIGN(TC_PLOAM_DS_DEACT_ONU, deact_onu);
-	ASSIGN(TC_PLOAM_DS_DIS_SER, disable_ser_no);
-	ASSIGN(TC_PLOAM_DS_REQ_REG, req_reg);
-	ASSIGN(TC_PLOAM_DS_ASS_ALLOC, assign_alloc_id);
-	ASSIGN(TC_PLOAM_DS_KEY_CTRL, key_control);
-	ASSIGN(TC_PLOAM_DS_SLP_ALLOW, sleep_allow);
-	ASSIGN(TC_PLOAM_DS_CALIB_REQ, cal_req);
-	ASSIGN(TC_PLOAM_DS_ADJ_TX_WL, tx_wavelength);
-	ASSIGN(TC_PLOAM_DS_TUNE_CTRL, tune_ctrl);
-	ASSIGN(TC_PLOAM_DS_SYS_PROFILE, system_profile);
-	ASSIGN(TC_PLOAM_DS_CH_PROFILE, channel_profile);
-	ASSIGN(TC_PLOAM_DS_PROT_CONTROL, protection);
-	ASSIGN(TC_PLOAM_DS_CHG_PW_LVL, cpl);
-	ASSIGN(TC_PLOAM_DS_PW_CONS, power);
-	ASSIGN(TC_PLOAM_DS_RATE_CTRL, rate);
-	ASSIGN(TC_PLOAM_DS_REBOOT_ONU, reset);
-	ASSIGN(TC_PLOAM_DS_UNKNOWN, unknown);
-	ASSIGN(TC_PLOAM_DS_ADJ_TX_WL_FAIL, tx_wavelength_err);
-	ASSIGN(TC_PLOAM_DS_TUNE_REQ, tuning_request);
-	ASSIGN(TC_PLOAM_DS_TUNE_COMPL, tuning_complete);
-
-	ASSIGN(TC_PLOAM_DS_US_OVERHEAD, us_overhead);
-	ASSIGN(TC_PLOAM_DS_ENC_PORT_ID, enc_port_id);
-	ASSIGN(TC_PLOAM_DS_REQ_PW, req_passwd);
-	ASSIGN(TC_PLOAM_DS_NO_MESSAGE, no_message);
-	ASSIGN(TC_PLOAM_DS_POPUP, popup);
-	ASSIGN(TC_PLOAM_DS_REQ_KEY, req_key);
-	ASSIGN(TC_PLOAM_DS_CONFIG_PORT_ID, config_port_id);
-	ASSIGN(TC_PLOAM_DS_PEE, pee);
-	ASSIGN(TC_PLOAM_DS_PST, pst);
-	ASSIGN(TC_PLOAM_DS_BER_INTERVAL, ber_interval);
-	ASSIGN(TC_PLOAM_DS_KEY_SWITCHING, key_switching);
-	ASSIGN(TC_PLOAM_DS_EXT_BURST, ext_burst);
-	ASSIGN(TC_PLOAM_DS_PON_ID, pon_id);
-	ASSIGN(TC_PLOAM_DS_SWIFT_POPUP, swift_popup);
-	ASSIGN(TC_PLOAM_DS_RANGING_ADJ, ranging_adj);
-	#undef ASSIGN
-
-	return PON_STATUS_OK;
+	return pon_cnt_decode(&pon_cnt_ploam_ds, attrs, priv);
 }
 
 static enum fapi_pon_errorcode
@@ -3434,53 +3944,9 @@ pon_twdm_ploam_ds_counters_get_decode(struct pon_ctx *ctx,
 				      struct nlattr **attrs,
 				      void *priv)
 {
-	struct pon_twdm_ploam_ds_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_TC_PLOAM_DS_MAX + 1];
-
-	memset(dst_param, 0, sizeof(*dst_param));
-
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
-
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_TC_PLOAM_DS_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_tc_ploam_ds_policy) < 0)
-		return PON_STATUS_ERR;
-
-	#define ASSIGN(src, dst) \
-		do { \
-			CNT_DECODE_U64(src, dst);; \
-			dst_param->all += dst_param->dst; \
-		} while (0)
-
-	ASSIGN(TC_PLOAM_DS_BST_PROFILE, burst_profile);
-	ASSIGN(TC_PLOAM_DS_ASS_ONU, assign_onu_id);
-	ASSIGN(TC_PLOAM_DS_RNG_TIME, ranging_time);
-	ASSIGN(TC_PLOAM_DS_DEACT_ONU, deact_onu);
-	ASSIGN(TC_PLOAM_DS_DIS_SER, disable_ser_no);
-	ASSIGN(TC_PLOAM_DS_REQ_REG, req_reg);
-	ASSIGN(TC_PLOAM_DS_ASS_ALLOC, assign_alloc_id);
-	ASSIGN(TC_PLOAM_DS_KEY_CTRL, key_control);
-	ASSIGN(TC_PLOAM_DS_SLP_ALLOW, sleep_allow);
-	ASSIGN(TC_PLOAM_DS_CALIB_REQ, cal_req);
-	ASSIGN(TC_PLOAM_DS_ADJ_TX_WL, tx_wavelength);
-	ASSIGN(TC_PLOAM_DS_TUNE_CTRL, tune_ctrl);
-	ASSIGN(TC_PLOAM_DS_SYS_PROFILE, system_profile);
-	ASSIGN(TC_PLOAM_DS_CH_PROFILE, channel_profile);
-	ASSIGN(TC_PLOAM_DS_PROT_CONTROL, protection);
-	ASSIGN(TC_PLOAM_DS_CHG_PW_LVL, cpl);
-	ASSIGN(TC_PLOAM_DS_PW_CONS, power);
-	ASSIGN(TC_PLOAM_DS_RATE_CTRL, rate);
-	ASSIGN(TC_PLOAM_DS_REBOOT_ONU, reset);
-	ASSIGN(TC_PLOAM_DS_UNKNOWN, unknown);
-	ASSIGN(TC_PLOAM_DS_ADJ_TX_WL_FAIL, tx_wavelength_err);
-	ASSIGN(TC_PLOAM_DS_TUNE_REQ, tuning_request);
-	ASSIGN(TC_PLOAM_DS_TUNE_COMPL, tuning_complete);
-	#undef ASSIGN
-
-	return PON_STATUS_OK;
+	return pon_cnt_decode(&pon_cnt_twdm_ploam_ds, attrs, priv);
 }
 
 static enum fapi_pon_errorcode
@@ -3596,37 +4062,20 @@ pon_alloc_counters_get_decode(struct pon_ctx *ctx,
 				 struct nlattr **attrs,
 				 void *priv)
 {
-	struct pon_alloc_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_ALLOC_MAX + 1];
-
-	memset(dst_param, 0, sizeof(*dst_param));
-
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
-
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_ALLOC_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_alloc_policy) < 0)
-		return PON_STATUS_ERR;
-
-	CNT_DECODE_U64(ALLOC_IDLE, idle);
-	CNT_DECODE_U64(ALLOC_ALLOCATIONS, allocations);
-	CNT_DECODE_U64(ALLOC_US_BW, us_bw);
-
-	return PON_STATUS_OK;
+	return pon_cnt_decode(&pon_cnt_alloc, attrs, priv);
 }
 
-enum fapi_pon_errorcode
-fapi_pon_alloc_counters_get(struct pon_ctx *ctx, uint8_t alloc_index,
-			    struct pon_alloc_counters *param)
+/* Prepare the allocation counter read, shared by the sync and async API */
+static enum fapi_pon_errorcode
+pon_alloc_counters_msg(struct pon_ctx *ctx, uint8_t alloc_index,
+		       struct pon_alloc_counters *param,
+		       struct nl_msg **msg, struct read_cmd_cb *cb_data,
+		       uint32_t *seq)
 {
 	struct pon_range_limits limits = {0};
-	struct read_cmd_cb cb_data;
-	struct nl_msg *msg;
 	enum fapi_pon_errorcode ret;
-	uint32_t seq = NL_AUTO_SEQ;
 
 	if (!pon_mode_check(ctx, MODE_ITU_PON))
 		return PON_STATUS_OPERATION_MODE_ERR;
@@ -3638,50 +4087,70 @@ fapi_pon_alloc_counters_get(struct pon_ctx *ctx, uint8_t alloc_index,
 	if (alloc_index > limits.alloc_idx_max)
 		return PON_STATUS_VALUE_RANGE_ERR;
 
-	ret = fapi_pon_nl_msg_prepare_decode(ctx, &msg, &cb_data, &seq,
+	ret = fapi_pon_nl_msg_prepare_decode(ctx, msg, cb_data, seq,
 				      &pon_alloc_counters_get_decode, NULL,
 				      param, PON_MBOX_C_ALLOC_ID_COUNTERS);
 	if (ret != PON_STATUS_OK)
 		return ret;
 
-	ret = nla_put_u8(msg, PON_MBOX_D_ALLOC_IDX, alloc_index);
+	ret = nla_put_u8(*msg, PON_MBOX_D_ALLOC_IDX, alloc_index);
 	if (ret) {
 		PON_DEBUG_ERR("Can't add netlink attribute");
-		nlmsg_free(msg);
+		nlmsg_free(*msg);
 		return PON_STATUS_NL_ERR;
 	}
 
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_alloc_counters_get(struct pon_ctx *ctx, uint8_t alloc_index,
+			    struct pon_alloc_counters *param)
+{
+	struct read_cmd_cb cb_data;
+	struct nl_msg *msg;
+	enum fapi_pon_errorcode ret;
+	uint32_t seq = NL_AUTO_SEQ;
+
+	ret = pon_alloc_counters_msg(ctx, alloc_index, param, &msg, &cb_data,
+				     &seq);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
 	return fapi_pon_nl_msg_send(ctx, &msg, &cb_data, &seq);
 }
 
+enum fapi_pon_errorcode
+fapi_pon_async_alloc_counters_get(struct pon_ctx *ctx, uint8_t alloc_index,
+				  struct pon_alloc_counters *param,
+				  fapi_pon_async_done done, void *done_priv,
+				  uint32_t *handle)
+{
+	struct read_cmd_cb cb_data;
+	struct nl_msg *msg;
+	enum fapi_pon_errorcode ret;
+	uint32_t seq = NL_AUTO_SEQ;
+
+	if (!ctx || !param)
+		return PON_STATUS_INPUT_ERR;
+
+	ret = pon_alloc_counters_msg(ctx, alloc_index, param, &msg, &cb_data,
+				     &seq);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	return fapi_pon_async_nl_msg_send(ctx, &msg, &cb_data, done,
+					  done_priv, handle);
+}
+
 static enum fapi_pon_errorcode
 pon_xgtc_counters_get_decode(struct pon_ctx *ctx,
 			    struct nlattr **attrs,
 			    void *priv)
 {
-	struct pon_xgtc_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_XGTC_MAX + 1];
-
-	memset(dst_param, 0, sizeof(*dst_param));
-
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
-
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_XGTC_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_xgtc_policy) < 0)
-		return PON_STATUS_ERR;
-
-	CNT_DECODE_U64(XGTC_FS_HEC_ERR_CORR, fs_hec_err_corr);
-	CNT_DECODE_U64(XGTC_FS_HEC_ERR_UNCORR, fs_hec_err_uncorr);
-	CNT_DECODE_U64(XGTC_LOST_WORDS, lost_words);
-	CNT_DECODE_U64(XGTC_PLOAM_MIC_ERR, ploam_mic_err);
-	CNT_DECODE_U64(XGTC_PSBD_HEC_ERR_CORR, psbd_hec_err_corr);
-	CNT_DECODE_U64(XGTC_PSBD_HEC_ERR_UNCORR,  psbd_hec_err_uncorr);
-
-	return PON_STATUS_OK;
+	return pon_cnt_decode(&pon_cnt_xgtc, attrs, priv);
 }
 
 static enum fapi_pon_errorcode
@@ -3726,71 +4195,35 @@ enum fapi_pon_errorcode
 fapi_pon_ploam_ds_counters_get(struct pon_ctx *ctx,
 			       struct pon_ploam_ds_counters *param)
 {
+	struct pon_cnt_snapshot snap = {0};
+	uint32_t groups = PON_CNT_SNAP_PLOAM_DS;
 	enum fapi_pon_errorcode ret;
-	struct pon_xgtc_counters pon_xgtc_cnt = { 0 };
+
+	if (!ctx || !param)
+		return PON_STATUS_INPUT_ERR;
 
 	if (!pon_mode_check(ctx, MODE_ITU_PON))
 		return PON_STATUS_OPERATION_MODE_ERR;
 
-	/* GPON mode */
-	/* XG-PON/XGS-PON/NG-PON2 mode */
-	ret = pon_tc_ploam_ds_counters_get(ctx, PON_MBOX_D_DSWLCH_ID_CURR,
-			&pon_ploam_ds_counters_get_decode, param);
+	/* The MIC errors are taken from the XGTC counters */
+	if (pon_mode_check(ctx, MODE_XG_PON))
+		groups |= PON_CNT_SNAP_XGTC;
+
+	ret = fapi_pon_cnt_snapshot_get(ctx, groups, &snap);
 	if (ret != PON_STATUS_OK)
 		return ret;
 
-	/* get XGTC */
-	/* XG-PON/XGS-PON/NG-PON2 mode only */
-	if (!pon_mode_check(ctx, MODE_987_XGPON |
-				 MODE_9807_XGSPON |
-				 MODE_989_NGPON2_10G |
-				 MODE_989_NGPON2_2G5))
-		goto EXIT;
-
-	ret = pon_xgtc_counters_get(ctx, PON_MBOX_D_DSWLCH_ID_CURR, &pon_xgtc_cnt);
-	if (ret != PON_STATUS_OK)
-		return ret;
-	param->mic_err = pon_xgtc_cnt.ploam_mic_err;
-	param->all += param->mic_err;
-EXIT:
-	return ret;
-}
+	return fapi_pon_cnt_snapshot_ploam_ds_get(&snap, param);
+}
 
 static enum fapi_pon_errorcode
 pon_gtc_counters_get_decode(struct pon_ctx *ctx,
 			    struct nlattr **attrs,
 			    void *priv)
 {
-	struct pon_gtc_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_GTC_MAX + 1];
-
-	memset(dst_param, 0, sizeof(*dst_param));
-
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
-
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_GTC_MAX, attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_gtc_policy) < 0)
-		return PON_STATUS_ERR;
-
-	CNT_DECODE_U64(GTC_BWMAP_HEC_ERRORS_CORR, bwmap_hec_errors_corr);
-	CNT_DECODE_U64(GTC_BIP_ERRORS, bip_errors);
-	CNT_DECODE_U64(GTC_GEM_HEC_ERRORS_CORR, gem_hec_errors_corr);
-	CNT_DECODE_U64(GTC_GEM_HEC_ERRORS_UNCORR, gem_hec_errors_uncorr);
-	CNT_DECODE_U64(GTC_DISC_GEM_FRAMES, disc_gem_frames);
-	CNT_DECODE_U64(GTC_BYTES_CORR, bytes_corr);
-	CNT_DECODE_U64(GTC_FEC_CODEWORDS_CORR, fec_codewords_corr);
-	CNT_DECODE_U64(GTC_FEC_COREWORDS_UNCORR, fec_codewords_uncorr);
-	CNT_DECODE_U64(GTC_TOTAL_FRAMES, total_frames);
-	CNT_DECODE_U64(GTC_FEC_SEC, fec_sec);
-	CNT_DECODE_U64(GTC_GEM_IDLE, gem_idle);
-	CNT_DECODE_U64(GTC_LODS_EVENTS, lods_events);
-	CNT_DECODE_U64(GTC_DG_TIME, dg_time);
-	CNT_DECODE_U64(GTC_PLOAM_CRC_ERRORS, ploam_crc_errors);
-
-	return PON_STATUS_OK;
+	return pon_cnt_decode(&pon_cnt_gtc, attrs, priv);
 }
 
 static enum fapi_pon_errorcode
@@ -3827,34 +4260,26 @@ enum fapi_pon_errorcode
 	fapi_pon_xgtc_counters_get(struct pon_ctx *ctx,
 				   struct pon_xgtc_counters *param)
 {
+	struct pon_cnt_snapshot snap = {0};
 	enum fapi_pon_errorcode ret;
-	struct pon_gtc_counters gtc_counters = { 0 };
 
-	if (!param)
+	if (!ctx || !param)
 		return PON_STATUS_INPUT_ERR;
 
 	/* XG-PON/XGS-PON/NG-PON2 mode only */
-	if (!pon_mode_check(ctx, MODE_987_XGPON |
-				 MODE_9807_XGSPON |
-				 MODE_989_NGPON2_10G |
-				 MODE_989_NGPON2_2G5))
+	if (!pon_mode_check(ctx, MODE_XG_PON))
 		return PON_STATUS_OPERATION_MODE_ERR;
 
-	ret = pon_xgtc_counters_get(ctx, PON_MBOX_D_DSWLCH_ID_CURR, param);
-	if (ret != PON_STATUS_OK)
-		return ret;
-
 	/* We get xgem_hec_err_corr, xgem_hec_err_uncorr from
 	 * GTC_COUNTERS message
 	 */
-	ret = pon_gtc_counters_get(ctx, PON_MBOX_D_DSWLCH_ID_CURR, &gtc_counters);
+	ret = fapi_pon_cnt_snapshot_get(ctx,
+					PON_CNT_SNAP_XGTC | PON_CNT_SNAP_GTC,
+					&snap);
 	if (ret != PON_STATUS_OK)
 		return ret;
 
-	param->xgem_hec_err_corr = gtc_counters.gem_hec_errors_corr;
-	param->xgem_hec_err_uncorr = gtc_counters.gem_hec_errors_uncorr;
-
-	return PON_STATUS_OK;
+	return fapi_pon_cnt_snapshot_xgtc_get(&snap, param);
 }
 
 enum fapi_pon_errorcode
@@ -3873,57 +4298,24 @@ enum fapi_pon_errorcode
 	fapi_pon_fec_counters_get(struct pon_ctx *ctx,
 				  struct pon_fec_counters *param)
 {
+	struct pon_cnt_snapshot snap = {0};
 	enum fapi_pon_errorcode ret;
-	struct pon_gpon_status gpon_status = {0};
-	struct pon_gtc_counters gtc_counters = {0};
-	uint8_t pon_mode;
 
 	if (!ctx || !param)
 		return PON_STATUS_INPUT_ERR;
 
-	if (!pon_mode_check(ctx, MODE_ITU_PON))
-		return PON_STATUS_OPERATION_MODE_ERR;
-
-	ret = fapi_pon_gpon_status_get(ctx, &gpon_status);
+	ret = fapi_pon_cnt_snapshot_get(ctx, PON_CNT_SNAP_STATUS, &snap);
 	if (ret != PON_STATUS_OK)
 		return ret;
 
-	if (gpon_status.fec_status_ds) {
-		/* The DS FEC codewords are calculated out from the total
-		 * frames. The total frames are counting continuously and
-		 * a value is reported even if the FEC feature is disabled.
-		 */
-		ret = pon_gtc_counters_get(ctx, PON_MBOX_D_DSWLCH_ID_CURR,
-					   &gtc_counters);
-		if (ret != PON_STATUS_OK)
-			return ret;
-
-		param->bytes_corr = gtc_counters.bytes_corr;
-		param->words_corr = gtc_counters.fec_codewords_corr;
-		param->words_uncorr = gtc_counters.fec_codewords_uncorr;
-		param->seconds = gtc_counters.fec_sec;
-
-		ret = fapi_pon_mode_get(ctx, &pon_mode);
+	/* The GTC counters are only needed with enabled DS FEC */
+	if (snap.fec_status_ds) {
+		ret = fapi_pon_cnt_snapshot_get(ctx, PON_CNT_SNAP_GTC, &snap);
 		if (ret != PON_STATUS_OK)
 			return ret;
-		switch (pon_mode) {
-			case PON_MODE_984_GPON:
-				param->words = gtc_counters.total_frames
-						* DS_FRAMES_TO_FEC_WORDS_MODE_984_GPON_2G5;
-				break;
-			case PON_MODE_989_NGPON2_2G5:
-				param->words = gtc_counters.total_frames
-						* DS_FRAMES_TO_FEC_WORDS_MODE_989_NGPON2_2G5;
-				break;
-			default:
-				/* All 10G modes (NG-PON2, XG-PON, XGS-PON) */
-				param->words = gtc_counters.total_frames
-						* DS_FRAMES_TO_FEC_WORDS_MODE_ANY_10G;
-				break;
-		}
 	}
 
-	return PON_STATUS_OK;
+	return fapi_pon_cnt_snapshot_fec_get(&snap, param);
 }
 
 enum fapi_pon_errorcode
@@ -3965,51 +4357,231 @@ enum fapi_pon_errorcode
 	return PON_STATUS_OK;
 }
 
+uint32_t pon_cnt_snapshot_groups(struct pon_ctx *ctx)
+{
+	uint32_t groups;
+
+	if (!pon_mode_check(ctx, MODE_ITU_PON))
+		return 0;
+
+	groups = PON_CNT_SNAP_STATUS | PON_CNT_SNAP_GTC |
+		 PON_CNT_SNAP_PLOAM_DS | PON_CNT_SNAP_PLOAM_US |
+		 PON_CNT_SNAP_GEM_ALL;
+
+	if (pon_mode_check(ctx, MODE_XG_PON))
+		groups |= PON_CNT_SNAP_XGTC;
+
+	if (pon_mode_check(ctx, MODE_987_XGPON | MODE_9807_XGSPON))
+		groups |= PON_CNT_SNAP_LODS;
+
+	return groups;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_cnt_snapshot_get(struct pon_ctx *ctx, uint32_t groups,
+			  struct pon_cnt_snapshot *snap)
+{
+	struct pon_gpon_status status = {0};
+	enum fapi_pon_errorcode ret;
+	uint8_t pon_mode;
+
+	if (!ctx || !snap)
+		return PON_STATUS_INPUT_ERR;
+
+	if (groups & ~pon_cnt_snapshot_groups(ctx))
+		return PON_STATUS_OPERATION_MODE_ERR;
+
+	if (!snap->valid) {
+		ret = fapi_pon_mode_get(ctx, &pon_mode);
+		if (ret != PON_STATUS_OK)
+			return ret;
+		snap->pon_mode = pon_mode;
+		snap->time = pon_time_us();
+	}
+
+	if (groups & PON_CNT_SNAP_STATUS) {
+		ret = fapi_pon_generic_get(ctx,
+					   PONFW_ONU_STATUS_CMD_ID,
+					   NULL,
+					   0,
+					   &pon_status_get_copy_xgtc,
+					   &status);
+		if (ret != PON_STATUS_OK)
+			return ret;
+		snap->fec_status_ds = (uint8_t)status.fec_status_ds;
+		snap->valid |= PON_CNT_SNAP_STATUS;
+	}
+
+	if (groups & PON_CNT_SNAP_GTC) {
+		ret = pon_gtc_counters_get(ctx, PON_MBOX_D_DSWLCH_ID_CURR,
+					   &snap->gtc);
+		if (ret != PON_STATUS_OK)
+			return ret;
+		snap->valid |= PON_CNT_SNAP_GTC;
+	}
+
+	if (groups & PON_CNT_SNAP_XGTC) {
+		ret = pon_xgtc_counters_get(ctx, PON_MBOX_D_DSWLCH_ID_CURR,
+					    &snap->xgtc);
+		if (ret != PON_STATUS_OK)
+			return ret;
+		snap->valid |= PON_CNT_SNAP_XGTC;
+	}
+
+	if (groups & PON_CNT_SNAP_PLOAM_DS) {
+		ret = pon_tc_ploam_ds_counters_get(ctx,
+					PON_MBOX_D_DSWLCH_ID_CURR,
+					&pon_ploam_ds_counters_get_decode,
+					&snap->ploam_ds);
+		if (ret != PON_STATUS_OK)
+			return ret;
+		snap->valid |= PON_CNT_SNAP_PLOAM_DS;
+	}
+
+	if (groups & PON_CNT_SNAP_PLOAM_US) {
+		ret = fapi_pon_ploam_us_counters_get(ctx, &snap->ploam_us);
+		if (ret != PON_STATUS_OK)
+			return ret;
+		snap->valid |= PON_CNT_SNAP_PLOAM_US;
+	}
+
+	if (groups & PON_CNT_SNAP_GEM_ALL) {
+		ret = fapi_pon_gem_all_counters_get(ctx, &snap->gem_all);
+		if (ret != PON_STATUS_OK)
+			return ret;
+		snap->valid |= PON_CNT_SNAP_GEM_ALL;
+	}
+
+	if (groups & PON_CNT_SNAP_LODS) {
+		ret = fapi_pon_xgspon_lods_counters_get(ctx, &snap->lods);
+		if (ret != PON_STATUS_OK)
+			return ret;
+		snap->valid |= PON_CNT_SNAP_LODS;
+	}
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_cnt_snapshot_fec_get(const struct pon_cnt_snapshot *snap,
+			      struct pon_fec_counters *param)
+{
+	if (!snap || !param || !(snap->valid & PON_CNT_SNAP_STATUS))
+		return PON_STATUS_INPUT_ERR;
+
+	memset(param, 0, sizeof(*param));
+
+	if (!snap->fec_status_ds)
+		return PON_STATUS_OK;
+
+	if (!(snap->valid & PON_CNT_SNAP_GTC))
+		return PON_STATUS_INPUT_ERR;
+
+	param->bytes_corr = snap->gtc.bytes_corr;
+	param->words_corr = snap->gtc.fec_codewords_corr;
+	param->words_uncorr = snap->gtc.fec_codewords_uncorr;
+	param->seconds = snap->gtc.fec_sec;
+
+	/* The DS FEC codewords are calculated out from the total frames.
+	 * The total frames are counting continuously and a value is
+	 * reported even if the FEC feature is disabled.
+	 */
+	switch (snap->pon_mode) {
+	case PON_MODE_984_GPON:
+		param->words = snap->gtc.total_frames *
+			       DS_FRAMES_TO_FEC_WORDS_MODE_984_GPON_2G5;
+		break;
+	case PON_MODE_989_NGPON2_2G5:
+		param->words = snap->gtc.total_frames *
+			       DS_FRAMES_TO_FEC_WORDS_MODE_989_NGPON2_2G5;
+		break;
+	default:
+		/* All 10G modes (NG-PON2, XG-PON, XGS-PON) */
+		param->words = snap->gtc.total_frames *
+			       DS_FRAMES_TO_FEC_WORDS_MODE_ANY_10G;
+		break;
+	}
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_cnt_snapshot_xgtc_get(const struct pon_cnt_snapshot *snap,
+			       struct pon_xgtc_counters *param)
+{
+	uint32_t groups = PON_CNT_SNAP_XGTC | PON_CNT_SNAP_GTC;
+
+	if (!snap || !param || (snap->valid & groups) != groups)
+		return PON_STATUS_INPUT_ERR;
+
+	*param = snap->xgtc;
+	param->xgem_hec_err_corr = snap->gtc.gem_hec_errors_corr;
+	param->xgem_hec_err_uncorr = snap->gtc.gem_hec_errors_uncorr;
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_cnt_snapshot_ploam_ds_get(const struct pon_cnt_snapshot *snap,
+				   struct pon_ploam_ds_counters *param)
+{
+	if (!snap || !param || !(snap->valid & PON_CNT_SNAP_PLOAM_DS))
+		return PON_STATUS_INPUT_ERR;
+
+	*param = snap->ploam_ds;
+
+	/* GPON mode has no PLOAM MIC */
+	if (snap->pon_mode == PON_MODE_984_GPON)
+		return PON_STATUS_OK;
+
+	if (!(snap->valid & PON_CNT_SNAP_XGTC))
+		return PON_STATUS_INPUT_ERR;
+
+	param->mic_err = snap->xgtc.ploam_mic_err;
+	param->all += param->mic_err;
+
+	return PON_STATUS_OK;
+}
+
 static enum fapi_pon_errorcode
 pon_gem_port_counters_get_decode(struct pon_ctx *ctx,
 				 struct nlattr **attrs,
 				 void *priv)
 {
-	struct pon_gem_port_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_GEM_PORT_MAX + 1];
-
-	if (memset_s(dst_param, sizeof(*dst_param), 0, sizeof(*dst_param))) {
-		PON_DEBUG_ERR("memset_s failed");
-		return PON_STATUS_MEMCPY_ERR;
-	}
-
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
+	return pon_cnt_decode(&pon_cnt_gem_port, attrs, priv);
+}
 
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_GEM_PORT_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_gem_port_policy) < 0)
-		return PON_STATUS_ERR;
+/* Decoder of the async read, which keeps the GEM port ID set by the caller */
+static enum fapi_pon_errorcode
+pon_gem_port_counters_async_decode(struct pon_ctx *ctx,
+				   struct nlattr **attrs,
+				   void *priv)
+{
+	struct pon_gem_port_counters *param = priv;
+	uint16_t gem_port_id = param->gem_port_id;
+	enum fapi_pon_errorcode ret;
 
-	CNT_DECODE_U64(GEM_PORT_TX_FRAMES, tx_frames);
-	CNT_DECODE_U64(GEM_PORT_TX_FRAGMENTS, tx_fragments);
-	CNT_DECODE_U64(GEM_PORT_TX_BYTES, tx_bytes);
-	CNT_DECODE_U64(GEM_PORT_RX_FRAMES, rx_frames);
-	CNT_DECODE_U64(GEM_PORT_RX_FRAGMENTS, rx_fragments);
-	CNT_DECODE_U64(GEM_PORT_RX_BYTES, rx_bytes);
-	CNT_DECODE_U64(GEM_PORT_KEY_ERRORS, key_errors);
+	ret = pon_gem_port_counters_get_decode(ctx, attrs, priv);
+	param->gem_port_id = gem_port_id;
 
-	return PON_STATUS_OK;
+	return ret;
 }
 
+/* Prepare the GEM port counter read, shared by the sync and async API */
 static enum fapi_pon_errorcode
-pon_gem_port_counters_get(struct pon_ctx *ctx,
+pon_gem_port_counters_msg(struct pon_ctx *ctx,
 			  const uint8_t dswlch_id,
 			  uint16_t gem_port_id,
-			  struct pon_gem_port_counters *param)
+			  fapi_pon_decode decode,
+			  struct pon_gem_port_counters *param,
+			  struct nl_msg **msg,
+			  struct read_cmd_cb *cb_data,
+			  uint32_t *seq)
 {
 	struct pon_gem_port gem_port;
 	struct pon_range_limits limits = {0};
-	struct read_cmd_cb cb_data;
-	struct nl_msg *msg;
-	uint32_t seq = NL_AUTO_SEQ;
 	enum fapi_pon_errorcode ret;
 
 	ret = fapi_pon_limits_get(ctx, &limits);
@@ -4020,32 +4592,52 @@ pon_gem_port_counters_get(struct pon_ctx *ctx,
 		return PON_STATUS_VALUE_RANGE_ERR;
 
 	/* This is only done to get the GEM port index for the GEM ID. */
-	ret = fapi_pon_gem_port_id_get(ctx, gem_port_id, &gem_port);
+	ret = pon_gem_port_cached_get(ctx, gem_port_id, &gem_port);
 	if (ret != PON_STATUS_OK)
 		return ret;
 
-	ret = fapi_pon_nl_msg_prepare_decode(ctx, &msg, &cb_data, &seq,
-					     &pon_gem_port_counters_get_decode,
+	ret = fapi_pon_nl_msg_prepare_decode(ctx, msg, cb_data, seq,
+					     decode,
 					     NULL,
 					     param,
 					     PON_MBOX_C_GEM_PORT_COUNTERS);
 	if (ret != PON_STATUS_OK)
 		return ret;
 
-	ret = nla_put_u8(msg, PON_MBOX_D_GEM_IDX, gem_port.gem_port_index);
+	ret = nla_put_u8(*msg, PON_MBOX_D_GEM_IDX, gem_port.gem_port_index);
 	if (ret) {
 		PON_DEBUG_ERR("Can't add netlink attribute");
-		nlmsg_free(msg);
+		nlmsg_free(*msg);
 		return PON_STATUS_NL_ERR;
 	}
 
-	ret = nla_put_u8(msg, PON_MBOX_D_DSWLCH_ID, dswlch_id);
+	ret = nla_put_u8(*msg, PON_MBOX_D_DSWLCH_ID, dswlch_id);
 	if (ret) {
 		PON_DEBUG_ERR("Can't add netlink attribute DSWLCH_ID");
-		nlmsg_free(msg);
+		nlmsg_free(*msg);
 		return PON_STATUS_NL_ERR;
 	}
 
+	return PON_STATUS_OK;
+}
+
+static enum fapi_pon_errorcode
+pon_gem_port_counters_get(struct pon_ctx *ctx,
+			  const uint8_t dswlch_id,
+			  uint16_t gem_port_id,
+			  struct pon_gem_port_counters *param)
+{
+	struct read_cmd_cb cb_data;
+	struct nl_msg *msg;
+	uint32_t seq = NL_AUTO_SEQ;
+	enum fapi_pon_errorcode ret;
+
+	ret = pon_gem_port_counters_msg(ctx, dswlch_id, gem_port_id,
+					&pon_gem_port_counters_get_decode,
+					param, &msg, &cb_data, &seq);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
 	ret = fapi_pon_nl_msg_send(ctx, &msg, &cb_data, &seq);
 
 	/* Set the GEM port id in the result as we do not get it back.
@@ -4070,36 +4662,74 @@ fapi_pon_gem_port_counters_get(struct pon_ctx *ctx,
 		PON_MBOX_D_DSWLCH_ID_CURR, gem_port_id, param);
 }
 
+enum fapi_pon_errorcode
+fapi_pon_async_gem_port_counters_get(struct pon_ctx *ctx,
+				     uint16_t gem_port_id,
+				     struct pon_gem_port_counters *param,
+				     fapi_pon_async_done done,
+				     void *done_priv,
+				     uint32_t *handle)
+{
+	struct read_cmd_cb cb_data;
+	struct nl_msg *msg;
+	uint32_t seq = NL_AUTO_SEQ;
+	enum fapi_pon_errorcode ret;
+
+	if (!ctx || !param)
+		return PON_STATUS_INPUT_ERR;
+
+	if (!pon_mode_check(ctx, MODE_ITU_PON))
+		return PON_STATUS_OPERATION_MODE_ERR;
+
+	/* Set the GEM port id in the result as we do not get it back. */
+	param->gem_port_id = gem_port_id;
+
+	ret = pon_gem_port_counters_msg(ctx, PON_MBOX_D_DSWLCH_ID_CURR,
+					gem_port_id,
+					&pon_gem_port_counters_async_decode,
+					param, &msg, &cb_data, &seq);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	return fapi_pon_async_nl_msg_send(ctx, &msg, &cb_data, done,
+					  done_priv, handle);
+}
+
 static enum fapi_pon_errorcode
 pon_gem_all_counters_get_decode(struct pon_ctx *ctx,
 				struct nlattr **attrs,
 				void *priv)
 {
-	struct pon_gem_port_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_GEM_PORT_MAX + 1];
-
-	if (memset_s(dst_param, sizeof(*dst_param), 0, sizeof(*dst_param))) {
-		PON_DEBUG_ERR("memset_s failed");
-		return PON_STATUS_MEMCPY_ERR;
-	}
-
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
+	return pon_cnt_decode(&pon_cnt_gem_port, attrs, priv);
+}
 
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_GEM_PORT_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_gem_port_policy) < 0)
-		return PON_STATUS_ERR;
+/* Prepare the summed GEM port counter read */
+static enum fapi_pon_errorcode
+pon_gem_all_counters_msg(struct pon_ctx *ctx,
+			 const uint8_t dswlch_id,
+			 struct pon_gem_port_counters *param,
+			 struct nl_msg **msg,
+			 struct read_cmd_cb *cb_data,
+			 uint32_t *seq)
+{
+	enum fapi_pon_errorcode ret;
+
+	ret = fapi_pon_nl_msg_prepare_decode(ctx, msg, cb_data, seq,
+					     &pon_gem_all_counters_get_decode,
+					     NULL,
+					     param,
+					     PON_MBOX_C_GEM_ALL_COUNTERS);
+	if (ret != PON_STATUS_OK)
+		return ret;
 
-	CNT_DECODE_U64(GEM_PORT_TX_FRAMES, tx_frames);
-	CNT_DECODE_U64(GEM_PORT_TX_FRAGMENTS, tx_fragments);
-	CNT_DECODE_U64(GEM_PORT_TX_BYTES, tx_bytes);
-	CNT_DECODE_U64(GEM_PORT_RX_FRAMES, rx_frames);
-	CNT_DECODE_U64(GEM_PORT_RX_FRAGMENTS, rx_fragments);
-	CNT_DECODE_U64(GEM_PORT_RX_BYTES, rx_bytes);
-	CNT_DECODE_U64(GEM_PORT_KEY_ERRORS, key_errors);
+	ret = nla_put_u8(*msg, PON_MBOX_D_DSWLCH_ID, dswlch_id);
+	if (ret) {
+		PON_DEBUG_ERR("Can't add netlink attribute DSWLCH_ID");
+		nlmsg_free(*msg);
+		return PON_STATUS_NL_ERR;
+	}
 
 	return PON_STATUS_OK;
 }
@@ -4114,36 +4744,271 @@ pon_gem_all_counters_get(struct pon_ctx *ctx,
 	uint32_t seq = NL_AUTO_SEQ;
 	enum fapi_pon_errorcode ret;
 
+	ret = pon_gem_all_counters_msg(ctx, dswlch_id, param, &msg, &cb_data,
+				       &seq);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	return fapi_pon_nl_msg_send(ctx, &msg, &cb_data, &seq);
+}
+
+enum fapi_pon_errorcode
+fapi_pon_gem_all_counters_get(struct pon_ctx *ctx,
+			      struct pon_gem_port_counters *param)
+{
+	if (!param)
+		return PON_STATUS_INPUT_ERR;
+
+	if (!pon_mode_check(ctx, MODE_ITU_PON))
+		return PON_STATUS_OPERATION_MODE_ERR;
+
+	return pon_gem_all_counters_get(ctx,
+		PON_MBOX_D_DSWLCH_ID_CURR, param);
+}
+
+enum fapi_pon_errorcode
+fapi_pon_async_gem_all_counters_get(struct pon_ctx *ctx,
+				    struct pon_gem_port_counters *param,
+				    fapi_pon_async_done done,
+				    void *done_priv,
+				    uint32_t *handle)
+{
+	struct read_cmd_cb cb_data;
+	struct nl_msg *msg;
+	uint32_t seq = NL_AUTO_SEQ;
+	enum fapi_pon_errorcode ret;
+
+	if (!ctx || !param)
+		return PON_STATUS_INPUT_ERR;
+
+	if (!pon_mode_check(ctx, MODE_ITU_PON))
+		return PON_STATUS_OPERATION_MODE_ERR;
+
+	ret = pon_gem_all_counters_msg(ctx, PON_MBOX_D_DSWLCH_ID_CURR, param,
+				       &msg, &cb_data, &seq);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	return fapi_pon_async_nl_msg_send(ctx, &msg, &cb_data, done,
+					  done_priv, handle);
+}
+
+/*
+ * Submit the GEM port counter read for one GEM port index, the answer is
+ * decoded into param when it is received.
+ */
+static enum fapi_pon_errorcode
+pon_gem_port_counters_submit(struct pon_ctx *ctx,
+			     struct pon_nl_batch *batch,
+			     const uint8_t dswlch_id,
+			     uint8_t gem_port_index,
+			     struct pon_gem_port_counters *param,
+			     enum fapi_pon_errorcode *result)
+{
+	struct read_cmd_cb cb_data;
+	struct nl_msg *msg;
+	uint32_t seq = NL_AUTO_SEQ;
+	enum fapi_pon_errorcode ret;
+
 	ret = fapi_pon_nl_msg_prepare_decode(ctx, &msg, &cb_data, &seq,
-					     &pon_gem_all_counters_get_decode,
+					     &pon_gem_port_counters_get_decode,
 					     NULL,
 					     param,
-					     PON_MBOX_C_GEM_ALL_COUNTERS);
+					     PON_MBOX_C_GEM_PORT_COUNTERS);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	ret = nla_put_u8(msg, PON_MBOX_D_GEM_IDX, gem_port_index);
+	if (ret) {
+		PON_DEBUG_ERR("Can't add netlink attribute");
+		nlmsg_free(msg);
+		return PON_STATUS_NL_ERR;
+	}
+
+	ret = nla_put_u8(msg, PON_MBOX_D_DSWLCH_ID, dswlch_id);
+	if (ret) {
+		PON_DEBUG_ERR("Can't add netlink attribute DSWLCH_ID");
+		nlmsg_free(msg);
+		return PON_STATUS_NL_ERR;
+	}
+
+	return pon_nl_batch_send(batch, &msg, &cb_data, result);
+}
+
+/*
+ * Resolve the GEM ports to read. If a list of GEM port IDs is given, each ID
+ * is looked up, otherwise all GEM port indexes are scanned for active GEM
+ * ports. All lookups are sent at once and their answers are collected
+ * afterwards.
+ */
+static enum fapi_pon_errorcode
+pon_gem_port_batch_resolve(struct pon_ctx *ctx,
+			   const uint16_t *gem_port_ids,
+			   uint32_t num,
+			   struct pon_gem_port *gem_port,
+			   enum fapi_pon_errorcode *result)
+{
+	struct ponfw_gem_port_idx fw_idx = {0};
+	struct ponfw_gem_port_id fw_id = {0};
+	struct pon_nl_batch *batch;
+	enum fapi_pon_errorcode ret = PON_STATUS_OK;
+	uint32_t i;
+
+	batch = pon_nl_batch_alloc(ctx, num);
+	if (!batch)
+		return PON_STATUS_MEM_ERR;
+
+	for (i = 0; i < num && ret == PON_STATUS_OK; i++) {
+		result[i] = PON_STATUS_ERR;
+		if (gem_port_ids &&
+		    pon_gem_cache_lookup(ctx, gem_port_ids[i], &gem_port[i])) {
+			result[i] = PON_STATUS_OK;
+			continue;
+		}
+		if (gem_port_ids) {
+			fw_id.gem_port_id = gem_port_ids[i];
+			ret = pon_nl_batch_read(batch,
+						PONFW_GEM_PORT_ID_CMD_ID,
+						&fw_id, PONFW_GEM_PORT_ID_LENR,
+						&pon_gem_port_id_get_copy,
+						&gem_port[i], &result[i]);
+		} else {
+			fw_idx.gem_port_idx = i;
+			ret = pon_nl_batch_read(batch,
+						PONFW_GEM_PORT_IDX_CMD_ID,
+						&fw_idx,
+						PONFW_GEM_PORT_IDX_LENR,
+						&pon_gem_port_index_get_copy,
+						&gem_port[i], &result[i]);
+		}
+	}
+
+	pon_nl_batch_finish(batch);
+
+	return ret;
+}
+
+static enum fapi_pon_errorcode
+pon_gem_port_counters_batch_get(struct pon_ctx *ctx,
+				const uint8_t dswlch_id,
+				const uint16_t *gem_port_ids,
+				uint32_t *num,
+				struct pon_gem_port_counters *param)
+{
+	struct pon_range_limits limits = {0};
+	struct pon_gem_port *gem_port;
+	struct pon_nl_batch *batch = NULL;
+	enum fapi_pon_errorcode *result;
+	enum fapi_pon_errorcode ret;
+	uint32_t lookups;
+	uint32_t found = 0;
+	uint32_t gen;
+	uint32_t i;
+
+	ret = fapi_pon_limits_get(ctx, &limits);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	if (gem_port_ids) {
+		lookups = *num;
+		for (i = 0; i < lookups; i++) {
+			if (gem_port_ids[i] > limits.gem_port_id_max)
+				return PON_STATUS_VALUE_RANGE_ERR;
+		}
+	} else {
+		lookups = limits.gem_port_idx_max + 1;
+	}
+
+	if (!lookups) {
+		*num = 0;
+		return PON_STATUS_OK;
+	}
+
+	gem_port = calloc(lookups, sizeof(*gem_port));
+	result = calloc(lookups, sizeof(*result));
+	if (!gem_port || !result) {
+		ret = PON_STATUS_MEM_ERR;
+		goto out;
+	}
+
+	gen = pon_gem_cache_gen_get();
+	ret = pon_gem_port_batch_resolve(ctx, gem_port_ids, lookups, gem_port,
+					 result);
 	if (ret != PON_STATUS_OK)
-		return ret;
+		goto out;
 
-	ret = nla_put_u8(msg, PON_MBOX_D_DSWLCH_ID, dswlch_id);
-	if (ret) {
-		PON_DEBUG_ERR("Can't add netlink attribute DSWLCH_ID");
-		nlmsg_free(msg);
-		return PON_STATUS_NL_ERR;
+	batch = pon_nl_batch_alloc(ctx, lookups);
+	if (!batch) {
+		ret = PON_STATUS_MEM_ERR;
+		goto out;
 	}
 
-	return fapi_pon_nl_msg_send(ctx, &msg, &cb_data, &seq);
+	for (i = 0; i < lookups; i++) {
+		/* A NACK means that the GEM port ID does not exist */
+		if (result[i] == PON_STATUS_FW_NACK)
+			continue;
+		if (result[i] != PON_STATUS_OK) {
+			ret = result[i];
+			goto out;
+		}
+		/* not upstream and not downstream means it is disabled. */
+		if (!gem_port[i].is_downstream && !gem_port[i].is_upstream)
+			continue;
+		/* Only the GEM port ID lookup provides the allocation */
+		if (gem_port_ids)
+			pon_gem_cache_insert(ctx, &gem_port[i], gen);
+		if (found >= *num) {
+			ret = PON_STATUS_MEM_NOT_ENOUGH;
+			goto out;
+		}
+
+		/* Reuse the lookup entry to keep the result of the read */
+		gem_port[found] = gem_port[i];
+		ret = pon_gem_port_counters_submit(ctx, batch, dswlch_id,
+				gem_port[found].gem_port_index,
+				&param[found], &result[found]);
+		if (ret != PON_STATUS_OK)
+			goto out;
+		found++;
+	}
+
+	pon_nl_batch_finish(batch);
+	batch = NULL;
+
+	for (i = 0; i < found; i++) {
+		if (result[i] != PON_STATUS_OK) {
+			ret = result[i];
+			goto out;
+		}
+		/* Set the GEM port id in the result as we do not get it back.
+		 */
+		param[i].gem_port_id = gem_port[i].gem_port_id;
+	}
+
+	*num = found;
+
+out:
+	if (batch)
+		pon_nl_batch_finish(batch);
+	free(result);
+	free(gem_port);
+	return ret;
 }
 
 enum fapi_pon_errorcode
-fapi_pon_gem_all_counters_get(struct pon_ctx *ctx,
-			      struct pon_gem_port_counters *param)
+fapi_pon_gem_port_counters_batch_get(struct pon_ctx *ctx,
+				     const uint16_t *gem_port_ids,
+				     uint32_t *num,
+				     struct pon_gem_port_counters *param)
 {
-	if (!param)
+	if (!num || !param)
 		return PON_STATUS_INPUT_ERR;
 
 	if (!pon_mode_check(ctx, MODE_ITU_PON))
 		return PON_STATUS_OPERATION_MODE_ERR;
 
-	return pon_gem_all_counters_get(ctx,
-		PON_MBOX_D_DSWLCH_ID_CURR, param);
+	return pon_gem_port_counters_batch_get(ctx, PON_MBOX_D_DSWLCH_ID_CURR,
+					       gem_port_ids, num, param);
 }
 
 enum fapi_pon_errorcode
@@ -4369,6 +5234,75 @@ fapi_pon_alarm_status_get(struct pon_ctx *ctx,
 				    param);
 }
 
+static enum fapi_pon_errorcode pon_alarm_active_copy(struct pon_ctx *ctx,
+						     const void *data,
+						     size_t data_size,
+						     void *priv)
+{
+	const union ponfw_msg *fw = data;
+	struct pon_alarm_active *active = priv;
+	unsigned int num = data_size / 4;
+	unsigned int i;
+
+	UNUSED(ctx);
+
+	if (num > ARRAY_SIZE(active->id))
+		num = ARRAY_SIZE(active->id);
+
+	for (i = 0; i < num; i++)
+		active->id[i] = (uint16_t)fw->val[i];
+	active->num = num;
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode pon_alarm_active_read(struct pon_ctx *ctx,
+					      struct pon_alarm_active *active)
+{
+	enum fapi_pon_errorcode ret;
+	uint32_t seq = pon_alarm_level_sync_start();
+
+	active->num = 0;
+
+	ret = fapi_pon_generic_get(ctx,
+				   PONFW_GET_STATIC_ALARM_CMD_ID,
+				   NULL,
+				   0,
+				   &pon_alarm_active_copy,
+				   active);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	pon_alarm_level_sync(active, seq);
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_alarm_snapshot_get(struct pon_ctx *ctx,
+			    struct pon_alarm_snapshot *param,
+			    uint8_t edge_clear)
+{
+	struct pon_alarm_active active;
+	enum fapi_pon_errorcode ret;
+
+	if (!ctx || !param)
+		return PON_STATUS_INPUT_ERR;
+
+	if (pon_mode_check(ctx, MODE_AON))
+		return PON_STATUS_OPERATION_MODE_ERR;
+
+	if (!pon_alarm_level_synced()) {
+		ret = pon_alarm_active_read(ctx, &active);
+		if (ret != PON_STATUS_OK)
+			return ret;
+	}
+
+	pon_alarm_snapshot_read(param, edge_clear != 0);
+
+	return PON_STATUS_OK;
+}
+
 enum fapi_pon_errorcode
 fapi_pon_alarm_status_set(struct pon_ctx *ctx,
 			  uint16_t pon_alarm_id,
@@ -6945,6 +7879,8 @@ pon_debug_gem_port_id_create(struct pon_ctx *ctx, uint32_t id,
 	ASSIGN_AND_OVERFLOW_CHECK(gem_port_id.max_gem_size, max_gem_size);
 	ASSIGN_AND_OVERFLOW_CHECK(gem_port_id.alloc_link_ref, alloc_link_ref);
 
+	pon_gem_cache_invalidate();
+
 	return fapi_pon_generic_set(ctx, PONFW_GEM_PORT_ID_CMD_ID, &gem_port_id,
 				    sizeof(gem_port_id));
 }
@@ -7083,6 +8019,8 @@ pon_debug_alloc_id_all_unlink(struct pon_ctx *ctx)
 	enum fapi_pon_errorcode ret;
 	struct ponfw_alloc_id_unlink alloc_id_unlink = {0};
 
+	pon_gem_cache_invalidate();
+
 	alloc_id_unlink.all = 0;
 	ret = fapi_pon_generic_set(ctx, PONFW_ALLOC_ID_UNLINK_CMD_ID,
 				   &alloc_id_unlink, sizeof(alloc_id_unlink));
@@ -7507,48 +8445,23 @@ pon_eth_counters_get_decode(struct pon_ctx *ctx,
 			    struct nlattr **attrs,
 			    void *priv)
 {
-	struct pon_eth_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_ETH_MAX + 1];
-
 	UNUSED(ctx);
 
-	memset(dst_param, 0, sizeof(*dst_param));
-
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
-
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_ETH_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_eth_policy) < 0)
-		return PON_STATUS_ERR;
-
-	CNT_DECODE_U64(ETH_BYTES, bytes);
-	CNT_DECODE_U64(ETH_FRAMES_LT_64, frames_lt_64);
-	CNT_DECODE_U64(ETH_FRAMES_64, frames_64);
-	CNT_DECODE_U64(ETH_FRAMES_65_127, frames_65_127);
-	CNT_DECODE_U64(ETH_FRAMES_128_255, frames_128_255);
-	CNT_DECODE_U64(ETH_FRAMES_256_511, frames_256_511);
-	CNT_DECODE_U64(ETH_FRAMES_512_1023, frames_512_1023);
-	CNT_DECODE_U64(ETH_FRAMES_1024_1518, frames_1024_1518);
-	CNT_DECODE_U64(ETH_FRAMES_GT_1518, frames_gt_1518);
-	CNT_DECODE_U64(ETH_FRAMES_FCS_ERR, frames_fcs_err);
-	CNT_DECODE_U64(ETH_BYTES_FCS_ERR, bytes_fcs_err);
-	CNT_DECODE_U64(ETH_FRAMES_TOO_LONG, frames_too_long);
-
-	return PON_STATUS_OK;
+	return pon_cnt_decode(&pon_cnt_eth, attrs, priv);
 }
 
+/* Prepare the Ethernet counter read, shared by the sync and async API */
 static enum fapi_pon_errorcode
-fapi_pon_eth_counters_get(struct pon_ctx *ctx,
-			  uint32_t gem_port_id,
-			  struct pon_eth_counters *param,
-			  int nl_cmd)
+pon_eth_counters_msg(struct pon_ctx *ctx,
+		     uint32_t gem_port_id,
+		     struct pon_eth_counters *param,
+		     int nl_cmd,
+		     struct nl_msg **msg,
+		     struct read_cmd_cb *cb_data,
+		     uint32_t *seq)
 {
 	struct pon_gem_port gem_port;
 	struct pon_range_limits limits = {0};
-	struct read_cmd_cb cb_data;
-	struct nl_msg *msg;
-	uint32_t seq = NL_AUTO_SEQ;
 	enum fapi_pon_errorcode ret;
 
 	if (!ctx)
@@ -7565,11 +8478,11 @@ fapi_pon_eth_counters_get(struct pon_ctx *ctx,
 		return PON_STATUS_VALUE_RANGE_ERR;
 
 	/* This is only done to get the GEM port index for the GEM ID. */
-	ret = fapi_pon_gem_port_id_get(ctx, gem_port_id, &gem_port);
+	ret = pon_gem_port_cached_get(ctx, gem_port_id, &gem_port);
 	if (ret != PON_STATUS_OK)
 		return ret;
 
-	ret = fapi_pon_nl_msg_prepare_decode(ctx, &msg, &cb_data, &seq,
+	ret = fapi_pon_nl_msg_prepare_decode(ctx, msg, cb_data, seq,
 					     &pon_eth_counters_get_decode,
 					     NULL,
 					     param,
@@ -7577,17 +8490,62 @@ fapi_pon_eth_counters_get(struct pon_ctx *ctx,
 	if (ret != PON_STATUS_OK)
 		return ret;
 
-	ret = nla_put_u8(msg, PON_MBOX_D_GEM_IDX,
+	ret = nla_put_u8(*msg, PON_MBOX_D_GEM_IDX,
 			 gem_port.gem_port_index);
 	if (ret) {
 		PON_DEBUG_ERR("Can't add netlink attribute");
-		nlmsg_free(msg);
+		nlmsg_free(*msg);
 		return PON_STATUS_NL_ERR;
 	}
 
+	return PON_STATUS_OK;
+}
+
+static enum fapi_pon_errorcode
+fapi_pon_eth_counters_get(struct pon_ctx *ctx,
+			  uint32_t gem_port_id,
+			  struct pon_eth_counters *param,
+			  int nl_cmd)
+{
+	struct read_cmd_cb cb_data;
+	struct nl_msg *msg;
+	uint32_t seq = NL_AUTO_SEQ;
+	enum fapi_pon_errorcode ret;
+
+	ret = pon_eth_counters_msg(ctx, gem_port_id, param, nl_cmd,
+				   &msg, &cb_data, &seq);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
 	return fapi_pon_nl_msg_send(ctx, &msg, &cb_data, &seq);
 }
 
+static enum fapi_pon_errorcode
+pon_async_eth_counters_get(struct pon_ctx *ctx,
+			   uint32_t gem_port_id,
+			   struct pon_eth_counters *param,
+			   int nl_cmd,
+			   fapi_pon_async_done done,
+			   void *done_priv,
+			   uint32_t *handle)
+{
+	struct read_cmd_cb cb_data;
+	struct nl_msg *msg;
+	uint32_t seq = NL_AUTO_SEQ;
+	enum fapi_pon_errorcode ret;
+
+	if (!param)
+		return PON_STATUS_INPUT_ERR;
+
+	ret = pon_eth_counters_msg(ctx, gem_port_id, param, nl_cmd,
+				   &msg, &cb_data, &seq);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	return fapi_pon_async_nl_msg_send(ctx, &msg, &cb_data, done,
+					  done_priv, handle);
+}
+
 enum fapi_pon_errorcode fapi_pon_eth_rx_counters_get(struct pon_ctx *ctx,
 		    uint32_t gem_port_id,
 		    struct pon_eth_counters *param)
@@ -7610,6 +8568,32 @@ enum fapi_pon_errorcode fapi_pon_eth_tx_counters_get(struct pon_ctx *ctx,
 					 PON_MBOX_C_ETH_TX_COUNTERS);
 }
 
+enum fapi_pon_errorcode
+fapi_pon_async_eth_rx_counters_get(struct pon_ctx *ctx,
+				   uint32_t gem_port_id,
+				   struct pon_eth_counters *param,
+				   fapi_pon_async_done done,
+				   void *done_priv,
+				   uint32_t *handle)
+{
+	return pon_async_eth_counters_get(ctx, gem_port_id, param,
+					  PON_MBOX_C_ETH_RX_COUNTERS,
+					  done, done_priv, handle);
+}
+
+enum fapi_pon_errorcode
+fapi_pon_async_eth_tx_counters_get(struct pon_ctx *ctx,
+				   uint32_t gem_port_id,
+				   struct pon_eth_counters *param,
+				   fapi_pon_async_done done,
+				   void *done_priv,
+				   uint32_t *handle)
+{
+	return pon_async_eth_counters_get(ctx, gem_port_id, param,
+					  PON_MBOX_C_ETH_TX_COUNTERS,
+					  done, done_priv, handle);
+}
+
 enum fapi_pon_errorcode
 fapi_pon_pin_config_set(struct pon_ctx *ctx, enum pon_gpio_pin_id pin_id,
 			enum pon_gpio_pin_status status)
@@ -8941,30 +9925,9 @@ pon_twdm_lods_counters_get_decode(struct pon_ctx *ctx,
 				  struct nlattr **attrs,
 				  void *priv)
 {
-	struct pon_twdm_xgtc_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_TWDM_LODS_MAX + 1];
-
-	memset(dst_param, 0, sizeof(*dst_param));
-
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
-
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_TWDM_LODS_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_twdm_lods_policy) < 0)
-		return PON_STATUS_ERR;
-
-	CNT_DECODE_U64(TWDM_LODS_EVENTS_ALL, lods_events_all);
-	CNT_DECODE_U64(TWDM_LODS_RESTORED_OPER, lods_restored_oper);
-	CNT_DECODE_U64(TWDM_LODS_RESTORED_PROT, lods_restored_prot);
-	CNT_DECODE_U64(TWDM_LODS_RESTORED_DISK, lods_restored_disc);
-	CNT_DECODE_U64(TWDM_LODS_REACTIVATION_OPER, lods_reactivation);
-	CNT_DECODE_U64(TWDM_LODS_REACTIVATION_PROT, lods_reactivation_prot);
-	CNT_DECODE_U64(TWDM_LODS_REACTIVATION_DISC, lods_reactivation_disc);
-
-	return PON_STATUS_OK;
+	return pon_cnt_decode(&pon_cnt_twdm_lods, attrs, priv);
 }
 
 enum fapi_pon_errorcode
@@ -9044,26 +10007,9 @@ pon_twdm_optic_pl_counters_get_decode(struct pon_ctx *ctx,
 				      struct nlattr **attrs,
 				      void *priv)
 {
-	struct pon_twdm_optic_pl_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_TWDM_OPTIC_PL_MAX + 1];
-
-	memset(dst_param, 0, sizeof(*dst_param));
-
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
-
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_TWDM_OPTIC_PL_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_twdm_optic_pl_policy) < 0)
-		return PON_STATUS_ERR;
-
-	CNT_DECODE_U64(TWDM_OPTIC_PL_REJECTED, rejected);
-	CNT_DECODE_U64(TWDM_OPTIC_PL_INCOMPLETE, incomplete);
-	CNT_DECODE_U64(TWDM_OPTIC_PL_COMPLETE, complete);
-
-	return PON_STATUS_OK;
+	return pon_cnt_decode(&pon_cnt_twdm_optic_pl, attrs, priv);
 }
 
 enum fapi_pon_errorcode
@@ -9240,37 +10186,267 @@ fapi_pon_twdm_tuning_counters_get(struct pon_ctx *ctx,
 	return fapi_pon_nl_msg_send(ctx, &msg, &cb_data, &seq);
 }
 
+/* Number of requests sent for each channel by the TWDM counter sweep */
+#define PON_TWDM_SWEEP_REQ 7
+
+/* Counters read for one channel which are merged after all answers arrived */
+struct pon_twdm_sweep_chan {
+	struct pon_xgtc_counters xgtc;
+	struct pon_gtc_counters gtc;
+	enum fapi_pon_errorcode result[PON_TWDM_SWEEP_REQ];
+};
+
+/*
+ * The LODS counter answer carries the XGTC LODS counters as well as the
+ * optic power leveling counters, decode both from one answer.
+ */
 static enum fapi_pon_errorcode
-pon_xgspon_lods_counters_get_decode(struct pon_ctx *ctx,
-				    struct nlattr **attrs,
-				    void *priv)
+pon_twdm_sweep_lods_decode(struct pon_ctx *ctx,
+			   struct nlattr **attrs,
+			   void *priv)
 {
-	struct pon_xgspon_lods_counters *dst_param = priv;
-	struct nlattr *cnt[PON_MBOX_A_CNT_TWDM_LODS_MAX + 1];
-
-	memset(dst_param, 0, sizeof(*dst_param));
+	struct pon_twdm_channel_counters *dst_param = priv;
+	enum fapi_pon_errorcode ret;
 
 	UNUSED(ctx);
 
-	if (!attrs[PON_MBOX_A_CNT])
-		return PON_STATUS_ERR;
+	ret = pon_cnt_decode(&pon_cnt_twdm_lods, attrs, &dst_param->xgtc);
+	if (ret != PON_STATUS_OK)
+		return ret;
 
-	if (nla_parse_nested(cnt, PON_MBOX_A_CNT_TWDM_LODS_MAX,
-			     attrs[PON_MBOX_A_CNT],
-			     pon_mbox_cnt_twdm_lods_policy) < 0)
-		return PON_STATUS_ERR;
+	return pon_cnt_decode(&pon_cnt_twdm_optic_pl, attrs,
+			      &dst_param->optic_pl);
+}
+
+/* Submit one counter read of a channel to the sweep batch */
+static enum fapi_pon_errorcode
+pon_twdm_sweep_submit(struct pon_ctx *ctx,
+		      struct pon_nl_batch *batch,
+		      uint8_t msg_type,
+		      const uint8_t dswlch_id,
+		      fapi_pon_decode decode,
+		      void *param,
+		      enum fapi_pon_errorcode *result)
+{
+	struct read_cmd_cb cb_data;
+	struct nl_msg *msg;
+	uint32_t seq = NL_AUTO_SEQ;
+	enum fapi_pon_errorcode ret;
+
+	ret = fapi_pon_nl_msg_prepare_decode(ctx, &msg, &cb_data, &seq,
+					     decode, NULL, param, msg_type);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	ret = nla_put_u8(msg, PON_MBOX_D_DSWLCH_ID, dswlch_id);
+	if (ret) {
+		PON_DEBUG_ERR("Can't add netlink attribute DSWLCH_ID");
+		nlmsg_free(msg);
+		return PON_STATUS_NL_ERR;
+	}
+
+	return pon_nl_batch_send(batch, &msg, &cb_data, result);
+}
+
+/*
+ * Collect the downstream wavelength channels of all channel profiles which
+ * have a valid downstream part. All profiles are requested at once, a
+ * profile which can not be read is skipped.
+ */
+static enum fapi_pon_errorcode
+pon_twdm_sweep_channels_get(struct pon_ctx *ctx,
+			    uint8_t *dswlch_ids,
+			    uint32_t *num)
+{
+	struct pon_twdm_channel_profile profile[PON_TWDM_DSWLCH_MAX];
+	enum fapi_pon_errorcode result[PON_TWDM_DSWLCH_MAX];
+	struct ponfw_twdm_channel_profile fw_param = {0};
+	struct pon_nl_batch *batch;
+	enum fapi_pon_errorcode ret = PON_STATUS_OK;
+	uint32_t i, j, found = 0;
+
+	batch = pon_nl_batch_alloc(ctx, PON_TWDM_DSWLCH_MAX);
+	if (!batch)
+		return PON_STATUS_MEM_ERR;
+
+	for (i = 0; i < PON_TWDM_DSWLCH_MAX; i++) {
+		fw_param.cp_id = i;
+		ret = pon_nl_batch_read(batch,
+					PONFW_TWDM_CHANNEL_PROFILE_CMD_ID,
+					&fw_param,
+					PONFW_TWDM_CHANNEL_PROFILE_LENR,
+					&fapi_pon_twdm_ch_pro_sts_get_copy,
+					&profile[i], &result[i]);
+		if (ret != PON_STATUS_OK)
+			break;
+	}
+
+	pon_nl_batch_finish(batch);
+	if (ret != PON_STATUS_OK)
+		return ret;
+
+	for (i = 0; i < PON_TWDM_DSWLCH_MAX; i++) {
+		if (result[i] != PON_STATUS_OK || !profile[i].ds_valid)
+			continue;
+		/* Several profiles can describe the same channel */
+		for (j = 0; j < found; j++) {
+			if (dswlch_ids[j] == profile[i].dswlch_id)
+				break;
+		}
+		if (j == found)
+			dswlch_ids[found++] = profile[i].dswlch_id;
+	}
 
-	CNT_DECODE_U64(TWDM_LODS_EVENTS_ALL, lods_events_all);
-	CNT_DECODE_U64(TWDM_LODS_RESTORED_OPER, lods_restored_oper);
-	CNT_DECODE_U64(TWDM_LODS_RESTORED_PROT, lods_restored_prot);
-	CNT_DECODE_U64(TWDM_LODS_RESTORED_DISK, lods_restored_disc);
-	CNT_DECODE_U64(TWDM_LODS_REACTIVATION_OPER, lods_reactivation);
-	CNT_DECODE_U64(TWDM_LODS_REACTIVATION_PROT, lods_reactivation_prot);
-	CNT_DECODE_U64(TWDM_LODS_REACTIVATION_DISC, lods_reactivation_disc);
+	*num = found;
 
 	return PON_STATUS_OK;
 }
 
+enum fapi_pon_errorcode
+fapi_pon_twdm_counters_sweep(struct pon_ctx *ctx,
+			     const uint8_t *dswlch_ids,
+			     uint32_t *num,
+			     struct pon_twdm_channel_counters *param)
+{
+	uint8_t active[PON_TWDM_DSWLCH_MAX];
+	struct pon_twdm_channel_counters *dst;
+	struct pon_twdm_sweep_chan *chan, *src;
+	struct pon_nl_batch *batch;
+	enum fapi_pon_errorcode ret = PON_STATUS_OK;
+	uint32_t i, j, count, words_per_frame;
+
+	if (!ctx || !num || !param)
+		return PON_STATUS_INPUT_ERR;
+
+	/* NG-PON2 mode only */
+	if (!pon_mode_check(ctx, MODE_989_NGPON2_10G |
+				 MODE_989_NGPON2_2G5))
+		return PON_STATUS_OPERATION_MODE_ERR;
+
+	if (pon_mode_check(ctx, MODE_989_NGPON2_2G5))
+		words_per_frame = DS_FRAMES_TO_BIP32_WORDS_MODE_NGPON2_2G5;
+	else
+		words_per_frame = DS_FRAMES_TO_BIP32_WORDS_MODE_NGPON2_10G;
+
+	count = *num;
+	if (!dswlch_ids) {
+		ret = pon_twdm_sweep_channels_get(ctx, active, &count);
+		if (ret != PON_STATUS_OK)
+			return ret;
+		if (count > *num)
+			return PON_STATUS_MEM_NOT_ENOUGH;
+		dswlch_ids = active;
+	}
+
+	if (!count) {
+		*num = 0;
+		return PON_STATUS_OK;
+	}
+
+	chan = calloc(count, sizeof(*chan));
+	if (!chan)
+		return PON_STATUS_MEM_ERR;
+
+	batch = pon_nl_batch_alloc(ctx, count * PON_TWDM_SWEEP_REQ);
+	if (!batch) {
+		free(chan);
+		return PON_STATUS_MEM_ERR;
+	}
+
+	/* Send the requests of all channels before any answer is waited for */
+	for (i = 0; i < count && ret == PON_STATUS_OK; i++) {
+		dst = &param[i];
+		src = &chan[i];
+		memset(dst, 0, sizeof(*dst));
+		dst->dswlch_id = dswlch_ids[i];
+
+		ret = pon_twdm_sweep_submit(ctx, batch,
+				PON_MBOX_C_TWDM_LODS_COUNTERS, dst->dswlch_id,
+				&pon_twdm_sweep_lods_decode, dst,
+				&src->result[0]);
+		if (ret == PON_STATUS_OK)
+			ret = pon_twdm_sweep_submit(ctx, batch,
+				PON_MBOX_C_XGTC_COUNTERS, dst->dswlch_id,
+				&pon_xgtc_counters_get_decode, &src->xgtc,
+				&src->result[1]);
+		if (ret == PON_STATUS_OK)
+			ret = pon_twdm_sweep_submit(ctx, batch,
+				PON_MBOX_C_GTC_COUNTERS, dst->dswlch_id,
+				&pon_gtc_counters_get_decode, &src->gtc,
+				&src->result[2]);
+		if (ret == PON_STATUS_OK)
+			ret = pon_twdm_sweep_submit(ctx, batch,
+				PON_MBOX_C_TC_PLOAM_DS_COUNTERS, dst->dswlch_id,
+				&pon_twdm_ploam_ds_counters_get_decode,
+				&dst->ploam_ds, &src->result[3]);
+		if (ret == PON_STATUS_OK)
+			ret = pon_twdm_sweep_submit(ctx, batch,
+				PON_MBOX_C_TC_PLOAM_US_COUNTERS, dst->dswlch_id,
+				&pon_twdm_ploam_us_counters_get_decode,
+				&dst->ploam_us, &src->result[4]);
+		if (ret == PON_STATUS_OK)
+			ret = pon_twdm_sweep_submit(ctx, batch,
+				PON_MBOX_C_TWDM_TC_COUNTERS, dst->dswlch_id,
+				&pon_twdm_tc_counters_get_decode,
+				&dst->tuning, &src->result[5]);
+		if (ret == PON_STATUS_OK)
+			ret = pon_twdm_sweep_submit(ctx, batch,
+				PON_MBOX_C_GEM_ALL_COUNTERS, dst->dswlch_id,
+				&pon_gem_all_counters_get_decode,
+				&dst->xgem, &src->result[6]);
+	}
+
+	pon_nl_batch_finish(batch);
+	if (ret != PON_STATUS_OK)
+		goto out;
+
+	for (i = 0; i < count; i++) {
+		dst = &param[i];
+		src = &chan[i];
+		for (j = 0; j < PON_TWDM_SWEEP_REQ; j++) {
+			if (src->result[j] != PON_STATUS_OK)
+				break;
+		}
+		if (j < PON_TWDM_SWEEP_REQ) {
+			dst->result = src->result[j];
+			continue;
+		}
+
+		/* Merge the counters the same way as the per channel reads */
+		dst->xgtc.psbd_hec_err_uncorr = src->xgtc.psbd_hec_err_uncorr;
+		dst->xgtc.psbd_hec_err_corr = src->xgtc.psbd_hec_err_corr;
+		dst->xgtc.fs_hec_err_uncorr = src->xgtc.fs_hec_err_uncorr;
+		dst->xgtc.fs_hec_err_corr = src->xgtc.fs_hec_err_corr;
+		dst->xgtc.lost_words = src->xgtc.lost_words;
+		dst->xgtc.ploam_mic_err = src->xgtc.ploam_mic_err;
+		dst->xgtc.burst_profile_err = src->xgtc.burst_profile_err;
+		dst->xgtc.xgem_hec_err_corr = src->gtc.gem_hec_errors_corr;
+		dst->xgtc.xgem_hec_err_uncorr = src->gtc.gem_hec_errors_uncorr;
+		dst->xgtc.bip_errors = src->gtc.bip_errors;
+		dst->xgtc.words = src->gtc.total_frames * words_per_frame;
+
+		dst->ploam_ds.mic_err = src->xgtc.ploam_mic_err;
+		dst->ploam_ds.all += dst->ploam_ds.mic_err;
+		dst->result = PON_STATUS_OK;
+	}
+
+	*num = count;
+
+out:
+	free(chan);
+	return ret;
+}
+
+static enum fapi_pon_errorcode
+pon_xgspon_lods_counters_get_decode(struct pon_ctx *ctx,
+				    struct nlattr **attrs,
+				    void *priv)
+{
+	UNUSED(ctx);
+
+	return pon_cnt_decode(&pon_cnt_xgspon_lods, attrs, priv);
+}
+
 enum fapi_pon_errorcode
 fapi_pon_xgspon_lods_counters_get(struct pon_ctx *ctx,
 				  struct pon_xgspon_lods_counters *param)
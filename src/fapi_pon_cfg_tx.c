@@ -0,0 +1,431 @@
+/******************************************************************************
+ *
+ *  Copyright (c) 2025 MaxLinear, Inc.
+ *
+ * For licensing information, see the file 'LICENSE' in the root folder of
+ * this software module.
+ *
+ *****************************************************************************/
+
+/*
+ * Configuration transactions. The firmware write requests of the thread
+ * owning the transaction are recorded and sent in one pipelined batch when
+ * the transaction is committed, or earlier when a request has to see the
+ * recorded configuration applied.
+ *
+ * The payload of each command written by the last committed transaction is
+ * kept in a process wide snapshot. A recorded request is skipped if the
+ * snapshot holds the same payload for its command. Commands which are
+ * written more than once by a transaction are not kept in the snapshot, as
+ * their messages can configure different instances. The snapshot is dropped
+ * whenever the firmware lost its configuration.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "pon_config.h"
+#endif
+
+#include <pthread.h>
+
+#include "pon_ip_msg.h"
+#include "fapi_pon.h"
+#include "fapi_pon_os.h"
+#include "fapi_pon_core.h"
+#include "fapi_pon_error.h"
+#include "fapi_pon_debug.h"
+
+/* Maximum payload size of a recorded request */
+#define PON_CFG_MSG_MAX sizeof(union ponfw_msg)
+/* Maximum number of commands held by the snapshot */
+#define PON_CFG_SNAP_MAX 32
+/* Initial number of recorded requests */
+#define PON_CFG_TX_MSGS 16
+
+/* States of a recorded request */
+enum pon_cfg_msg_state {
+	/** The request was not sent yet */
+	PON_CFG_MSG_PENDING = 0,
+	/** The firmware already holds this configuration */
+	PON_CFG_MSG_SKIPPED = 1,
+	/** The request was sent */
+	PON_CFG_MSG_SENT = 2
+};
+
+/* Recorded firmware write request */
+struct pon_cfg_msg {
+	/** Firmware command ID */
+	uint16_t command;
+	/** Payload size in bytes */
+	uint16_t len;
+	/** Set if the command was recorded before by the transaction */
+	bool repeat;
+	/** Request state */
+	enum pon_cfg_msg_state state;
+	/** Result of the request once it was sent */
+	enum fapi_pon_errorcode err;
+	/** Request payload */
+	uint8_t data[PON_CFG_MSG_MAX];
+};
+
+struct pon_cfg_tx {
+	/** Set while a transaction is open */
+	bool active;
+	/** Set while the recorded requests are sent */
+	bool flushing;
+	/** Thread which started the transaction */
+	pthread_t owner;
+	/** Snapshot generation at the start of the transaction */
+	uint32_t gen;
+	/** Recorded requests */
+	struct pon_cfg_msg *msg;
+	/** Number of recorded requests */
+	unsigned int num;
+	/** Size of the msg array */
+	unsigned int max;
+	/** Number of requests already sent or skipped */
+	unsigned int done;
+	/** Result of the first failed request */
+	enum fapi_pon_errorcode err;
+	/** Transaction statistics */
+	struct pon_cfg_tx_stats stats;
+};
+
+/* Payload of a command written by the last committed transaction */
+struct pon_cfg_snap_entry {
+	/** Firmware command ID */
+	uint16_t command;
+	/** Payload size in bytes */
+	uint16_t len;
+	/** Request payload */
+	uint8_t data[PON_CFG_MSG_MAX];
+};
+
+static pthread_mutex_t pon_cfg_snap_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct pon_cfg_snap_entry pon_cfg_snap[PON_CFG_SNAP_MAX];
+/* Number of snapshot entries, also read without the lock as hint */
+static volatile uint32_t pon_cfg_snap_num;
+/* Incremented whenever the snapshot is dropped */
+static uint32_t pon_cfg_snap_gen;
+
+/* Must be called with pon_cfg_snap_lock held */
+static struct pon_cfg_snap_entry *pon_cfg_snap_find(uint16_t command)
+{
+	unsigned int i;
+
+	for (i = 0; i < pon_cfg_snap_num; i++)
+		if (pon_cfg_snap[i].command == command)
+			return &pon_cfg_snap[i];
+
+	return NULL;
+}
+
+/* Must be called with pon_cfg_snap_lock held */
+static void pon_cfg_snap_remove(uint16_t command)
+{
+	struct pon_cfg_snap_entry *entry = pon_cfg_snap_find(command);
+	uint32_t num = pon_cfg_snap_num;
+
+	if (!entry)
+		return;
+
+	*entry = pon_cfg_snap[num - 1];
+	pon_atomic_set(&pon_cfg_snap_num, num - 1);
+}
+
+void pon_cfg_snap_invalidate(void)
+{
+	pthread_mutex_lock(&pon_cfg_snap_lock);
+	pon_cfg_snap_gen++;
+	pon_atomic_set(&pon_cfg_snap_num, 0);
+	pthread_mutex_unlock(&pon_cfg_snap_lock);
+}
+
+/* Check if the firmware already holds the configuration of a request */
+static bool pon_cfg_snap_match(uint32_t gen, const struct pon_cfg_msg *msg)
+{
+	struct pon_cfg_snap_entry *entry;
+	bool match = false;
+
+	pthread_mutex_lock(&pon_cfg_snap_lock);
+	if (gen == pon_cfg_snap_gen) {
+		entry = pon_cfg_snap_find(msg->command);
+		match = entry && entry->len == msg->len &&
+			memcmp(entry->data, msg->data, msg->len) == 0;
+	}
+	pthread_mutex_unlock(&pon_cfg_snap_lock);
+
+	return match;
+}
+
+/* Update the snapshot with the requests of a committed transaction */
+static void pon_cfg_snap_store(const struct pon_cfg_tx *tx)
+{
+	const struct pon_cfg_msg *msg, *other;
+	struct pon_cfg_snap_entry *entry;
+	unsigned int i, j;
+	bool keep;
+
+	pthread_mutex_lock(&pon_cfg_snap_lock);
+	/* The firmware might have lost the configuration meanwhile */
+	if (tx->gen != pon_cfg_snap_gen) {
+		pthread_mutex_unlock(&pon_cfg_snap_lock);
+		return;
+	}
+
+	for (i = 0; i < tx->num; i++) {
+		msg = &tx->msg[i];
+		if (msg->repeat)
+			continue;
+
+		keep = msg->state == PON_CFG_MSG_SKIPPED ||
+		       msg->err == PON_STATUS_OK;
+		for (j = i + 1; j < tx->num && keep; j++) {
+			other = &tx->msg[j];
+			if (other->command == msg->command)
+				keep = false;
+		}
+
+		if (!keep) {
+			pon_cfg_snap_remove(msg->command);
+			continue;
+		}
+
+		entry = pon_cfg_snap_find(msg->command);
+		if (!entry) {
+			if (pon_cfg_snap_num >= PON_CFG_SNAP_MAX)
+				continue;
+			entry = &pon_cfg_snap[pon_cfg_snap_num];
+			pon_atomic_set(&pon_cfg_snap_num, pon_cfg_snap_num + 1);
+		}
+		entry->command = msg->command;
+		entry->len = msg->len;
+		memcpy(entry->data, msg->data, msg->len);
+	}
+	pthread_mutex_unlock(&pon_cfg_snap_lock);
+}
+
+/* Send all pending requests of the transaction in one batch */
+static void pon_cfg_tx_flush(struct pon_ctx *ctx, struct pon_cfg_tx *tx)
+{
+	struct pon_set_req *req;
+	struct pon_cfg_msg *msg;
+	unsigned int i, num = 0;
+
+	if (tx->done == tx->num)
+		return;
+
+	req = calloc(tx->num - tx->done, sizeof(*req));
+
+	for (i = tx->done; i < tx->num; i++) {
+		msg = &tx->msg[i];
+		if (!msg->repeat && pon_cfg_snap_match(tx->gen, msg)) {
+			msg->state = PON_CFG_MSG_SKIPPED;
+			tx->stats.skipped++;
+			continue;
+		}
+		if (req) {
+			req[num].command = msg->command;
+			req[num].param = msg->data;
+			req[num].size = msg->len;
+		}
+		num++;
+	}
+
+	if (req && num) {
+		tx->flushing = true;
+		pon_generic_set_batch(ctx, req, num);
+		tx->flushing = false;
+		tx->stats.batches++;
+	}
+
+	for (i = tx->done, num = 0; i < tx->num; i++) {
+		msg = &tx->msg[i];
+		if (msg->state != PON_CFG_MSG_PENDING)
+			continue;
+		msg->state = PON_CFG_MSG_SENT;
+		msg->err = req ? req[num++].err : PON_STATUS_MEM_ERR;
+		tx->stats.sent++;
+		if (msg->err != PON_STATUS_OK && tx->err == PON_STATUS_OK) {
+			tx->err = msg->err;
+			tx->stats.err_command = msg->command;
+		}
+	}
+
+	tx->done = tx->num;
+	free(req);
+}
+
+static bool pon_cfg_tx_record(struct pon_cfg_tx *tx, uint32_t command,
+			      const void *buf, size_t size)
+{
+	struct pon_cfg_msg *msg;
+	unsigned int i, max;
+
+	if (size > PON_CFG_MSG_MAX || (size && !buf))
+		return false;
+
+	if (tx->num == tx->max) {
+		max = tx->max ? tx->max * 2 : PON_CFG_TX_MSGS;
+		msg = realloc(tx->msg, max * sizeof(*msg));
+		if (!msg)
+			return false;
+		tx->msg = msg;
+		tx->max = max;
+	}
+
+	msg = &tx->msg[tx->num];
+	msg->command = (uint16_t)command;
+	msg->len = (uint16_t)size;
+	msg->repeat = false;
+	msg->state = PON_CFG_MSG_PENDING;
+	msg->err = PON_STATUS_OK;
+	if (size)
+		memcpy(msg->data, buf, size);
+
+	for (i = 0; i < tx->num; i++) {
+		if (tx->msg[i].command == msg->command) {
+			msg->repeat = true;
+			break;
+		}
+	}
+
+	tx->num++;
+	tx->stats.msgs++;
+
+	return true;
+}
+
+/* Check if a request for the command is waiting to be sent */
+static bool pon_cfg_tx_pending(const struct pon_cfg_tx *tx, uint32_t command)
+{
+	unsigned int i;
+
+	for (i = tx->done; i < tx->num; i++)
+		if (tx->msg[i].command == command)
+			return true;
+
+	return false;
+}
+
+bool pon_cfg_tx_check(struct pon_ctx *ctx, uint32_t read, uint32_t command,
+		      const void *buf, size_t size, bool recordable)
+{
+	struct pon_cfg_tx *tx = ctx->cfg_tx;
+
+	if (tx && tx->active && pthread_equal(tx->owner, pthread_self())) {
+		/* The batch of the transaction is being sent */
+		if (tx->flushing)
+			return false;
+
+		/* After a failed request the following writes are dropped
+		 * and fail with its error, as in a serial sequence.
+		 */
+		if (read == PONFW_WRITE && recordable &&
+		    (tx->err != PON_STATUS_OK ||
+		     pon_cfg_tx_record(tx, command, buf, size)))
+			return true;
+
+		/* A read has to see the recorded configuration applied,
+		 * other writes keep their order.
+		 */
+		if (read == PONFW_WRITE || pon_cfg_tx_pending(tx, command))
+			pon_cfg_tx_flush(ctx, tx);
+	}
+
+	if (read == PONFW_WRITE && pon_atomic_get(&pon_cfg_snap_num)) {
+		pthread_mutex_lock(&pon_cfg_snap_lock);
+		pon_cfg_snap_remove((uint16_t)command);
+		pthread_mutex_unlock(&pon_cfg_snap_lock);
+	}
+
+	return false;
+}
+
+enum fapi_pon_errorcode pon_cfg_tx_result(struct pon_ctx *ctx)
+{
+	struct pon_cfg_tx *tx = ctx->cfg_tx;
+
+	if (!tx || !tx->active || !pthread_equal(tx->owner, pthread_self()))
+		return PON_STATUS_OK;
+
+	return tx->err;
+}
+
+void pon_cfg_tx_sync(struct pon_ctx *ctx)
+{
+	struct pon_cfg_tx *tx = ctx->cfg_tx;
+
+	if (tx && tx->active && !tx->flushing &&
+	    pthread_equal(tx->owner, pthread_self()))
+		pon_cfg_tx_flush(ctx, tx);
+}
+
+void pon_cfg_tx_free(struct pon_ctx *ctx)
+{
+	struct pon_cfg_tx *tx = ctx->cfg_tx;
+
+	if (!tx)
+		return;
+
+	ctx->cfg_tx = NULL;
+	free(tx->msg);
+	free(tx);
+}
+
+enum fapi_pon_errorcode fapi_pon_cfg_tx_begin(struct pon_ctx *ctx)
+{
+	struct pon_cfg_tx *tx;
+
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	/* The transaction stays allocated, so that other threads of a shared
+	 * context can always check its owner.
+	 */
+	tx = ctx->cfg_tx;
+	if (!tx) {
+		tx = calloc(1, sizeof(*tx));
+		if (!tx)
+			return PON_STATUS_MEM_ERR;
+		ctx->cfg_tx = tx;
+	}
+
+	if (tx->active)
+		return PON_STATUS_ERR;
+
+	tx->owner = pthread_self();
+	tx->num = 0;
+	tx->done = 0;
+	tx->err = PON_STATUS_OK;
+	memset(&tx->stats, 0, sizeof(tx->stats));
+
+	pthread_mutex_lock(&pon_cfg_snap_lock);
+	tx->gen = pon_cfg_snap_gen;
+	pthread_mutex_unlock(&pon_cfg_snap_lock);
+
+	tx->active = true;
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_cfg_tx_commit(struct pon_ctx *ctx,
+					       struct pon_cfg_tx_stats *stats)
+{
+	struct pon_cfg_tx *tx;
+
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	tx = ctx->cfg_tx;
+	if (!tx || !tx->active || !pthread_equal(tx->owner, pthread_self()))
+		return PON_STATUS_ERR;
+
+	pon_cfg_tx_flush(ctx, tx);
+	pon_cfg_snap_store(tx);
+	tx->active = false;
+
+	if (stats)
+		*stats = tx->stats;
+
+	return tx->err;
+}
@@ -11,6 +11,9 @@
 #  include "pon_config.h"
 #endif
 
+#include <pthread.h>
+#include <time.h>
+
 #include "pon_ip_msg.h"
 #include "fapi_pon.h"
 #include "fapi_pon_os.h"
@@ -24,7 +27,7 @@ enum pon_debug_level pon_dbg_lvl = PON_DBG_WRN;
  * NetLink policy, this is used to check if the received data has the correct
  * types.
  */
-static struct nla_policy pon_mbox_genl_policy[PON_MBOX_A_MAX + 1] = {
+struct nla_policy pon_mbox_genl_policy[PON_MBOX_A_MAX + 1] = {
 	[PON_MBOX_A_READ_WRITE] = { .type = NLA_U8 },
 	[PON_MBOX_A_COMMAND] = { .type = NLA_U16 },
 	[PON_MBOX_A_ACK] = { .type = NLA_U8 },
@@ -144,10 +147,14 @@ static int cb_valid_handler(struct nl_msg *msg, void *arg)
 		return NL_STOP;
 	}
 
+	if (attrs[PON_MBOX_A_DATA])
+		cb_data->rx_len = nla_len(attrs[PON_MBOX_A_DATA]);
+
 	ack = nla_get_u8(attrs[PON_MBOX_A_ACK]);
 	if (ack == PONFW_ACK) {
 		cb_data->err = PON_STATUS_OK;
 	} else {
+		cb_data->nack = (ack == PONFW_NACK);
 		if (cb_data->error_cb)
 			cb_data->err = cb_data->error_cb(cb_data->ctx,
 							 ack, cb_data->priv);
@@ -188,448 +195,2057 @@ static int fapi_pon_nl_ow_recv(struct nl_sock *sk, struct sockaddr_nl *nla,
 	return ret;
 }
 
-/*
- * Create and send a message to the mailbox driver which contains a message
- * for the FW. The in_buf is optional if we have a message without a payload
- * set it to NULL. 'flags' attribute allows to distinguish whether called event
- * is fake or not.
- */
-static enum fapi_pon_errorcode
-fapi_pon_send_msg_int(struct nl_sock *nls, int family, uint32_t *seq,
-		      uint32_t read, uint32_t command, uint32_t ack,
-		      const void *in_buf, size_t in_size, uint8_t msg_type,
-		      uint32_t flags)
+/* Set the receive function used for the answers of the context */
+static void pon_recv_ow_set(struct pon_ctx *ctx, struct nl_cb *cb)
 {
-	struct nl_msg *msg;
-	struct nlmsghdr *nlh;
-	void *nl_hdr;
-	int ret;
+	if (ctx->lb)
+		pon_lb_recv_set(cb);
+	else
+		nl_cb_overwrite_recv(cb, fapi_pon_nl_ow_recv);
+}
 
-	msg = nlmsg_alloc();
-	if (!msg) {
-		PON_DEBUG_ERR("Can't alloc netlink message");
-		return PON_STATUS_NL_ERR;
-	}
+/* Request waiting for an answer on a context shared by threads */
+struct pon_mt_req {
+	/** Sequence number of the request */
+	uint32_t seq;
+	/** Callback data used to handle the answer */
+	struct read_cmd_cb *cb_data;
+	/** Set to 1 by the dispatcher once the answer was handled */
+	int done;
+	/** Set to 1 while the dispatcher handles the answer */
+	int busy;
+	/** Time the request was sent in us */
+	uint64_t start;
+	/** Deadline of the calling thread in us, 0 if not set */
+	uint64_t deadline;
+	/** Next request in the list of pending requests */
+	struct pon_mt_req *next;
+};
 
-	nl_hdr = genlmsg_put(msg, 0, *seq, family, 0, 0, msg_type, 0);
-	if (!nl_hdr) {
-		PON_DEBUG_ERR("Can't generate message");
-		nlmsg_free(msg);
-		return PON_STATUS_NL_ERR;
-	}
+/* Request dispatcher of a context shared by threads */
+struct pon_mt {
+	/** Protects all members and the caches of the context */
+	pthread_mutex_t lock;
+	/** Signaled whenever a request was completed or the receiver left */
+	pthread_cond_t cond;
+	/** Pending requests */
+	struct pon_mt_req *req;
+	/** Set to 1 while a thread reads from the socket */
+	int receiving;
+	/** Thread which reads from the socket */
+	pthread_t receiver;
+	/** Callback set used by the receiving thread */
+	struct nl_cb *cb;
+	/** Last used sequence number */
+	volatile uint32_t seq;
+	/** Per thread deadline set by fapi_pon_deadline_set() */
+	pthread_key_t deadline_key;
+};
 
-	ret = nla_put_u8(msg, PON_MBOX_A_READ_WRITE, read ? 1 : 0);
-	if (ret) {
-		PON_DEBUG_ERR("Can't add netlink attribute");
-		nlmsg_free(msg);
-		return PON_STATUS_NL_ERR;
-	}
+/* Return the histogram bucket for a round-trip time */
+static unsigned int pon_lat_bucket(uint64_t us)
+{
+	unsigned int i = 0;
 
-	ret = nla_put_u16(msg, PON_MBOX_A_COMMAND, command);
-	if (ret) {
-		PON_DEBUG_ERR("Can't add netlink attribute");
-		nlmsg_free(msg);
-		return PON_STATUS_NL_ERR;
+	while (us > 1 && i < PON_LAT_BUCKETS - 1) {
+		us >>= 1;
+		i++;
 	}
 
-	ret = nla_put_u8(msg, PON_MBOX_A_ACK, ack);
-	if (ret) {
-		PON_DEBUG_ERR("Can't add netlink attribute");
-		nlmsg_free(msg);
-		return PON_STATUS_NL_ERR;
-	}
+	return i;
+}
 
-	if (flags) {
-		ret = nla_put_u32(msg, PON_MBOX_A_FLAGS, flags);
-		if (ret) {
-			PON_DEBUG_ERR("Can't add netlink attribute");
-			nlmsg_free(msg);
-			return PON_STATUS_NL_ERR;
-		}
-	}
+/*
+ * Record a round-trip time for the adaptive timeout. The history is halved
+ * regularly, so the timeout follows changes of the firmware latency. On a
+ * context shared by threads this has to be called with the context locked.
+ */
+static void pon_lat_record(struct pon_lat_hist *hist, uint64_t us)
+{
+	unsigned int i;
 
-	if (in_buf) {
-		ret = nla_put(msg, PON_MBOX_A_DATA, in_size, in_buf);
-		if (ret) {
-			PON_DEBUG_ERR("Can't add netlink attribute");
-			nlmsg_free(msg);
-			return PON_STATUS_NL_ERR;
-		}
+	hist->bucket[pon_lat_bucket(us)]++;
+	if (++hist->count < PON_LAT_WINDOW)
+		return;
+
+	hist->count = 0;
+	for (i = 0; i < PON_LAT_BUCKETS; i++) {
+		hist->bucket[i] /= 2;
+		hist->count += hist->bucket[i];
 	}
+}
 
-	ret = nl_send_auto_complete(nls, msg);
-	if (ret < 0) {
-		PON_DEBUG_ERR("Can't send netlink message: %i", ret);
-		nlmsg_free(msg);
-		return PON_STATUS_NL_ERR;
+/*
+ * Derive a timeout from the 99th percentile of the measured round-trip
+ * times, with a safety factor of 4.
+ */
+static uint32_t pon_timeout_adaptive(const struct pon_lat_hist *hist)
+{
+	uint32_t count = hist->count;
+	uint32_t limit;
+	uint32_t sum = 0;
+	uint64_t timeout;
+	unsigned int i;
+
+	if (count < PON_LAT_MIN_SAMPLES)
+		return PON_TIMEOUT_DEFAULT;
+
+	limit = count - count / 100;
+	for (i = 0; i < PON_LAT_BUCKETS - 1; i++) {
+		sum += hist->bucket[i];
+		if (sum >= limit)
+			break;
 	}
-	nlh = nlmsg_hdr(msg);
-	if (nlh)
-		*seq = nlh->nlmsg_seq;
 
-	nlmsg_free(msg);
+	/* upper bound of the bucket in ms */
+	timeout = ((2ULL << i) * 4 + 999) / 1000;
+	if (timeout < PON_TIMEOUT_MIN)
+		return PON_TIMEOUT_MIN;
+	if (timeout > PON_TIMEOUT_DEFAULT)
+		return PON_TIMEOUT_DEFAULT;
 
-	return PON_STATUS_OK;
+	return (uint32_t)timeout;
 }
 
-enum fapi_pon_errorcode fapi_pon_open(struct pon_ctx **param)
+/*
+ * Return the request timeout of the context in ms. PON_TIMEOUT_NONBLOCK
+ * only applies to fapi_pon_async_process(), everything else waits for the
+ * default time.
+ */
+static uint32_t pon_timeout_get(struct pon_ctx *ctx)
+{
+	if (ctx->timeout == PON_TIMEOUT_ADAPTIVE)
+		return pon_timeout_adaptive(&ctx->lat);
+
+	if (ctx->timeout == PON_TIMEOUT_NONBLOCK)
+		return PON_TIMEOUT_DEFAULT;
+
+	return ctx->timeout;
+}
+
+/*
+ * Set the receive timeout of the socket. A SO_RCVTIMEO of 0 would block
+ * forever, PON_TIMEOUT_NONBLOCK switches the socket to non-blocking mode
+ * instead.
+ */
+static enum fapi_pon_errorcode pon_sock_timeout_set(struct pon_ctx *ctx,
+						    uint32_t timeout_ms)
 {
-	struct pon_ctx *ctx;
-	int ret;
-	int i;
 #if defined(LINUX) && !defined(PON_LIB_SIMULATOR)
-	int nl_sock;
 	struct timeval timeout = {
-		.tv_sec = 2,
-		.tv_usec = 0,
+		.tv_sec = timeout_ms / 1000,
+		.tv_usec = (timeout_ms % 1000) * 1000,
 	};
-#endif
-
-	if (!param)
-		return PON_STATUS_INPUT_ERR;
-
-	ctx = calloc(1, sizeof(*ctx));
-	if (!ctx)
-		return PON_STATUS_MEM_ERR;
+	bool nonblock = timeout_ms == PON_TIMEOUT_NONBLOCK;
+	int nl_sock;
+	int flags;
+	int ret;
 
-	ctx->nls = nl_socket_alloc();
-	if (!ctx->nls) {
-		PON_DEBUG_ERR("Can't alloc netlink socket");
-		fapi_pon_close(ctx);
-		return PON_STATUS_NL_ERR;
+	/* The loopback backend reads the timeout from the context */
+	if (ctx->lb) {
+		ctx->sock_timeout = timeout_ms;
+		return PON_STATUS_OK;
 	}
 
-	ret = genl_connect(ctx->nls);
-	if (ret) {
-		PON_DEBUG_ERR("Can't connect to netlink socket: %i", ret);
-		fapi_pon_close(ctx);
-		return PON_STATUS_NL_ERR;
-	}
+	nl_sock = nl_socket_get_fd(ctx->nls);
 
-	ctx->family = genl_ctrl_resolve(ctx->nls, PON_MBOX_FAMILY);
-	if (ctx->family < 0) {
-		PON_DEBUG_ERR("No pon mbox netlink interface found: %i",
-				ctx->family);
-		fapi_pon_close(ctx);
-		return PON_STATUS_NL_NAME_ERR;
+	if (nonblock != (ctx->sock_timeout == PON_TIMEOUT_NONBLOCK)) {
+		flags = fcntl(nl_sock, F_GETFL);
+		if (flags < 0) {
+			PON_DEBUG_ERR("fcntl failed with: %i", errno);
+			return PON_STATUS_ERR;
+		}
+		if (nonblock)
+			flags |= O_NONBLOCK;
+		else
+			flags &= ~O_NONBLOCK;
+		ret = fcntl(nl_sock, F_SETFL, flags);
+		if (ret < 0) {
+			PON_DEBUG_ERR("fcntl failed with: %i", errno);
+			return PON_STATUS_ERR;
+		}
 	}
 
-#if defined(LINUX) && !defined(PON_LIB_SIMULATOR)
-	/* We set a socket timeout of 2 seconds here. We assume that the FW can
-	 * answer to all request within 2 seconds. The default nl_recv()
-	 * function just retries the reading in case it ran into a timeout,
-	 * we have to overwrite it in \ref fapi_pon_send_msg.
-	 */
-	nl_sock = nl_socket_get_fd(ctx->nls);
-
-	ret = setsockopt(nl_sock, SOL_SOCKET, SO_RCVTIMEO, &timeout,
-			 sizeof(timeout));
-	if (ret) {
-		PON_DEBUG_ERR("setsockopt failed with: %i", errno);
-		fapi_pon_close(ctx);
-		return PON_STATUS_ERR;
+	if (!nonblock) {
+		ret = setsockopt(nl_sock, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+				 sizeof(timeout));
+		if (ret) {
+			PON_DEBUG_ERR("setsockopt failed with: %i", errno);
+			return PON_STATUS_ERR;
+		}
 	}
 #endif
+	ctx->sock_timeout = timeout_ms;
 
-	for (i = 0; i < PON_DDMI_MAX; i++)
-		ctx->eeprom_fd[i] = -1;
-
-	*param = ctx;
 	return PON_STATUS_OK;
 }
 
-enum fapi_pon_errorcode fapi_pon_close(struct pon_ctx *ctx)
+/* Set the receive timeout of the socket, if it is not already set */
+static enum fapi_pon_errorcode pon_sock_timeout_apply(struct pon_ctx *ctx,
+						      uint32_t timeout_ms)
 {
-	int i;
-
-	for (i = 0; i < PON_DDMI_MAX; i++) {
-		if (ctx->eeprom_fd[i] >= 0)
-			pon_close(ctx->eeprom_fd[i]);
-	}
-
-	nl_socket_free(ctx->nls);
-	nl_socket_free(ctx->nls_event);
-	free(ctx);
+	if (ctx->sock_timeout == timeout_ms)
+		return PON_STATUS_OK;
 
-	return PON_STATUS_OK;
+	return pon_sock_timeout_set(ctx, timeout_ms);
 }
 
-enum fapi_pon_errorcode
-fapi_pon_nl_msg_prepare_decode(struct pon_ctx *ctx,
-			       struct nl_msg **msg,
-			       struct read_cmd_cb *cb_data,
-			       uint32_t *seq,
-			       fapi_pon_decode decode,
-			       fapi_pon_error error_cb,
-			       void *copy_priv,
-			       uint8_t msg_type)
+/* Return the deadline of the caller in us, 0 if none is set */
+static uint64_t pon_deadline_get(struct pon_ctx *ctx)
 {
-	void *nl_hdr;
-	struct pon_ctx *context = ctx;
+	uint64_t *deadline;
 
-	if (!ctx || !cb_data)
-		return PON_STATUS_INPUT_ERR;
+	if (!ctx->mt)
+		return ctx->deadline;
 
-	cb_data->running = 1;
-	cb_data->copy = NULL;
-	cb_data->error_cb = error_cb;
-	cb_data->priv = copy_priv;
-	cb_data->ctx = ctx;
-	cb_data->decode = decode;
+	deadline = pthread_getspecific(ctx->mt->deadline_key);
 
-	*msg = nlmsg_alloc();
-	if (!(*msg)) {
-		PON_DEBUG_ERR("Can't alloc netlink message");
-		return PON_STATUS_NL_ERR;
+	return deadline ? *deadline : 0;
+}
+
+static enum fapi_pon_errorcode pon_deadline_store(struct pon_ctx *ctx,
+						  uint64_t value)
+{
+	uint64_t *deadline;
+
+	if (!ctx->mt) {
+		ctx->deadline = value;
+		return PON_STATUS_OK;
 	}
 
-	nl_hdr = genlmsg_put(*msg, 0, *seq, context->family, 0, 0, msg_type, 0);
-	if (!nl_hdr) {
-		PON_DEBUG_ERR("Can't generate message");
-		nlmsg_free(*msg);
-		return PON_STATUS_NL_ERR;
+	deadline = pthread_getspecific(ctx->mt->deadline_key);
+	if (!deadline) {
+		if (!value)
+			return PON_STATUS_OK;
+		deadline = malloc(sizeof(*deadline));
+		if (!deadline)
+			return PON_STATUS_MEM_ERR;
+		if (pthread_setspecific(ctx->mt->deadline_key, deadline)) {
+			free(deadline);
+			return PON_STATUS_ERR;
+		}
 	}
+	*deadline = value;
 
 	return PON_STATUS_OK;
 }
 
-enum fapi_pon_errorcode fapi_pon_nl_msg_prepare(struct pon_ctx *ctx,
-						struct nl_msg **msg,
-						struct read_cmd_cb *cb_data,
-						uint32_t *seq,
-						fapi_pon_copy copy,
-						fapi_pon_error error_cb,
-						void *copy_priv,
-						uint8_t msg_type)
+/*
+ * Calculate how long to wait for the answer to a request which was sent at
+ * the given time. Returns false if the time is over. The first receive
+ * attempt is always done, so in non-blocking mode an answer which is already
+ * available gets handled.
+ */
+static bool pon_req_wait_time(struct pon_ctx *ctx, uint64_t start,
+			      uint64_t deadline, bool first,
+			      uint32_t *wait_ms)
 {
-	void *nl_hdr;
-	struct pon_ctx *context = ctx;
+	uint64_t end = start + (uint64_t)pon_timeout_get(ctx) * 1000;
+	uint64_t now = pon_time_us();
 
-	cb_data->running = 1;
-	cb_data->copy = copy;
-	cb_data->error_cb = error_cb;
-	cb_data->priv = copy_priv;
-	cb_data->ctx = ctx;
-	cb_data->decode = NULL;
+	if (deadline && deadline < end)
+		end = deadline;
 
-	*msg = nlmsg_alloc();
-	if (!(*msg)) {
-		PON_DEBUG_ERR("Can't alloc netlink message");
-		return PON_STATUS_NL_ERR;
+	if (now >= end) {
+		*wait_ms = PON_TIMEOUT_NONBLOCK;
+		return first;
 	}
 
-	nl_hdr = genlmsg_put(*msg, 0, *seq, context->family, 0, 0, msg_type, 0);
-	if (!nl_hdr) {
-		PON_DEBUG_ERR("Can't generate message");
-		nlmsg_free(*msg);
-		return PON_STATUS_NL_ERR;
-	}
+	*wait_ms = (uint32_t)((end - now + 999) / 1000);
 
-	return PON_STATUS_OK;
+	return true;
 }
 
-enum fapi_pon_errorcode fapi_pon_nl_msg_send(struct pon_ctx *ctx,
-					     struct nl_msg **msg,
-					     struct read_cmd_cb *cb_data,
-					     uint32_t *seq)
+/*
+ * Return the request message of the context. The message is allocated once
+ * in fapi_pon_open() and reused for every request. A reference is taken, so
+ * the nlmsg_free() calls of the request functions only drop this reference
+ * again. The header is reset to the state of a newly allocated message.
+ */
+static struct nl_msg *pon_req_msg_get(struct pon_ctx *ctx)
 {
 	struct nlmsghdr *nlh;
-	struct nl_cb *cb;
-	struct nl_cb *orig;
-	struct pon_ctx *context = ctx;
+
+	if (!ctx->req_msg)
+		return nlmsg_alloc();
+
+	nlh = nlmsg_hdr(ctx->req_msg);
+	if (memset_s(nlh, sizeof(*nlh), 0, sizeof(*nlh)))
+		return nlmsg_alloc();
+	nlh->nlmsg_len = NLMSG_HDRLEN;
+	nlmsg_get(ctx->req_msg);
+
+	return ctx->req_msg;
+}
+
+/*
+ * Wait for the answer to a request with the given sequence number. The
+ * callback set of the context is created once in fapi_pon_open(), only the
+ * arguments of the handlers are updated for each request. A request issued
+ * from within a handler gets its own copy of the callback set.
+ */
+static enum fapi_pon_errorcode pon_req_answer_wait(struct pon_ctx *ctx,
+						   uint32_t *seq,
+						   struct read_cmd_cb *cb_data,
+						   uint64_t start)
+{
+	struct nl_cb *cb = ctx->req_cb;
+	uint64_t deadline = pon_deadline_get(ctx);
+	uint32_t wait_ms;
+	bool first = true;
 	int ret;
 
-	orig = nl_socket_get_cb(context->nls);
-	cb = nl_cb_clone(orig);
-	nl_cb_put(orig);
+	if (ctx->req_cb_busy)
+		cb = nl_cb_clone(ctx->req_cb);
 	if (!cb) {
 		PON_DEBUG_ERR("Can't allocate new callback struct");
-		nlmsg_free(*msg);
-		return PON_STATUS_NL_ERR;
-	}
-
-	ret = nl_send_auto_complete(context->nls, *msg);
-	if (ret < 0) {
-		PON_DEBUG_ERR("Can't send netlink message: %i", ret);
-		nl_cb_put(cb);
-		nlmsg_free(*msg);
 		return PON_STATUS_NL_ERR;
 	}
-
-	nlh = nlmsg_hdr(*msg);
-	if (nlh)
-		*seq = nlh->nlmsg_seq;
-
-	nlmsg_free(*msg);
+	if (cb == ctx->req_cb)
+		ctx->req_cb_busy = 1;
 
 	nl_cb_set(cb, NL_CB_SEQ_CHECK, NL_CB_CUSTOM, pon_seq_check, seq);
 	nl_cb_err(cb, NL_CB_CUSTOM, cb_error_handler, cb_data);
 	nl_cb_set(cb, NL_CB_VALID, NL_CB_CUSTOM, cb_valid_handler, cb_data);
 
-	/*
-	 * Overwrite the nl_recv() function. This functions returns 0 in case
-	 * of an error and the return value is forward in the next functions.
-	 * To get to know if everything is fine or if we ran into an error
-	 * return a negative value in case of an error instead. An error is
-	 * for example the timeout of 2 seconds was reached.
-	 */
-	nl_cb_overwrite_recv(cb, fapi_pon_nl_ow_recv);
-
 	while (cb_data->running == 1) {
-		ret = nl_recvmsgs(context->nls, cb);
+		if (!pon_req_wait_time(ctx, start, deadline, first, &wait_ms) ||
+		    pon_sock_timeout_apply(ctx, wait_ms) != PON_STATUS_OK) {
+			cb_data->err = PON_STATUS_TIMEOUT;
+			break;
+		}
+		first = false;
+
+		ret = nl_recvmsgs(ctx->nls, cb);
 		if (ret) {
 			cb_data->err = PON_STATUS_TIMEOUT;
 			break;
 		}
 	}
 
-	nl_cb_put(cb);
+	if (cb == ctx->req_cb)
+		ctx->req_cb_busy = 0;
+	else
+		nl_cb_put(cb);
+
+	if (!cb_data->running)
+		pon_lat_record(&ctx->lat, pon_time_us() - start);
+
+	return cb_data->err;
+}
+
+void pon_ctx_lock(struct pon_ctx *ctx)
+{
+	if (ctx && ctx->mt)
+		pthread_mutex_lock(&ctx->mt->lock);
+}
+
+void pon_ctx_unlock(struct pon_ctx *ctx)
+{
+	if (ctx && ctx->mt)
+		pthread_mutex_unlock(&ctx->mt->lock);
+}
+
+/*
+ * Return the sequence number for a new request. For a context shared by
+ * threads the sequence numbers are assigned here instead of by libnl, as the
+ * counter of the socket is not protected against concurrent use.
+ */
+static uint32_t pon_req_seq(struct pon_ctx *ctx)
+{
+	uint32_t seq;
+
+	if (!ctx->mt)
+		return NL_AUTO_SEQ;
+
+	do {
+		seq = pon_atomic_inc(&ctx->mt->seq);
+	} while (seq == NL_AUTO_SEQ);
+
+	return seq;
+}
+
+/* Must be called with the dispatcher lock held */
+static struct pon_mt_req *pon_mt_req_find(struct pon_mt *mt, uint32_t seq)
+{
+	struct pon_mt_req *req;
+
+	for (req = mt->req; req; req = req->next) {
+		if (req->seq == seq && !req->done)
+			return req;
+	}
+
+	return NULL;
+}
+
+/* Must be called with the dispatcher lock held */
+static void pon_mt_req_unlink(struct pon_mt *mt, struct pon_mt_req *req)
+{
+	struct pon_mt_req **p;
+
+	for (p = &mt->req; *p; p = &(*p)->next) {
+		if (*p == req) {
+			*p = req->next;
+			break;
+		}
+	}
+}
+
+/*
+ * Register a request before it is sent, so that the answer can not be
+ * received by another thread before the request is known.
+ */
+static void pon_mt_req_add(struct pon_ctx *ctx, struct pon_mt_req *req,
+			   uint32_t seq, struct read_cmd_cb *cb_data)
+{
+	struct pon_mt *mt = ctx->mt;
+
+	req->seq = seq;
+	req->cb_data = cb_data;
+	req->done = 0;
+	req->busy = 0;
+	req->start = pon_time_us();
+	req->deadline = pon_deadline_get(ctx);
+
+	pthread_mutex_lock(&mt->lock);
+	req->next = mt->req;
+	mt->req = req;
+	pthread_mutex_unlock(&mt->lock);
+}
+
+static void pon_mt_req_del(struct pon_ctx *ctx, struct pon_mt_req *req)
+{
+	struct pon_mt *mt = ctx->mt;
+
+	pthread_mutex_lock(&mt->lock);
+	pon_mt_req_unlink(mt, req);
+	pthread_mutex_unlock(&mt->lock);
+}
+
+/*
+ * Mark a request as completed if the handler has finished it. This is only
+ * called by the receiving thread.
+ */
+static void pon_mt_req_check(struct pon_mt *mt, struct pon_mt_req *req)
+{
+	pthread_mutex_lock(&mt->lock);
+	req->busy = 0;
+	if (!req->cb_data->running) {
+		req->done = 1;
+		pon_mt_req_unlink(mt, req);
+	}
+	pthread_cond_broadcast(&mt->cond);
+	pthread_mutex_unlock(&mt->lock);
+}
+
+/* Must be called with the dispatcher lock held */
+static void pon_mt_req_timeout(struct pon_mt *mt, struct pon_mt_req *req)
+{
+	req->cb_data->err = PON_STATUS_TIMEOUT;
+	req->done = 1;
+	pon_mt_req_unlink(mt, req);
+}
+
+/* Wait for a signal of the dispatcher for at most the given time */
+static void pon_mt_cond_wait(struct pon_mt *mt, uint32_t wait_ms)
+{
+	pon_cond_wait_us(&mt->cond, &mt->lock, (uint64_t)wait_ms * 1000);
+}
+
+/*
+ * Netlink callback handler of the dispatcher which accepts all sequence
+ * numbers, the answers are assigned to the requests by the handlers below.
+ */
+static int pon_mt_seq_check(struct nl_msg *msg, void *arg)
+{
+	UNUSED(msg);
+	UNUSED(arg);
+
+	return NL_OK;
+}
+
+/*
+ * Find the request an answer belongs to. The request is marked as busy until
+ * pon_mt_req_check() is called, so the waiting thread does not give up on it
+ * while the answer is copied.
+ */
+static struct pon_mt_req *pon_mt_req_get(struct pon_mt *mt, uint32_t seq)
+{
+	struct pon_mt_req *req;
+
+	pthread_mutex_lock(&mt->lock);
+	req = pon_mt_req_find(mt, seq);
+	if (req)
+		req->busy = 1;
+	pthread_mutex_unlock(&mt->lock);
+
+	return req;
+}
+
+static int pon_mt_valid_handler(struct nl_msg *msg, void *arg)
+{
+	struct pon_ctx *ctx = arg;
+	struct pon_mt_req *req;
+	struct nlmsghdr *nlh;
+
+	nlh = nlmsg_hdr(msg);
+	if (!nlh)
+		return NL_SKIP;
+
+	req = pon_mt_req_get(ctx->mt, nlh->nlmsg_seq);
+	if (!req)
+		return NL_SKIP;
+
+	cb_valid_handler(msg, req->cb_data);
+	pon_mt_req_check(ctx->mt, req);
+
+	return NL_OK;
+}
+
+static int pon_mt_error_handler(struct sockaddr_nl *nla,
+				struct nlmsgerr *nlerr, void *arg)
+{
+	struct pon_ctx *ctx = arg;
+	struct pon_mt_req *req;
+
+	req = pon_mt_req_get(ctx->mt, nlerr->msg.nlmsg_seq);
+	if (!req)
+		return NL_SKIP;
+
+	cb_error_handler(nla, nlerr, req->cb_data);
+	pon_mt_req_check(ctx->mt, req);
+
+	return NL_OK;
+}
+
+/*
+ * Wait for the answer to a registered request. Only one thread at a time
+ * reads from the socket and hands the answers over to the waiting threads.
+ * When this thread got its own answer, it passes the socket on to one of the
+ * other waiting threads. A request issued from within a handler is received
+ * by the thread which is already reading.
+ */
+static enum fapi_pon_errorcode pon_mt_answer_wait(struct pon_ctx *ctx,
+						  struct pon_mt_req *req)
+{
+	struct pon_mt *mt = ctx->mt;
+	pthread_t self = pthread_self();
+	uint32_t wait_ms;
+	bool first = true;
+	bool in_time;
+	int nested;
+	int ret;
+
+	pthread_mutex_lock(&mt->lock);
+	while (!req->done) {
+		in_time = pon_req_wait_time(ctx, req->start, req->deadline,
+					    first, &wait_ms);
+		first = false;
+		if (!in_time && !req->busy) {
+			pon_mt_req_timeout(mt, req);
+			break;
+		}
+
+		nested = mt->receiving && pthread_equal(mt->receiver, self);
+		if (mt->receiving && !nested) {
+			if (in_time)
+				pon_mt_cond_wait(mt, wait_ms);
+			else
+				pthread_cond_wait(&mt->cond, &mt->lock);
+			continue;
+		}
+
+		mt->receiving = 1;
+		mt->receiver = self;
+		pthread_mutex_unlock(&mt->lock);
+
+		ret = pon_sock_timeout_apply(ctx, wait_ms);
+		if (ret == PON_STATUS_OK)
+			ret = nl_recvmsgs(ctx->nls, mt->cb);
+
+		pthread_mutex_lock(&mt->lock);
+		if (ret && !req->done)
+			pon_mt_req_timeout(mt, req);
+		if (!nested) {
+			mt->receiving = 0;
+			pthread_cond_broadcast(&mt->cond);
+		}
+	}
+	if (!req->cb_data->running)
+		pon_lat_record(&ctx->lat, pon_time_us() - req->start);
+	pthread_mutex_unlock(&mt->lock);
+
+	return req->cb_data->err;
+}
+
+static void pon_mt_free(struct pon_ctx *ctx)
+{
+	struct pon_mt *mt = ctx->mt;
+
+	if (!mt)
+		return;
+
+	if (mt->cb)
+		nl_cb_put(mt->cb);
+	pthread_key_delete(mt->deadline_key);
+	pthread_cond_destroy(&mt->cond);
+	pthread_mutex_destroy(&mt->lock);
+	free(mt);
+	ctx->mt = NULL;
+}
+
+static enum fapi_pon_errorcode pon_mt_init(struct pon_ctx *ctx)
+{
+	struct pon_mt *mt;
+	struct nl_cb *orig;
+
+	mt = calloc(1, sizeof(*mt));
+	if (!mt)
+		return PON_STATUS_MEM_ERR;
+
+	if (pthread_mutex_init(&mt->lock, NULL)) {
+		free(mt);
+		return PON_STATUS_ERR;
+	}
+	if (pon_cond_init(&mt->cond)) {
+		pthread_mutex_destroy(&mt->lock);
+		free(mt);
+		return PON_STATUS_ERR;
+	}
+	if (pthread_key_create(&mt->deadline_key, free)) {
+		pthread_cond_destroy(&mt->cond);
+		pthread_mutex_destroy(&mt->lock);
+		free(mt);
+		return PON_STATUS_ERR;
+	}
+	ctx->mt = mt;
+
+	orig = nl_socket_get_cb(ctx->nls);
+	mt->cb = nl_cb_clone(orig);
+	nl_cb_put(orig);
+	if (!mt->cb) {
+		PON_DEBUG_ERR("Can't allocate new callback struct");
+		pon_mt_free(ctx);
+		return PON_STATUS_NL_ERR;
+	}
+
+	nl_cb_set(mt->cb, NL_CB_SEQ_CHECK, NL_CB_CUSTOM, pon_mt_seq_check,
+		  NULL);
+	nl_cb_err(mt->cb, NL_CB_CUSTOM, pon_mt_error_handler, ctx);
+	nl_cb_set(mt->cb, NL_CB_VALID, NL_CB_CUSTOM, pon_mt_valid_handler,
+		  ctx);
+	pon_recv_ow_set(ctx, mt->cb);
+
+	mt->seq = (uint32_t)time(NULL);
+
+	/* The shared request message can not be used by multiple threads,
+	 * every request allocates its own message instead.
+	 */
+	if (ctx->req_msg) {
+		nlmsg_free(ctx->req_msg);
+		ctx->req_msg = NULL;
+	}
+
+	return PON_STATUS_OK;
+}
+
+/* Statistics of one firmware command and request type */
+struct pon_cmd_stats_entry {
+	/** Command and request type, 0 for an unused entry */
+	uint32_t key;
+	/** Number of answered requests */
+	uint64_t answered;
+	/** Sum of the round-trip times of the answered requests in us */
+	uint64_t lat_sum;
+	/** Statistics as returned by fapi_pon_stats_get() */
+	struct pon_cmd_stats stats;
+};
+
+/*
+ * Return the statistics entry of a command, the table is allocated on first
+ * use. Must be called with the context lock held. Returns NULL if the table
+ * is full.
+ */
+static struct pon_cmd_stats_entry *pon_stats_entry_get(struct pon_ctx *ctx,
+						       uint32_t command,
+						       uint32_t read)
+{
+	struct pon_cmd_stats_entry *entry;
+	uint32_t key = ((command << 1) | (read ? 1 : 0)) + 1;
+	unsigned int i, idx;
+
+	if (!ctx->stats) {
+		ctx->stats = calloc(PON_CMD_STATS_MAX, sizeof(*ctx->stats));
+		if (!ctx->stats)
+			return NULL;
+	}
+
+	idx = (key * 2654435761U) >> 24;
+	for (i = 0; i < PON_CMD_STATS_MAX; i++) {
+		entry = &ctx->stats[(idx + i) % PON_CMD_STATS_MAX];
+		if (entry->key == key)
+			return entry;
+		if (entry->key)
+			continue;
+
+		entry->key = key;
+		entry->stats.command = (uint16_t)command;
+		entry->stats.read = read ? 1 : 0;
+		return entry;
+	}
+
+	return NULL;
+}
+
+/* Account a finished synchronous request in the command statistics */
+static void pon_stats_record(struct pon_ctx *ctx, uint32_t command,
+			     uint32_t read, size_t tx_len,
+			     const struct read_cmd_cb *cb_data,
+			     enum fapi_pon_errorcode err, uint64_t start)
+{
+	struct pon_cmd_stats_entry *entry;
+	struct pon_cmd_stats *stats;
+	uint64_t lat = pon_time_us() - start;
+
+	if (lat > UINT32_MAX)
+		lat = UINT32_MAX;
+
+	pon_ctx_lock(ctx);
+	entry = pon_stats_entry_get(ctx, command, read);
+	if (!entry) {
+		pon_ctx_unlock(ctx);
+		return;
+	}
+
+	stats = &entry->stats;
+	stats->count++;
+	stats->tx_bytes += tx_len;
+	if (err != PON_STATUS_OK)
+		stats->errors++;
+	if (err == PON_STATUS_TIMEOUT)
+		stats->timeouts++;
+
+	if (!cb_data->running) {
+		if (cb_data->nack)
+			stats->nacks++;
+		stats->rx_bytes += cb_data->rx_len;
+
+		if (!entry->answered || lat < stats->lat_min)
+			stats->lat_min = (uint32_t)lat;
+		if (lat > stats->lat_max)
+			stats->lat_max = (uint32_t)lat;
+		stats->lat_hist[pon_lat_bucket(lat)]++;
+		entry->answered++;
+		entry->lat_sum += lat;
+	}
+	pon_ctx_unlock(ctx);
+}
+
+/* Read the command, request type and payload size of a request message */
+static void pon_stats_msg_info(struct nl_msg *msg, uint32_t *command,
+			       uint32_t *read, size_t *tx_len)
+{
+	struct nlmsghdr *nlh = nlmsg_hdr(msg);
+	struct nlattr *attr;
+
+	attr = nlmsg_find_attr(nlh, GENL_HDRLEN, PON_MBOX_A_COMMAND);
+	*command = attr ? nla_get_u16(attr) : 0;
+	attr = nlmsg_find_attr(nlh, GENL_HDRLEN, PON_MBOX_A_READ_WRITE);
+	*read = attr ? nla_get_u8(attr) : 0;
+	attr = nlmsg_find_attr(nlh, GENL_HDRLEN, PON_MBOX_A_DATA);
+	*tx_len = attr ? (size_t)nla_len(attr) : 0;
+}
+
+enum fapi_pon_errorcode fapi_pon_stats_get(struct pon_ctx *ctx,
+					   uint32_t *num,
+					   struct pon_cmd_stats *stats)
+{
+	struct pon_cmd_stats_entry *entry;
+	uint32_t cnt = 0;
+	unsigned int i;
+
+	if (!ctx || !num || !stats)
+		return PON_STATUS_INPUT_ERR;
+
+	pon_ctx_lock(ctx);
+	for (i = 0; ctx->stats && i < PON_CMD_STATS_MAX && cnt < *num; i++) {
+		entry = &ctx->stats[i];
+		if (!entry->key)
+			continue;
+
+		stats[cnt] = entry->stats;
+		if (entry->answered)
+			stats[cnt].lat_avg =
+				(uint32_t)(entry->lat_sum / entry->answered);
+		cnt++;
+	}
+	pon_ctx_unlock(ctx);
+
+	*num = cnt;
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_stats_reset(struct pon_ctx *ctx)
+{
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	pon_ctx_lock(ctx);
+	if (ctx->stats)
+		memset(ctx->stats, 0, PON_CMD_STATS_MAX * sizeof(*ctx->stats));
+	pon_ctx_unlock(ctx);
+
+	return PON_STATUS_OK;
+}
+
+/* Add the attributes of a firmware message to a Netlink message */
+static enum fapi_pon_errorcode pon_fw_attr_put(struct nl_msg *msg,
+					       uint32_t read, uint32_t command,
+					       uint32_t ack,
+					       const void *in_buf,
+					       size_t in_size, uint32_t flags)
+{
+	int ret;
+
+	ret = nla_put_u8(msg, PON_MBOX_A_READ_WRITE, read ? 1 : 0);
+	if (ret)
+		return PON_STATUS_NL_ERR;
+
+	ret = nla_put_u16(msg, PON_MBOX_A_COMMAND, command);
+	if (ret)
+		return PON_STATUS_NL_ERR;
+
+	ret = nla_put_u8(msg, PON_MBOX_A_ACK, ack);
+	if (ret)
+		return PON_STATUS_NL_ERR;
+
+	if (flags) {
+		ret = nla_put_u32(msg, PON_MBOX_A_FLAGS, flags);
+		if (ret)
+			return PON_STATUS_NL_ERR;
+	}
+
+	if (in_buf) {
+		ret = nla_put(msg, PON_MBOX_A_DATA, in_size, in_buf);
+		if (ret)
+			return PON_STATUS_NL_ERR;
+	}
+
+	return PON_STATUS_OK;
+}
+
+/*
+ * Create and send a message to the mailbox driver which contains a message
+ * for the FW. The in_buf is optional if we have a message without a payload
+ * set it to NULL. 'flags' attribute allows to distinguish whether called event
+ * is fake or not.
+ */
+static enum fapi_pon_errorcode
+fapi_pon_send_msg_int(struct pon_ctx *ctx, uint32_t *seq,
+		      uint32_t read, uint32_t command, uint32_t ack,
+		      const void *in_buf, size_t in_size, uint8_t msg_type,
+		      uint32_t flags)
+{
+	struct nl_msg *msg;
+	struct nlmsghdr *nlh;
+	void *nl_hdr;
+	int ret;
+
+	msg = pon_req_msg_get(ctx);
+	if (!msg) {
+		PON_DEBUG_ERR("Can't alloc netlink message");
+		return PON_STATUS_NL_ERR;
+	}
+
+	nl_hdr = genlmsg_put(msg, 0, *seq, ctx->family, 0, 0, msg_type, 0);
+	if (!nl_hdr) {
+		PON_DEBUG_ERR("Can't generate message");
+		nlmsg_free(msg);
+		return PON_STATUS_NL_ERR;
+	}
+
+	if (pon_fw_attr_put(msg, read, command, ack, in_buf, in_size,
+			    flags) != PON_STATUS_OK) {
+		PON_DEBUG_ERR("Can't add netlink attribute");
+		nlmsg_free(msg);
+		return PON_STATUS_NL_ERR;
+	}
+
+	ret = nl_send_auto_complete(ctx->nls, msg);
+	if (ret < 0) {
+		PON_DEBUG_ERR("Can't send netlink message: %i", ret);
+		nlmsg_free(msg);
+		return PON_STATUS_NL_ERR;
+	}
+	nlh = nlmsg_hdr(msg);
+	if (nlh)
+		*seq = nlh->nlmsg_seq;
+
+	nlmsg_free(msg);
+
+	return PON_STATUS_OK;
+}
+
+/*
+ * Create a context which talks to the pon_mbox driver or, if a fixture is
+ * given, to the loopback backend.
+ */
+static enum fapi_pon_errorcode pon_ctx_open(struct pon_ctx **param,
+					    const char *fixture)
+{
+	struct pon_ctx *ctx;
+	struct nl_cb *orig;
+	enum fapi_pon_errorcode err;
+	int ret;
+	int i;
+
+	if (!param)
+		return PON_STATUS_INPUT_ERR;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx)
+		return PON_STATUS_MEM_ERR;
+
+	ctx->nls = nl_socket_alloc();
+	if (!ctx->nls) {
+		PON_DEBUG_ERR("Can't alloc netlink socket");
+		fapi_pon_close(ctx);
+		return PON_STATUS_NL_ERR;
+	}
+
+	if (fixture) {
+		err = pon_lb_attach(ctx, fixture);
+		if (err != PON_STATUS_OK) {
+			fapi_pon_close(ctx);
+			return err;
+		}
+	} else {
+		ret = genl_connect(ctx->nls);
+		if (ret) {
+			PON_DEBUG_ERR("Can't connect to netlink socket: %i",
+				      ret);
+			fapi_pon_close(ctx);
+			return PON_STATUS_NL_ERR;
+		}
+
+		ctx->family = genl_ctrl_resolve(ctx->nls, PON_MBOX_FAMILY);
+		if (ctx->family < 0) {
+			PON_DEBUG_ERR("No pon mbox netlink interface found: %i",
+					ctx->family);
+			fapi_pon_close(ctx);
+			return PON_STATUS_NL_NAME_ERR;
+		}
+	}
+
+	ctx->req_msg = nlmsg_alloc();
+	if (!ctx->req_msg) {
+		PON_DEBUG_ERR("Can't alloc netlink message");
+		fapi_pon_close(ctx);
+		return PON_STATUS_NL_ERR;
+	}
+
+	orig = nl_socket_get_cb(ctx->nls);
+	ctx->req_cb = nl_cb_clone(orig);
+	nl_cb_put(orig);
+	if (!ctx->req_cb) {
+		PON_DEBUG_ERR("Can't allocate new callback struct");
+		fapi_pon_close(ctx);
+		return PON_STATUS_NL_ERR;
+	}
+
+	/*
+	 * Overwrite the nl_recv() function. This functions returns 0 in case
+	 * of an error and the return value is forward in the next functions.
+	 * To get to know if everything is fine or if we ran into an error
+	 * return a negative value in case of an error instead. An error is
+	 * for example the timeout of 2 seconds was reached.
+	 */
+	pon_recv_ow_set(ctx, ctx->req_cb);
+
+	/* We set a socket timeout of 2 seconds here. We assume that the FW can
+	 * answer to all request within 2 seconds. The default nl_recv()
+	 * function just retries the reading in case it ran into a timeout,
+	 * we have overwritten it for the request callback set above.
+	 */
+	ctx->timeout = PON_TIMEOUT_DEFAULT;
+	ctx->sock_timeout = PON_TIMEOUT_DEFAULT;
+	err = pon_sock_timeout_set(ctx, PON_TIMEOUT_DEFAULT);
+	if (err != PON_STATUS_OK) {
+		fapi_pon_close(ctx);
+		return err;
+	}
+
+	for (i = 0; i < PON_DDMI_MAX; i++)
+		ctx->eeprom_fd[i] = -1;
+
+	err = pon_dmi_cache_init(ctx);
+	if (err != PON_STATUS_OK) {
+		fapi_pon_close(ctx);
+		return err;
+	}
+
+	*param = ctx;
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_open(struct pon_ctx **param)
+{
+#ifdef INCLUDE_PON_TESTS
+	/* Test builds can run unmodified applications on the loopback */
+	const char *fixture = getenv("PON_LIB_LOOPBACK");
+
+	if (fixture && fixture[0])
+		return pon_ctx_open(param, fixture);
+#endif
+
+	return pon_ctx_open(param, NULL);
+}
+
+enum fapi_pon_errorcode fapi_pon_open_loopback(struct pon_ctx **param,
+					       const char *fixture)
+{
+	if (!fixture)
+		return PON_STATUS_INPUT_ERR;
+
+	return pon_ctx_open(param, fixture);
+}
+
+enum fapi_pon_errorcode fapi_pon_open_mt(struct pon_ctx **param)
+{
+	enum fapi_pon_errorcode err;
+	struct pon_ctx *ctx;
+
+	if (!param)
+		return PON_STATUS_INPUT_ERR;
+
+	err = fapi_pon_open(&ctx);
+	if (err != PON_STATUS_OK)
+		return err;
+
+	err = pon_mt_init(ctx);
+	if (err != PON_STATUS_OK) {
+		fapi_pon_close(ctx);
+		return err;
+	}
+
+	*param = ctx;
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_close(struct pon_ctx *ctx)
+{
+	int i;
+
+#ifndef WIN32
+	fapi_pon_shm_export_stop(ctx);
+#endif
+	fapi_pon_listener_defer_stop(ctx);
+	pon_cfg_tx_free(ctx);
+	fapi_pon_ploam_capture_stop(ctx);
+
+	for (i = 0; i < PON_DDMI_MAX; i++) {
+		if (ctx->eeprom_fd[i] >= 0)
+			pon_close(ctx->eeprom_fd[i]);
+	}
+
+	if (ctx->async_cb)
+		nl_cb_put(ctx->async_cb);
+	pon_mt_free(ctx);
+	if (ctx->req_cb)
+		nl_cb_put(ctx->req_cb);
+	if (ctx->req_msg)
+		nlmsg_free(ctx->req_msg);
+	free(ctx->async_req);
+	free(ctx->stats);
+	pon_gem_cache_free(ctx);
+	pon_dmi_cache_free(ctx);
+	pon_lb_detach(ctx);
+
+	nl_socket_free(ctx->nls);
+	nl_socket_free(ctx->nls_event);
+	free(ctx);
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_nl_msg_prepare_decode(struct pon_ctx *ctx,
+			       struct nl_msg **msg,
+			       struct read_cmd_cb *cb_data,
+			       uint32_t *seq,
+			       fapi_pon_decode decode,
+			       fapi_pon_error error_cb,
+			       void *copy_priv,
+			       uint8_t msg_type)
+{
+	void *nl_hdr;
+	struct pon_ctx *context = ctx;
+
+	if (!ctx || !cb_data)
+		return PON_STATUS_INPUT_ERR;
+
+	cb_data->running = 1;
+	cb_data->copy = NULL;
+	cb_data->error_cb = error_cb;
+	cb_data->priv = copy_priv;
+	cb_data->ctx = ctx;
+	cb_data->decode = decode;
+	cb_data->nack = 0;
+	cb_data->rx_len = 0;
+
+	/* The message of the context is reused by the recorded requests */
+	pon_cfg_tx_sync(context);
+
+	*msg = pon_req_msg_get(context);
+	if (!(*msg)) {
+		PON_DEBUG_ERR("Can't alloc netlink message");
+		return PON_STATUS_NL_ERR;
+	}
+
+	nl_hdr = genlmsg_put(*msg, 0, *seq, context->family, 0, 0, msg_type, 0);
+	if (!nl_hdr) {
+		PON_DEBUG_ERR("Can't generate message");
+		nlmsg_free(*msg);
+		return PON_STATUS_NL_ERR;
+	}
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_nl_msg_prepare(struct pon_ctx *ctx,
+						struct nl_msg **msg,
+						struct read_cmd_cb *cb_data,
+						uint32_t *seq,
+						fapi_pon_copy copy,
+						fapi_pon_error error_cb,
+						void *copy_priv,
+						uint8_t msg_type)
+{
+	void *nl_hdr;
+	struct pon_ctx *context = ctx;
+
+	cb_data->running = 1;
+	cb_data->copy = copy;
+	cb_data->error_cb = error_cb;
+	cb_data->priv = copy_priv;
+	cb_data->ctx = ctx;
+	cb_data->decode = NULL;
+	cb_data->nack = 0;
+	cb_data->rx_len = 0;
+
+	/* The message of the context is reused by the recorded requests */
+	pon_cfg_tx_sync(context);
+
+	*msg = pon_req_msg_get(context);
+	if (!(*msg)) {
+		PON_DEBUG_ERR("Can't alloc netlink message");
+		return PON_STATUS_NL_ERR;
+	}
+
+	nl_hdr = genlmsg_put(*msg, 0, *seq, context->family, 0, 0, msg_type, 0);
+	if (!nl_hdr) {
+		PON_DEBUG_ERR("Can't generate message");
+		nlmsg_free(*msg);
+		return PON_STATUS_NL_ERR;
+	}
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_nl_msg_send(struct pon_ctx *ctx,
+					     struct nl_msg **msg,
+					     struct read_cmd_cb *cb_data,
+					     uint32_t *seq)
+{
+	struct nlmsghdr *nlh;
+	struct pon_ctx *context = ctx;
+	enum fapi_pon_errorcode err;
+	struct pon_mt_req req;
+	uint32_t command, read;
+	size_t tx_len;
+	uint64_t start;
+	int ret;
+
+	/* Answers to asynchronous requests would be skipped by our sequence
+	 * number check, complete them first.
+	 */
+	if (context->async_pending)
+		fapi_pon_async_wait_all(context);
+
+	if (context->mt) {
+		nlh = nlmsg_hdr(*msg);
+		nlh->nlmsg_seq = pon_req_seq(context);
+		pon_mt_req_add(context, &req, nlh->nlmsg_seq, cb_data);
+	}
+
+	pon_stats_msg_info(*msg, &command, &read, &tx_len);
+	pon_cfg_tx_check(context, read, command, NULL, 0, false);
+
+	start = pon_time_us();
+	ret = nl_send_auto_complete(context->nls, *msg);
+	if (ret < 0) {
+		PON_DEBUG_ERR("Can't send netlink message: %i", ret);
+		if (context->mt)
+			pon_mt_req_del(context, &req);
+		nlmsg_free(*msg);
+		pon_stats_record(context, command, read, tx_len, cb_data,
+				 PON_STATUS_NL_ERR, start);
+		return PON_STATUS_NL_ERR;
+	}
+
+	nlh = nlmsg_hdr(*msg);
+	if (nlh)
+		*seq = nlh->nlmsg_seq;
+
+	nlmsg_free(*msg);
+
+	if (context->mt)
+		err = pon_mt_answer_wait(context, &req);
+	else
+		err = pon_req_answer_wait(context, seq, cb_data, start);
+
+	pon_stats_record(context, command, read, tx_len, cb_data, err, start);
+
+	return err;
+}
+
+/*
+ * This sends a NetLink message to the mbox driver and waits for the answer.
+ * \ref fapi_pon_send_msg_int is used to create the message and send it. This
+ * function also registers all the callback handlers needed to handle the
+ * answer. If no pon_ctx is given this function will create a context on its
+ * own and deletes it again after using it.
+ */
+static enum fapi_pon_errorcode fapi_pon_send_msg(struct pon_ctx *ctx,
+				     uint32_t read, uint32_t command,
+				     uint32_t ack, const void *in_buf,
+				     size_t in_size, fapi_pon_copy copy,
+				     fapi_pon_error error_cb,
+				     void *copy_priv, uint8_t msg_type)
+{
+	uint32_t seq;
+	uint64_t start;
+	enum fapi_pon_errorcode err;
+	struct pon_mt_req req;
+	struct read_cmd_cb cb_data = {
+		.running = 1,
+		.copy = copy,
+		.error_cb = error_cb,
+		.priv = copy_priv,
+		.ctx = ctx,
+	};
+
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	/* Only plain write requests can be deferred, the error callback and
+	 * its data might not be valid anymore when the answer arrives.
+	 */
+	if (pon_cfg_tx_check(ctx, read, command, in_buf, in_size,
+			     msg_type == PON_MBOX_C_MSG && !error_cb &&
+			     !copy_priv))
+		return pon_cfg_tx_result(ctx);
+
+	/* Answers to asynchronous requests would be skipped by our sequence
+	 * number check, complete them first.
+	 */
+	if (ctx->async_pending)
+		fapi_pon_async_wait_all(ctx);
+
+	seq = pon_req_seq(ctx);
+	if (ctx->mt)
+		pon_mt_req_add(ctx, &req, seq, &cb_data);
+
+	start = pon_time_us();
+	err = fapi_pon_send_msg_int(ctx, &seq, read, command, ack, in_buf,
+				    in_size, msg_type, 0);
+	if (err != PON_STATUS_OK) {
+		if (ctx->mt)
+			pon_mt_req_del(ctx, &req);
+	} else if (ctx->mt) {
+		err = pon_mt_answer_wait(ctx, &req);
+	} else {
+		err = pon_req_answer_wait(ctx, &seq, &cb_data, start);
+	}
+
+	pon_stats_record(ctx, command, read, in_buf ? in_size : 0, &cb_data,
+			 err, start);
+
+	return err;
+}
+
+/*
+ * This sends an answer to a previous NetLink message. This is used to send
+ * an ACK or NACK to an event received from the firmware.
+ */
+enum fapi_pon_errorcode
+fapi_pon_send_msg_answer(struct pon_ctx *ctx, struct nl_msg *msg,
+			 struct nlattr **attrs, uint32_t ack, void *buf,
+			 size_t size, uint8_t msg_type)
+{
+	struct nlmsghdr *hdr = nlmsg_hdr(msg);
+	uint16_t command;
+	uint8_t read;
+	uint32_t flags = 0;
+
+	command = nla_get_u16(attrs[PON_MBOX_A_COMMAND]);
+	read = nla_get_u8(attrs[PON_MBOX_A_READ_WRITE]);
+
+	if (attrs[PON_MBOX_A_FLAGS])
+		flags = nla_get_u32(attrs[PON_MBOX_A_FLAGS]);
+
+	/*
+	 * Send it on normal socket and not the multicast socket. In case
+	 * there is a problem the answer would be revived by the event handler
+	 * which does not handle them, send them to the normal socket which
+	 * will ignore it. The normal netlink socket should ignores the
+	 * answers as it ignores all messages with unexpected sequence numbers.
+	 */
+	return fapi_pon_send_msg_int(ctx, &hdr->nlmsg_seq, read, command, ack,
+				     buf, size, msg_type, flags);
+}
+
+#if defined(INCLUDE_DEBUG_SUPPORT)
+uint32_t pon_debug_print(const enum pon_debug_level level,
+			 const char *format, ...)
+{
+	uint32_t ret = 0;
+	va_list ap;
+
+	if ((level < PON_DBG_OFF) && (level >= pon_dbg_lvl)) {
+		va_start(ap, format);
+		ret = vprintf(format, ap);
+		if (ret > 0)
+			ret = printf(PON_CRLF);
+		va_end(ap);
+	}
+	return ret;
+}
+#endif
+
+enum fapi_pon_errorcode fapi_pon_generic_error_get(struct pon_ctx *ctx,
+						   uint32_t command,
+						   const void *in_buf,
+						   size_t in_size,
+						   fapi_pon_copy copy,
+						   fapi_pon_error error_cb,
+						   void *copy_priv,
+						   uint8_t msg_type)
+{
+	return fapi_pon_send_msg(ctx, PONFW_READ, command, PONFW_CMD, in_buf,
+				 in_size, copy, error_cb, copy_priv, msg_type);
+}
+
+enum fapi_pon_errorcode fapi_pon_generic_error_set(struct pon_ctx *ctx,
+						   uint32_t command,
+						   const void *param,
+						   uint32_t sizeof_param,
+						   fapi_pon_error error_cb,
+						   void *copy_priv,
+						   uint8_t msg_type)
+{
+	return fapi_pon_send_msg(ctx, PONFW_WRITE, command, PONFW_CMD, param,
+				 sizeof_param, NULL, error_cb, copy_priv,
+				 msg_type);
+}
+
+/* Request of a batch sent on a context shared by threads */
+struct pon_batch_req {
+	/** Dispatcher entry */
+	struct pon_mt_req req;
+	/** Callback data used to handle the answer */
+	struct read_cmd_cb cb_data;
+	/** Time the request was sent in us */
+	uint64_t start;
+	/** Firmware command ID, request type and payload size for the
+	 *  statistics
+	 */
+	uint32_t command;
+	uint32_t read;
+	size_t tx_len;
+	/** Result of the request */
+	enum fapi_pon_errorcode *result;
+};
+
+struct pon_nl_batch {
+	/** Context the requests are sent on */
+	struct pon_ctx *ctx;
+	/** Number of sent requests */
+	unsigned int num;
+	/** Maximum number of requests */
+	unsigned int max;
+	/** Requests, only used on a context shared by threads */
+	struct pon_batch_req req[];
+};
+
+struct pon_nl_batch *pon_nl_batch_alloc(struct pon_ctx *ctx, unsigned int max)
+{
+	struct pon_nl_batch *batch;
+	size_t size = sizeof(*batch);
+
+	/* Without a dispatcher the asynchronous requests are used */
+	if (ctx->mt)
+		size += max * sizeof(batch->req[0]);
+
+	batch = calloc(1, size);
+	if (!batch)
+		return NULL;
+
+	batch->ctx = ctx;
+	batch->max = max;
+
+	return batch;
+}
+
+enum fapi_pon_errorcode pon_nl_batch_send(struct pon_nl_batch *batch,
+					  struct nl_msg **msg,
+					  struct read_cmd_cb *cb_data,
+					  enum fapi_pon_errorcode *result)
+{
+	struct pon_ctx *ctx = batch->ctx;
+	struct pon_batch_req *req;
+	struct nlmsghdr *nlh;
+	uint32_t command, read;
+	size_t tx_len;
+	int ret;
+
+	*result = PON_STATUS_OK;
+
+	pon_stats_msg_info(*msg, &command, &read, &tx_len);
+	pon_cfg_tx_check(ctx, read, command, NULL, 0, false);
+
+	if (!ctx->mt) {
+		*result = fapi_pon_async_nl_msg_send(ctx, msg, cb_data,
+						fapi_pon_async_result_store,
+						result, NULL);
+		return *result;
+	}
+
+	if (batch->num >= batch->max) {
+		nlmsg_free(*msg);
+		*result = PON_STATUS_RESOURCE_ERR;
+		return *result;
+	}
+
+	req = &batch->req[batch->num];
+	req->cb_data = *cb_data;
+	req->command = command;
+	req->read = read;
+	req->tx_len = tx_len;
+	req->result = result;
+
+	nlh = nlmsg_hdr(*msg);
+	nlh->nlmsg_seq = pon_req_seq(ctx);
+	pon_mt_req_add(ctx, &req->req, nlh->nlmsg_seq, &req->cb_data);
+
+	req->start = pon_time_us();
+	ret = nl_send_auto_complete(ctx->nls, *msg);
+	nlmsg_free(*msg);
+	if (ret < 0) {
+		PON_DEBUG_ERR("Can't send netlink message: %i", ret);
+		pon_mt_req_del(ctx, &req->req);
+		*result = PON_STATUS_NL_ERR;
+		return *result;
+	}
+
+	batch->num++;
+
+	return PON_STATUS_OK;
+}
+
+/* Send a firmware request as part of a batch */
+static enum fapi_pon_errorcode pon_nl_batch_fw(struct pon_nl_batch *batch,
+					       uint32_t read,
+					       uint32_t command,
+					       const void *in_buf,
+					       size_t in_size,
+					       fapi_pon_copy copy,
+					       void *copy_priv,
+					       enum fapi_pon_errorcode *result)
+{
+	struct read_cmd_cb cb_data;
+	struct nl_msg *msg;
+	uint32_t seq = NL_AUTO_SEQ;
+	enum fapi_pon_errorcode ret;
+
+	ret = fapi_pon_nl_msg_prepare(batch->ctx, &msg, &cb_data, &seq, copy,
+				      NULL, copy_priv, PON_MBOX_C_MSG);
+	if (ret == PON_STATUS_OK) {
+		ret = pon_fw_attr_put(msg, read, command, PONFW_CMD,
+				      in_buf, in_size, 0);
+		if (ret != PON_STATUS_OK) {
+			PON_DEBUG_ERR("Can't add netlink attribute");
+			nlmsg_free(msg);
+		}
+	}
+	if (ret != PON_STATUS_OK) {
+		*result = ret;
+		return ret;
+	}
+
+	return pon_nl_batch_send(batch, &msg, &cb_data, result);
+}
+
+enum fapi_pon_errorcode pon_nl_batch_read(struct pon_nl_batch *batch,
+					  uint32_t command,
+					  const void *in_buf,
+					  size_t in_size,
+					  fapi_pon_copy copy,
+					  void *copy_priv,
+					  enum fapi_pon_errorcode *result)
+{
+	return pon_nl_batch_fw(batch, PONFW_READ, command, in_buf, in_size,
+			       copy, copy_priv, result);
+}
+
+void pon_nl_batch_finish(struct pon_nl_batch *batch)
+{
+	struct pon_ctx *ctx = batch->ctx;
+	struct pon_batch_req *req;
+	enum fapi_pon_errorcode err;
+	unsigned int i;
+
+	if (!ctx->mt)
+		fapi_pon_async_wait_all(ctx);
+
+	for (i = 0; i < batch->num; i++) {
+		req = &batch->req[i];
+		err = pon_mt_answer_wait(ctx, &req->req);
+		*req->result = err;
+		pon_stats_record(ctx, req->command, req->read, req->tx_len,
+				 &req->cb_data, err, req->start);
+	}
+
+	free(batch);
+}
+
+void pon_generic_set_batch(struct pon_ctx *ctx, struct pon_set_req *req,
+			   unsigned int num)
+{
+	struct pon_nl_batch *batch;
+	unsigned int i;
+
+	batch = pon_nl_batch_alloc(ctx, num);
+	if (!batch) {
+		for (i = 0; i < num; i++)
+			req[i].err = fapi_pon_generic_set(ctx, req[i].command,
+							  req[i].param,
+							  req[i].size);
+		return;
+	}
+
+	/* A failed request does not stop the following ones */
+	for (i = 0; i < num; i++)
+		pon_nl_batch_fw(batch, PONFW_WRITE, req[i].command,
+				req[i].param, req[i].size, NULL, NULL,
+				&req[i].err);
+
+	pon_nl_batch_finish(batch);
+}
+
+/*
+ * Search the asynchronous request which is waiting for the answer with the
+ * given sequence number.
+ */
+static struct pon_async_req *pon_async_find(struct pon_ctx *ctx, uint32_t seq)
+{
+	unsigned int i;
+
+	if (!ctx->async_req)
+		return NULL;
+
+	for (i = 0; i < PON_ASYNC_MAX_PENDING; i++) {
+		if (ctx->async_req[i].state == PON_ASYNC_PENDING &&
+		    ctx->async_req[i].seq == seq)
+			return &ctx->async_req[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Mark an asynchronous request as completed. In case a completion callback
+ * was given the slot is released before the callback is called, otherwise
+ * the result is kept until it gets collected by fapi_pon_async_wait().
+ */
+static void pon_async_complete(struct pon_ctx *ctx, struct pon_async_req *req)
+{
+	fapi_pon_async_done done = req->done;
+	void *done_priv = req->done_priv;
+	uint32_t seq = req->seq;
+
+	ctx->async_pending--;
+
+	if (!done) {
+		req->state = PON_ASYNC_DONE;
+		return;
+	}
+
+	req->state = PON_ASYNC_FREE;
+	done(ctx, seq, req->cb_data.err, done_priv);
+}
+
+/* Complete all outstanding asynchronous requests with the given error. */
+static void pon_async_fail_all(struct pon_ctx *ctx,
+			       enum fapi_pon_errorcode err)
+{
+	unsigned int i;
+
+	if (!ctx->async_req)
+		return;
+
+	for (i = 0; i < PON_ASYNC_MAX_PENDING; i++) {
+		if (ctx->async_req[i].state != PON_ASYNC_PENDING)
+			continue;
+		ctx->async_req[i].cb_data.err = err;
+		pon_async_complete(ctx, &ctx->async_req[i]);
+	}
+}
+
+/*
+ * Netlink callback handler which skips all messages which do not belong to
+ * an outstanding asynchronous request.
+ */
+static int pon_async_seq_check(struct nl_msg *msg, void *arg)
+{
+	struct pon_ctx *ctx = arg;
+	struct nlmsghdr *nlh;
+
+	nlh = nlmsg_hdr(msg);
+	if (!nlh || !pon_async_find(ctx, nlh->nlmsg_seq))
+		return NL_SKIP;
+
+	return NL_OK;
+}
+
+/*
+ * Netlink callback handler for error messages belonging to an asynchronous
+ * request, the error message contains the header of the original request.
+ */
+static int pon_async_error_handler(struct sockaddr_nl *nla,
+				   struct nlmsgerr *nlerr, void *arg)
+{
+	struct pon_ctx *ctx = arg;
+	struct pon_async_req *req;
+
+	req = pon_async_find(ctx, nlerr->msg.nlmsg_seq);
+	if (!req)
+		return NL_SKIP;
+
+	cb_error_handler(nla, nlerr, &req->cb_data);
+	pon_async_complete(ctx, req);
+
+	return NL_OK;
+}
+
+/*
+ * Netlink callback handler for valid answers belonging to an asynchronous
+ * request. The answer is handled by the same code as the synchronous
+ * requests, but we continue with the next message in the buffer afterwards.
+ */
+static int pon_async_valid_handler(struct nl_msg *msg, void *arg)
+{
+	struct pon_ctx *ctx = arg;
+	struct pon_async_req *req;
+
+	req = pon_async_find(ctx, nlmsg_hdr(msg)->nlmsg_seq);
+	if (!req)
+		return NL_SKIP;
+
+	cb_valid_handler(msg, &req->cb_data);
+	pon_async_complete(ctx, req);
+
+	return NL_OK;
+}
+
+/*
+ * Get a free asynchronous request slot. The slot table and the callback set
+ * are created on first use. When all slots are in use this waits for the
+ * answers of the outstanding requests until one slot is available again.
+ */
+static enum fapi_pon_errorcode pon_async_slot_get(struct pon_ctx *ctx,
+						  struct pon_async_req **req)
+{
+	enum fapi_pon_errorcode err;
+	struct nl_cb *orig;
+	unsigned int i;
+
+	/* The answers are dispatched to the threads of a shared context */
+	if (ctx->mt)
+		return PON_STATUS_SUPPORT;
+
+	if (!ctx->async_req) {
+		ctx->async_req = calloc(PON_ASYNC_MAX_PENDING,
+					sizeof(*ctx->async_req));
+		if (!ctx->async_req)
+			return PON_STATUS_MEM_ERR;
+	}
+
+	if (!ctx->async_cb) {
+		orig = nl_socket_get_cb(ctx->nls);
+		ctx->async_cb = nl_cb_clone(orig);
+		nl_cb_put(orig);
+		if (!ctx->async_cb) {
+			PON_DEBUG_ERR("Can't allocate new callback struct");
+			return PON_STATUS_NL_ERR;
+		}
+
+		nl_cb_set(ctx->async_cb, NL_CB_SEQ_CHECK, NL_CB_CUSTOM,
+			  pon_async_seq_check, ctx);
+		nl_cb_err(ctx->async_cb, NL_CB_CUSTOM, pon_async_error_handler,
+			  ctx);
+		nl_cb_set(ctx->async_cb, NL_CB_VALID, NL_CB_CUSTOM,
+			  pon_async_valid_handler, ctx);
+		pon_recv_ow_set(ctx, ctx->async_cb);
+	}
+
+	for (;;) {
+		for (i = 0; i < PON_ASYNC_MAX_PENDING; i++) {
+			if (ctx->async_req[i].state == PON_ASYNC_FREE) {
+				*req = &ctx->async_req[i];
+				return PON_STATUS_OK;
+			}
+		}
+
+		/* All slots are occupied by results nobody collects */
+		if (!ctx->async_pending)
+			return PON_STATUS_RESOURCE_ERR;
+
+		err = fapi_pon_async_process(ctx);
+		if (err != PON_STATUS_OK && err != PON_STATUS_TIMEOUT)
+			return err;
+	}
+}
+
+/* Fill the request slot after the message was sent successfully. */
+static void pon_async_slot_fill(struct pon_ctx *ctx, struct pon_async_req *req,
+				uint32_t seq, const struct read_cmd_cb *cb_data,
+				fapi_pon_async_done done, void *done_priv,
+				uint32_t *handle)
+{
+	req->cb_data = *cb_data;
+	req->cb_data.running = 1;
+	req->seq = seq;
+	req->done = done;
+	req->done_priv = done_priv;
+	req->state = PON_ASYNC_PENDING;
+	ctx->async_pending++;
+
+	if (handle)
+		*handle = seq;
+}
+
+/*
+ * This sends a NetLink message to the mbox driver without waiting for the
+ * answer. The answer is matched by its sequence number when it is received
+ * by fapi_pon_async_process().
+ */
+static enum fapi_pon_errorcode
+fapi_pon_async_send_msg(struct pon_ctx *ctx, uint32_t read, uint32_t command,
+			const void *in_buf, size_t in_size, fapi_pon_copy copy,
+			fapi_pon_error error_cb, void *copy_priv,
+			uint8_t msg_type, fapi_pon_async_done done,
+			void *done_priv, uint32_t *handle)
+{
+	uint32_t seq = NL_AUTO_SEQ;
+	enum fapi_pon_errorcode err;
+	struct pon_async_req *req;
+	struct read_cmd_cb cb_data = {
+		.running = 1,
+		.copy = copy,
+		.error_cb = error_cb,
+		.priv = copy_priv,
+		.ctx = ctx,
+	};
+
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	pon_cfg_tx_check(ctx, read, command, in_buf, in_size, false);
+
+	err = pon_async_slot_get(ctx, &req);
+	if (err != PON_STATUS_OK)
+		return err;
+
+	err = fapi_pon_send_msg_int(ctx, &seq, read, command, PONFW_CMD,
+				    in_buf, in_size, msg_type, 0);
+	if (err != PON_STATUS_OK)
+		return err;
+
+	pon_async_slot_fill(ctx, req, seq, &cb_data, done, done_priv, handle);
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_async_generic_error_get(struct pon_ctx *ctx,
+				 uint32_t command,
+				 const void *in_buf,
+				 size_t in_size,
+				 fapi_pon_copy copy,
+				 fapi_pon_error error_cb,
+				 void *copy_priv,
+				 uint8_t msg_type,
+				 fapi_pon_async_done done,
+				 void *done_priv,
+				 uint32_t *handle)
+{
+	return fapi_pon_async_send_msg(ctx, PONFW_READ, command, in_buf,
+				       in_size, copy, error_cb, copy_priv,
+				       msg_type, done, done_priv, handle);
+}
+
+enum fapi_pon_errorcode
+fapi_pon_async_generic_error_set(struct pon_ctx *ctx,
+				 uint32_t command,
+				 const void *param,
+				 uint32_t sizeof_param,
+				 fapi_pon_error error_cb,
+				 void *copy_priv,
+				 uint8_t msg_type,
+				 fapi_pon_async_done done,
+				 void *done_priv,
+				 uint32_t *handle)
+{
+	return fapi_pon_async_send_msg(ctx, PONFW_WRITE, command, param,
+				       sizeof_param, NULL, error_cb, copy_priv,
+				       msg_type, done, done_priv, handle);
+}
+
+enum fapi_pon_errorcode fapi_pon_async_nl_msg_send(struct pon_ctx *ctx,
+						   struct nl_msg **msg,
+						   struct read_cmd_cb *cb_data,
+						   fapi_pon_async_done done,
+						   void *done_priv,
+						   uint32_t *handle)
+{
+	enum fapi_pon_errorcode err;
+	struct pon_async_req *req;
+	struct nlmsghdr *nlh;
+	uint32_t seq = NL_AUTO_SEQ;
+	int ret;
+
+	if (!ctx || !cb_data) {
+		nlmsg_free(*msg);
+		return PON_STATUS_INPUT_ERR;
+	}
+
+	err = pon_async_slot_get(ctx, &req);
+	if (err != PON_STATUS_OK) {
+		nlmsg_free(*msg);
+		return err;
+	}
+
+	ret = nl_send_auto_complete(ctx->nls, *msg);
+	if (ret < 0) {
+		PON_DEBUG_ERR("Can't send netlink message: %i", ret);
+		nlmsg_free(*msg);
+		return PON_STATUS_NL_ERR;
+	}
+
+	nlh = nlmsg_hdr(*msg);
+	if (nlh)
+		seq = nlh->nlmsg_seq;
+
+	nlmsg_free(*msg);
+
+	pon_async_slot_fill(ctx, req, seq, cb_data, done, done_priv, handle);
+
+	return PON_STATUS_OK;
+}
+
+void fapi_pon_async_result_store(struct pon_ctx *ctx, uint32_t handle,
+				 enum fapi_pon_errorcode err, void *priv)
+{
+	enum fapi_pon_errorcode *result = priv;
+
+	UNUSED(ctx);
+	UNUSED(handle);
+
+	*result = err;
+}
+
+enum fapi_pon_errorcode fapi_pon_async_fd_get(struct pon_ctx *ctx, int *fd)
+{
+	if (!ctx || !fd)
+		return PON_STATUS_INPUT_ERR;
+
+	if (ctx->mt)
+		return PON_STATUS_SUPPORT;
 
-	return (*cb_data).err;
+	if (ctx->lb)
+		*fd = pon_lb_fd_get(ctx->lb);
+	else
+		*fd = nl_socket_get_fd(ctx->nls);
+	if (*fd < 0)
+		return PON_STATUS_NL_ERR;
+
+	return PON_STATUS_OK;
 }
 
 /*
- * This sends a NetLink message to the mbox driver and waits for the answer.
- * \ref fapi_pon_send_msg_int is used to create the message and send it. This
- * function also registers all the callback handlers needed to handle the
- * answer. If no pon_ctx is given this function will create a context on its
- * own and deletes it again after using it.
+ * Receive answers to asynchronous requests with the given timeout. In
+ * non-blocking mode the outstanding requests are kept if nothing was
+ * received.
  */
-static enum fapi_pon_errorcode fapi_pon_send_msg(struct pon_ctx *ctx,
-				     uint32_t read, uint32_t command,
-				     uint32_t ack, const void *in_buf,
-				     size_t in_size, fapi_pon_copy copy,
-				     fapi_pon_error error_cb,
-				     void *copy_priv, uint8_t msg_type)
+static enum fapi_pon_errorcode pon_async_recv(struct pon_ctx *ctx,
+					      uint32_t timeout_ms)
 {
-	int ret;
-	uint32_t seq = NL_AUTO_SEQ;
 	enum fapi_pon_errorcode err;
-	struct nl_cb *cb;
-	struct nl_cb *orig;
-	struct read_cmd_cb cb_data = {
-		.running = 1,
-		.copy = copy,
-		.error_cb = error_cb,
-		.priv = copy_priv,
-		.ctx = ctx,
-	};
+	int ret;
 
-	if (!ctx)
-		return PON_STATUS_INPUT_ERR;
+	if (!ctx->async_pending)
+		return PON_STATUS_OK;
 
-	err = fapi_pon_send_msg_int(ctx->nls, ctx->family, &seq, read, command,
-				    ack, in_buf, in_size, msg_type, 0);
+	err = pon_sock_timeout_apply(ctx, timeout_ms);
 	if (err != PON_STATUS_OK)
 		return err;
 
-	orig = nl_socket_get_cb(ctx->nls);
-	cb = nl_cb_clone(orig);
-	nl_cb_put(orig);
-	if (!cb) {
-		PON_DEBUG_ERR("Can't allocate new callback struct");
-		return PON_STATUS_NL_ERR;
+	ret = nl_recvmsgs(ctx->nls, ctx->async_cb);
+	if (ret) {
+		if (timeout_ms == PON_TIMEOUT_NONBLOCK)
+			return PON_STATUS_OK_NO_RESPONSE;
+		pon_async_fail_all(ctx, PON_STATUS_TIMEOUT);
+		return PON_STATUS_TIMEOUT;
 	}
 
-	nl_cb_set(cb, NL_CB_SEQ_CHECK, NL_CB_CUSTOM, pon_seq_check, &seq);
-	nl_cb_err(cb, NL_CB_CUSTOM, cb_error_handler, &cb_data);
-	nl_cb_set(cb, NL_CB_VALID, NL_CB_CUSTOM, cb_valid_handler, &cb_data);
+	return PON_STATUS_OK;
+}
 
-	/*
-	 * Overwrite the nl_recv() function. This functions returns 0 in case
-	 * of an error and the return value is forward in the next functions.
-	 * To get to know if everything is fine or if we ran into an error
-	 * return a negative value in case of an error instead. An error is
-	 * for example the timeout of 2 seconds was reached.
-	 */
-	nl_cb_overwrite_recv(cb, fapi_pon_nl_ow_recv);
+enum fapi_pon_errorcode fapi_pon_async_process(struct pon_ctx *ctx)
+{
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
 
-	while (cb_data.running == 1) {
-		ret = nl_recvmsgs(ctx->nls, cb);
-		if (ret) {
-			cb_data.err = PON_STATUS_TIMEOUT;
+	if (ctx->timeout == PON_TIMEOUT_NONBLOCK)
+		return pon_async_recv(ctx, PON_TIMEOUT_NONBLOCK);
+
+	return pon_async_recv(ctx, pon_timeout_get(ctx));
+}
+
+enum fapi_pon_errorcode fapi_pon_async_wait(struct pon_ctx *ctx,
+					    uint32_t handle,
+					    enum fapi_pon_errorcode *result)
+{
+	struct pon_async_req *req = NULL;
+	enum fapi_pon_errorcode err;
+	unsigned int i;
+
+	if (!ctx || !result || !ctx->async_req)
+		return PON_STATUS_INPUT_ERR;
+
+	for (i = 0; i < PON_ASYNC_MAX_PENDING; i++) {
+		if (ctx->async_req[i].state != PON_ASYNC_FREE &&
+		    ctx->async_req[i].seq == handle &&
+		    !ctx->async_req[i].done) {
+			req = &ctx->async_req[i];
 			break;
 		}
 	}
 
-	nl_cb_put(cb);
-	return cb_data.err;
+	if (!req)
+		return PON_STATUS_INPUT_ERR;
+
+	/* A timeout also completes the request, any other error leaves it
+	 * pending and has to be reported as nothing more can be received.
+	 */
+	while (req->state == PON_ASYNC_PENDING) {
+		err = pon_async_recv(ctx, pon_timeout_get(ctx));
+		if (err != PON_STATUS_OK && err != PON_STATUS_TIMEOUT)
+			return err;
+	}
+
+	*result = req->cb_data.err;
+	req->state = PON_ASYNC_FREE;
+
+	return PON_STATUS_OK;
 }
 
-/*
- * This sends an answer to a previous NetLink message. This is used to send
- * an ACK or NACK to an event received from the firmware.
- */
-enum fapi_pon_errorcode
-fapi_pon_send_msg_answer(struct pon_ctx *ctx, struct nl_msg *msg,
-			 struct nlattr **attrs, uint32_t ack, void *buf,
-			 size_t size, uint8_t msg_type)
+enum fapi_pon_errorcode fapi_pon_async_wait_all(struct pon_ctx *ctx)
 {
-	struct nlmsghdr *hdr = nlmsg_hdr(msg);
-	uint16_t command;
-	uint8_t read;
-	uint32_t flags = 0;
+	enum fapi_pon_errorcode err = PON_STATUS_OK;
 
-	command = nla_get_u16(attrs[PON_MBOX_A_COMMAND]);
-	read = nla_get_u8(attrs[PON_MBOX_A_READ_WRITE]);
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
 
-	if (attrs[PON_MBOX_A_FLAGS])
-		flags = nla_get_u32(attrs[PON_MBOX_A_FLAGS]);
+	while (ctx->async_pending) {
+		err = pon_async_recv(ctx, pon_timeout_get(ctx));
+		if (err != PON_STATUS_OK)
+			break;
+	}
 
-	/*
-	 * Send it on normal socket and not the multicast socket. In case
-	 * there is a problem the answer would be revived by the event handler
-	 * which does not handle them, send them to the normal socket which
-	 * will ignore it. The normal netlink socket should ignores the
-	 * answers as it ignores all messages with unexpected sequence numbers.
-	 */
-	return fapi_pon_send_msg_int(ctx->nls, ctx->family,
-				     &hdr->nlmsg_seq, read, command, ack,
-				     buf, size, msg_type, flags);
+	return err;
 }
 
-#if defined(INCLUDE_DEBUG_SUPPORT)
-uint32_t pon_debug_print(const enum pon_debug_level level,
-			 const char *format, ...)
+enum fapi_pon_errorcode fapi_pon_async_cancel(struct pon_ctx *ctx,
+					      uint32_t handle)
 {
-	uint32_t ret = 0;
-	va_list ap;
+	struct pon_async_req *req;
+	unsigned int i;
 
-	if ((level < PON_DBG_OFF) && (level >= pon_dbg_lvl)) {
-		va_start(ap, format);
-		ret = vprintf(format, ap);
-		if (ret > 0)
-			ret = printf(PON_CRLF);
-		va_end(ap);
+	if (!ctx || !ctx->async_req)
+		return PON_STATUS_INPUT_ERR;
+
+	for (i = 0; i < PON_ASYNC_MAX_PENDING; i++) {
+		req = &ctx->async_req[i];
+		if (req->state == PON_ASYNC_FREE || req->seq != handle)
+			continue;
+
+		/* A late answer is skipped as no request matches any more */
+		if (req->state == PON_ASYNC_PENDING)
+			ctx->async_pending--;
+		req->state = PON_ASYNC_FREE;
+		return PON_STATUS_OK;
 	}
-	return ret;
+
+	return PON_STATUS_INPUT_ERR;
 }
-#endif
 
-enum fapi_pon_errorcode fapi_pon_generic_error_get(struct pon_ctx *ctx,
-						   uint32_t command,
-						   const void *in_buf,
-						   size_t in_size,
-						   fapi_pon_copy copy,
-						   fapi_pon_error error_cb,
-						   void *copy_priv,
-						   uint8_t msg_type)
+enum fapi_pon_errorcode fapi_pon_timeout_set(struct pon_ctx *ctx,
+					     uint32_t timeout_ms)
 {
-	return fapi_pon_send_msg(ctx, PONFW_READ, command, PONFW_CMD, in_buf,
-				 in_size, copy, error_cb, copy_priv, msg_type);
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	ctx->timeout = timeout_ms;
+
+	return PON_STATUS_OK;
 }
 
-enum fapi_pon_errorcode fapi_pon_generic_error_set(struct pon_ctx *ctx,
-						   uint32_t command,
-						   const void *param,
-						   uint32_t sizeof_param,
-						   fapi_pon_error error_cb,
-						   void *copy_priv,
-						   uint8_t msg_type)
+enum fapi_pon_errorcode fapi_pon_timeout_get(struct pon_ctx *ctx,
+					     uint32_t *timeout_ms)
 {
-	return fapi_pon_send_msg(ctx, PONFW_WRITE, command, PONFW_CMD, param,
-				 sizeof_param, NULL, error_cb, copy_priv,
-				 msg_type);
+	if (!ctx || !timeout_ms)
+		return PON_STATUS_INPUT_ERR;
+
+	if (ctx->timeout == PON_TIMEOUT_NONBLOCK)
+		*timeout_ms = PON_TIMEOUT_NONBLOCK;
+	else
+		*timeout_ms = pon_timeout_get(ctx);
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_deadline_set(struct pon_ctx *ctx,
+					      uint32_t timeout_ms)
+{
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	/* 0 is used for "no deadline" */
+	return pon_deadline_store(ctx,
+				  pon_time_us() + (uint64_t)timeout_ms * 1000 +
+				  1);
+}
+
+enum fapi_pon_errorcode fapi_pon_deadline_clear(struct pon_ctx *ctx)
+{
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	return pon_deadline_store(ctx, 0);
 }
 
 /*
@@ -658,10 +2274,13 @@ static int fapi_pon_listener_rec(struct nl_msg *msg, void *arg)
 			return -EINVAL;
 
 		command = nla_get_u16(attrs[PON_MBOX_A_COMMAND]);
+		ctx->event_stats.events++;
 		fapi_pon_listener_msg(command, ctx, msg, attrs);
 		break;
 	case PON_MBOX_C_RESET:
 		PON_DEBUG_ERR("mailbox reset was requested");
+		/* The firmware is restarted with its default configuration */
+		pon_cfg_snap_invalidate();
 		break;
 	case PON_MBOX_C_FW_INIT_COMPLETE:
 		fapi_pon_fw_init_complete_msg(ctx, msg, attrs);
@@ -683,18 +2302,15 @@ static int fapi_pon_listener_rec(struct nl_msg *msg, void *arg)
 static int fapi_pon_listener_recv(struct nl_sock *sk, struct sockaddr_nl *nla,
 				  unsigned char **buf, struct ucred **creds)
 {
-	fd_set rfds;
+	struct pollfd pfd = { .events = POLLIN };
 	int ret;
-	int s_fd = nl_socket_get_fd(sk);
 
-	if (s_fd < 0)
+	pfd.fd = nl_socket_get_fd(sk);
+	if (pfd.fd < 0)
 		return -NLE_BAD_SOCK;
 
-	FD_ZERO(&rfds);
-	FD_SET(s_fd, &rfds);
-
-	ret = select(s_fd + 1, &rfds, NULL, NULL, NULL);
-	if (ret  == -1)
+	ret = poll(&pfd, 1, -1);
+	if (ret == -1)
 		return nl_syserr2nlerr(errno);
 	if (ret == 0)
 		return -NLE_INTR;
@@ -711,6 +2327,7 @@ enum fapi_pon_errorcode fapi_pon_listener_connect(struct pon_ctx *ctx,
 	struct nl_cb *s_cb;
 
 	ctx->priv = priv;
+	memset(&ctx->event_stats, 0, sizeof(ctx->event_stats));
 
 	ctx->nls_event = nl_socket_alloc();
 	if (!ctx->nls_event) {
@@ -718,11 +2335,21 @@ enum fapi_pon_errorcode fapi_pon_listener_connect(struct pon_ctx *ctx,
 		return PON_STATUS_NL_ERR;
 	}
 
-	ret = genl_connect(ctx->nls_event);
-	if (ret) {
-		PON_DEBUG_ERR("can not connect to netlink socket: %i", ret);
-		err = PON_STATUS_NL_ERR;
-		goto out_nl_socket_free;
+	if (!ctx->lb) {
+		ret = genl_connect(ctx->nls_event);
+		if (ret) {
+			PON_DEBUG_ERR("can not connect to netlink socket: %i",
+				      ret);
+			err = PON_STATUS_NL_ERR;
+			goto out_nl_socket_free;
+		}
+
+		/* Keep bursts of events, for example during a LOS storm */
+		ret = nl_socket_set_buffer_size(ctx->nls_event,
+						PON_EVENT_SOCK_BUF, 0);
+		if (ret)
+			PON_DEBUG_WRN("can not set event socket buffer: %i",
+				      ret);
 	}
 
 	nl_socket_disable_seq_check(ctx->nls_event);
@@ -735,6 +2362,13 @@ enum fapi_pon_errorcode fapi_pon_listener_connect(struct pon_ctx *ctx,
 		goto out_nl_socket_free;
 	}
 
+	if (ctx->lb) {
+		err = pon_lb_listener_attach(ctx);
+		if (err != PON_STATUS_OK)
+			goto out_nl_socket_free;
+		return PON_STATUS_OK;
+	}
+
 	msg_grp = genl_ctrl_resolve_grp(ctx->nls_event, PON_MBOX_FAMILY, "msg");
 	if (msg_grp < 0) {
 		PON_DEBUG_ERR("cannot find netlink group: %i", msg_grp);
@@ -761,13 +2395,11 @@ out_nl_socket_free:
 	return err;
 }
 
-enum fapi_pon_errorcode fapi_pon_listener_run(struct pon_ctx *ctx)
+/* Receive and handle one message from the event socket */
+static enum fapi_pon_errorcode pon_listener_recv_one(struct pon_ctx *ctx)
 {
 	int ret;
 
-	if (!ctx)
-		return PON_STATUS_INPUT_ERR;
-
 	ret = nl_recvmsgs_default(ctx->nls_event);
 	if (ret == -NLE_INTR)
 		return PON_STATUS_OK;
@@ -778,10 +2410,12 @@ enum fapi_pon_errorcode fapi_pon_listener_run(struct pon_ctx *ctx)
 		 * NetLink messages the kernel will return an -ENOBUFS in the
 		 * recvmsg syscall, libnl translates this to -NLE_NOMEM. This
 		 * behavior is also described in the NetLink man page. We will
-		 * ignore this error and will let the calling application just
-		 * try it again.
+		 * not fail here but read back the state which could have been
+		 * changed by the lost events and report it again.
 		 */
 		PON_DEBUG_WRN("NetLink ENOMEM, some FW events are lost");
+		ctx->event_stats.overflows++;
+		pon_listener_resync(ctx);
 		return PON_STATUS_OK;
 	}
 	if (ret < 0) {
@@ -792,19 +2426,115 @@ enum fapi_pon_errorcode fapi_pon_listener_run(struct pon_ctx *ctx)
 	return PON_STATUS_OK;
 }
 
+enum fapi_pon_errorcode fapi_pon_listener_run(struct pon_ctx *ctx)
+{
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	return pon_listener_recv_one(ctx);
+}
+
+/* Get the file descriptor signaling pending events */
+static int pon_listener_fd(struct pon_ctx *ctx)
+{
+	if (ctx->lb_event)
+		return pon_lb_fd_get(ctx->lb_event);
+
+	return nl_socket_get_fd(ctx->nls_event);
+}
+
+/*
+ * Check without blocking if an event is pending. Returns 1 if an event can
+ * be received, 0 if not and a negative value in case of error.
+ */
+static int pon_listener_pending(struct pon_ctx *ctx)
+{
+	struct pollfd pfd = { .events = POLLIN };
+	int ret;
+
+	pfd.fd = pon_listener_fd(ctx);
+	if (pfd.fd < 0)
+		return -1;
+
+	ret = poll(&pfd, 1, 0);
+	if (ret == -1)
+		return errno == EINTR ? 0 : -1;
+
+	return ret > 0;
+}
+
+enum fapi_pon_errorcode fapi_pon_listener_fd_get(struct pon_ctx *ctx, int *fd)
+{
+	if (!ctx || !fd || !ctx->nls_event)
+		return PON_STATUS_INPUT_ERR;
+
+	*fd = pon_listener_fd(ctx);
+	if (*fd < 0)
+		return PON_STATUS_NL_ERR;
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_listener_dispatch(struct pon_ctx *ctx,
+						   uint32_t max,
+						   uint32_t *num)
+{
+	enum fapi_pon_errorcode err = PON_STATUS_OK;
+	uint32_t cnt = 0;
+	int ret;
+
+	if (!ctx || !ctx->nls_event)
+		return PON_STATUS_INPUT_ERR;
+
+	while (!max || cnt < max) {
+		ret = pon_listener_pending(ctx);
+		if (ret < 0) {
+			err = PON_STATUS_NL_ERR;
+			break;
+		}
+		if (!ret)
+			break;
+
+		err = pon_listener_recv_one(ctx);
+		if (err != PON_STATUS_OK)
+			break;
+		cnt++;
+	}
+
+	if (num)
+		*num = cnt;
+
+	return err;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_listener_stats_get(struct pon_ctx *ctx,
+			    struct pon_listener_stats *stats)
+{
+	if (!ctx || !stats || !ctx->nls_event)
+		return PON_STATUS_INPUT_ERR;
+
+	*stats = ctx->event_stats;
+
+	return PON_STATUS_OK;
+}
+
 enum fapi_pon_errorcode fapi_pon_msg_prepare(struct pon_ctx **ctx,
 					     struct nl_msg **msg,
 					     uint8_t cmd)
 {
 	void *nl_hdr;
 
-	*msg = nlmsg_alloc();
+	/* Direct driver messages are sent after the recorded requests */
+	pon_cfg_tx_sync(*ctx);
+
+	*msg = pon_req_msg_get(*ctx);
 	if (!(*msg)) {
 		PON_DEBUG_ERR("Can't alloc netlink message");
 		return PON_STATUS_NL_ERR;
 	}
 
-	nl_hdr = genlmsg_put(*msg, 0, NL_AUTO_SEQ, (*ctx)->family, 0, 0,
+	nl_hdr = genlmsg_put(*msg, 0, pon_req_seq(*ctx), (*ctx)->family, 0, 0,
 			     cmd, 0);
 	if (!nl_hdr) {
 		PON_DEBUG_ERR("Can't generate message");
@@ -828,6 +2558,11 @@ enum fapi_pon_errorcode fapi_pon_reset(struct pon_ctx *ctx, enum pon_mode mode)
 	if (err != PON_STATUS_OK)
 		return err;
 
+	/* The firmware is reloaded with its default configuration */
+	pon_cfg_snap_invalidate();
+	pon_fw_info_invalidate();
+	pon_alarm_level_invalidate();
+
 	if (mode != PON_MODE_UNKNOWN) {
 		ret = nla_put_u8(msg, PON_MBOX_A_MODE, mode);
 		if (ret) {
@@ -892,6 +2627,8 @@ enum fapi_pon_errorcode fapi_pon_eeprom_open(struct pon_ctx *ctx,
 		pon_close(ctx->eeprom_fd[ddmi_page]);
 		ctx->eeprom_fd[ddmi_page] = -1;
 	}
+	if (ddmi_page == PON_DDMI_A2)
+		pon_dmi_cache_invalidate(ctx);
 
 #ifdef HAVE_SOPEN_S
 	_sopen_s(&ctx->eeprom_fd[ddmi_page], filename, PON_RDONLY, 0, 0);
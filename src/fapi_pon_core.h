@@ -25,7 +25,6 @@
 #include <stdbool.h>
 #ifdef LINUX
 #  include <sys/socket.h>
-#  include <sys/select.h>
 #  include <errno.h>
 #endif /* LINUX */
 #ifdef WIN32
@@ -38,6 +37,15 @@
 
 #define UNUSED(x) (void)(x)
 
+struct pon_gem_cache;
+struct pon_mt;
+struct pon_cmd_stats_entry;
+struct pon_lb;
+struct pon_ploam_cap;
+struct pon_event_defer;
+struct pon_cfg_tx;
+struct pon_shm_export;
+
 /** \addtogroup PON_FAPI_REFERENCE
  *   @{
  */
@@ -80,6 +88,30 @@ struct pon_dbg_level {
 	enum pon_debug_level level;
 };
 
+/** Number of buckets of a latency histogram, bucket n counts the round-trip
+ *  times from 2^n to 2^(n+1) - 1 microseconds, the last bucket also counts
+ *  all longer ones.
+ */
+#define PON_LAT_BUCKETS PON_CMD_STATS_LAT_BUCKETS
+/** Number of samples after which the adaptive timeout history is halved */
+#define PON_LAT_WINDOW 1024
+/** Minimum number of samples before the adaptive timeout is used */
+#define PON_LAT_MIN_SAMPLES 32
+/** Lower limit of the adaptive timeout in milliseconds */
+#define PON_TIMEOUT_MIN 20
+/** Receive buffer size of the event socket in bytes, limited by the kernel
+ *  to net.core.rmem_max.
+ */
+#define PON_EVENT_SOCK_BUF (1024 * 1024)
+
+/** Histogram of request round-trip times */
+struct pon_lat_hist {
+	/** Number of samples per bucket */
+	volatile uint32_t bucket[PON_LAT_BUCKETS];
+	/** Number of samples in all buckets */
+	volatile uint32_t count;
+};
+
 /** PON library handle structure.
  *  Used by \ref fapi_pon_open and \ref fapi_pon_close.
  */
@@ -128,32 +160,58 @@ struct pon_ctx {
 	fapi_pon_onu_auth_res_tbl onu_auth_res_tbl;
 	/** Callback handler for unlink all request */
 	fapi_pon_unlink_all unlink_all;
+	/** Callback handler called after a resync of the event state */
+	fapi_pon_resync resync;
+	/** Event listener statistics */
+	struct pon_listener_stats event_stats;
 	/** File descriptor to EEPROM data. */
 	int eeprom_fd[PON_DDMI_MAX];
-	/** Cache for FW capabilities information */
-	struct pon_cap caps_data;
-	/** Set to 1 if cached capabilities value is valid */
-	int caps_valid;
-	/** Cache for FW version information */
-	struct pon_version ver_data;
-	/** Set to 1 if cached version value is valid */
-	int ver_valid;
-	/** Cache for GEM port and allocation limits */
-	struct pon_range_limits limits_data;
-	/** Set to 1 if cached limits values are valid */
-	int limits_valid;
-	/** Cache for PON mode information */
-	enum pon_mode mode;
-	/** Set to 1 if cached PON mode value is valid */
-	int mode_valid;
-	/** Platform type as established by a PONIP FW FW_VERSION msg. readout,
-	 *  if yet 0 it is invalid
-	 */
-	int actual_plat_type;
 	/** Cache for optic external calibration type */
 	bool ext_calibrated;
 	/** Set to 1 if optic external calibration type value is valid */
 	int ext_cal_valid;
+	/** Cached optical DMI status */
+	struct pon_dmi_cache *dmi_cache;
+	/** Table of asynchronous requests, allocated on first use */
+	struct pon_async_req *async_req;
+	/** Number of asynchronous requests waiting for an answer */
+	unsigned int async_pending;
+	/** Netlink callback set used to receive asynchronous answers */
+	struct nl_cb *async_cb;
+	/** GEM port ID to GEM port index cache, allocated on first use */
+	struct pon_gem_cache *gem_cache;
+	/** Netlink message reused for all requests of this context */
+	struct nl_msg *req_msg;
+	/** Netlink callback set used to receive synchronous answers */
+	struct nl_cb *req_cb;
+	/** Set to 1 while req_cb is used to wait for an answer */
+	int req_cb_busy;
+	/** Request dispatcher, only set for contexts shared by threads */
+	struct pon_mt *mt;
+	/** Request timeout in ms as set by fapi_pon_timeout_set() */
+	uint32_t timeout;
+	/** Receive timeout in ms currently configured on the socket */
+	uint32_t sock_timeout;
+	/** Deadline set by fapi_pon_deadline_set() in us, 0 if not set */
+	uint64_t deadline;
+	/** Round-trip times used for the adaptive timeout */
+	struct pon_lat_hist lat;
+	/** Request statistics per firmware command, allocated on first use */
+	struct pon_cmd_stats_entry *stats;
+	/** Loopback backend replacing the socket, NULL for pon_mbox */
+	struct pon_lb *lb;
+	/** Loopback backend replacing the event socket */
+	struct pon_lb *lb_event;
+	/** PLOAM log capture, NULL if not running */
+	struct pon_ploam_cap *ploam_cap;
+	/** Workers executing the deferred event callbacks, NULL if the
+	 *  callbacks are executed by the listener
+	 */
+	struct pon_event_defer *defer;
+	/** Open configuration transaction, NULL if none */
+	struct pon_cfg_tx *cfg_tx;
+	/** Shared memory counter export, NULL if not running */
+	struct pon_shm_export *shm_export;
 };
 
 /* PON FAPI function definitions */
@@ -348,6 +406,14 @@ enum fapi_pon_errorcode
 void fapi_pon_listener_msg(uint16_t command, struct pon_ctx *ctx,
 			   struct nl_msg *msg, struct nlattr **attrs);
 
+/**
+ *	Reads back the alarm, PLOAM and TWDM state after events were lost and
+ *	reports it through the registered event callbacks.
+ *
+ *	\param[in] ctx Handler containing information about the current state
+ */
+void pon_listener_resync(struct pon_ctx *ctx);
+
 /**
  *	Receives the "firmware initialization complete" message from the
  *	mailbox driver.
@@ -412,8 +478,112 @@ struct read_cmd_cb {
 	 *  decode and the error_cb function
 	 */
 	void *priv;
+	/** Set to 1 if the firmware answered with a NACK */
+	int nack;
+	/** Payload length of the answer in bytes */
+	uint32_t rx_len;
+};
+
+/** States of an asynchronous request slot */
+enum pon_async_state {
+	/** The slot is not used. */
+	PON_ASYNC_FREE = 0,
+	/** The request was sent, the answer was not received yet. */
+	PON_ASYNC_PENDING = 1,
+	/** The answer was received, the result was not collected yet. */
+	PON_ASYNC_DONE = 2
+};
+
+/** This structure holds one asynchronous request, identified by the Netlink
+ *  sequence number of the request message.
+ */
+struct pon_async_req {
+	/** Slot state */
+	enum pon_async_state state;
+	/** Netlink sequence number of the request, used as handle */
+	uint32_t seq;
+	/** Data given to the Netlink callback handlers */
+	struct read_cmd_cb cb_data;
+	/** Completion callback, if NULL the result is kept until it is
+	 *  collected by \ref fapi_pon_async_wait.
+	 */
+	fapi_pon_async_done done;
+	/** Private data given to the completion callback */
+	void *done_priv;
 };
 
+/**
+ *	Sends a read request to the firmware without waiting for the answer.
+ *	The answer is handled by \ref fapi_pon_async_process.
+ *
+ *	\param[in] ctx PON FAPI context created by \ref fapi_pon_open.
+ *	\param[in] command Number representing used command.
+ *	\param[in] in_buf Pointer to a structure used to write information.
+ *	\param[in] in_size Number representing the size of the structure used to
+ *		write information.
+ *	\param[in] copy Callback function which converts the data from
+ *		the firmware format into the FAPI format.
+ *	\param[in] error_cb Callback function which gets called in case a
+ *		NACK is received from the firmware. Set this to NULL to use the
+ *		default handler.
+ *	\param[in] copy_priv Private data given to the copy callback function,
+ *		this has to stay valid until the request is completed.
+ *	\param[in] msg_type Type of Netlink message to send.
+ *	\param[in] done Completion callback, can be NULL.
+ *	\param[in] done_priv Private data given to the completion callback.
+ *	\param[out] handle Handle of the request, can be NULL.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode
+fapi_pon_async_generic_error_get(struct pon_ctx *ctx,
+				 uint32_t command,
+				 const void *in_buf,
+				 size_t in_size,
+				 fapi_pon_copy copy,
+				 fapi_pon_error error_cb,
+				 void *copy_priv,
+				 uint8_t msg_type,
+				 fapi_pon_async_done done,
+				 void *done_priv,
+				 uint32_t *handle);
+
+/**
+ *	Sends a write request to the firmware without waiting for the answer.
+ *	The answer is handled by \ref fapi_pon_async_process.
+ *
+ *	\param[in] ctx PON FAPI context created by \ref fapi_pon_open.
+ *	\param[in] command Number representing used command.
+ *	\param[in] param Pointer to a structure used to write information.
+ *	\param[in] sizeof_param Number representing the size of the structure
+ *		used to write information.
+ *	\param[in] error_cb Callback function which gets called in case a
+ *		NACK is received from the firmware. Set this to NULL to use the
+ *		default handler.
+ *	\param[in] copy_priv Private data given to the error callback function.
+ *	\param[in] msg_type Type of Netlink message to send.
+ *	\param[in] done Completion callback, can be NULL.
+ *	\param[in] done_priv Private data given to the completion callback.
+ *	\param[out] handle Handle of the request, can be NULL.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode
+fapi_pon_async_generic_error_set(struct pon_ctx *ctx,
+				 uint32_t command,
+				 const void *param,
+				 uint32_t sizeof_param,
+				 fapi_pon_error error_cb,
+				 void *copy_priv,
+				 uint8_t msg_type,
+				 fapi_pon_async_done done,
+				 void *done_priv,
+				 uint32_t *handle);
+
 /** Netlink message preparation */
 enum fapi_pon_errorcode fapi_pon_nl_msg_prepare(struct pon_ctx *ctx,
 						struct nl_msg **msg,
@@ -441,11 +611,398 @@ enum fapi_pon_errorcode fapi_pon_nl_msg_send(struct pon_ctx *ctx,
 					     struct read_cmd_cb *cb_data,
 					     uint32_t *seq);
 
+/**
+ *	Sends a Netlink message prepared by \ref fapi_pon_nl_msg_prepare or
+ *	\ref fapi_pon_nl_msg_prepare_decode without waiting for the answer.
+ *	The content of cb_data is copied, the message is freed.
+ *
+ *	\param[in] ctx PON FAPI context created by \ref fapi_pon_open.
+ *	\param[in] msg Prepared Netlink message
+ *	\param[in] cb_data Callback data filled by the prepare function
+ *	\param[in] done Completion callback, can be NULL.
+ *	\param[in] done_priv Private data given to the completion callback.
+ *	\param[out] handle Handle of the request, can be NULL.
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode fapi_pon_async_nl_msg_send(struct pon_ctx *ctx,
+						   struct nl_msg **msg,
+						   struct read_cmd_cb *cb_data,
+						   fapi_pon_async_done done,
+						   void *done_priv,
+						   uint32_t *handle);
+
+/**
+ *	Completion callback for asynchronous requests which stores the result
+ *	of the request in the enum fapi_pon_errorcode variable given as
+ *	private data.
+ *
+ *	\param[in] ctx PON FAPI context
+ *	\param[in] handle Handle of the completed request
+ *	\param[in] err Result of the request
+ *	\param[out] priv Pointer to an enum fapi_pon_errorcode variable
+ */
+void fapi_pon_async_result_store(struct pon_ctx *ctx, uint32_t handle,
+				 enum fapi_pon_errorcode err, void *priv);
+
 /** Message preparation */
 enum fapi_pon_errorcode fapi_pon_msg_prepare(struct pon_ctx **ctx,
 					     struct nl_msg **msg,
 					     uint8_t cmd);
 
+/**
+ *	Stores a PLOAM message log event in the capture ring buffer, if a
+ *	capture is running. This must only be called by the thread handling
+ *	the events of the context.
+ *
+ *	\param[in] ctx PON FAPI context
+ *	\param[in] hdr Record header, the time is set by this function
+ *	\param[in] msg Message contents of hdr->len bytes
+ */
+void pon_ploam_cap_put(struct pon_ctx *ctx,
+		       struct pon_ploam_cap_rec_hdr *hdr,
+		       const uint8_t *msg);
+
+/** Firmware write request sent by \ref pon_generic_set_batch */
+struct pon_set_req {
+	/** Firmware command ID */
+	uint32_t command;
+	/** Request payload */
+	const void *param;
+	/** Payload size in bytes */
+	uint32_t size;
+	/** Result of the request */
+	enum fapi_pon_errorcode err;
+};
+
+/**
+ *	Sends firmware write requests without waiting for the answers in
+ *	between and waits for all answers afterwards. The firmware handles
+ *	the requests in the given order. The result of each request is
+ *	stored in its err member.
+ *
+ *	\param[in] ctx PON library context
+ *	\param[in,out] req Requests
+ *	\param[in] num Number of requests
+ */
+void pon_generic_set_batch(struct pon_ctx *ctx, struct pon_set_req *req,
+			   unsigned int num);
+
+/** Batch of read requests whose answers are waited for together */
+struct pon_nl_batch;
+
+/**
+ *	Creates a batch of read requests. The requests are sent by
+ *	\ref pon_nl_batch_send or \ref pon_nl_batch_read without waiting for
+ *	the answers, \ref pon_nl_batch_finish waits for all answers. This works
+ *	on contexts shared by threads as well.
+ *
+ *	\param[in] ctx PON library context
+ *	\param[in] max Maximum number of requests
+ *
+ *	\return The batch or NULL if it can not be allocated.
+ */
+struct pon_nl_batch *pon_nl_batch_alloc(struct pon_ctx *ctx, unsigned int max);
+
+/**
+ *	Sends a Netlink message prepared by \ref fapi_pon_nl_msg_prepare or
+ *	\ref fapi_pon_nl_msg_prepare_decode as part of a batch. The message
+ *	is freed, the destination of the answer has to stay valid until
+ *	\ref pon_nl_batch_finish returns.
+ *
+ *	\param[in] batch Batch created by \ref pon_nl_batch_alloc
+ *	\param[in] msg Prepared Netlink message
+ *	\param[in] cb_data Callback data filled by the prepare function
+ *	\param[out] result Result of the request, set when the batch is
+ *		finished
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode pon_nl_batch_send(struct pon_nl_batch *batch,
+					  struct nl_msg **msg,
+					  struct read_cmd_cb *cb_data,
+					  enum fapi_pon_errorcode *result);
+
+/**
+ *	Sends a firmware read request as part of a batch.
+ *
+ *	\param[in] batch Batch created by \ref pon_nl_batch_alloc
+ *	\param[in] command Firmware command ID
+ *	\param[in] in_buf Request payload, can be NULL
+ *	\param[in] in_size Payload size in bytes
+ *	\param[in] copy Callback function which converts the answer
+ *	\param[in] copy_priv Destination given to the copy callback
+ *	\param[out] result Result of the request, set when the batch is
+ *		finished
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode pon_nl_batch_read(struct pon_nl_batch *batch,
+					  uint32_t command,
+					  const void *in_buf,
+					  size_t in_size,
+					  fapi_pon_copy copy,
+					  void *copy_priv,
+					  enum fapi_pon_errorcode *result);
+
+/**
+ *	Waits for the answers to all requests of a batch and frees it.
+ *
+ *	\param[in] batch Batch created by \ref pon_nl_batch_alloc
+ */
+void pon_nl_batch_finish(struct pon_nl_batch *batch);
+
+/**
+ *	Checks a firmware request against the configuration transaction of
+ *	the context. Write requests of the thread owning the transaction are
+ *	recorded, for other requests the recorded ones are sent first if
+ *	needed.
+ *
+ *	\param[in] ctx PON library context
+ *	\param[in] read PONFW_READ or PONFW_WRITE
+ *	\param[in] command Firmware command ID
+ *	\param[in] buf Request payload
+ *	\param[in] size Payload size in bytes
+ *	\param[in] recordable Set to false if the request can not be deferred
+ *
+ *	\return true if the request was recorded and must not be sent
+ */
+bool pon_cfg_tx_check(struct pon_ctx *ctx, uint32_t read, uint32_t command,
+		      const void *buf, size_t size, bool recordable);
+
+/**
+ *	Returns the result of the requests of the configuration transaction
+ *	which were sent so far. A recorded request is answered with it.
+ *
+ *	\param[in] ctx PON library context
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If no request failed or the calling thread does not
+ *	  own a transaction
+ *	- Other: The error code of the first failed request.
+ */
+enum fapi_pon_errorcode pon_cfg_tx_result(struct pon_ctx *ctx);
+
+/**
+ *	Sends the requests recorded by the configuration transaction of the
+ *	calling thread. This is called before a message to the mailbox driver
+ *	is prepared, so that messages which are not checked by
+ *	\ref pon_cfg_tx_check keep their order as well.
+ *
+ *	\param[in] ctx PON library context
+ */
+void pon_cfg_tx_sync(struct pon_ctx *ctx);
+
+/**
+ *	Drops the configuration snapshot used to skip unchanged requests of
+ *	a configuration transaction. This has to be called whenever the
+ *	firmware lost its configuration.
+ */
+void pon_cfg_snap_invalidate(void);
+
+/**
+ *	Ends the configuration transaction of a context without sending the
+ *	recorded requests.
+ *
+ *	\param[in] ctx PON library context
+ */
+void pon_cfg_tx_free(struct pon_ctx *ctx);
+
+/** Classes of events executed in order by the deferred event workers */
+enum pon_event_class {
+	/** Alarm report and clear */
+	PON_EVENT_CLASS_ALARM = 0,
+	/** SyncE status */
+	PON_EVENT_CLASS_SYNCE = 1,
+	/** ONU random challenge and authentication result tables */
+	PON_EVENT_CLASS_AUTH = 2,
+	/** TWDM configuration */
+	PON_EVENT_CLASS_TWDM = 3,
+	/** Number of event classes */
+	PON_EVENT_CLASS_NUM = 4
+};
+
+/**
+ *	Executes the callback of an event which does not need an answer to
+ *	the firmware.
+ *
+ *	\param[in] ctx PON library context
+ *	\param[in] command Firmware command ID of the event
+ *	\param[in] data Event data sent by the firmware
+ *	\param[in] len Length of the event data
+ */
+void pon_event_exec(struct pon_ctx *ctx, uint16_t command,
+		    const void *data, int len);
+
+/**
+ *	Queues an event to the worker executing the events of its class.
+ *
+ *	\param[in] defer Deferred event workers of the context
+ *	\param[in] cls Event class as defined by \ref pon_event_class
+ *	\param[in] command Firmware command ID of the event
+ *	\param[in] data Event data sent by the firmware, copied
+ *	\param[in] len Length of the event data
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error, the event has to be handled
+ *	  by the caller.
+ */
+enum fapi_pon_errorcode pon_event_defer(struct pon_event_defer *defer,
+					unsigned int cls, uint16_t command,
+					const void *data, int len);
+
+/** Maximum number of active static alarms read from the firmware */
+#define PON_ALARM_ACTIVE_MAX 64
+
+/** Static alarms which are active in the firmware */
+struct pon_alarm_active {
+	/** Number of active alarms */
+	unsigned int num;
+	/** Alarm IDs */
+	uint16_t id[PON_ALARM_ACTIVE_MAX];
+};
+
+/**
+ *	Reads the active static alarms from the firmware with one request and
+ *	updates the alarm states of the process.
+ *
+ *	\param[in] ctx PON library context
+ *	\param[out] active Active alarms
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode pon_alarm_active_read(struct pon_ctx *ctx,
+					      struct pon_alarm_active *active);
+
+/**
+ *	Updates the alarm state of the process on an alarm report or clear
+ *	event.
+ *
+ *	\param[in] alarm_id Alarm ID
+ *	\param[in] active True if the alarm was reported, false if cleared
+ */
+void pon_alarm_state_set(uint16_t alarm_id, bool active);
+
+/**
+ *	Marks the start of a read of the active alarms from the firmware.
+ *
+ *	\return Value to be given to \ref pon_alarm_level_sync
+ */
+uint32_t pon_alarm_level_sync_start(void);
+
+/**
+ *	Replaces the level alarm states of the process by the alarms read from
+ *	the firmware. Alarms changed by an event after the read was started
+ *	keep the state of the event.
+ *
+ *	\param[in] active Active alarms
+ *	\param[in] seq Value returned by \ref pon_alarm_level_sync_start
+ *		before the alarms were read
+ */
+void pon_alarm_level_sync(const struct pon_alarm_active *active, uint32_t seq);
+
+/**
+ *	Forces the level alarm states to be read from the firmware again, as
+ *	they may have been lost by a firmware reset.
+ */
+void pon_alarm_level_invalidate(void);
+
+/**
+ *	Checks if the level alarm states were read from the firmware.
+ *
+ *	\return True if \ref pon_alarm_level_sync was called before
+ */
+bool pon_alarm_level_synced(void);
+
+/**
+ *	Copies the alarm states of the process.
+ *
+ *	\param[out] snap Alarm states
+ *	\param[in] edge_clear Clear the edge alarms after copying them
+ */
+void pon_alarm_snapshot_read(struct pon_alarm_snapshot *snap, bool edge_clear);
+
+/**
+ *	Invalidates the GEM port caches of all contexts of the process. This
+ *	has to be called whenever the GEM port configuration of the firmware
+ *	might have changed.
+ */
+void pon_gem_cache_invalidate(void);
+
+/**
+ *	Invalidates the firmware capabilities, version, limits and mode cached
+ *	for all contexts of the process. This has to be called whenever the
+ *	firmware is reloaded.
+ */
+void pon_fw_info_invalidate(void);
+
+/**
+ *	Returns the raw counter groups of a counter snapshot which can be read
+ *	in the current PON mode.
+ *
+ *	\param[in] ctx PON FAPI context
+ *
+ *	\return Bit mask of the groups, see PON_CNT_SNAP_*
+ */
+uint32_t pon_cnt_snapshot_groups(struct pon_ctx *ctx);
+
+/**
+ *	Frees the GEM port cache of a context.
+ *
+ *	\param[in] ctx PON FAPI context
+ */
+void pon_gem_cache_free(struct pon_ctx *ctx);
+
+/**
+ *	Allocates the optical DMI status cache of a context.
+ *
+ *	\param[in] ctx PON FAPI context
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode pon_dmi_cache_init(struct pon_ctx *ctx);
+
+/**
+ *	Marks the cached optical DMI status of a context as outdated.
+ *
+ *	\param[in] ctx PON FAPI context
+ */
+void pon_dmi_cache_invalidate(struct pon_ctx *ctx);
+
+/**
+ *	Frees the optical DMI status cache of a context.
+ *
+ *	\param[in] ctx PON FAPI context
+ */
+void pon_dmi_cache_free(struct pon_ctx *ctx);
+
+/**
+ *	Locks the data of a context which is shared by multiple threads.
+ *	Does nothing for a context which was not opened by
+ *	\ref fapi_pon_open_mt.
+ *
+ *	\param[in] ctx PON FAPI context
+ */
+void pon_ctx_lock(struct pon_ctx *ctx);
+
+/**
+ *	Unlocks the data of a context locked by \ref pon_ctx_lock.
+ *
+ *	\param[in] ctx PON FAPI context
+ */
+void pon_ctx_unlock(struct pon_ctx *ctx);
+
 /**
  * \brief Get clock cycle from PON IP capabilities
  *
@@ -465,6 +1022,90 @@ int get_clock_cycle_from_caps(struct pon_cap *caps);
  */
 void pon_byte_copy(uint8_t *dst, const uint8_t *src, int size);
 
+/** Netlink attribute policy of the pon_mbox messages */
+extern struct nla_policy pon_mbox_genl_policy[PON_MBOX_A_MAX + 1];
+
+#ifndef WIN32
+/**
+ *	Replaces the request socket of a context by the loopback backend,
+ *	see fapi_pon_loopback.c for the fixture format.
+ *
+ *	\param[in] ctx PON FAPI context
+ *	\param[in] fixture Path of the fixture file
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode pon_lb_attach(struct pon_ctx *ctx, const char *fixture);
+
+/**
+ *	Replaces the event socket of a loopback context by the loopback
+ *	backend and sends the events of the fixture to it.
+ *
+ *	\param[in] ctx PON FAPI context
+ *
+ *	\return Return value as follows:
+ *	- PON_STATUS_OK: If successful
+ *	- Other: An error code in case of error.
+ */
+enum fapi_pon_errorcode pon_lb_listener_attach(struct pon_ctx *ctx);
+
+/**
+ *	Releases the loopback backend of a context.
+ *
+ *	\param[in] ctx PON FAPI context
+ */
+void pon_lb_detach(struct pon_ctx *ctx);
+
+/**
+ *	Sets the loopback receive function in a callback set.
+ *
+ *	\param[in] cb Netlink callback set
+ */
+void pon_lb_recv_set(struct nl_cb *cb);
+
+/**
+ *	Returns a file descriptor which is readable while loopback messages
+ *	are waiting to be received.
+ *
+ *	\param[in] lb Loopback backend of a context
+ */
+int pon_lb_fd_get(struct pon_lb *lb);
+#else
+/* The loopback backend is built on eventfd, which Windows does not have */
+static inline enum fapi_pon_errorcode pon_lb_attach(struct pon_ctx *ctx,
+						    const char *fixture)
+{
+	UNUSED(ctx);
+	UNUSED(fixture);
+	return PON_STATUS_SUPPORT;
+}
+
+static inline enum fapi_pon_errorcode
+pon_lb_listener_attach(struct pon_ctx *ctx)
+{
+	UNUSED(ctx);
+	return PON_STATUS_SUPPORT;
+}
+
+static inline void pon_lb_detach(struct pon_ctx *ctx)
+{
+	UNUSED(ctx);
+}
+
+static inline void pon_lb_recv_set(struct nl_cb *cb)
+{
+	UNUSED(cb);
+}
+
+static inline int pon_lb_fd_get(struct pon_lb *lb)
+{
+	UNUSED(lb);
+	return -1;
+}
+#endif /* WIN32 */
+
 /*! @} */ /* PON_FAPI_CORE */
 
 /*! @} */ /* PON_FAPI_REFERENCE */
@@ -13,11 +13,17 @@
 
 #include "pon_mbox.h"
 #include "fapi_pon.h"
+#include "fapi_pon_alarms.h"
 #include "fapi_pon_core.h"
 #include "fapi_pon_debug.h"
 #include "fapi_pon_os.h"
 #include "pon_ip_msg.h"
 
+/* Time budget for the requests done while handling a TWDM wavelength switch,
+ * the firmware waits for the answer.
+ */
+#define PON_TWDM_WL_DEADLINE_MS 100
+
 #define COPY_32_BITS_TO_8_BITS(fapi_array, fw_param, index)		\
 	do {								\
 		fapi_array[index] = (fw_param & 0xFF000000) >> 24;	\
@@ -40,7 +46,7 @@ static void fapi_pon_listener_xgtc_log(struct pon_ctx *ctx, struct nl_msg *msg,
 	enum fapi_pon_errorcode err;
 	int i;
 
-	if (!ctx->xgtc_log)
+	if (!ctx->xgtc_log && !ctx->ploam_cap)
 		return;
 
 	if (!attrs[PON_MBOX_A_DATA]
@@ -60,7 +66,21 @@ static void fapi_pon_listener_xgtc_log(struct pon_ctx *ctx, struct nl_msg *msg,
 		COPY_32_BITS_TO_8_BITS(xgtc_log.message,
 				       fw_param->msg[i], i * 4);
 
-	ctx->xgtc_log(ctx->priv, &xgtc_log);
+	if (ctx->ploam_cap) {
+		struct pon_ploam_cap_rec_hdr rec = {0};
+
+		rec.time_stamp = xgtc_log.time_stamp;
+		rec.onu_id = xgtc_log.onu_id;
+		rec.format = PON_PLOAM_CAP_XGTC;
+		rec.direction = xgtc_log.direction;
+		rec.message_type_id = xgtc_log.message_type_id;
+		rec.message_seq_no = xgtc_log.message_seq_no;
+		rec.len = sizeof(xgtc_log.message);
+		pon_ploam_cap_put(ctx, &rec, xgtc_log.message);
+	}
+
+	if (ctx->xgtc_log)
+		ctx->xgtc_log(ctx->priv, &xgtc_log);
 
 	err = fapi_pon_send_msg_answer(ctx, msg, attrs, PONFW_ACK, NULL, 0,
 				       PON_MBOX_C_MSG);
@@ -76,7 +96,7 @@ static void fapi_pon_listener_gtc_log(struct pon_ctx *ctx, struct nl_msg *msg,
 	struct ponfw_gtc_ploam_log *fw_param;
 	enum fapi_pon_errorcode err;
 
-	if (!ctx->gtc_log)
+	if (!ctx->gtc_log && !ctx->ploam_cap)
 		return;
 
 	if (!attrs[PON_MBOX_A_DATA]
@@ -95,7 +115,20 @@ static void fapi_pon_listener_gtc_log(struct pon_ctx *ctx, struct nl_msg *msg,
 	COPY_32_BITS_TO_8_BITS(gtc_log.message, fw_param->data2, 2);
 	COPY_32_BITS_TO_8_BITS(gtc_log.message, fw_param->data3, 6);
 
-	ctx->gtc_log(ctx->priv, &gtc_log);
+	if (ctx->ploam_cap) {
+		struct pon_ploam_cap_rec_hdr rec = {0};
+
+		rec.time_stamp = gtc_log.time_stamp;
+		rec.onu_id = gtc_log.onu_id;
+		rec.format = PON_PLOAM_CAP_GTC;
+		rec.direction = gtc_log.direction;
+		rec.message_type_id = gtc_log.message_type_id;
+		rec.len = sizeof(gtc_log.message);
+		pon_ploam_cap_put(ctx, &rec, gtc_log.message);
+	}
+
+	if (ctx->gtc_log)
+		ctx->gtc_log(ctx->priv, &gtc_log);
 
 	err = fapi_pon_send_msg_answer(ctx, msg, attrs, PONFW_ACK, NULL, 0,
 				       PON_MBOX_C_MSG);
@@ -136,25 +169,19 @@ static void fapi_pon_listener_ploam_state(struct pon_ctx *ctx,
 }
 
 static void fapi_pon_listener_alarm_report(struct pon_ctx *ctx,
-					   struct nl_msg *msg,
-					   struct nlattr **attrs)
+					   const void *data, int len)
 {
 	struct pon_alarm_status alarms;
-	struct ponfw_report_alarm *fw_param;
-
-	UNUSED(msg);
+	const struct ponfw_report_alarm *fw_param = data;
 
 	if (!ctx->alarm_report)
 		return;
 
-	if (!attrs[PON_MBOX_A_DATA]
-	   || nla_len(attrs[PON_MBOX_A_DATA]) != sizeof(*fw_param)) {
+	if (!data || len != sizeof(*fw_param)) {
 		PON_DEBUG_ERR("Cannot read FW data");
 		return;
 	}
 
-	fw_param = nla_data(attrs[PON_MBOX_A_DATA]);
-
 	alarms.alarm_id = fw_param->alarm_id;
 	alarms.alarm_status = PON_ALARM_EN;
 
@@ -164,25 +191,19 @@ static void fapi_pon_listener_alarm_report(struct pon_ctx *ctx,
 }
 
 static void fapi_pon_listener_alarm_clear(struct pon_ctx *ctx,
-					  struct nl_msg *msg,
-					  struct nlattr **attrs)
+					  const void *data, int len)
 {
 	struct pon_alarm_status alarms;
-	struct ponfw_clear_alarm *fw_param;
-
-	UNUSED(msg);
+	const struct ponfw_clear_alarm *fw_param = data;
 
 	if (!ctx->alarm_clear)
 		return;
 
-	if (!attrs[PON_MBOX_A_DATA]
-	   || nla_len(attrs[PON_MBOX_A_DATA]) != sizeof(*fw_param)) {
+	if (!data || len != sizeof(*fw_param)) {
 		PON_DEBUG_ERR("Cannot read FW data");
 		return;
 	}
 
-	fw_param = nla_data(attrs[PON_MBOX_A_DATA]);
-
 	alarms.alarm_id = fw_param->alarm_id;
 	alarms.alarm_status = PON_ALARM_DIS;
 
@@ -318,11 +339,15 @@ static void fapi_pon_twdm_us_wl_config(struct pon_ctx *ctx,
 
 	fw_param = nla_data(attrs[PON_MBOX_A_DATA]);
 
+	fapi_pon_deadline_set(ctx, PON_TWDM_WL_DEADLINE_MS);
+
 	/* check if the switching is possible */
 	ret = ctx->twdm_wl_check(ctx->priv, PON_TWDM_US_WL_CONF,
 				 fw_param->uwlch_id, fw_param->us_execute);
-	if (ret == PON_STATUS_OK_NO_RESPONSE)
+	if (ret == PON_STATUS_OK_NO_RESPONSE) {
+		fapi_pon_deadline_clear(ctx);
 		return;
+	}
 
 	fw_param->us_valid = (ret == PON_STATUS_OK);
 
@@ -337,6 +362,8 @@ static void fapi_pon_twdm_us_wl_config(struct pon_ctx *ctx,
 		}
 	}
 
+	fapi_pon_deadline_clear(ctx);
+
 	ret = fapi_pon_send_msg_answer(ctx, msg, attrs, PONFW_ACK, fw_param,
 				       PONFW_TWDM_US_WL_CONFIG_LENW,
 				       PON_MBOX_C_MSG);
@@ -372,11 +399,15 @@ static void fapi_pon_twdm_ds_wl_config(struct pon_ctx *ctx,
 
 	fw_param = nla_data(attrs[PON_MBOX_A_DATA]);
 
+	fapi_pon_deadline_set(ctx, PON_TWDM_WL_DEADLINE_MS);
+
 	/* check if the switching is possible */
 	ret = ctx->twdm_wl_check(ctx->priv, PON_TWDM_DS_WL_CONF,
 				 fw_param->dwlch_id, fw_param->ds_execute);
-	if (ret == PON_STATUS_OK_NO_RESPONSE)
+	if (ret == PON_STATUS_OK_NO_RESPONSE) {
+		fapi_pon_deadline_clear(ctx);
 		return;
+	}
 
 	fw_param->ds_valid = (ret == PON_STATUS_OK);
 
@@ -399,6 +430,8 @@ static void fapi_pon_twdm_ds_wl_config(struct pon_ctx *ctx,
 		}
 	}
 
+	fapi_pon_deadline_clear(ctx);
+
 	ret = fapi_pon_send_msg_answer(ctx, msg, attrs, PONFW_ACK, fw_param,
 				       PONFW_TWDM_DS_WL_CONFIG_LENW,
 				       PON_MBOX_C_MSG);
@@ -445,25 +478,19 @@ static void fapi_pon_lc_twdm_us_wl_tuning(struct pon_ctx *ctx,
 }
 
 static void fapi_pon_listener_synce_status(struct pon_ctx *ctx,
-		struct nl_msg *msg,
-		struct nlattr **attrs)
+					   const void *data, int len)
 {
-	struct ponfw_synce_status *fw_param;
+	const struct ponfw_synce_status *fw_param = data;
 	struct pon_synce_status param;
 
-	UNUSED(msg);
-
 	if (!ctx->synce_status)
 		return;
 
-	if (!attrs[PON_MBOX_A_DATA]
-		|| nla_len(attrs[PON_MBOX_A_DATA]) != sizeof(*fw_param)) {
+	if (!data || len != sizeof(*fw_param)) {
 		PON_DEBUG_ERR("Cannot read FW data");
 		return;
 	}
 
-	fw_param = nla_data(attrs[PON_MBOX_A_DATA]);
-
 	param.stat = fw_param->synce_stat;
 
 	ctx->synce_status(ctx->priv, &param);
@@ -543,24 +570,19 @@ static void fapi_pon_listener_twdm_ch_prfl_status(struct pon_ctx *ctx,
 }
 
 static void fapi_pon_listener_onu_rnd_chl_tbl(struct pon_ctx *ctx,
-					      struct nl_msg *msg,
-					      struct nlattr **attrs)
+					      const void *data, int len)
 {
-	struct ponfw_xgtc_onu_rnd_chal_table *fw_param;
+	const struct ponfw_xgtc_onu_rnd_chal_table *fw_param = data;
 	struct pon_generic_auth_table param;
 
-	UNUSED(msg);
-
 	if (!ctx->onu_rnd_chl_tbl)
 		return;
 
-	if (!attrs[PON_MBOX_A_DATA]
-		|| nla_len(attrs[PON_MBOX_A_DATA]) != sizeof(*fw_param)) {
+	if (!data || len != sizeof(*fw_param)) {
 		PON_DEBUG_ERR("Cannot read FW data");
 		return;
 	}
 
-	fw_param = nla_data(attrs[PON_MBOX_A_DATA]);
 	param.size = MAX_AUTH_TABLE_SIZE;
 	param.table = calloc(param.size, sizeof(uint8_t));
 	if (!param.table) {
@@ -574,24 +596,19 @@ static void fapi_pon_listener_onu_rnd_chl_tbl(struct pon_ctx *ctx,
 }
 
 static void fapi_pon_listener_onu_auth_res_tbl(struct pon_ctx *ctx,
-					       struct nl_msg *msg,
-					       struct nlattr **attrs)
+					       const void *data, int len)
 {
-	struct ponfw_xgtc_onu_auth_result_table *fw_param;
+	const struct ponfw_xgtc_onu_auth_result_table *fw_param = data;
 	struct pon_generic_auth_table param;
 
-	UNUSED(msg);
-
 	if (!ctx->onu_auth_res_tbl)
 		return;
 
-	if (!attrs[PON_MBOX_A_DATA]
-		|| nla_len(attrs[PON_MBOX_A_DATA]) != sizeof(*fw_param)) {
+	if (!data || len != sizeof(*fw_param)) {
 		PON_DEBUG_ERR("Cannot read FW data");
 		return;
 	}
 
-	fw_param = nla_data(attrs[PON_MBOX_A_DATA]);
 	param.size = MAX_AUTH_TABLE_SIZE;
 	param.table = calloc(param.size, sizeof(uint8_t));
 	if (!param.table) {
@@ -605,24 +622,18 @@ static void fapi_pon_listener_onu_auth_res_tbl(struct pon_ctx *ctx,
 }
 
 static void fapi_pon_listener_twdm_config(struct pon_ctx *ctx,
-					  struct nl_msg *msg,
-					  struct nlattr **attrs)
+					  const void *data, int len)
 {
-	struct ponfw_twdm_config *fw_param;
-
-	UNUSED(msg);
+	const struct ponfw_twdm_config *fw_param = data;
 
 	if (!ctx->twdm_config)
 		return;
 
-	if (!attrs[PON_MBOX_A_DATA] ||
-	    nla_len(attrs[PON_MBOX_A_DATA]) != sizeof(*fw_param)) {
+	if (!data || len != sizeof(*fw_param)) {
 		PON_DEBUG_ERR("Cannot read FW data");
 		return;
 	}
 
-	fw_param = nla_data(attrs[PON_MBOX_A_DATA]);
-
 	ctx->twdm_config(ctx->priv, fw_param->cpi, fw_param->dwlch_id);
 }
 
@@ -646,24 +657,19 @@ static void fapi_pon_unlink_all_answer(struct pon_ctx *ctx,
 }
 
 static void fapi_pon_listener_unlink_all(struct pon_ctx *ctx,
-					 struct nl_msg *msg,
-					 struct nlattr **attrs)
+					 const void *data, int len)
 {
-	struct ponfw_alloc_id_unlink *fw_param;
+	const struct ponfw_alloc_id_unlink *fw_param = data;
 	enum fapi_pon_errorcode ret;
 
-	UNUSED(msg);
-
 	if (!ctx->unlink_all)
 		return;
 
-	if (!attrs[PON_MBOX_A_DATA] ||
-	    nla_len(attrs[PON_MBOX_A_DATA]) != sizeof(*fw_param)) {
+	if (!data || len != sizeof(*fw_param)) {
 		PON_DEBUG_ERR("Cannot read FW data");
 		return;
 	}
 
-	fw_param = nla_data(attrs[PON_MBOX_A_DATA]);
 	if (!fw_param->all)
 		return;
 
@@ -869,6 +875,232 @@ fapi_pon_register_unlink_all(struct pon_ctx *ctx,
 	return func_old;
 }
 
+fapi_pon_resync fapi_pon_register_resync(struct pon_ctx *ctx,
+					 fapi_pon_resync func)
+{
+	fapi_pon_resync func_old = ctx->resync;
+
+	ctx->resync = func;
+
+	return func_old;
+}
+
+void pon_event_exec(struct pon_ctx *ctx, uint16_t command,
+		    const void *data, int len)
+{
+	switch (command) {
+	case PONFW_REPORT_ALARM_CMD_ID:
+		fapi_pon_listener_alarm_report(ctx, data, len);
+		return;
+	case PONFW_CLEAR_ALARM_CMD_ID:
+		fapi_pon_listener_alarm_clear(ctx, data, len);
+		return;
+	case PONFW_SYNCE_STATUS_CMD_ID:
+		fapi_pon_listener_synce_status(ctx, data, len);
+		return;
+	case PONFW_TWDM_CONFIG_CMD_ID:
+		fapi_pon_listener_twdm_config(ctx, data, len);
+		return;
+	case PONFW_XGTC_ONU_RND_CHAL_TABLE_CMD_ID:
+		fapi_pon_listener_onu_rnd_chl_tbl(ctx, data, len);
+		return;
+	case PONFW_XGTC_ONU_AUTH_RESULT_TABLE_CMD_ID:
+		fapi_pon_listener_onu_auth_res_tbl(ctx, data, len);
+		return;
+	case PONFW_ALLOC_ID_UNLINK_CMD_ID:
+		fapi_pon_listener_unlink_all(ctx, data, len);
+		return;
+	default:
+		return;
+	}
+}
+
+/*
+ * Return the class of an event which can be handled by the deferred event
+ * workers. The events of one class are executed in the order they were
+ * received. Events which have to be acknowledged are always handled
+ * inline, the firmware is waiting for them. This includes the unlink all
+ * event, its answer is needed by the firmware to leave O11.
+ */
+static int pon_event_class(uint16_t command)
+{
+	switch (command) {
+	case PONFW_REPORT_ALARM_CMD_ID:
+	case PONFW_CLEAR_ALARM_CMD_ID:
+		return PON_EVENT_CLASS_ALARM;
+	case PONFW_SYNCE_STATUS_CMD_ID:
+		return PON_EVENT_CLASS_SYNCE;
+	case PONFW_TWDM_CONFIG_CMD_ID:
+		return PON_EVENT_CLASS_TWDM;
+	case PONFW_XGTC_ONU_RND_CHAL_TABLE_CMD_ID:
+	case PONFW_XGTC_ONU_AUTH_RESULT_TABLE_CMD_ID:
+		return PON_EVENT_CLASS_AUTH;
+	default:
+		return -1;
+	}
+}
+
+/* Queue an event to the deferred event workers or handle it inline */
+static void pon_event_post(struct pon_ctx *ctx, uint16_t command,
+			   const void *data, int len)
+{
+	int cls = pon_event_class(command);
+
+	if (ctx->defer && cls >= 0 &&
+	    pon_event_defer(ctx->defer, (unsigned int)cls, command,
+			    data, len) == PON_STATUS_OK)
+		return;
+
+	pon_event_exec(ctx, command, data, len);
+}
+
+/* Check if an alarm is in the list of active alarms */
+static bool pon_resync_alarm_active(const struct pon_alarm_active *active,
+				    uint16_t alarm_id)
+{
+	unsigned int i;
+
+	for (i = 0; i < active->num; i++)
+		if (active->id[i] == alarm_id)
+			return true;
+
+	return false;
+}
+
+/*
+ * Report all level alarms again, the alarm clear events are the ones lost
+ * most likely during a LOS storm. A clear is only reported for the alarms
+ * which the application has seen active before, the tracked state is read
+ * before the firmware state replaces it.
+ */
+static void pon_resync_alarms_report(struct pon_ctx *ctx,
+				     struct pon_resync_info *info)
+{
+	struct ponfw_report_alarm report = {0};
+	struct ponfw_clear_alarm clear = {0};
+	struct pon_alarm_snapshot before;
+	struct pon_alarm_active active;
+	enum fapi_pon_errorcode err;
+	unsigned int i, nr;
+	uint32_t bits;
+
+	pon_alarm_snapshot_read(&before, false);
+
+	/* One request returns all active static alarms */
+	err = pon_alarm_active_read(ctx, &active);
+	if (err != PON_STATUS_OK) {
+		PON_DEBUG_ERR("reading active alarms failed %i", err);
+		return;
+	}
+
+	info->alarms_active = active.num;
+
+	for (i = 0; i < active.num && ctx->alarm_report; i++) {
+		report.alarm_id = active.id[i];
+		pon_event_post(ctx, PONFW_REPORT_ALARM_CMD_ID, &report,
+			       sizeof(report));
+	}
+
+	if (!ctx->alarm_clear)
+		return;
+
+	for (i = 0; i < PON_ALARM_GROUPS; i++) {
+		bits = before.level[i];
+		for (nr = 0; bits; nr++, bits >>= 1) {
+			if (!(bits & 1))
+				continue;
+			clear.alarm_id = (uint16_t)(i << 8 | nr);
+			if (pon_resync_alarm_active(&active, clear.alarm_id))
+				continue;
+			/* Queued behind pending alarm events if deferred */
+			pon_event_post(ctx, PONFW_CLEAR_ALARM_CMD_ID, &clear,
+				       sizeof(clear));
+		}
+	}
+}
+
+void pon_listener_resync(struct pon_ctx *ctx)
+{
+	struct pon_resync_info info = {0};
+	struct pon_ploam_state_evt ploam_evt;
+	enum fapi_pon_errorcode err;
+	uint8_t pon_mode = 0;
+
+	info.overflows = ctx->event_stats.overflows;
+
+	/* One of the lost events might have reported a firmware reload */
+	pon_fw_info_invalidate();
+	pon_gem_cache_invalidate();
+	pon_cfg_snap_invalidate();
+
+	err = fapi_pon_mode_get(ctx, &pon_mode);
+	if (err == PON_STATUS_OK && pon_mode == PON_MODE_AON)
+		goto out;
+
+	pon_resync_alarms_report(ctx, &info);
+
+	err = fapi_pon_ploam_state_get(ctx, &info.ploam_state);
+	if (err == PON_STATUS_OK) {
+		info.ploam_valid = 1;
+		if (ctx->ploam_state) {
+			ploam_evt.current = info.ploam_state.current;
+			ploam_evt.previous = info.ploam_state.previous;
+			/* The time in the previous state is not known */
+			ploam_evt.time_prev = 0;
+			ploam_evt.change_reason =
+				info.ploam_state.change_reason;
+			ctx->ploam_state(ctx->priv, &ploam_evt);
+		}
+	}
+
+	err = fapi_pon_twdm_status_get(ctx, &info.twdm_status);
+	if (err == PON_STATUS_OK)
+		info.twdm_valid = 1;
+
+out:
+	ctx->event_stats.resyncs++;
+
+	if (ctx->resync)
+		ctx->resync(ctx->priv, &info);
+}
+
+/* Handle an event which does not need an answer */
+static void fapi_pon_listener_notify(struct pon_ctx *ctx, uint16_t command,
+				     struct nlattr **attrs)
+{
+	const struct ponfw_report_alarm *report;
+	const struct ponfw_clear_alarm *clear;
+	const void *data = NULL;
+	int len = 0;
+
+	if (attrs[PON_MBOX_A_DATA]) {
+		data = nla_data(attrs[PON_MBOX_A_DATA]);
+		len = nla_len(attrs[PON_MBOX_A_DATA]);
+	}
+
+	/* The library state is updated before the event is queued */
+	switch (command) {
+	case PONFW_REPORT_ALARM_CMD_ID:
+		report = data;
+		if (data && len == sizeof(*report))
+			pon_alarm_state_set(report->alarm_id, true);
+		break;
+	case PONFW_CLEAR_ALARM_CMD_ID:
+		clear = data;
+		if (data && len == sizeof(*clear))
+			pon_alarm_state_set(clear->alarm_id, false);
+		break;
+	case PONFW_ALLOC_ID_UNLINK_CMD_ID:
+		/* The GEM ports are unlinked from their allocations */
+		pon_gem_cache_invalidate();
+		break;
+	default:
+		break;
+	}
+
+	pon_event_post(ctx, command, data, len);
+}
+
 void fapi_pon_listener_msg(uint16_t command, struct pon_ctx *ctx,
 			   struct nl_msg *msg, struct nlattr **attrs)
 {
@@ -883,10 +1115,13 @@ void fapi_pon_listener_msg(uint16_t command, struct pon_ctx *ctx,
 		fapi_pon_listener_ploam_state(ctx, msg, attrs);
 		return;
 	case PONFW_REPORT_ALARM_CMD_ID:
-		fapi_pon_listener_alarm_report(ctx, msg, attrs);
-		return;
 	case PONFW_CLEAR_ALARM_CMD_ID:
-		fapi_pon_listener_alarm_clear(ctx, msg, attrs);
+	case PONFW_SYNCE_STATUS_CMD_ID:
+	case PONFW_TWDM_CONFIG_CMD_ID:
+	case PONFW_XGTC_ONU_RND_CHAL_TABLE_CMD_ID:
+	case PONFW_XGTC_ONU_AUTH_RESULT_TABLE_CMD_ID:
+	case PONFW_ALLOC_ID_UNLINK_CMD_ID:
+		fapi_pon_listener_notify(ctx, command, attrs);
 		return;
 	case PONFW_TX_POWER_LEVEL_REQ_CMD_ID:
 		fapi_pon_listener_xgtc_power_level(ctx, msg, attrs);
@@ -906,25 +1141,12 @@ void fapi_pon_listener_msg(uint16_t command, struct pon_ctx *ctx,
 	case PONFW_TWDM_ONU_CAL_RECORD_CMD_ID:
 		fapi_pon_twdm_cal_record_status(ctx, msg, attrs);
 		return;
-	case PONFW_SYNCE_STATUS_CMD_ID:
-		fapi_pon_listener_synce_status(ctx, msg, attrs);
-		return;
 	case PONFW_TWDM_CHANNEL_PROFILE_CMD_ID:
 		fapi_pon_listener_twdm_ch_prfl_status(ctx, msg, attrs);
 		return;
-	case PONFW_TWDM_CONFIG_CMD_ID:
-		fapi_pon_listener_twdm_config(ctx, msg, attrs);
-		return;
-	case PONFW_XGTC_ONU_RND_CHAL_TABLE_CMD_ID:
-		fapi_pon_listener_onu_rnd_chl_tbl(ctx, msg, attrs);
-		return;
-	case PONFW_XGTC_ONU_AUTH_RESULT_TABLE_CMD_ID:
-		fapi_pon_listener_onu_auth_res_tbl(ctx, msg, attrs);
-		return;
-	case PONFW_ALLOC_ID_UNLINK_CMD_ID:
-		fapi_pon_listener_unlink_all(ctx, msg, attrs);
-		return;
 	case PONFW_ALLOC_ID_LINK_CMD_ID:
+		/* The allocation of the linked GEM ports changed */
+		pon_gem_cache_invalidate();
 		return;
 	default:
 		PON_DEBUG_ERR("got unknown event: 0x%x", command);
@@ -952,12 +1174,11 @@ fapi_pon_fw_init_complete_msg(struct pon_ctx *ctx,
 	UNUSED(msg);
 
 	/* invalidate the cache */
-	ctx->caps_valid = 0;
-	ctx->ver_valid = 0;
-	ctx->limits_valid = 0;
-	ctx->mode_valid = 0;
 	ctx->ext_cal_valid = 0;
-	ctx->actual_plat_type = 0;
+	pon_fw_info_invalidate();
+	pon_gem_cache_invalidate();
+	pon_cfg_snap_invalidate();
+	pon_alarm_level_invalidate();
 
 	if (ctx->fw_init_complete)
 		ctx->fw_init_complete(ctx->priv);
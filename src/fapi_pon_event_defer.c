@@ -0,0 +1,222 @@
+/******************************************************************************
+ *
+ *  Copyright (c) 2025 MaxLinear, Inc.
+ *
+ * For licensing information, see the file 'LICENSE' in the root folder of
+ * this software module.
+ *
+ *****************************************************************************/
+
+/*
+ * Deferred execution of the event callbacks. The events which are not
+ * answered to the firmware are copied into a FIFO queue by the listener and
+ * executed by a worker thread. Each event class is bound to one worker, so
+ * the events of a class are executed in the order they were received, while
+ * a slow callback of one class does not delay the other classes.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "pon_config.h"
+#endif
+
+#include <pthread.h>
+
+#include "pon_ip_msg.h"
+#include "fapi_pon.h"
+#include "fapi_pon_os.h"
+#include "fapi_pon_core.h"
+#include "fapi_pon_error.h"
+#include "fapi_pon_debug.h"
+
+/* Queued event */
+struct pon_event_entry {
+	/** Next event in the queue */
+	struct pon_event_entry *next;
+	/** Firmware command ID */
+	uint16_t command;
+	/** Length of the event data */
+	int len;
+	/** Event data */
+	uint8_t data[];
+};
+
+/* Worker thread with its event queue */
+struct pon_event_worker {
+	/** Protects the queue */
+	pthread_mutex_t lock;
+	/** Signaled when an event was queued or the worker shall stop */
+	pthread_cond_t cond;
+	/** First queued event */
+	struct pon_event_entry *head;
+	/** Last queued event */
+	struct pon_event_entry *tail;
+	/** Set to 1 to terminate the worker after the queue is empty */
+	int stop;
+	/** Set to 1 once the thread was created */
+	int running;
+	/** Worker thread */
+	pthread_t thread;
+	/** Context of the events */
+	struct pon_ctx *ctx;
+};
+
+struct pon_event_defer {
+	/** Number of workers */
+	unsigned int num;
+	/** Workers, the events of class c are executed by worker c % num */
+	struct pon_event_worker worker[PON_EVENT_CLASS_NUM];
+};
+
+enum fapi_pon_errorcode pon_event_defer(struct pon_event_defer *defer,
+					unsigned int cls, uint16_t command,
+					const void *data, int len)
+{
+	struct pon_event_worker *worker;
+	struct pon_event_entry *entry;
+
+	if (cls >= PON_EVENT_CLASS_NUM || len < 0 || (len && !data))
+		return PON_STATUS_INPUT_ERR;
+
+	entry = malloc(sizeof(*entry) + (size_t)len);
+	if (!entry)
+		return PON_STATUS_MEM_ERR;
+
+	entry->next = NULL;
+	entry->command = command;
+	entry->len = len;
+	if (len)
+		memcpy(entry->data, data, (size_t)len);
+
+	worker = &defer->worker[cls % defer->num];
+
+	pthread_mutex_lock(&worker->lock);
+	if (worker->tail)
+		worker->tail->next = entry;
+	else
+		worker->head = entry;
+	worker->tail = entry;
+	pthread_cond_signal(&worker->cond);
+	pthread_mutex_unlock(&worker->lock);
+
+	return PON_STATUS_OK;
+}
+
+static void *pon_event_worker_thread(void *arg)
+{
+	struct pon_event_worker *worker = arg;
+	struct pon_event_entry *entry;
+
+	pthread_mutex_lock(&worker->lock);
+	for (;;) {
+		entry = worker->head;
+		if (!entry) {
+			if (worker->stop)
+				break;
+			pthread_cond_wait(&worker->cond, &worker->lock);
+			continue;
+		}
+
+		worker->head = entry->next;
+		if (!worker->head)
+			worker->tail = NULL;
+		pthread_mutex_unlock(&worker->lock);
+
+		pon_event_exec(worker->ctx, entry->command,
+			       entry->len ? entry->data : NULL, entry->len);
+		free(entry);
+
+		pthread_mutex_lock(&worker->lock);
+	}
+	pthread_mutex_unlock(&worker->lock);
+
+	return NULL;
+}
+
+/* Stop all workers after their queues were executed */
+static void pon_event_defer_free(struct pon_event_defer *defer)
+{
+	struct pon_event_worker *worker;
+	unsigned int i;
+
+	for (i = 0; i < defer->num; i++) {
+		worker = &defer->worker[i];
+		if (!worker->running)
+			continue;
+		pthread_mutex_lock(&worker->lock);
+		worker->stop = 1;
+		pthread_cond_signal(&worker->cond);
+		pthread_mutex_unlock(&worker->lock);
+		pthread_join(worker->thread, NULL);
+	}
+
+	for (i = 0; i < defer->num; i++) {
+		worker = &defer->worker[i];
+		pthread_cond_destroy(&worker->cond);
+		pthread_mutex_destroy(&worker->lock);
+	}
+
+	free(defer);
+}
+
+enum fapi_pon_errorcode fapi_pon_listener_defer_start(struct pon_ctx *ctx,
+						      uint32_t workers)
+{
+	struct pon_event_defer *defer;
+	struct pon_event_worker *worker;
+	unsigned int i;
+
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	/* The callbacks send requests concurrently to the listener */
+	if (!ctx->mt || ctx->defer)
+		return PON_STATUS_ERR;
+
+	defer = calloc(1, sizeof(*defer));
+	if (!defer)
+		return PON_STATUS_MEM_ERR;
+
+	if (!workers)
+		workers = 1;
+	defer->num = workers < PON_EVENT_CLASS_NUM ?
+		     workers : PON_EVENT_CLASS_NUM;
+
+	for (i = 0; i < defer->num; i++) {
+		worker = &defer->worker[i];
+		worker->ctx = ctx;
+		pthread_mutex_init(&worker->lock, NULL);
+		pthread_cond_init(&worker->cond, NULL);
+	}
+
+	for (i = 0; i < defer->num; i++) {
+		worker = &defer->worker[i];
+		if (pthread_create(&worker->thread, NULL,
+				   pon_event_worker_thread, worker)) {
+			PON_DEBUG_ERR("Cannot start event worker %u", i);
+			pon_event_defer_free(defer);
+			return PON_STATUS_ERR;
+		}
+		worker->running = 1;
+	}
+
+	ctx->defer = defer;
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_listener_defer_stop(struct pon_ctx *ctx)
+{
+	struct pon_event_defer *defer;
+
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	defer = ctx->defer;
+	if (!defer)
+		return PON_STATUS_OK;
+
+	ctx->defer = NULL;
+	pon_event_defer_free(defer);
+
+	return PON_STATUS_OK;
+}
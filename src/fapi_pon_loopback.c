@@ -0,0 +1,756 @@
+/******************************************************************************
+ *
+ *  Copyright (c) 2025 MaxLinear, Inc.
+ *
+ * For licensing information, see the file 'LICENSE' in the root folder of
+ * this software module.
+ *
+ *****************************************************************************/
+
+/*
+ * Loopback backend which stands in for the pon_mbox driver and the PON IP
+ * firmware. The Netlink send and receive functions of the sockets of a
+ * loopback context are overwritten, the messages never leave the process.
+ * Requests are answered from a fixture file, which holds one record per line:
+ *
+ *	# comment
+ *	latency <us>
+ *	mode <PON mode>
+ *	cmd <command> <r|w> <ack> [<payload>|-] [<latency us>]
+ *	event <command> [<payload>]
+ *
+ * The payload is given as hex string, the ack as "ack", "nack" or number.
+ * The PON mode is the value reported by the driver, as PON_MODE_9807_XGSPON.
+ * Read requests without a record are answered with a NACK. Write requests
+ * without a record are acknowledged and their payload is used as answer to
+ * following read requests of the same command, so a "set" can be read back
+ * with a "get". The events are sent to every listener when it connects.
+ * All contexts opened with the same fixture file share one emulated device.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "pon_config.h"
+#endif
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "pon_ip_msg.h"
+#include "fapi_pon.h"
+#include "fapi_pon_os.h"
+#include "fapi_pon_core.h"
+#include "fapi_pon_error.h"
+#include "fapi_pon_debug.h"
+
+/* Generic Netlink family ID used in the emulated messages */
+#define PON_LB_FAMILY 0x7F
+/* Maximum length of a fixture line */
+#define PON_LB_LINE_MAX 4096
+
+/* Answer or event defined in the fixture */
+struct pon_lb_rec {
+	/** Firmware command ID */
+	uint16_t command;
+	/** 1 for read requests, 0 for write requests */
+	uint8_t read;
+	/** Acknowledge sent in the answer */
+	uint8_t ack;
+	/** Set to 1 for an event sent to the listeners */
+	int event;
+	/** Answer latency in us */
+	uint32_t latency;
+	/** Payload length in bytes */
+	uint32_t len;
+	/** Payload */
+	uint8_t *data;
+};
+
+/* Emulated device, shared by all contexts using the same fixture */
+struct pon_lb_dev {
+	/** Path of the fixture file */
+	char *path;
+	/** Number of endpoints using this device */
+	unsigned int refcnt;
+	/** Records of the fixture */
+	struct pon_lb_rec *rec;
+	/** Number of used records */
+	unsigned int rec_num;
+	/** Number of allocated records */
+	unsigned int rec_size;
+	/** Default answer latency in us */
+	uint32_t latency;
+	/** PON mode reported to PON_MBOX_C_MODE_READ, 0 if not given */
+	uint8_t mode;
+	/** Endpoints of this device */
+	struct pon_lb *ep;
+	/** Next device */
+	struct pon_lb_dev *next;
+};
+
+/* Message waiting to be received */
+struct pon_lb_buf {
+	/** Time in us from which on the message can be received */
+	uint64_t due;
+	/** Message length in bytes */
+	size_t len;
+	/** Netlink message */
+	unsigned char *data;
+	/** Next message */
+	struct pon_lb_buf *next;
+};
+
+/* Loopback replacement of a Netlink socket */
+struct pon_lb {
+	/** Netlink socket replaced by this endpoint */
+	struct nl_sock *sk;
+	/** Context owning the socket */
+	struct pon_ctx *ctx;
+	/** Emulated device */
+	struct pon_lb_dev *dev;
+	/** Set to 1 for the event socket of a context */
+	int event;
+	/** Messages waiting to be received */
+	struct pon_lb_buf *head;
+	/** Last message waiting to be received */
+	struct pon_lb_buf *tail;
+	/** Signaled when a message was queued */
+	pthread_cond_t cond;
+	/** Event file descriptor which is readable while messages are queued */
+	int fd;
+	/** Next endpoint of the device */
+	struct pon_lb *next;
+};
+
+/* Protects all loopback devices and endpoints */
+static pthread_mutex_t pon_lb_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct pon_lb_dev *pon_lb_devs;
+
+/* Must be called with pon_lb_lock held */
+static struct pon_lb *pon_lb_find(struct nl_sock *sk)
+{
+	struct pon_lb_dev *dev;
+	struct pon_lb *ep;
+
+	for (dev = pon_lb_devs; dev; dev = dev->next)
+		for (ep = dev->ep; ep; ep = ep->next)
+			if (ep->sk == sk)
+				return ep;
+
+	return NULL;
+}
+
+static struct pon_lb_rec *pon_lb_rec_find(struct pon_lb_dev *dev,
+					  uint16_t command, uint8_t read)
+{
+	unsigned int i;
+
+	for (i = 0; i < dev->rec_num; i++) {
+		if (!dev->rec[i].event && dev->rec[i].command == command &&
+		    dev->rec[i].read == read)
+			return &dev->rec[i];
+	}
+
+	return NULL;
+}
+
+static struct pon_lb_rec *pon_lb_rec_add(struct pon_lb_dev *dev)
+{
+	struct pon_lb_rec *rec;
+	unsigned int size;
+
+	if (dev->rec_num == dev->rec_size) {
+		size = dev->rec_size ? dev->rec_size * 2 : 64;
+		rec = realloc(dev->rec, size * sizeof(*rec));
+		if (!rec)
+			return NULL;
+		dev->rec = rec;
+		dev->rec_size = size;
+	}
+
+	rec = &dev->rec[dev->rec_num++];
+	memset(rec, 0, sizeof(*rec));
+	rec->latency = dev->latency;
+
+	return rec;
+}
+
+static int pon_lb_hex_parse(const char *str, uint8_t **data, uint32_t *len)
+{
+	size_t n = strlen(str);
+	unsigned int byte;
+	size_t i;
+
+	*data = NULL;
+	*len = 0;
+
+	if (strcmp(str, "-") == 0)
+		return 0;
+	if (n % 2)
+		return -1;
+
+	*data = malloc(n / 2);
+	if (!*data)
+		return -1;
+
+	for (i = 0; i < n / 2; i++) {
+		if (sscanf(&str[i * 2], "%2x", &byte) != 1) {
+			free(*data);
+			*data = NULL;
+			return -1;
+		}
+		(*data)[i] = (uint8_t)byte;
+	}
+	*len = (uint32_t)(n / 2);
+
+	return 0;
+}
+
+static int pon_lb_ack_parse(const char *str, uint8_t *ack)
+{
+	if (strcmp(str, "ack") == 0)
+		*ack = PONFW_ACK;
+	else if (strcmp(str, "nack") == 0)
+		*ack = PONFW_NACK;
+	else
+		*ack = (uint8_t)strtoul(str, NULL, 0);
+
+	return 0;
+}
+
+/* Parse one line of the fixture file */
+static int pon_lb_line_parse(struct pon_lb_dev *dev, char *line)
+{
+	char *tok[6] = {NULL};
+	struct pon_lb_rec *rec;
+	char *save = NULL;
+	unsigned int n = 0;
+	char *t;
+
+	for (t = strtok_r(line, " \t\r\n", &save); t && n < 6;
+	     t = strtok_r(NULL, " \t\r\n", &save))
+		tok[n++] = t;
+
+	if (!n || tok[0][0] == '#')
+		return 0;
+
+	if (strcmp(tok[0], "latency") == 0 && n == 2) {
+		dev->latency = (uint32_t)strtoul(tok[1], NULL, 0);
+		return 0;
+	}
+
+	if (strcmp(tok[0], "mode") == 0 && n == 2) {
+		dev->mode = (uint8_t)strtoul(tok[1], NULL, 0);
+		return 0;
+	}
+
+	if (strcmp(tok[0], "cmd") == 0 && n >= 4) {
+		rec = pon_lb_rec_add(dev);
+		if (!rec)
+			return -1;
+		rec->command = (uint16_t)strtoul(tok[1], NULL, 0);
+		rec->read = tok[2][0] == 'r';
+		pon_lb_ack_parse(tok[3], &rec->ack);
+		if (n > 5)
+			rec->latency = (uint32_t)strtoul(tok[5], NULL, 0);
+		return n > 4 ? pon_lb_hex_parse(tok[4], &rec->data, &rec->len)
+			     : 0;
+	}
+
+	if (strcmp(tok[0], "event") == 0 && n >= 2) {
+		rec = pon_lb_rec_add(dev);
+		if (!rec)
+			return -1;
+		rec->event = 1;
+		rec->command = (uint16_t)strtoul(tok[1], NULL, 0);
+		rec->ack = PONFW_CMD;
+		return n > 2 ? pon_lb_hex_parse(tok[2], &rec->data, &rec->len)
+			     : 0;
+	}
+
+	return -1;
+}
+
+static enum fapi_pon_errorcode pon_lb_fixture_load(struct pon_lb_dev *dev)
+{
+	char *line;
+	unsigned int nr = 0;
+	FILE *f;
+
+	f = fopen(dev->path, "r");
+	if (!f) {
+		PON_DEBUG_ERR("Can't open loopback fixture %s", dev->path);
+		return PON_STATUS_INPUT_ERR;
+	}
+
+	line = malloc(PON_LB_LINE_MAX);
+	if (!line) {
+		fclose(f);
+		return PON_STATUS_MEM_ERR;
+	}
+
+	while (fgets(line, PON_LB_LINE_MAX, f)) {
+		nr++;
+		if (pon_lb_line_parse(dev, line))
+			PON_DEBUG_WRN("Invalid loopback fixture line %u", nr);
+	}
+
+	free(line);
+	fclose(f);
+
+	return PON_STATUS_OK;
+}
+
+static void pon_lb_dev_put(struct pon_lb_dev *dev)
+{
+	struct pon_lb_dev **pp;
+	unsigned int i;
+
+	if (--dev->refcnt)
+		return;
+
+	for (pp = &pon_lb_devs; *pp; pp = &(*pp)->next) {
+		if (*pp == dev) {
+			*pp = dev->next;
+			break;
+		}
+	}
+
+	for (i = 0; i < dev->rec_num; i++)
+		free(dev->rec[i].data);
+	free(dev->rec);
+	free(dev->path);
+	free(dev);
+}
+
+/* Must be called with pon_lb_lock held */
+static struct pon_lb_dev *pon_lb_dev_get(const char *path)
+{
+	struct pon_lb_dev *dev;
+
+	for (dev = pon_lb_devs; dev; dev = dev->next) {
+		if (strcmp(dev->path, path) == 0) {
+			dev->refcnt++;
+			return dev;
+		}
+	}
+
+	dev = calloc(1, sizeof(*dev));
+	if (!dev)
+		return NULL;
+
+	dev->path = strdup(path);
+	if (!dev->path) {
+		free(dev);
+		return NULL;
+	}
+	dev->refcnt = 1;
+
+	if (pon_lb_fixture_load(dev) != PON_STATUS_OK) {
+		free(dev->path);
+		free(dev);
+		return NULL;
+	}
+
+	dev->next = pon_lb_devs;
+	pon_lb_devs = dev;
+
+	return dev;
+}
+
+/* Queue a message for reception, must be called with pon_lb_lock held */
+static void pon_lb_queue(struct pon_lb *ep, struct nl_msg *msg, uint64_t due)
+{
+	struct nlmsghdr *nlh = nlmsg_hdr(msg);
+	struct pon_lb_buf *buf;
+	uint64_t one = 1;
+
+	buf = malloc(sizeof(*buf));
+	if (!buf)
+		return;
+
+	buf->data = malloc(nlh->nlmsg_len);
+	if (!buf->data) {
+		free(buf);
+		return;
+	}
+	memcpy(buf->data, nlh, nlh->nlmsg_len);
+	buf->len = nlh->nlmsg_len;
+	buf->due = due;
+	buf->next = NULL;
+
+	if (ep->tail)
+		ep->tail->next = buf;
+	else
+		ep->head = buf;
+	ep->tail = buf;
+
+	if (write(ep->fd, &one, sizeof(one)) < 0)
+		PON_DEBUG_WRN("Can't signal loopback event fd");
+	pthread_cond_broadcast(&ep->cond);
+}
+
+/* Build a message as the pon_mbox driver sends it */
+static struct nl_msg *pon_lb_msg_build(uint32_t seq, uint8_t type,
+				       uint16_t command, uint8_t read,
+				       uint8_t ack, const void *data,
+				       uint32_t len)
+{
+	struct nl_msg *msg;
+
+	msg = nlmsg_alloc();
+	if (!msg)
+		return NULL;
+
+	if (!genlmsg_put(msg, 0, seq, PON_LB_FAMILY, 0, 0, type, 0) ||
+	    nla_put_u8(msg, PON_MBOX_A_READ_WRITE, read) ||
+	    nla_put_u16(msg, PON_MBOX_A_COMMAND, command) ||
+	    nla_put_u8(msg, PON_MBOX_A_ACK, ack) ||
+	    (data && nla_put(msg, PON_MBOX_A_DATA, len, data))) {
+		nlmsg_free(msg);
+		return NULL;
+	}
+
+	return msg;
+}
+
+/* Send an event to all listeners, must be called with pon_lb_lock held */
+static void pon_lb_event_queue(struct pon_lb_dev *dev, struct pon_lb *only,
+			       uint16_t command, const void *data,
+			       uint32_t len)
+{
+	struct nl_msg *msg;
+	struct pon_lb *ep;
+
+	msg = pon_lb_msg_build(0, PON_MBOX_C_MSG, command, 0, PONFW_CMD,
+			       data, len);
+	if (!msg)
+		return;
+
+	for (ep = dev->ep; ep; ep = ep->next) {
+		if (ep->event && (!only || ep == only))
+			pon_lb_queue(ep, msg, pon_time_us());
+	}
+
+	nlmsg_free(msg);
+}
+
+/*
+ * Netlink callback which overwrites nl_send() of a loopback socket, it
+ * answers the request from the fixture.
+ */
+static int pon_lb_send(struct nl_sock *sk, struct nl_msg *msg)
+{
+	struct nlattr *attrs[PON_MBOX_A_MAX + 1];
+	struct nlmsghdr *nlh = nlmsg_hdr(msg);
+	struct genlmsghdr *header = nlmsg_data(nlh);
+	struct pon_lb_rec *rec;
+	struct nl_msg *answer;
+	struct pon_lb *ep;
+	uint16_t command = 0;
+	uint8_t read = 0;
+	uint8_t ack = PONFW_CMD;
+	uint32_t latency;
+	int len = (int)nlh->nlmsg_len;
+
+	if (genlmsg_parse(nlh, 0, attrs, PON_MBOX_A_MAX,
+			  pon_mbox_genl_policy) < 0)
+		return -NLE_INVAL;
+
+	if (attrs[PON_MBOX_A_COMMAND])
+		command = nla_get_u16(attrs[PON_MBOX_A_COMMAND]);
+	if (attrs[PON_MBOX_A_READ_WRITE])
+		read = nla_get_u8(attrs[PON_MBOX_A_READ_WRITE]);
+	if (attrs[PON_MBOX_A_ACK])
+		ack = nla_get_u8(attrs[PON_MBOX_A_ACK]);
+
+	pthread_mutex_lock(&pon_lb_lock);
+	ep = pon_lb_find(sk);
+	if (!ep) {
+		pthread_mutex_unlock(&pon_lb_lock);
+		return -NLE_BAD_SOCK;
+	}
+
+	/* Answers to events are not answered again */
+	if (header->cmd == PON_MBOX_C_MSG && ack != PONFW_CMD) {
+		pthread_mutex_unlock(&pon_lb_lock);
+		return len;
+	}
+
+	latency = ep->dev->latency;
+	rec = pon_lb_rec_find(ep->dev, command, read);
+	if (rec) {
+		latency = rec->latency;
+		answer = pon_lb_msg_build(nlh->nlmsg_seq, PON_MBOX_C_MSG,
+					  command, read, rec->ack, rec->data,
+					  rec->len);
+	} else if (read && header->cmd == PON_MBOX_C_MSG) {
+		answer = pon_lb_msg_build(nlh->nlmsg_seq, PON_MBOX_C_MSG,
+					  command, read, PONFW_NACK, NULL, 0);
+	} else {
+		/* A write can be read back by the corresponding read */
+		if (header->cmd == PON_MBOX_C_MSG && attrs[PON_MBOX_A_DATA]) {
+			rec = pon_lb_rec_find(ep->dev, command, 1);
+			if (!rec)
+				rec = pon_lb_rec_add(ep->dev);
+			if (rec) {
+				free(rec->data);
+				rec->command = command;
+				rec->read = 1;
+				rec->ack = PONFW_ACK;
+				rec->len = nla_len(attrs[PON_MBOX_A_DATA]);
+				rec->data = malloc(rec->len);
+				if (rec->data)
+					memcpy(rec->data,
+					       nla_data(attrs[PON_MBOX_A_DATA]),
+					       rec->len);
+				else
+					rec->len = 0;
+			}
+		}
+		answer = pon_lb_msg_build(nlh->nlmsg_seq, PON_MBOX_C_MSG,
+					  command, read, PONFW_ACK, NULL, 0);
+	}
+
+	/* The driver answers the mode request without the firmware */
+	if (answer && header->cmd == PON_MBOX_C_MODE_READ && ep->dev->mode &&
+	    nla_put_u8(answer, PON_MBOX_A_PON_MODE, ep->dev->mode)) {
+		nlmsg_free(answer);
+		answer = NULL;
+	}
+
+	if (answer) {
+		pon_lb_queue(ep, answer, pon_time_us() + latency);
+		nlmsg_free(answer);
+	}
+	pthread_mutex_unlock(&pon_lb_lock);
+
+	return len;
+}
+
+/* Wait for a signal of the endpoint, must be called with pon_lb_lock held */
+static void pon_lb_cond_wait(struct pon_lb *ep, uint64_t wait_us)
+{
+	pon_cond_wait_us(&ep->cond, &pon_lb_lock, wait_us);
+}
+
+/*
+ * Netlink callback which overwrites nl_recv() of a loopback socket. The
+ * receive timeout of the context applies as for a real socket, the event
+ * socket blocks until an event was sent.
+ */
+static int pon_lb_recv(struct nl_sock *sk, struct sockaddr_nl *nla,
+		       unsigned char **buf, struct ucred **creds)
+{
+	struct pon_lb_buf *head;
+	struct pon_lb *ep;
+	uint64_t now, end = 0;
+	uint64_t value;
+	int len;
+
+	UNUSED(creds);
+
+	pthread_mutex_lock(&pon_lb_lock);
+	ep = pon_lb_find(sk);
+	if (!ep) {
+		pthread_mutex_unlock(&pon_lb_lock);
+		return -NLE_BAD_SOCK;
+	}
+
+	if (!ep->event)
+		end = pon_time_us() + (uint64_t)ep->ctx->sock_timeout * 1000;
+
+	for (;;) {
+		now = pon_time_us();
+		head = ep->head;
+		if (head && head->due <= now)
+			break;
+
+		if (end && now >= end) {
+			pthread_mutex_unlock(&pon_lb_lock);
+			return -EAGAIN;
+		}
+
+		if (head && (!end || head->due < end))
+			pon_lb_cond_wait(ep, head->due - now);
+		else if (end)
+			pon_lb_cond_wait(ep, end - now);
+		else
+			pthread_cond_wait(&ep->cond, &pon_lb_lock);
+	}
+
+	ep->head = head->next;
+	if (!ep->head) {
+		ep->tail = NULL;
+		if (read(ep->fd, &value, sizeof(value)) < 0)
+			PON_DEBUG_WRN("Can't reset loopback event fd");
+	}
+	pthread_mutex_unlock(&pon_lb_lock);
+
+	memset(nla, 0, sizeof(*nla));
+	nla->nl_family = AF_NETLINK;
+	*buf = head->data;
+	len = (int)head->len;
+	free(head);
+
+	return len;
+}
+
+/* Must be called with pon_lb_lock held */
+static enum fapi_pon_errorcode pon_lb_ep_add(struct pon_ctx *ctx,
+					     struct nl_sock *sk,
+					     struct pon_lb_dev *dev,
+					     int event, struct pon_lb **lb)
+{
+	struct pon_lb *ep;
+	struct nl_cb *s_cb;
+
+	ep = calloc(1, sizeof(*ep));
+	if (!ep)
+		return PON_STATUS_MEM_ERR;
+
+	ep->fd = eventfd(0, EFD_NONBLOCK);
+	if (ep->fd < 0) {
+		free(ep);
+		return PON_STATUS_ERR;
+	}
+	if (pon_cond_init(&ep->cond)) {
+		close(ep->fd);
+		free(ep);
+		return PON_STATUS_ERR;
+	}
+
+	ep->sk = sk;
+	ep->ctx = ctx;
+	ep->dev = dev;
+	ep->event = event;
+	ep->next = dev->ep;
+	dev->ep = ep;
+
+	s_cb = nl_socket_get_cb(sk);
+	nl_cb_overwrite_send(s_cb, pon_lb_send);
+	nl_cb_overwrite_recv(s_cb, pon_lb_recv);
+	nl_cb_put(s_cb);
+
+	*lb = ep;
+
+	return PON_STATUS_OK;
+}
+
+/* Must be called with pon_lb_lock held */
+static void pon_lb_ep_del(struct pon_lb *ep)
+{
+	struct pon_lb_buf *buf;
+	struct pon_lb **pp;
+
+	for (pp = &ep->dev->ep; *pp; pp = &(*pp)->next) {
+		if (*pp == ep) {
+			*pp = ep->next;
+			break;
+		}
+	}
+
+	while (ep->head) {
+		buf = ep->head;
+		ep->head = buf->next;
+		free(buf->data);
+		free(buf);
+	}
+
+	pon_lb_dev_put(ep->dev);
+	pthread_cond_destroy(&ep->cond);
+	close(ep->fd);
+	free(ep);
+}
+
+enum fapi_pon_errorcode pon_lb_attach(struct pon_ctx *ctx, const char *fixture)
+{
+	enum fapi_pon_errorcode err;
+	struct pon_lb_dev *dev;
+
+	pthread_mutex_lock(&pon_lb_lock);
+	dev = pon_lb_dev_get(fixture);
+	if (!dev) {
+		pthread_mutex_unlock(&pon_lb_lock);
+		return PON_STATUS_INPUT_ERR;
+	}
+
+	err = pon_lb_ep_add(ctx, ctx->nls, dev, 0, &ctx->lb);
+	if (err != PON_STATUS_OK)
+		pon_lb_dev_put(dev);
+	pthread_mutex_unlock(&pon_lb_lock);
+
+	ctx->family = PON_LB_FAMILY;
+
+	return err;
+}
+
+enum fapi_pon_errorcode pon_lb_listener_attach(struct pon_ctx *ctx)
+{
+	enum fapi_pon_errorcode err;
+	struct pon_lb_dev *dev;
+	struct pon_lb *ep;
+	unsigned int i;
+
+	pthread_mutex_lock(&pon_lb_lock);
+	dev = ctx->lb->dev;
+	dev->refcnt++;
+
+	err = pon_lb_ep_add(ctx, ctx->nls_event, dev, 1, &ep);
+	if (err != PON_STATUS_OK) {
+		pon_lb_dev_put(dev);
+		pthread_mutex_unlock(&pon_lb_lock);
+		return err;
+	}
+	ctx->lb_event = ep;
+
+	for (i = 0; i < dev->rec_num; i++) {
+		if (dev->rec[i].event)
+			pon_lb_event_queue(dev, ep, dev->rec[i].command,
+					   dev->rec[i].data, dev->rec[i].len);
+	}
+	pthread_mutex_unlock(&pon_lb_lock);
+
+	return PON_STATUS_OK;
+}
+
+void pon_lb_detach(struct pon_ctx *ctx)
+{
+	pthread_mutex_lock(&pon_lb_lock);
+	if (ctx->lb_event)
+		pon_lb_ep_del(ctx->lb_event);
+	if (ctx->lb)
+		pon_lb_ep_del(ctx->lb);
+	pthread_mutex_unlock(&pon_lb_lock);
+
+	ctx->lb_event = NULL;
+	ctx->lb = NULL;
+}
+
+void pon_lb_recv_set(struct nl_cb *cb)
+{
+	nl_cb_overwrite_recv(cb, pon_lb_recv);
+}
+
+int pon_lb_fd_get(struct pon_lb *lb)
+{
+	return lb->fd;
+}
+
+enum fapi_pon_errorcode fapi_pon_loopback_event_send(struct pon_ctx *ctx,
+						     uint16_t command,
+						     const void *data,
+						     uint32_t size)
+{
+	if (!ctx || (!data && size))
+		return PON_STATUS_INPUT_ERR;
+
+	if (!ctx->lb)
+		return PON_STATUS_SUPPORT;
+
+	pthread_mutex_lock(&pon_lb_lock);
+	pon_lb_event_queue(ctx->lb->dev, NULL, command, data, size);
+	pthread_mutex_unlock(&pon_lb_lock);
+
+	return PON_STATUS_OK;
+}
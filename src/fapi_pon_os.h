@@ -13,10 +13,13 @@
 
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <sys/stat.h>
 
 #ifdef HAVE_CONFIG_H
@@ -25,6 +28,9 @@
 
 #ifdef WIN32
 #  include <io.h>
+#  include <winsock2.h>
+/* WSAPoll takes the same arguments as poll */
+#  define poll WSAPoll
 #  define PON_RDONLY _O_RDONLY
 #  define PON_RDWR _O_RDWR
 #  define pon_open _open
@@ -57,6 +63,7 @@ int pon_pwrite(int fd, const void *buf, size_t count, off_t offset)
 #include <sys/timeb.h>
 
 #define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1
 
 static inline
 int clock_gettime(int mode, struct timespec *tv)
@@ -134,6 +141,7 @@ memcmp_s(const void *p, size_t s1, const void *v, size_t s2, int *pret)
 #endif
 #ifdef LINUX
 #  include <unistd.h>
+#  include <poll.h>
 #  define PON_RDONLY O_RDONLY
 #  define PON_RDWR O_RDWR
 #  define pon_open open
@@ -196,6 +204,132 @@ memcmp_s(const void *p, size_t s1, const void *v, size_t s2, int *pret)
 	snprintf(buf, size, fmt, __VA_ARGS__)
 #endif /* HAVE_SPRINTF_S */
 
+#ifdef WIN32
+static inline uint32_t pon_atomic_inc(volatile uint32_t *val)
+{
+	return (uint32_t)InterlockedIncrement((volatile LONG *)val);
+}
+
+static inline uint32_t pon_atomic_get(volatile uint32_t *val)
+{
+	return (uint32_t)InterlockedCompareExchange((volatile LONG *)val,
+						    0, 0);
+}
+
+static inline void pon_atomic_set(volatile uint32_t *val, uint32_t new_val)
+{
+	InterlockedExchange((volatile LONG *)val, (LONG)new_val);
+}
+
+static inline uint32_t pon_atomic_or(volatile uint32_t *val, uint32_t mask)
+{
+	return (uint32_t)InterlockedOr((volatile LONG *)val, (LONG)mask);
+}
+
+static inline uint32_t pon_atomic_and(volatile uint32_t *val, uint32_t mask)
+{
+	return (uint32_t)InterlockedAnd((volatile LONG *)val, (LONG)mask);
+}
+
+static inline void pon_smp_rmb(void)
+{
+	MemoryBarrier();
+}
+
+static inline void pon_smp_wmb(void)
+{
+	MemoryBarrier();
+}
+#else
+static inline uint32_t pon_atomic_inc(volatile uint32_t *val)
+{
+	return __atomic_add_fetch(val, 1, __ATOMIC_SEQ_CST);
+}
+
+static inline uint32_t pon_atomic_get(volatile uint32_t *val)
+{
+	return __atomic_load_n(val, __ATOMIC_ACQUIRE);
+}
+
+static inline void pon_atomic_set(volatile uint32_t *val, uint32_t new_val)
+{
+	__atomic_store_n(val, new_val, __ATOMIC_RELEASE);
+}
+
+/* Atomically sets the bits of mask, returns the previous value */
+static inline uint32_t pon_atomic_or(volatile uint32_t *val, uint32_t mask)
+{
+	return __atomic_fetch_or(val, mask, __ATOMIC_SEQ_CST);
+}
+
+/* Atomically keeps only the bits of mask, returns the previous value */
+static inline uint32_t pon_atomic_and(volatile uint32_t *val, uint32_t mask)
+{
+	return __atomic_fetch_and(val, mask, __ATOMIC_SEQ_CST);
+}
+
+/* Orders the loads before the barrier against the loads after it */
+static inline void pon_smp_rmb(void)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+/* Orders the stores before the barrier against the stores after it */
+static inline void pon_smp_wmb(void)
+{
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+#endif
+
+/* Monotonic time in microseconds, used to measure request durations */
+static inline uint64_t pon_time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Initialize a condition variable for pon_cond_wait_us() */
+static inline int pon_cond_init(pthread_cond_t *cond)
+{
+	pthread_condattr_t attr;
+	int ret;
+
+	ret = pthread_condattr_init(&attr);
+	if (ret)
+		return ret;
+#ifndef WIN32
+	ret = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+	if (!ret)
+		ret = pthread_cond_init(cond, &attr);
+	pthread_condattr_destroy(&attr);
+
+	return ret;
+}
+
+/*
+ * Wait for a signal of the condition variable for at most the given time.
+ * The deadline is taken from the monotonic clock, so a change of the wall
+ * clock does not stretch the wait.
+ */
+static inline int pon_cond_wait_us(pthread_cond_t *cond,
+				   pthread_mutex_t *lock, uint64_t wait_us)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ts.tv_sec += wait_us / 1000000;
+	ts.tv_nsec += (long)(wait_us % 1000000) * 1000;
+	if (ts.tv_nsec >= 1000000000) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000;
+	}
+
+	return pthread_cond_timedwait(cond, lock, &ts);
+}
+
 static inline char *pon_strerr(int err, char *buf, size_t buflen)
 {
 	char *errstr = buf;
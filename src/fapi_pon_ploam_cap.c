@@ -0,0 +1,290 @@
+/******************************************************************************
+ *
+ *  Copyright (c) 2025 MaxLinear, Inc.
+ *
+ * For licensing information, see the file 'LICENSE' in the root folder of
+ * this software module.
+ *
+ *****************************************************************************/
+
+/*
+ * Binary capture of the PLOAM message log events. The event listener only
+ * copies each message into a single producer, single consumer ring buffer,
+ * a writer thread drains the ring buffer into the capture file. When the
+ * ring buffer is full the message is dropped and counted, the event
+ * handling never waits for the file system.
+ *
+ * pon_ploam_cap_lock only protects the capture pointer of the context, so
+ * a capture cannot be freed while the listener stores a message. The
+ * writer thread never takes it.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "pon_config.h"
+#endif
+
+#include <pthread.h>
+#include <time.h>
+
+#include "pon_ip_msg.h"
+#include "fapi_pon.h"
+#include "fapi_pon_os.h"
+#include "fapi_pon_core.h"
+#include "fapi_pon_error.h"
+#include "fapi_pon_debug.h"
+
+/* Default number of messages in the ring buffer */
+#define PON_PLOAM_CAP_SLOTS_DEF 4096
+/* Maximum number of messages in the ring buffer */
+#define PON_PLOAM_CAP_SLOTS_MAX (1024 * 1024)
+/* Maximum length of a captured PLOAM message */
+#define PON_PLOAM_CAP_MSG_MAX 36
+/* Time the writer thread waits between two drains in us */
+#define PON_PLOAM_CAP_PERIOD 100000
+/* Buffer size of the capture file stream */
+#define PON_PLOAM_CAP_FILE_BUF (64 * 1024)
+
+/* One entry of the ring buffer */
+struct pon_ploam_cap_slot {
+	/** Record header as written to the file */
+	struct pon_ploam_cap_rec_hdr hdr;
+	/** Message contents */
+	uint8_t msg[PON_PLOAM_CAP_MSG_MAX];
+};
+
+struct pon_ploam_cap {
+	/** Ring buffer entries */
+	struct pon_ploam_cap_slot *slot;
+	/** Number of entries minus one, the size is a power of two */
+	uint32_t mask;
+	/** Next entry written by the event listener */
+	volatile uint32_t head;
+	/** Next entry read by the writer thread */
+	volatile uint32_t tail;
+	/** Set to 1 to terminate the writer thread */
+	volatile uint32_t stop;
+	/** Number of dropped messages, only written by the event listener */
+	volatile uint32_t dropped;
+	/** Number of messages lost by a failed file write, only written by
+	 *  the writer thread
+	 */
+	volatile uint32_t lost;
+	/** Number of written records, only written by the writer thread */
+	volatile uint32_t records;
+	/** Number of written bytes, only written by the writer thread */
+	uint64_t bytes;
+	/** Monotonic time of the capture start in us */
+	uint64_t start;
+	/** Capture file */
+	FILE *file;
+	/** Writer thread */
+	pthread_t thread;
+};
+
+static pthread_mutex_t pon_ploam_cap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t pon_ploam_cap_time(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+void pon_ploam_cap_put(struct pon_ctx *ctx,
+		       struct pon_ploam_cap_rec_hdr *hdr,
+		       const uint8_t *msg)
+{
+	struct pon_ploam_cap_slot *slot;
+	struct pon_ploam_cap *cap;
+	uint32_t head;
+
+	pthread_mutex_lock(&pon_ploam_cap_lock);
+	cap = ctx->ploam_cap;
+	if (!cap)
+		goto out;
+
+	head = cap->head;
+	if (head - pon_atomic_get(&cap->tail) > cap->mask) {
+		cap->dropped++;
+		goto out;
+	}
+
+	if (hdr->len > PON_PLOAM_CAP_MSG_MAX)
+		hdr->len = PON_PLOAM_CAP_MSG_MAX;
+	hdr->time = pon_ploam_cap_time(CLOCK_MONOTONIC) - cap->start;
+
+	slot = &cap->slot[head & cap->mask];
+	slot->hdr = *hdr;
+	memcpy(slot->msg, msg, hdr->len);
+
+	/* publish the entry to the writer thread */
+	pon_atomic_set(&cap->head, head + 1);
+out:
+	pthread_mutex_unlock(&pon_ploam_cap_lock);
+}
+
+/* Write all entries of the ring buffer to the file */
+static void pon_ploam_cap_drain(struct pon_ploam_cap *cap)
+{
+	struct pon_ploam_cap_slot *slot;
+	uint32_t head = pon_atomic_get(&cap->head);
+	uint32_t tail = cap->tail;
+	size_t len;
+
+	if (head == tail)
+		return;
+
+	for (; tail != head; tail++) {
+		slot = &cap->slot[tail & cap->mask];
+		len = sizeof(slot->hdr) + slot->hdr.len;
+		if (fwrite(slot, 1, len, cap->file) != len) {
+			PON_DEBUG_ERR("PLOAM capture write failed");
+			break;
+		}
+		cap->records++;
+		cap->bytes += len;
+	}
+
+	/* the entries which could not be written are not retried, this
+	 * would only repeat the error and block the ring buffer
+	 */
+	if (tail != head)
+		pon_atomic_set(&cap->lost, cap->lost + (head - tail));
+
+	/* release the entries to the event listener */
+	pon_atomic_set(&cap->tail, head);
+	fflush(cap->file);
+}
+
+static void *pon_ploam_cap_thread(void *arg)
+{
+	struct pon_ploam_cap *cap = arg;
+
+	while (!pon_atomic_get(&cap->stop)) {
+		pon_ploam_cap_drain(cap);
+		usleep(PON_PLOAM_CAP_PERIOD);
+	}
+	pon_ploam_cap_drain(cap);
+
+	return NULL;
+}
+
+static void pon_ploam_cap_free(struct pon_ploam_cap *cap)
+{
+	if (cap->file)
+		fclose(cap->file);
+	free(cap->slot);
+	free(cap);
+}
+
+enum fapi_pon_errorcode fapi_pon_ploam_capture_start(struct pon_ctx *ctx,
+						     const char *file,
+						     uint32_t size)
+{
+	struct pon_ploam_cap_file_hdr hdr = {0};
+	struct pon_ploam_cap *cap;
+	uint32_t slots = 1;
+
+	if (!ctx || !file)
+		return PON_STATUS_INPUT_ERR;
+
+	if (!ctx->nls_event || ctx->ploam_cap)
+		return PON_STATUS_ERR;
+
+	if (!size)
+		size = PON_PLOAM_CAP_SLOTS_DEF;
+	if (size > PON_PLOAM_CAP_SLOTS_MAX)
+		return PON_STATUS_VALUE_RANGE_ERR;
+	while (slots < size)
+		slots <<= 1;
+
+	cap = calloc(1, sizeof(*cap));
+	if (!cap)
+		return PON_STATUS_MEM_ERR;
+
+	cap->slot = calloc(slots, sizeof(*cap->slot));
+	if (!cap->slot) {
+		pon_ploam_cap_free(cap);
+		return PON_STATUS_MEM_ERR;
+	}
+	cap->mask = slots - 1;
+
+	cap->file = fopen(file, "wb");
+	if (!cap->file) {
+		PON_DEBUG_ERR("Cannot open PLOAM capture file %s", file);
+		pon_ploam_cap_free(cap);
+		return PON_STATUS_ERR;
+	}
+	setvbuf(cap->file, NULL, _IOFBF, PON_PLOAM_CAP_FILE_BUF);
+
+	hdr.magic = PON_PLOAM_CAP_MAGIC;
+	hdr.version = PON_PLOAM_CAP_VERSION;
+	hdr.rec_hdr_len = sizeof(struct pon_ploam_cap_rec_hdr);
+	hdr.start_time = pon_ploam_cap_time(CLOCK_REALTIME);
+	cap->start = pon_ploam_cap_time(CLOCK_MONOTONIC);
+	if (fwrite(&hdr, sizeof(hdr), 1, cap->file) != 1) {
+		pon_ploam_cap_free(cap);
+		return PON_STATUS_ERR;
+	}
+	cap->bytes = sizeof(hdr);
+
+	if (pthread_create(&cap->thread, NULL, pon_ploam_cap_thread, cap)) {
+		pon_ploam_cap_free(cap);
+		return PON_STATUS_ERR;
+	}
+
+	pthread_mutex_lock(&pon_ploam_cap_lock);
+	ctx->ploam_cap = cap;
+	pthread_mutex_unlock(&pon_ploam_cap_lock);
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_ploam_capture_stop(struct pon_ctx *ctx)
+{
+	struct pon_ploam_cap *cap;
+
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	/* after this the listener cannot reach the capture anymore */
+	pthread_mutex_lock(&pon_ploam_cap_lock);
+	cap = ctx->ploam_cap;
+	ctx->ploam_cap = NULL;
+	pthread_mutex_unlock(&pon_ploam_cap_lock);
+	if (!cap)
+		return PON_STATUS_OK;
+
+	pon_atomic_set(&cap->stop, 1);
+	pthread_join(cap->thread, NULL);
+	pon_ploam_cap_free(cap);
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_ploam_capture_stats_get(struct pon_ctx *ctx,
+				 struct pon_ploam_cap_stats *stats)
+{
+	struct pon_ploam_cap *cap;
+
+	if (!ctx || !stats)
+		return PON_STATUS_INPUT_ERR;
+
+	pthread_mutex_lock(&pon_ploam_cap_lock);
+	cap = ctx->ploam_cap;
+	if (!cap) {
+		pthread_mutex_unlock(&pon_ploam_cap_lock);
+		return PON_STATUS_ERR;
+	}
+
+	stats->records = pon_atomic_get(&cap->records);
+	stats->dropped = (uint64_t)pon_atomic_get(&cap->dropped) +
+			 pon_atomic_get(&cap->lost);
+	stats->bytes = cap->bytes;
+	pthread_mutex_unlock(&pon_ploam_cap_lock);
+
+	return PON_STATUS_OK;
+}
@@ -0,0 +1,456 @@
+/******************************************************************************
+ *
+ *  Copyright (c) 2025 MaxLinear, Inc.
+ *
+ * For licensing information, see the file 'LICENSE' in the root folder of
+ * this software module.
+ *
+ *****************************************************************************/
+
+/*
+ * Export of the counters to a POSIX shared memory object. A thread reads
+ * the counters into a private buffer and copies the complete sample into
+ * the shared region, guarded by a sequence counter. The sequence counter is
+ * odd while the region is updated, a reader copies the sample and retries
+ * if the sequence counter was odd or changed during the copy. The readers
+ * never block the writer and do not need a PON library context.
+ *
+ * The exporting process holds an exclusive lock on the shared memory
+ * object. The lock goes away with the process, so an object left behind by
+ * a terminated exporter is taken over by the next one, while a second
+ * export of a running exporter is rejected.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "pon_config.h"
+#endif
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pon_ip_msg.h"
+#include "fapi_pon.h"
+#include "fapi_pon_os.h"
+#include "fapi_pon_core.h"
+#include "fapi_pon_error.h"
+#include "fapi_pon_debug.h"
+
+/* Magic number at the start of the shared memory region, "PONC" */
+#define PON_SHM_MAGIC 0x504F4E43
+/* Version of the shared memory region layout */
+#define PON_SHM_VERSION 1
+/* Default time between two samples in ms */
+#define PON_SHM_PERIOD_DEF 1000
+/* Default counter groups, the groups read per GEM port or allocation are
+ * only sampled on request as they cost a firmware request per entry
+ */
+#define PON_SHM_GROUPS_DEF \
+	(PON_SHM_GTC | PON_SHM_XGTC | PON_SHM_FEC | PON_SHM_GEM_ALL | \
+	 PON_SHM_OPTIC)
+/* Number of attempts of a reader to get a consistent sample */
+#define PON_SHM_READ_RETRY 100
+/* Maximum length of the shared memory object name */
+#define PON_SHM_NAME_LEN 64
+
+/* Layout of the shared memory region */
+struct pon_shm_region {
+	/** Magic number, PON_SHM_MAGIC */
+	uint32_t magic;
+	/** Layout version, PON_SHM_VERSION */
+	uint32_t version;
+	/** Size of the counter sample in bytes */
+	uint32_t size;
+	/** Set to 1 when the export was stopped */
+	volatile uint32_t stopped;
+	/** Sequence counter, odd while the sample is updated */
+	volatile uint32_t seq;
+	/** Latest counter sample */
+	struct pon_shm_counters cnt;
+};
+
+struct pon_shm_export {
+	/** Shared memory region */
+	struct pon_shm_region *region;
+	/** Sample read by the thread before it is published */
+	struct pon_shm_counters cnt;
+	/** Configuration */
+	struct pon_shm_cfg cfg;
+	/** Name of the shared memory object */
+	char name[PON_SHM_NAME_LEN];
+	/** Shared memory object, holds the lock of the exporter */
+	int fd;
+	/** Set to 1 to terminate the sampling thread */
+	volatile uint32_t stop;
+	/** Sampling thread */
+	pthread_t thread;
+	/** Context used to read the counters */
+	struct pon_ctx *ctx;
+};
+
+struct pon_shm_reader {
+	/** Shared memory region, mapped read only */
+	const struct pon_shm_region *region;
+};
+
+/* Read the GEM port based counters */
+static void pon_shm_gem_read(struct pon_shm_export *exp)
+{
+	struct pon_shm_counters *cnt = &exp->cnt;
+	enum fapi_pon_errorcode ret;
+	uint32_t num = PON_SHM_GEM_MAX;
+	uint32_t i;
+
+	ret = fapi_pon_gem_port_counters_batch_get(exp->ctx, NULL, &num,
+						   cnt->gem);
+	if (ret != PON_STATUS_OK)
+		return;
+	cnt->gem_num = num;
+	cnt->valid |= PON_SHM_GEM;
+
+	if (!(exp->cfg.groups & PON_SHM_ETH))
+		return;
+
+	for (i = 0; i < num; i++) {
+		ret = fapi_pon_eth_rx_counters_get(exp->ctx,
+						   cnt->gem[i].gem_port_id,
+						   &cnt->eth_rx[i]);
+		if (ret != PON_STATUS_OK)
+			return;
+		ret = fapi_pon_eth_tx_counters_get(exp->ctx,
+						   cnt->gem[i].gem_port_id,
+						   &cnt->eth_tx[i]);
+		if (ret != PON_STATUS_OK)
+			return;
+	}
+	cnt->valid |= PON_SHM_ETH;
+}
+
+/* Read the counters of all allocation indexes which can be read */
+static void pon_shm_alloc_read(struct pon_shm_export *exp)
+{
+	struct pon_shm_counters *cnt = &exp->cnt;
+	struct pon_range_limits limits = {0};
+	uint32_t i, num;
+
+	if (fapi_pon_limits_get(exp->ctx, &limits) != PON_STATUS_OK)
+		return;
+
+	num = limits.alloc_idx_max + 1;
+	if (num > PON_SHM_ALLOC_MAX)
+		num = PON_SHM_ALLOC_MAX;
+
+	for (i = 0; i < num; i++) {
+		if (fapi_pon_alloc_counters_get(exp->ctx, (uint8_t)i,
+					&cnt->alloc[cnt->alloc_num]))
+			continue;
+		cnt->alloc_index[cnt->alloc_num++] = (uint8_t)i;
+	}
+	cnt->valid |= PON_SHM_ALLOC;
+}
+
+/* Read all configured counter groups into the private sample */
+static void pon_shm_sample(struct pon_shm_export *exp)
+{
+	struct pon_shm_counters *cnt = &exp->cnt;
+	struct pon_cnt_snapshot snap = {0};
+	uint32_t groups = exp->cfg.groups;
+	uint32_t snap_groups = 0;
+	uint32_t sample = cnt->sample;
+
+	memset(cnt, 0, sizeof(*cnt));
+	cnt->sample = sample + 1;
+
+	if (groups & (PON_SHM_GTC | PON_SHM_XGTC | PON_SHM_FEC))
+		snap_groups |= PON_CNT_SNAP_GTC;
+	if (groups & PON_SHM_XGTC)
+		snap_groups |= PON_CNT_SNAP_XGTC;
+	if (groups & PON_SHM_FEC)
+		snap_groups |= PON_CNT_SNAP_STATUS;
+	if (groups & PON_SHM_GEM_ALL)
+		snap_groups |= PON_CNT_SNAP_GEM_ALL;
+	snap_groups &= pon_cnt_snapshot_groups(exp->ctx);
+
+	if (snap_groups &&
+	    fapi_pon_cnt_snapshot_get(exp->ctx, snap_groups,
+				      &snap) == PON_STATUS_OK) {
+		cnt->pon_mode = snap.pon_mode;
+		if ((groups & PON_SHM_GTC) && (snap.valid & PON_CNT_SNAP_GTC)) {
+			cnt->gtc = snap.gtc;
+			cnt->valid |= PON_SHM_GTC;
+		}
+		if ((groups & PON_SHM_XGTC) &&
+		    !fapi_pon_cnt_snapshot_xgtc_get(&snap, &cnt->xgtc))
+			cnt->valid |= PON_SHM_XGTC;
+		if ((groups & PON_SHM_FEC) &&
+		    !fapi_pon_cnt_snapshot_fec_get(&snap, &cnt->fec))
+			cnt->valid |= PON_SHM_FEC;
+		if (snap.valid & PON_CNT_SNAP_GEM_ALL) {
+			cnt->gem_all = snap.gem_all;
+			cnt->valid |= PON_SHM_GEM_ALL;
+		}
+	}
+
+	if (groups & (PON_SHM_GEM | PON_SHM_ETH))
+		pon_shm_gem_read(exp);
+
+	if (groups & PON_SHM_ALLOC)
+		pon_shm_alloc_read(exp);
+
+	if ((groups & PON_SHM_OPTIC) &&
+	    fapi_pon_optic_status_cached_get(exp->ctx, &cnt->optic,
+					     exp->cfg.tx_power_scale,
+					     exp->cfg.period) == PON_STATUS_OK)
+		cnt->valid |= PON_SHM_OPTIC;
+
+	cnt->time = pon_time_us();
+}
+
+/* Copy the private sample into the shared region */
+static void pon_shm_publish(struct pon_shm_export *exp)
+{
+	struct pon_shm_region *region = exp->region;
+	uint32_t seq = region->seq;
+
+	pon_atomic_set(&region->seq, seq + 1);
+	pon_smp_wmb();
+	memcpy(&region->cnt, &exp->cnt, sizeof(region->cnt));
+	pon_atomic_set(&region->seq, seq + 2);
+}
+
+static void *pon_shm_thread(void *arg)
+{
+	struct pon_shm_export *exp = arg;
+	uint64_t period = (uint64_t)exp->cfg.period * 1000;
+	uint64_t start, spent;
+
+	while (!pon_atomic_get(&exp->stop)) {
+		start = pon_time_us();
+		pon_shm_sample(exp);
+		pon_shm_publish(exp);
+
+		spent = pon_time_us() - start;
+		if (spent < period)
+			usleep((useconds_t)(period - spent));
+	}
+
+	return NULL;
+}
+
+static void pon_shm_export_free(struct pon_shm_export *exp, bool destroy)
+{
+	if (exp->region) {
+		pon_atomic_set(&exp->region->stopped, 1);
+		munmap(exp->region, sizeof(*exp->region));
+	}
+	if (destroy)
+		shm_unlink(exp->name);
+	if (exp->fd >= 0)
+		close(exp->fd);
+	free(exp);
+}
+
+enum fapi_pon_errorcode
+fapi_pon_shm_export_start(struct pon_ctx *ctx, const char *name,
+			  const struct pon_shm_cfg *cfg)
+{
+	struct pon_shm_export *exp;
+	void *region;
+	uint32_t seq;
+
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	/* The samples are read concurrently to the other requests */
+	if (!ctx->mt || ctx->shm_export)
+		return PON_STATUS_ERR;
+
+	if (!name)
+		name = PON_SHM_NAME_DEF;
+	if (name[0] != '/' || strnlen_s(name, PON_SHM_NAME_LEN) >=
+			      PON_SHM_NAME_LEN)
+		return PON_STATUS_INPUT_ERR;
+
+	exp = calloc(1, sizeof(*exp));
+	if (!exp)
+		return PON_STATUS_MEM_ERR;
+	exp->fd = -1;
+
+	if (cfg)
+		exp->cfg = *cfg;
+	if (!exp->cfg.period)
+		exp->cfg.period = PON_SHM_PERIOD_DEF;
+	if (!exp->cfg.groups)
+		exp->cfg.groups = PON_SHM_GROUPS_DEF;
+	/* the Ethernet counters are read for the active GEM ports */
+	if (exp->cfg.groups & PON_SHM_ETH)
+		exp->cfg.groups |= PON_SHM_GEM;
+	sprintf_s(exp->name, sizeof(exp->name), "%s", name);
+	exp->ctx = ctx;
+
+	exp->fd = shm_open(exp->name, O_CREAT | O_RDWR, 0644);
+	if (exp->fd < 0) {
+		PON_DEBUG_ERR("Cannot create shared memory %s", exp->name);
+		pon_shm_export_free(exp, false);
+		return PON_STATUS_RESOURCE_ERR;
+	}
+
+	/* only one export per name, the object of a terminated exporter is
+	 * not locked anymore and is taken over
+	 */
+	if (flock(exp->fd, LOCK_EX | LOCK_NB)) {
+		PON_DEBUG_ERR("Shared memory %s is exported by another process",
+			      exp->name);
+		pon_shm_export_free(exp, false);
+		return PON_STATUS_RESOURCE_ERR;
+	}
+
+	if (ftruncate(exp->fd, sizeof(*exp->region))) {
+		pon_shm_export_free(exp, true);
+		return PON_STATUS_MEM_ERR;
+	}
+
+	region = mmap(NULL, sizeof(*exp->region), PROT_READ | PROT_WRITE,
+		      MAP_SHARED, exp->fd, 0);
+	if (region == MAP_FAILED) {
+		pon_shm_export_free(exp, true);
+		return PON_STATUS_MEM_ERR;
+	}
+
+	exp->region = region;
+	/* A taken over region can be in the middle of an update, continue
+	 * with an even sequence counter so that the next update is seen
+	 */
+	seq = exp->region->seq;
+	pon_atomic_set(&exp->region->seq, (seq + 1) & ~1U);
+	pon_atomic_set(&exp->region->stopped, 0);
+	exp->region->size = sizeof(exp->region->cnt);
+	exp->region->version = PON_SHM_VERSION;
+	/* the magic number makes the region valid for the readers */
+	pon_smp_wmb();
+	pon_atomic_set(&exp->region->magic, PON_SHM_MAGIC);
+
+	if (pthread_create(&exp->thread, NULL, pon_shm_thread, exp)) {
+		PON_DEBUG_ERR("Cannot start shared memory export thread");
+		pon_shm_export_free(exp, true);
+		return PON_STATUS_ERR;
+	}
+
+	ctx->shm_export = exp;
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_shm_export_stop(struct pon_ctx *ctx)
+{
+	struct pon_shm_export *exp;
+
+	if (!ctx)
+		return PON_STATUS_INPUT_ERR;
+
+	exp = ctx->shm_export;
+	if (!exp)
+		return PON_STATUS_OK;
+
+	ctx->shm_export = NULL;
+	pon_atomic_set(&exp->stop, 1);
+	pthread_join(exp->thread, NULL);
+	pon_shm_export_free(exp, true);
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_shm_reader_open(const char *name, struct pon_shm_reader **reader)
+{
+	const struct pon_shm_region *region;
+	struct pon_shm_reader *rd;
+	struct stat st;
+	void *map;
+	int fd;
+
+	if (!reader)
+		return PON_STATUS_INPUT_ERR;
+
+	if (!name)
+		name = PON_SHM_NAME_DEF;
+
+	fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0)
+		return PON_STATUS_RESOURCE_ERR;
+
+	if (fstat(fd, &st) || (size_t)st.st_size < sizeof(*region)) {
+		close(fd);
+		return PON_STATUS_RESOURCE_ERR;
+	}
+
+	map = mmap(NULL, sizeof(*region), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return PON_STATUS_MEM_ERR;
+	region = map;
+
+	if (pon_atomic_get((volatile uint32_t *)&region->magic) !=
+	    PON_SHM_MAGIC || region->version != PON_SHM_VERSION ||
+	    region->size != sizeof(region->cnt)) {
+		munmap(map, sizeof(*region));
+		return PON_STATUS_RESOURCE_ERR;
+	}
+
+	rd = calloc(1, sizeof(*rd));
+	if (!rd) {
+		munmap(map, sizeof(*region));
+		return PON_STATUS_MEM_ERR;
+	}
+	rd->region = region;
+	*reader = rd;
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode
+fapi_pon_shm_reader_close(struct pon_shm_reader *reader)
+{
+	if (!reader)
+		return PON_STATUS_INPUT_ERR;
+
+	munmap((void *)reader->region, sizeof(*reader->region));
+	free(reader);
+
+	return PON_STATUS_OK;
+}
+
+enum fapi_pon_errorcode fapi_pon_shm_read(struct pon_shm_reader *reader,
+					  struct pon_shm_counters *cnt)
+{
+	const struct pon_shm_region *region;
+	uint32_t seq, i;
+
+	if (!reader || !cnt)
+		return PON_STATUS_INPUT_ERR;
+
+	region = reader->region;
+	for (i = 0; i < PON_SHM_READ_RETRY; i++) {
+		if (pon_atomic_get((volatile uint32_t *)&region->stopped))
+			return PON_STATUS_RESOURCE_ERR;
+
+		seq = pon_atomic_get((volatile uint32_t *)&region->seq);
+		/* odd while updated, 0 before the first sample */
+		if ((seq & 1) || !seq) {
+			sched_yield();
+			continue;
+		}
+
+		memcpy(cnt, (const void *)&region->cnt, sizeof(*cnt));
+		pon_smp_rmb();
+		if (pon_atomic_get((volatile uint32_t *)&region->seq) == seq)
+			return PON_STATUS_OK;
+	}
+
+	return PON_STATUS_TIMEOUT;
+}
@@ -15,6 +15,8 @@
 #include <stdint.h>
 #include <pthread.h>
 #include <sys/time.h>
+#include <time.h>
+#include <inttypes.h>
 #include "fapi_pon.h"
 
 static const char *help =
@@ -22,6 +24,29 @@ static const char *help =
 	"Options:\n"
 	"-s, --stest	Mailbox stress test. Argument: number of calls per thread.\n"
 	"-t, --threads	Number of threads for chosen test.\n"
+	"-m, --shared	Share one context between all threads.\n"
+	"-b, --bench	Mailbox benchmark. Argument: number of operations per thread.\n"
+	"-c, --mix	Benchmark command mix, comma separated list of\n"
+	"		operations with optional weight, e.g. status:2,counters.\n"
+	"		Operations: status, counters, cfg_get, cfg_set, reg,\n"
+	"		gem.\n"
+	"		Default: status,counters,cfg_get,reg\n"
+	"-M, --mode	Benchmark mode:\n"
+	"		sync  - one context shared by all threads\n"
+	"		pipe  - one context per thread, pipelined requests where\n"
+	"		        available (batched GEM port counter read)\n"
+	"		multi - one context per thread (default)\n"
+	"-w, --warmup	Benchmark warm-up operations per thread, not measured.\n"
+	"-r, --reg	Register address read by the 'reg' operation.\n"
+	"-g, --gem	GEM port ID read by the 'gem' operation, which\n"
+	"		drops the GEM port cache before each read. In sync\n"
+	"		mode this stresses the cold cache of one context.\n"
+	"-o, --format	Benchmark output format: text (default), csv or json.\n"
+	"-l, --loopback	Run on the loopback backend. Argument: fixture file,\n"
+	"		e.g. pon_test_loopback.fix. Checks that a written\n"
+	"		configuration is read back, the stress test and\n"
+	"		benchmark then run on the same emulated device.\n"
+	"		Default benchmark mix: cfg_get,cfg_set\n"
 	"-h, --help	Print help and exit.\n"
 	"-v, --verbose	Enable verbose mode for more debug data.\n"
 	;
@@ -39,11 +64,58 @@ static void print_help(char *app_name)
 static struct option long_opts[] = {
 	{"stest", required_argument, 0, 's'},
 	{"threads", required_argument, 0, 't'},
+	{"shared", no_argument, 0, 'm'},
+	{"bench", required_argument, 0, 'b'},
+	{"mix", required_argument, 0, 'c'},
+	{"mode", required_argument, 0, 'M'},
+	{"warmup", required_argument, 0, 'w'},
+	{"reg", required_argument, 0, 'r'},
+	{"gem", required_argument, 0, 'g'},
+	{"format", required_argument, 0, 'o'},
+	{"loopback", required_argument, 0, 'l'},
 	{"help", no_argument, 0, 'h'},
 	{"verbose", no_argument, 0, 'v'},
 	{0, 0, 0, 0}
 };
 
+/* Benchmark operations */
+enum bench_op {
+	BENCH_OP_STATUS,
+	BENCH_OP_COUNTERS,
+	BENCH_OP_CFG_GET,
+	BENCH_OP_CFG_SET,
+	BENCH_OP_REG,
+	BENCH_OP_GEM,
+	BENCH_OP_MAX
+};
+
+static const char * const bench_op_name[BENCH_OP_MAX] = {
+	"status", "counters", "cfg_get", "cfg_set", "reg", "gem"
+};
+
+/* Benchmark modes */
+enum bench_mode {
+	BENCH_MODE_MULTI,
+	BENCH_MODE_SYNC,
+	BENCH_MODE_PIPE
+};
+
+static const char * const bench_mode_name[] = {
+	"multi", "sync", "pipe"
+};
+
+/* Benchmark output formats */
+enum bench_format {
+	BENCH_FORMAT_TEXT,
+	BENCH_FORMAT_CSV,
+	BENCH_FORMAT_JSON
+};
+
+/* Maximum sum of the operation weights of the command mix */
+#define BENCH_MIX_MAX 64
+/* Number of GEM ports read by one batched counter read */
+#define BENCH_GEM_BATCH 256
+
 /* Structure to control test framework */
 struct test_controller {
 	/* Enable mailbox stress test */
@@ -52,9 +124,53 @@ struct test_controller {
 	uint32_t call_cnt;
 	/* Number of running threads */
 	uint32_t thread_cnt;
+	/* Use one context shared by all threads */
+	bool shared_enabled;
+	/* Context shared by all threads */
+	struct pon_ctx *shared_ctx;
 	/* Enable verbose mode */
 	bool verbose_enabled;
-} test_ctrl;
+	/* Enable mailbox benchmark */
+	bool bench_enabled;
+	/* Benchmark mode */
+	enum bench_mode bench_mode;
+	/* Benchmark output format */
+	enum bench_format bench_format;
+	/* Number of warm-up operations per thread */
+	uint32_t warmup_cnt;
+	/* Register address read by the register operation */
+	uint32_t reg_addr;
+	/* GEM port ID read by the GEM port operation */
+	uint16_t gem_port_id;
+	/* Operation sequence executed by every thread, built from the mix */
+	enum bench_op mix[BENCH_MIX_MAX];
+	/* Number of entries in mix */
+	uint32_t mix_len;
+	/* Synchronizes the start of the measurement of all threads */
+	pthread_mutex_t start_lock;
+	pthread_cond_t start_cond;
+	/* Number of threads which finished the warm-up */
+	uint32_t ready_cnt;
+	/* Set when the measurement starts */
+	bool go;
+	/* Fixture file of the loopback backend, NULL for the driver */
+	const char *loopback;
+	/* Keeps the emulated loopback device open until the end of the test */
+	struct pon_ctx *lb_ctx;
+} test_ctrl = {
+	.start_lock = PTHREAD_MUTEX_INITIALIZER,
+	.start_cond = PTHREAD_COND_INITIALIZER,
+};
+
+/* Benchmark results of one thread */
+struct bench_result {
+	/* Latency of each measured operation in us */
+	uint32_t *lat;
+	/* Number of measured operations */
+	uint32_t cnt;
+	/* Number of failed operations per operation type */
+	uint32_t errors[BENCH_OP_MAX];
+};
 
 /* Mailbox stress test errors counters */
 struct stest_call_errors {
@@ -62,6 +178,67 @@ struct stest_call_errors {
 	uint32_t mbox_err;
 };
 
+/** Parse the benchmark command mix
+ *
+ *  \param[in] arg Comma separated list of operations with optional weight
+ */
+static int bench_mix_parse(const char *arg)
+{
+	char buf[256];
+	char *tok, *save = NULL, *colon;
+	unsigned int weight;
+	unsigned int op;
+	uint32_t len = 0;
+
+	if (snprintf(buf, sizeof(buf), "%s", arg) >= (int)sizeof(buf))
+		return 1;
+
+	for (tok = strtok_r(buf, ",", &save); tok;
+	     tok = strtok_r(NULL, ",", &save)) {
+		weight = 1;
+		colon = strchr(tok, ':');
+		if (colon) {
+			*colon = '\0';
+			if (sscanf(colon + 1, "%u", &weight) != 1 || !weight)
+				return 1;
+		}
+
+		for (op = 0; op < BENCH_OP_MAX; op++)
+			if (strcmp(tok, bench_op_name[op]) == 0)
+				break;
+		if (op == BENCH_OP_MAX || len + weight > BENCH_MIX_MAX)
+			return 1;
+
+		while (weight--)
+			test_ctrl.mix[len++] = (enum bench_op)op;
+	}
+
+	if (!len)
+		return 1;
+	test_ctrl.mix_len = len;
+
+	return 0;
+}
+
+/** Parse the benchmark mode
+ *
+ *  \param[in] arg Mode name
+ */
+static int bench_mode_parse(const char *arg)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(bench_mode_name) / sizeof(bench_mode_name[0]);
+	     i++) {
+		if (strcmp(arg, bench_mode_name[i]) == 0) {
+			test_ctrl.bench_mode = (enum bench_mode)i;
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
 /** Parse command-line arguments
  *
  *  \param[in] argc Arguments count
@@ -75,7 +252,8 @@ static int parse_args(int argc, char *argv[])
 	int error = 0;
 
 	do {
-		c = getopt_long(argc, argv, "s:t:hv", long_opts, &index);
+		c = getopt_long(argc, argv, "s:t:mb:c:M:w:r:g:o:l:hv",
+				long_opts, &index);
 
 		if (c == -1)
 			return 0;
@@ -88,6 +266,9 @@ static int parse_args(int argc, char *argv[])
 		case 'v':
 			test_ctrl.verbose_enabled = true;
 			break;
+		case 'm':
+			test_ctrl.shared_enabled = true;
+			break;
 		case 's':
 			if (optarg == NULL) {
 				printf("Missing value for argument '-s'\n");
@@ -103,6 +284,75 @@ static int parse_args(int argc, char *argv[])
 
 			test_ctrl.stest_enabled = true;
 			break;
+		case 'b':
+			if (optarg == NULL ||
+			    sscanf(optarg, "%u", &test_ctrl.call_cnt) != 1) {
+				printf("Invalid value for argument '-b'\n");
+				error = 1;
+				break;
+			}
+			test_ctrl.bench_enabled = true;
+			break;
+		case 'c':
+			if (optarg == NULL || bench_mix_parse(optarg)) {
+				printf("Invalid value for argument '-c'\n");
+				error = 1;
+			}
+			break;
+		case 'M':
+			if (optarg == NULL || bench_mode_parse(optarg)) {
+				printf("Invalid value for argument '-M'\n");
+				error = 1;
+			}
+			break;
+		case 'w':
+			if (optarg == NULL ||
+			    sscanf(optarg, "%u", &test_ctrl.warmup_cnt) != 1) {
+				printf("Invalid value for argument '-w'\n");
+				error = 1;
+			}
+			break;
+		case 'r':
+			if (optarg == NULL ||
+			    sscanf(optarg, "%" SCNi32,
+				   &test_ctrl.reg_addr) != 1) {
+				printf("Invalid value for argument '-r'\n");
+				error = 1;
+			}
+			break;
+		case 'g':
+			if (optarg == NULL ||
+			    sscanf(optarg, "%" SCNu16,
+				   &test_ctrl.gem_port_id) != 1) {
+				printf("Invalid value for argument '-g'\n");
+				error = 1;
+			}
+			break;
+		case 'o':
+			if (optarg == NULL) {
+				printf("Missing value for argument '-o'\n");
+				error = 1;
+			} else if (strcmp(optarg, "text") == 0) {
+				test_ctrl.bench_format = BENCH_FORMAT_TEXT;
+			} else if (strcmp(optarg, "csv") == 0) {
+				test_ctrl.bench_format = BENCH_FORMAT_CSV;
+			} else if (strcmp(optarg, "json") == 0) {
+				test_ctrl.bench_format = BENCH_FORMAT_JSON;
+			} else {
+				printf("Invalid value for argument '-o'\n");
+				error = 1;
+			}
+			break;
+		case 'l':
+			if (optarg == NULL) {
+				printf("Missing value for argument '-l'\n");
+				error = 1;
+				break;
+			}
+			test_ctrl.loopback = optarg;
+			/* All contexts opened by the tests use the loopback */
+			setenv("PON_LIB_LOOPBACK", optarg, 1);
+			break;
 		case 't':
 			if (optarg == NULL) {
 				printf("Missing value for argument '-t'\n");
@@ -139,12 +389,16 @@ static void *fapi_pon_call(void *vargo)
 		pthread_exit(0);
 	}
 
-	ret = fapi_pon_open(&ctx);
-	if (ret != PON_STATUS_OK) {
-		printf("fapi_pon_open failed - thread_id=%ld errorcode=%d",
-			(long)pthread_self(),
-			(int)ret);
-		pthread_exit(0);
+	if (test_ctrl.shared_ctx) {
+		ctx = test_ctrl.shared_ctx;
+	} else {
+		ret = fapi_pon_open(&ctx);
+		if (ret != PON_STATUS_OK) {
+			printf("fapi_pon_open failed - thread_id=%ld errorcode=%d",
+				(long)pthread_self(),
+				(int)ret);
+			pthread_exit(0);
+		}
 	}
 
 	for (i = 0; i < calls; i++) {
@@ -162,11 +416,13 @@ static void *fapi_pon_call(void *vargo)
 				(int)ret);
 	}
 
-	ret = fapi_pon_close(ctx);
-	if (ret != PON_STATUS_OK) {
-		printf("fapi_pon_close failed - thread_id=%ld errorcode=%d",
-			(long)pthread_self(),
-			(int)ret);
+	if (!test_ctrl.shared_ctx) {
+		ret = fapi_pon_close(ctx);
+		if (ret != PON_STATUS_OK) {
+			printf("fapi_pon_close failed - thread_id=%ld errorcode=%d",
+				(long)pthread_self(),
+				(int)ret);
+		}
 	}
 
 	if (test_ctrl.verbose_enabled)
@@ -185,6 +441,16 @@ static void mailbox_stress_test(uint32_t threads_cnt, uint32_t calls_cnt,
 	uint32_t i;
 	struct stest_call_errors *stest_thr_err = 0;
 	pthread_t tid[threads_cnt];
+	enum fapi_pon_errorcode ret;
+
+	if (test_ctrl.shared_enabled) {
+		ret = fapi_pon_open_mt(&test_ctrl.shared_ctx);
+		if (ret != PON_STATUS_OK) {
+			printf("fapi_pon_open_mt failed - errorcode=%d\n",
+				(int)ret);
+			return;
+		}
+	}
 
 	for (i = 0; i < threads_cnt; i++) {
 		error = pthread_create(&tid[i], NULL, fapi_pon_call,
@@ -208,6 +474,424 @@ static void mailbox_stress_test(uint32_t threads_cnt, uint32_t calls_cnt,
 			free(stest_thr_err);
 		}
 	}
+
+	if (test_ctrl.shared_ctx) {
+		fapi_pon_close(test_ctrl.shared_ctx);
+		test_ctrl.shared_ctx = NULL;
+	}
+}
+
+/* Benchmark thread data */
+struct bench_thread {
+	/* Thread ID */
+	pthread_t tid;
+	/* Set if the thread was started */
+	bool started;
+	/* Measured results */
+	struct bench_result res;
+	/* GPON configuration written by the cfg_set operation */
+	struct pon_gpon_cfg cfg;
+	/* Buffer used by the batched counter read */
+	struct pon_gem_port_counters *counters;
+};
+
+/* Benchmark statistics of one operation type */
+struct bench_stats {
+	uint32_t cnt;
+	uint32_t errors;
+	uint32_t min;
+	uint32_t avg;
+	uint32_t p50;
+	uint32_t p90;
+	uint32_t p99;
+	uint32_t p999;
+	uint32_t max;
+};
+
+static uint64_t bench_time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static enum fapi_pon_errorcode bench_op_exec(struct pon_ctx *ctx,
+					     struct bench_thread *thr,
+					     enum bench_op op)
+{
+	struct pon_gpon_status status;
+	struct pon_gem_port_counters counters;
+	struct pon_gpon_cfg cfg;
+	struct pon_register reg;
+	uint32_t num = BENCH_GEM_BATCH;
+
+	switch (op) {
+	case BENCH_OP_STATUS:
+		return fapi_pon_gpon_status_get(ctx, &status);
+	case BENCH_OP_COUNTERS:
+		if (thr->counters)
+			return fapi_pon_gem_port_counters_batch_get(ctx, NULL,
+					&num, thr->counters);
+		return fapi_pon_gem_all_counters_get(ctx, &counters);
+	case BENCH_OP_CFG_GET:
+		return fapi_pon_gpon_cfg_get(ctx, &cfg);
+	case BENCH_OP_CFG_SET:
+		return fapi_pon_gpon_cfg_set(ctx, &thr->cfg);
+	case BENCH_OP_REG:
+		return fapi_pon_register_get(ctx, test_ctrl.reg_addr, &reg);
+	case BENCH_OP_GEM:
+		/* Every read starts on a cold GEM port cache */
+		fapi_pon_gem_port_cache_invalidate(ctx);
+		return fapi_pon_gem_port_counters_get(ctx,
+				test_ctrl.gem_port_id, &counters);
+	default:
+		return PON_STATUS_INPUT_ERR;
+	}
+}
+
+static void *bench_call(void *arg)
+{
+	struct bench_thread *thr = arg;
+	struct bench_result *res = &thr->res;
+	struct pon_ctx *ctx = test_ctrl.shared_ctx;
+	enum fapi_pon_errorcode ret = PON_STATUS_OK;
+	enum bench_op op;
+	uint64_t start;
+	uint32_t i;
+
+	if (!ctx)
+		ret = fapi_pon_open(&ctx);
+	if (ret != PON_STATUS_OK) {
+		printf("fapi_pon_open failed - thread_id=%ld errorcode=%d\n",
+			(long)pthread_self(), (int)ret);
+		ctx = NULL;
+	}
+
+	if (ctx && test_ctrl.bench_mode == BENCH_MODE_PIPE) {
+		thr->counters = calloc(BENCH_GEM_BATCH,
+				       sizeof(*thr->counters));
+		if (!thr->counters)
+			printf("Could not allocate memory for counters.\n");
+	}
+
+	/* The current configuration is written back by cfg_set */
+	if (ctx && fapi_pon_gpon_cfg_get(ctx, &thr->cfg) != PON_STATUS_OK)
+		printf("fapi_pon_gpon_cfg_get failed - thread_id=%ld\n",
+			(long)pthread_self());
+
+	for (i = 0; ctx && i < test_ctrl.warmup_cnt; i++)
+		bench_op_exec(ctx, thr,
+			      test_ctrl.mix[i % test_ctrl.mix_len]);
+
+	/* Every thread has to report ready, also in case of an error */
+	pthread_mutex_lock(&test_ctrl.start_lock);
+	test_ctrl.ready_cnt++;
+	pthread_cond_broadcast(&test_ctrl.start_cond);
+	while (!test_ctrl.go)
+		pthread_cond_wait(&test_ctrl.start_cond,
+				  &test_ctrl.start_lock);
+	pthread_mutex_unlock(&test_ctrl.start_lock);
+
+	for (i = 0; ctx && res->lat && i < test_ctrl.call_cnt; i++) {
+		op = test_ctrl.mix[i % test_ctrl.mix_len];
+		start = bench_time_us();
+		ret = bench_op_exec(ctx, thr, op);
+		res->lat[i] = (uint32_t)(bench_time_us() - start);
+		res->cnt++;
+		if (ret != PON_STATUS_OK) {
+			res->errors[op]++;
+			if (test_ctrl.verbose_enabled)
+				printf("thread_id=%ld op=%s errorcode=%d\n",
+					(long)pthread_self(),
+					bench_op_name[op], (int)ret);
+		}
+	}
+
+	if (ctx && !test_ctrl.shared_ctx)
+		fapi_pon_close(ctx);
+	free(thr->counters);
+	thr->counters = NULL;
+
+	return NULL;
+}
+
+static int bench_lat_cmp(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/** Calculate the statistics of one operation type
+ *
+ *  \param[in] thr Benchmark thread data
+ *  \param[in] op Operation type, BENCH_OP_MAX for all operations
+ *  \param[in] lat Buffer which can hold all measured latencies
+ *  \param[out] stats Calculated statistics
+ */
+static void bench_stats_get(const struct bench_thread *thr,
+			    enum bench_op op, uint32_t *lat,
+			    struct bench_stats *stats)
+{
+	uint64_t sum = 0;
+	uint32_t t, i, cnt = 0;
+	enum bench_op cur;
+
+	memset(stats, 0, sizeof(*stats));
+
+	for (t = 0; t < test_ctrl.thread_cnt; t++) {
+		for (i = 0; i < thr[t].res.cnt; i++) {
+			cur = test_ctrl.mix[i % test_ctrl.mix_len];
+			if (op != BENCH_OP_MAX && cur != op)
+				continue;
+			lat[cnt++] = thr[t].res.lat[i];
+			sum += thr[t].res.lat[i];
+		}
+		for (i = 0; i < BENCH_OP_MAX; i++)
+			if (op == BENCH_OP_MAX || op == (enum bench_op)i)
+				stats->errors += thr[t].res.errors[i];
+	}
+
+	stats->cnt = cnt;
+	if (!cnt)
+		return;
+
+	qsort(lat, cnt, sizeof(*lat), bench_lat_cmp);
+	stats->min = lat[0];
+	stats->max = lat[cnt - 1];
+	stats->avg = (uint32_t)(sum / cnt);
+	stats->p50 = lat[(uint64_t)(cnt - 1) * 500 / 1000];
+	stats->p90 = lat[(uint64_t)(cnt - 1) * 900 / 1000];
+	stats->p99 = lat[(uint64_t)(cnt - 1) * 990 / 1000];
+	stats->p999 = lat[(uint64_t)(cnt - 1) * 999 / 1000];
+}
+
+static void bench_print(const char *name, const struct bench_stats *stats,
+			double time, bool first)
+{
+	double ops = time > 0 ? stats->cnt / time : 0;
+
+	switch (test_ctrl.bench_format) {
+	case BENCH_FORMAT_CSV:
+		printf("%s,%u,%s,%u,%u,%.1lf,%u,%u,%u,%u,%u,%u,%u\n",
+			bench_mode_name[test_ctrl.bench_mode],
+			test_ctrl.thread_cnt, name, stats->cnt,
+			stats->errors, ops, stats->min, stats->avg,
+			stats->p50, stats->p90, stats->p99, stats->p999,
+			stats->max);
+		break;
+	case BENCH_FORMAT_JSON:
+		printf("%s\n    {\"op\": \"%s\", \"count\": %u, "
+			"\"errors\": %u, "
+			"\"ops_per_sec\": %.1lf, \"min_us\": %u, "
+			"\"avg_us\": %u, \"p50_us\": %u, \"p90_us\": %u, "
+			"\"p99_us\": %u, \"p999_us\": %u, \"max_us\": %u}",
+			first ? "" : ",", name, stats->cnt, stats->errors,
+			ops, stats->min, stats->avg, stats->p50, stats->p90,
+			stats->p99, stats->p999, stats->max);
+		break;
+	default:
+		printf("%-9s %9u %7u %10.1lf %7u %7u %7u %7u %7u %7u %7u\n",
+			name, stats->cnt, stats->errors, ops, stats->min,
+			stats->avg, stats->p50, stats->p90, stats->p99,
+			stats->p999, stats->max);
+		break;
+	}
+}
+
+static void bench_report(const struct bench_thread *thr, double time)
+{
+	struct bench_stats stats;
+	uint32_t *lat;
+	uint32_t total = test_ctrl.thread_cnt * test_ctrl.call_cnt;
+	bool used[BENCH_OP_MAX] = {0};
+	bool first = true;
+	uint32_t i;
+
+	lat = calloc(total ? total : 1, sizeof(*lat));
+	if (!lat) {
+		printf("Could not allocate memory for the benchmark report.\n");
+		return;
+	}
+
+	for (i = 0; i < test_ctrl.mix_len; i++)
+		used[test_ctrl.mix[i]] = true;
+
+	switch (test_ctrl.bench_format) {
+	case BENCH_FORMAT_CSV:
+		printf("mode,threads,op,count,errors,ops_per_sec,min_us,avg_us,p50_us,p90_us,p99_us,p999_us,max_us\n");
+		break;
+	case BENCH_FORMAT_JSON:
+		printf("{\n  \"mode\": \"%s\",\n  \"threads\": %u,\n"
+			"  \"ops_per_thread\": %u,\n  \"warmup\": %u,\n"
+			"  \"time_s\": %.3lf,\n  \"results\": [",
+			bench_mode_name[test_ctrl.bench_mode],
+			test_ctrl.thread_cnt, test_ctrl.call_cnt,
+			test_ctrl.warmup_cnt, time);
+		break;
+	default:
+		printf("mode=%s threads=%u ops_per_thread=%u warmup=%u time=%.3lf\n",
+			bench_mode_name[test_ctrl.bench_mode],
+			test_ctrl.thread_cnt, test_ctrl.call_cnt,
+			test_ctrl.warmup_cnt, time);
+		printf("%-9s %9s %7s %10s %7s %7s %7s %7s %7s %7s %7s\n",
+			"op", "count", "errors", "ops/s", "min_us", "avg_us",
+			"p50_us", "p90_us", "p99_us", "p999_us", "max_us");
+		break;
+	}
+
+	for (i = 0; i < BENCH_OP_MAX; i++) {
+		if (!used[i])
+			continue;
+		bench_stats_get(thr, (enum bench_op)i, lat, &stats);
+		bench_print(bench_op_name[i], &stats, time, first);
+		first = false;
+	}
+	bench_stats_get(thr, BENCH_OP_MAX, lat, &stats);
+	bench_print("all", &stats, time, first);
+
+	if (test_ctrl.bench_format == BENCH_FORMAT_JSON)
+		printf("\n  ]\n}\n");
+
+	free(lat);
+}
+
+static int mailbox_benchmark(void)
+{
+	struct bench_thread *thr;
+	enum fapi_pon_errorcode ret;
+	uint64_t start, stop;
+	uint32_t started = 0;
+	uint32_t i;
+	int error;
+
+	if (!test_ctrl.mix_len)
+		bench_mix_parse(test_ctrl.loopback ? "cfg_get,cfg_set" :
+				"status,counters,cfg_get,reg");
+
+	thr = calloc(test_ctrl.thread_cnt, sizeof(*thr));
+	if (!thr) {
+		printf("Could not allocate memory for the benchmark.\n");
+		return 1;
+	}
+
+	for (i = 0; i < test_ctrl.thread_cnt; i++) {
+		thr[i].res.lat = calloc(test_ctrl.call_cnt ?
+					test_ctrl.call_cnt : 1,
+					sizeof(*thr[i].res.lat));
+		if (!thr[i].res.lat)
+			printf("Could not allocate memory for latencies.\n");
+	}
+
+	if (test_ctrl.bench_mode == BENCH_MODE_SYNC) {
+		ret = fapi_pon_open_mt(&test_ctrl.shared_ctx);
+		if (ret != PON_STATUS_OK) {
+			printf("fapi_pon_open_mt failed - errorcode=%d\n",
+				(int)ret);
+			test_ctrl.shared_ctx = NULL;
+		}
+	}
+
+	for (i = 0; i < test_ctrl.thread_cnt; i++) {
+		error = pthread_create(&thr[i].tid, NULL, bench_call, &thr[i]);
+		if (error != 0) {
+			printf("pthread create failed - id=%d errorcode=%d\n",
+				i, error);
+			continue;
+		}
+		thr[i].started = true;
+		started++;
+	}
+
+	/* Start the measurement when all threads finished the warm-up */
+	pthread_mutex_lock(&test_ctrl.start_lock);
+	while (test_ctrl.ready_cnt < started)
+		pthread_cond_wait(&test_ctrl.start_cond,
+				  &test_ctrl.start_lock);
+	start = bench_time_us();
+	test_ctrl.go = true;
+	pthread_cond_broadcast(&test_ctrl.start_cond);
+	pthread_mutex_unlock(&test_ctrl.start_lock);
+
+	for (i = 0; i < test_ctrl.thread_cnt; i++) {
+		if (!thr[i].started)
+			continue;
+		error = pthread_join(thr[i].tid, NULL);
+		if (error != 0)
+			printf("pthread_join failed - id=%d errorcode=%d\n",
+				i, error);
+	}
+
+	stop = bench_time_us();
+
+	if (test_ctrl.shared_ctx) {
+		fapi_pon_close(test_ctrl.shared_ctx);
+		test_ctrl.shared_ctx = NULL;
+	}
+
+	bench_report(thr, (stop - start) / 1000000.0);
+
+	for (i = 0; i < test_ctrl.thread_cnt; i++)
+		free(thr[i].res.lat);
+	free(thr);
+
+	return 0;
+}
+
+/** Write the ONU configuration to the loopback device and read it back.
+ *  The context stays open, so the stress test and the benchmark find the
+ *  configuration on the same emulated device.
+ */
+static int loopback_test(void)
+{
+	static const char serial_no[PON_SERIAL_NO_SIZE] = "LBTS0001";
+	struct pon_gpon_cfg set = {0};
+	struct pon_gpon_cfg get = {0};
+	enum fapi_pon_errorcode ret;
+	unsigned int i;
+
+	ret = fapi_pon_open_loopback(&test_ctrl.lb_ctx, test_ctrl.loopback);
+	if (ret != PON_STATUS_OK) {
+		printf("fapi_pon_open_loopback failed - errorcode=%d\n",
+			(int)ret);
+		test_ctrl.lb_ctx = NULL;
+		return 1;
+	}
+
+	memcpy(set.serial_no, serial_no, sizeof(set.serial_no));
+	for (i = 0; i < sizeof(set.reg_id); i++)
+		set.reg_id[i] = (uint8_t)i;
+	set.mode = PON_MODE_9807_XGSPON;
+	set.ploam_timeout_1 = 100;
+	set.ploam_timeout_2 = 125;
+
+	ret = fapi_pon_gpon_cfg_set(test_ctrl.lb_ctx, &set);
+	if (ret != PON_STATUS_OK) {
+		printf("loopback: cfg_set failed - errorcode=%d\n", (int)ret);
+		return 1;
+	}
+
+	ret = fapi_pon_gpon_cfg_get(test_ctrl.lb_ctx, &get);
+	if (ret != PON_STATUS_OK) {
+		printf("loopback: cfg_get failed - errorcode=%d\n", (int)ret);
+		return 1;
+	}
+
+	if (memcmp(get.serial_no, set.serial_no, sizeof(get.serial_no)) ||
+	    memcmp(get.reg_id, set.reg_id, sizeof(get.reg_id)) ||
+	    get.mode != set.mode ||
+	    get.ploam_timeout_1 != set.ploam_timeout_1 ||
+	    get.ploam_timeout_2 != set.ploam_timeout_2) {
+		printf("loopback: configuration read back differs\n");
+		return 1;
+	}
+
+	printf("loopback: configuration read back ok\n");
+
+	return 0;
 }
 
 int main(int argc, char *argv[])
@@ -215,6 +899,7 @@ int main(int argc, char *argv[])
 	struct timeval stop, start;
 	struct stest_call_errors stest_err = {0};
 	unsigned long long start_mili, stop_mili;
+	int ret = 0;
 
 	/* parse commands arguments */
 	if (parse_args(argc, argv)) {
@@ -226,6 +911,12 @@ int main(int argc, char *argv[])
 		/* set default thread number */
 		test_ctrl.thread_cnt = 8;
 
+	if (test_ctrl.loopback) {
+		ret = loopback_test();
+		if (ret)
+			goto out;
+	}
+
 	if (test_ctrl.stest_enabled) {
 		gettimeofday(&start, NULL);
 
@@ -248,8 +939,15 @@ int main(int argc, char *argv[])
 			test_ctrl.thread_cnt, test_ctrl.call_cnt,
 			test_ctrl.thread_cnt * test_ctrl.call_cnt);
 
-		return 0;
+		goto out;
 	}
 
-	return 0;
+	if (test_ctrl.bench_enabled)
+		ret = mailbox_benchmark();
+
+out:
+	if (test_ctrl.lb_ctx)
+		fapi_pon_close(test_ctrl.lb_ctx);
+
+	return ret;
 }